@@ -0,0 +1,127 @@
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <libslic3r/Arachne/WallToolPaths.hpp>
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Format/OBJ.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/TriangleMeshSlicer.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+// Count heap allocations of the whole process, the wall generator is the only thing running while measuring.
+static std::atomic<size_t> g_num_allocations { 0 };
+
+void* operator new(std::size_t size)
+{
+    ++ g_num_allocations;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace Slic3r {
+
+enum { WallGeneration };
+struct MeasureResult
+{
+    static constexpr const char * Names[] = {
+        "Wall generation [s]",
+    };
+
+    double measurements[std::size(Names)] = {0.};
+    size_t num_allocations = 0;
+    size_t num_lines       = 0;
+};
+
+static std::vector<ExPolygons> slice_outlines(const indexed_triangle_set &its, double layer_height)
+{
+    BoundingBoxf3 bb = bounding_box(its);
+    std::vector<float> zs;
+    for (double z = bb.min.z() + 0.5 * layer_height; z < bb.max.z(); z += layer_height)
+        zs.emplace_back(float(z));
+    return slice_mesh_ex(its, zs);
+}
+
+static MeasureResult measure_walls(const std::vector<ExPolygons> &layers, double layer_height, size_t num_runs)
+{
+    Arachne::WallToolPathsParams params;
+    params.min_bead_width                   = 0.34f;
+    params.min_feature_size                 = 0.1f;
+    params.min_length_factor                = 0.5f;
+    params.wall_transition_length           = 0.4f;
+    params.wall_transition_angle            = 10.f;
+    params.wall_transition_filter_deviation = 0.1f;
+    params.wall_distribution_count          = 1;
+    params.is_top_or_bottom_layer           = false;
+    const coord_t bead_width = scaled<coord_t>(0.45);
+
+    Benchmark     b;
+    MeasureResult r;
+    for (size_t run = 0; run < num_runs; ++ run)
+        for (const ExPolygons &layer : layers) {
+            const Polygons outline = to_polygons(layer);
+            const size_t num_allocations = g_num_allocations;
+            b.start();
+            Arachne::WallToolPaths wall_tool_paths(outline, bead_width, bead_width, 3, 0, layer_height, params);
+            const std::vector<Arachne::VariableWidthLines> &toolpaths = wall_tool_paths.getToolPaths();
+            b.stop();
+            r.measurements[WallGeneration] += b.getElapsedSec();
+            r.num_allocations += g_num_allocations - num_allocations;
+            for (const Arachne::VariableWidthLines &lines : toolpaths)
+                r.num_lines += lines.size();
+        }
+
+    r.measurements[WallGeneration] /= double(num_runs);
+    r.num_allocations /= num_runs;
+    r.num_lines /= num_runs;
+    return r;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    if (argc < 2) {
+        std::cerr << "Usage: arachne_bench <model.obj|model.stl>..., e.g. tests/data/*.obj" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const double layer_height = 0.2;
+    const size_t num_runs     = 3;
+
+    for (int i = 1; i < argc; ++ i) {
+        const std::string path = argv[i];
+        TriangleMesh mesh;
+        bool loaded = false;
+        if (path.size() > 4 && path.substr(path.size() - 4) == ".obj") {
+            ObjInfo     obj_info;
+            std::string message;
+            loaded = load_obj(path.c_str(), &mesh, obj_info, message);
+        } else
+            loaded = mesh.ReadSTLFile(path.c_str());
+        if (! loaded) {
+            std::cerr << "Failed to load " << path << std::endl;
+            continue;
+        }
+
+        std::vector<ExPolygons> layers = slice_outlines(mesh.its, layer_height);
+        MeasureResult r = measure_walls(layers, layer_height, num_runs);
+        std::cout << path << " (" << layers.size() << " layers)" << std::endl;
+        for (size_t j = 0; j < std::size(MeasureResult::Names); ++ j)
+            std::cout << "  " << MeasureResult::Names[j] << ": " << r.measurements[j] << std::endl;
+        std::cout << "  Allocations: " << r.num_allocations << std::endl;
+        std::cout << "  Extrusion lines: " << r.num_lines << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Clipper2Utils.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/TriangleMeshSlicer.hpp>
+#include <libslic3r/BoundingBox.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+namespace Slic3r {
+
+enum class Backend { Clipper, Clipper2 };
+
+enum { Union, Diff, DiffPartitioned, Intersection, Shrink, ExpandRound, Opening };
+struct MeasureResult
+{
+    static constexpr const char * Names[] = {
+        "union_ex [s]",
+        "diff_ex [s]",
+        "diff_ex_partitioned [s]",
+        "intersection_ex [s]",
+        "offset_ex inwards [s]",
+        "offset_ex outwards, round [s]",
+        "opening_ex [s]"
+    };
+
+    double                  measurements[std::size(Names)] = {0.};
+    // Results of the last run, to compare the two libraries.
+    std::vector<ExPolygons> results[std::size(Names)];
+};
+
+static std::vector<ExPolygons> slice_outlines(const indexed_triangle_set &its, size_t num_layers)
+{
+    BoundingBoxf3 bb = bounding_box(its);
+    std::vector<float> zs;
+    for (size_t i = 0; i < num_layers; ++ i)
+        zs.emplace_back(float(bb.min.z() + (bb.max.z() - bb.min.z()) * (double(i) + 0.5) / double(num_layers)));
+    return slice_mesh_ex(its, zs);
+}
+
+// The operations PrintObject runs on neighbor layers: merging, overhang / overlap detection, perimeter offsets, cleanup.
+// The partitioned diff is implemented with ClipperLib only, it is measured for both backends.
+static MeasureResult measure_clipper(const std::vector<ExPolygons> &layers, Backend backend, size_t num_runs)
+{
+    const bool clipper2 = backend == Backend::Clipper2;
+    Benchmark     b;
+    MeasureResult r;
+    auto measure = [&b, &r](size_t idx, auto &&fn) {
+        b.start();
+        ExPolygons out = fn();
+        b.stop();
+        r.measurements[idx] += b.getElapsedSec();
+        r.results[idx].emplace_back(std::move(out));
+    };
+
+    for (size_t run = 0; run < num_runs; ++ run) {
+        for (std::vector<ExPolygons> &results : r.results)
+            results.clear();
+        for (size_t i = 0; i + 1 < layers.size(); ++ i) {
+            const ExPolygons &layer = layers[i];
+            const ExPolygons &above = layers[i + 1];
+            Polygons both = to_polygons(layer);
+            append(both, to_polygons(above));
+            measure(Union,           [&]() { return clipper2 ? union_ex_2(both) : union_ex(both); });
+            measure(Diff,            [&]() { return clipper2 ? diff_ex_2(above, layer, ApplySafetyOffset::Yes) : diff_ex(above, layer, ApplySafetyOffset::Yes); });
+            measure(DiffPartitioned, [&]() { return diff_ex_partitioned(above, layer, ApplySafetyOffset::Yes); });
+            measure(Intersection,    [&]() { return clipper2 ? intersection_ex_2(layer, above) : intersection_ex(layer, above); });
+            measure(Shrink,          [&]() { return clipper2 ? offset_ex_2(layer, - scaled<float>(0.2)) : offset_ex(layer, - scaled<float>(0.2)); });
+            measure(ExpandRound,     [&]() { return clipper2 ? offset_ex_2(layer, scaled<float>(0.5), jtRound, scaled<double>(0.005)) :
+                                                               offset_ex(layer, scaled<float>(0.5), jtRound, scaled<double>(0.005)); });
+            measure(Opening,         [&]() { return clipper2 ? opening_ex_2(layer, scaled<float>(0.2)) : opening_ex(layer, scaled<float>(0.2)); });
+        }
+    }
+    for (double &m : r.measurements)
+        m /= double(num_runs);
+    return r;
+}
+
+// Number of layers, where the two libraries produced a different number of islands or holes, or an area differing by more than 0.1%.
+static size_t count_differences(const std::vector<ExPolygons> &clipper, const std::vector<ExPolygons> &clipper2)
+{
+    auto num_holes = [](const ExPolygons &expolys) {
+        size_t cnt = 0;
+        for (const ExPolygon &expoly : expolys)
+            cnt += expoly.holes.size();
+        return cnt;
+    };
+    size_t cnt = 0;
+    for (size_t i = 0; i < clipper.size(); ++ i) {
+        double a1 = area(clipper[i]);
+        double a2 = area(clipper2[i]);
+        if (clipper[i].size() != clipper2[i].size() || num_holes(clipper[i]) != num_holes(clipper2[i]) || std::abs(a1 - a2) > 0.001 * std::max(a1, a2))
+            ++ cnt;
+    }
+    return cnt;
+}
+
+static std::vector<std::pair<std::string, indexed_triangle_set>> load_meshes(int argc, const char *argv[])
+{
+    std::vector<std::pair<std::string, indexed_triangle_set>> out;
+    for (int i = 1; i < argc; ++ i) {
+        TriangleMesh mesh;
+        if (mesh.ReadSTLFile(argv[i]))
+            out.emplace_back(argv[i], std::move(mesh.its));
+        else
+            std::cerr << "Failed to load " << argv[i] << std::endl;
+    }
+    if (out.empty()) {
+        // Built-in shapes, if no STL files were passed on the command line.
+        out.emplace_back("sphere", its_make_sphere(50., 2 * PI / 720));
+        indexed_triangle_set cylinders;
+        for (int i = 0; i < 10; ++ i) {
+            indexed_triangle_set cyl = its_make_cylinder(5., 40., 2 * PI / 360);
+            its_translate(cyl, Vec3f(float(12 * (i % 5)), float(12 * (i / 5)), 0.f));
+            its_merge(cylinders, cyl);
+        }
+        out.emplace_back("10 cylinders", std::move(cylinders));
+    }
+    return out;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    const size_t num_layers = 200;
+    const size_t num_runs   = 3;
+
+    for (const auto &[name, its] : load_meshes(argc, argv)) {
+        std::vector<ExPolygons> layers = slice_outlines(its, num_layers);
+        MeasureResult clipper  = measure_clipper(layers, Backend::Clipper,  num_runs);
+        MeasureResult clipper2 = measure_clipper(layers, Backend::Clipper2, num_runs);
+        std::cout << name << std::endl;
+        for (size_t i = 0; i < std::size(MeasureResult::Names); ++ i)
+            std::cout << "  " << MeasureResult::Names[i] << ": Clipper " << clipper.measurements[i] << ", Clipper2 " << clipper2.measurements[i]
+                      << ", layers differing: " << count_differences(clipper.results[i], clipper2.results[i]) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <iostream>
+#include <vector>
+#include <random>
+
+#include <libslic3r/EdgeGrid.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/TriangleMeshSlicer.hpp>
+#include <libslic3r/BoundingBox.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+namespace Slic3r {
+
+enum { GridCreation, ClosestPoint, SignedDistance, LineVisits, SelfIntersections };
+struct MeasureResult
+{
+    static constexpr const char * Names[] = {
+        "Grid creation [s]",
+        "closest_point_signed_distance [s]",
+        "signed_distance_edges [s]",
+        "Line intersection visits [s]",
+        "has_intersecting_edges [s]"
+    };
+
+    double measurements[std::size(Names)] = {0.};
+};
+
+const auto Seed = 0;// std::random_device{}();
+
+// Layer outlines of a mesh, the same shapes EdgeGrid::Grid is built from when slicing.
+static std::vector<ExPolygons> slice_outlines(const indexed_triangle_set &its, size_t num_layers)
+{
+    BoundingBoxf3 bb = bounding_box(its);
+    std::vector<float> zs;
+    for (size_t i = 0; i < num_layers; ++ i)
+        zs.emplace_back(float(bb.min.z() + (bb.max.z() - bb.min.z()) * (double(i) + 0.5) / double(num_layers)));
+    return slice_mesh_ex(its, zs);
+}
+
+static MeasureResult measure_grid(const std::vector<ExPolygons> &layers, coord_t resolution, size_t num_queries)
+{
+    Benchmark     b;
+    MeasureResult r;
+    std::mt19937  rng(Seed);
+
+    // Keep the queries outside of the timed sections.
+    for (const ExPolygons &layer : layers) {
+        if (layer.empty())
+            continue;
+        BoundingBox bbox = get_extents(layer);
+        std::uniform_int_distribution<coord_t> dist_x(bbox.min.x(), bbox.max.x());
+        std::uniform_int_distribution<coord_t> dist_y(bbox.min.y(), bbox.max.y());
+        Points points;
+        points.reserve(num_queries + 1);
+        for (size_t i = 0; i <= num_queries; ++ i)
+            points.emplace_back(dist_x(rng), dist_y(rng));
+
+        EdgeGrid::Grid grid;
+        b.start();
+        grid.set_bbox(bbox.inflated(resolution));
+        grid.create(layer, resolution);
+        b.stop();
+        r.measurements[GridCreation] += b.getElapsedSec();
+
+        double sum = 0.;
+        b.start();
+        for (size_t i = 0; i < num_queries; ++ i)
+            if (EdgeGrid::Grid::ClosestPointResult cp = grid.closest_point_signed_distance(points[i], 4 * resolution); cp.valid())
+                sum += cp.distance;
+        b.stop();
+        r.measurements[ClosestPoint] += b.getElapsedSec();
+
+        b.start();
+        for (size_t i = 0; i < num_queries; ++ i) {
+            double d;
+            if (grid.signed_distance_edges(points[i], 4 * resolution, d))
+                sum += d;
+        }
+        b.stop();
+        r.measurements[SignedDistance] += b.getElapsedSec();
+
+        struct Visitor {
+            const EdgeGrid::Grid &grid;
+            const Point          *p1;
+            const Point          *p2;
+            size_t                hits = 0;
+            bool operator()(coord_t iy, coord_t ix) {
+                if (grid.cell_intersects_line(iy, ix, *p1, *p2))
+                    ++ hits;
+                return true;
+            }
+        } visitor { grid, nullptr, nullptr };
+        b.start();
+        for (size_t i = 0; i < num_queries; ++ i)
+            if (points[i] != points[i + 1]) {
+                visitor.p1 = &points[i];
+                visitor.p2 = &points[i + 1];
+                grid.visit_cells_intersecting_line(points[i], points[i + 1], visitor);
+            }
+        b.stop();
+        r.measurements[LineVisits] += b.getElapsedSec();
+
+        b.start();
+        bool self_intersecting = grid.has_intersecting_edges();
+        b.stop();
+        r.measurements[SelfIntersections] += b.getElapsedSec();
+
+        // Make sure the queries are not optimized out.
+        if (sum == 42. && visitor.hits == 42 && self_intersecting)
+            std::cout << "";
+    }
+
+    return r;
+}
+
+static std::vector<std::pair<std::string, indexed_triangle_set>> load_meshes(int argc, const char *argv[])
+{
+    std::vector<std::pair<std::string, indexed_triangle_set>> out;
+    for (int i = 1; i < argc; ++ i) {
+        TriangleMesh mesh;
+        if (mesh.ReadSTLFile(argv[i]))
+            out.emplace_back(argv[i], std::move(mesh.its));
+        else
+            std::cerr << "Failed to load " << argv[i] << std::endl;
+    }
+    if (out.empty()) {
+        // Built-in shapes, if no STL files were passed on the command line.
+        out.emplace_back("sphere", its_make_sphere(50., 2 * PI / 720));
+        indexed_triangle_set cylinders;
+        for (int i = 0; i < 10; ++ i) {
+            indexed_triangle_set cyl = its_make_cylinder(5., 40., 2 * PI / 360);
+            its_translate(cyl, Vec3f(float(12 * (i % 5)), float(12 * (i / 5)), 0.f));
+            its_merge(cylinders, cyl);
+        }
+        out.emplace_back("10 cylinders", std::move(cylinders));
+    }
+    return out;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    // The resolutions used by the slicer: avoid crossing perimeters, elephant foot compensation, fill.
+    const std::vector<coord_t> resolutions { scaled<coord_t>(0.5), scaled<coord_t>(1.), scaled<coord_t>(2.) };
+    const size_t num_layers  = 50;
+    const size_t num_queries = 20000;
+
+    for (const auto &[name, its] : load_meshes(argc, argv)) {
+        std::vector<ExPolygons> layers = slice_outlines(its, num_layers);
+        std::cout << name << std::endl;
+        for (coord_t resolution : resolutions) {
+            MeasureResult r = measure_grid(layers, resolution, num_queries);
+            std::cout << "  resolution " << unscaled(resolution) << " mm" << std::endl;
+            for (size_t i = 0; i < std::size(MeasureResult::Names); ++ i)
+                std::cout << "    " << MeasureResult::Names[i] << ": " << r.measurements[i] << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/Fill/FillLightning.hpp>
+#include <libslic3r/Format/OBJ.hpp>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/ModelArrange.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+namespace Slic3r {
+
+enum { Walls, LightningGenerator };
+struct MeasureResult
+{
+    static constexpr const char * Names[] = {
+        "Walls (make_perimeters) [s]",
+        "Lightning generator [s]",
+    };
+
+    double measurements[std::size(Names)] = {0.};
+    size_t num_layers = 0;
+};
+
+// Slice the mesh stretched to the given height and time the lightning trees of all its layers against the walls.
+static MeasureResult measure_lightning(const TriangleMesh &input_mesh, double height, size_t num_runs)
+{
+    TriangleMesh mesh = input_mesh;
+    const BoundingBoxf3 bb = mesh.bounding_box();
+    if (bb.size().z() > EPSILON)
+        mesh.scale(Vec3f(1.f, 1.f, float(height / bb.size().z())));
+
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "sparse_infill_pattern", "lightning" },
+        { "sparse_infill_density", "15%" },
+        { "layer_height",          0.2 }
+    });
+
+    Model        model;
+    ModelObject *object = model.add_object();
+    object->name = "object.stl";
+    object->add_volume(std::move(mesh));
+    object->add_instance();
+    arrange_objects(model, InfiniteBed{}, ArrangeParams{ scaled(min_object_distance(config)) });
+    object->ensure_on_bed();
+
+    Print print;
+    print.auto_assign_extruders(object);
+    print.apply(model, config);
+    print.validate();
+
+    // The walls are generated between these two status updates of PrintObject::make_perimeters() and PrintObject::prepare_infill().
+    using clock = std::chrono::steady_clock;
+    clock::time_point walls_start, walls_end;
+    print.set_status_callback([&walls_start, &walls_end](const PrintBase::SlicingStatus &status) {
+        if (status.percent == 15)
+            walls_start = clock::now();
+        else if (status.percent == 25)
+            walls_end = clock::now();
+    });
+    print.process();
+
+    MeasureResult r;
+    r.measurements[Walls] = std::chrono::duration<double>(walls_end - walls_start).count();
+    r.num_layers          = print.objects().front()->layers().size();
+
+    Benchmark b;
+    for (size_t run = 0; run < num_runs; ++ run) {
+        b.start();
+        FillLightning::GeneratorPtr generator = FillLightning::build_generator(*print.objects().front(), []() {});
+        b.stop();
+        r.measurements[LightningGenerator] += b.getElapsedSec();
+    }
+    r.measurements[LightningGenerator] /= double(num_runs);
+    return r;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    if (argc < 2) {
+        std::cerr << "Usage: lightning_bench [--height <mm>] <model.obj|model.stl>..., e.g. tests/data/*.obj" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The models are stretched vertically, the lightning trees are propagated through all the layers below the top surfaces.
+    double height   = 150.;
+    const size_t num_runs = 3;
+
+    for (int i = 1; i < argc; ++ i) {
+        const std::string path = argv[i];
+        if (path == "--height" && i + 1 < argc) {
+            height = std::atof(argv[++ i]);
+            continue;
+        }
+        TriangleMesh mesh;
+        bool loaded = false;
+        if (path.size() > 4 && path.substr(path.size() - 4) == ".obj") {
+            ObjInfo     obj_info;
+            std::string message;
+            loaded = load_obj(path.c_str(), &mesh, obj_info, message);
+        } else
+            loaded = mesh.ReadSTLFile(path.c_str());
+        if (! loaded) {
+            std::cerr << "Failed to load " << path << std::endl;
+            continue;
+        }
+
+        MeasureResult r = measure_lightning(mesh, height, num_runs);
+        std::cout << path << " (" << height << " mm, " << r.num_layers << " layers)" << std::endl;
+        for (size_t j = 0; j < std::size(MeasureResult::Names); ++ j)
+            std::cout << "  " << MeasureResult::Names[j] << ": " << r.measurements[j] << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
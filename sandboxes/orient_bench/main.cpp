@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <libslic3r/MeshProxy.hpp>
+#include <libslic3r/Orient.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+
+namespace Slic3r {
+
+// A sphere of about num_facets facets with its vertices randomly displaced along the normal, resembling a scanned part.
+static indexed_triangle_set make_scanned_sphere(double radius, size_t num_facets, double noise)
+{
+    indexed_triangle_set its = its_make_sphere(radius, 2. * PI / std::sqrt(double(num_facets)));
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> displacement(float(- noise), float(noise));
+    for (stl_vertex &v : its.vertices)
+        v += v.normalized() * displacement(rng);
+    return its;
+}
+
+// A bumpy sphere standing on a cylinder, placed off its optimal orientation.
+static indexed_triangle_set make_scanned_part(size_t num_facets)
+{
+    indexed_triangle_set its = make_scanned_sphere(20., num_facets, 0.2);
+    indexed_triangle_set cyl = its_make_cylinder(10., 30., 2. * PI / 360.);
+    its_translate(cyl, Vec3f(0.f, 0.f, -45.f));
+    its_merge(its, cyl);
+    its_transform(its, Transform3f(Eigen::AngleAxisf(float(PI / 3.), Vec3f::UnitX())));
+    return its;
+}
+
+static std::vector<std::pair<std::string, indexed_triangle_set>> load_meshes(int argc, const char *argv[])
+{
+    std::vector<std::pair<std::string, indexed_triangle_set>> out;
+    for (int i = 1; i < argc; ++ i) {
+        TriangleMesh mesh;
+        if (mesh.ReadSTLFile(argv[i]))
+            out.emplace_back(argv[i], std::move(mesh.its));
+        else
+            std::cerr << "Failed to load " << argv[i] << std::endl;
+    }
+    if (out.empty()) {
+        // Built-in shapes of about 1M facets, if no STL files were passed on the command line.
+        out.emplace_back("scanned sphere", make_scanned_sphere(50., 1000000, 0.3));
+        out.emplace_back("scanned part", make_scanned_part(1000000));
+    }
+    return out;
+}
+
+// Time orienting a plate of num_copies copies of the mesh, either one object after another as the GUI does or all objects in parallel.
+// With a proxy, the candidates are searched on the proxy and validated on the full mesh.
+static double measure_orient(const indexed_triangle_set &its, const indexed_triangle_set *proxy, size_t num_copies, bool parallel, Vec3d &orientation)
+{
+    orientation::OrientMeshs meshes(num_copies);
+    for (orientation::OrientMesh &mesh : meshes) {
+        mesh.mesh = TriangleMesh(its);
+        if (proxy)
+            mesh.proxy = TriangleMesh(*proxy);
+    }
+    orientation::OrientParams params;
+    params.parallel   = parallel;
+    params.min_volume = true;
+    params.progressind = [](unsigned, std::string) {};
+
+    using clock = std::chrono::steady_clock;
+    clock::time_point start = clock::now();
+    orientation::orient(meshes, {}, params);
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    orientation = meshes.front().orientation;
+    return elapsed;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    const size_t num_copies = 4;
+
+    for (const auto &[name, its] : load_meshes(argc, argv)) {
+        Vec3d  orientation_single, orientation_plate, orientation_proxy;
+        double single = measure_orient(its, nullptr, 1, false, orientation_single);
+        double plate  = measure_orient(its, nullptr, num_copies, true, orientation_plate);
+
+        using clock = std::chrono::steady_clock;
+        clock::time_point    start = clock::now();
+        indexed_triangle_set proxy = its_make_proxy(its, MeshProxy::Params());
+        double decimation = std::chrono::duration<double>(clock::now() - start).count();
+        double with_proxy = measure_orient(its, &proxy, 1, false, orientation_proxy);
+
+        std::cerr << name << " (" << its.indices.size() << " facets)" << std::endl
+                  << "  single object [s]: " << single << ", orientation: " << orientation_single.transpose() << std::endl
+                  << "  plate of " << num_copies << " copies [s]: " << plate << ", orientation: " << orientation_plate.transpose() << std::endl
+                  << "  proxy of " << proxy.indices.size() << " facets, decimated in the background [s]: " << decimation << std::endl
+                  << "  single object on the proxy [s]: " << with_proxy << ", orientation: " << orientation_proxy.transpose() << std::endl;
+    }
+
+    return 0;
+}
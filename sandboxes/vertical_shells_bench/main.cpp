@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/Print.hpp>
+#include <libslic3r/Format/OBJ.hpp>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/ModelArrange.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+
+namespace Slic3r {
+
+struct MeasureResult
+{
+    // PrintObject::prepare_infill(), which is dominated by discover_vertical_shells() for thick shells.
+    double infill_regions = 0.;
+    size_t num_layers     = 0;
+};
+
+// Slice the mesh stretched to the given height with "ensure vertical shell thickness" enabled for all surfaces
+// and num_shell_layers top / bottom shell layers, time the detection of the infill regions.
+static MeasureResult measure_vertical_shells(const TriangleMesh &input_mesh, double height, int num_shell_layers, size_t num_runs)
+{
+    TriangleMesh mesh = input_mesh;
+    const BoundingBoxf3 bb = mesh.bounding_box();
+    if (bb.size().z() > EPSILON)
+        mesh.scale(Vec3f(1.f, 1.f, float(height / bb.size().z())));
+
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "ensure_vertical_shell_thickness", "ensure_all" },
+        { "top_shell_layers",                num_shell_layers },
+        { "bottom_shell_layers",             num_shell_layers },
+        { "top_shell_thickness",             0 },
+        { "bottom_shell_thickness",          0 },
+        { "sparse_infill_density",           "15%" },
+        { "layer_height",                    0.2 }
+    });
+
+    MeasureResult r;
+    for (size_t run = 0; run < num_runs; ++ run) {
+        Model        model;
+        ModelObject *object = model.add_object();
+        object->name = "object.stl";
+        object->add_volume(mesh);
+        object->add_instance();
+        arrange_objects(model, InfiniteBed{}, ArrangeParams{ scaled(min_object_distance(config)) });
+        object->ensure_on_bed();
+
+        Print print;
+        print.auto_assign_extruders(object);
+        print.apply(model, config);
+        print.validate();
+
+        // The infill regions are generated between these two status updates of PrintObject::prepare_infill() and PrintObject::infill().
+        using clock = std::chrono::steady_clock;
+        clock::time_point start, end;
+        print.set_status_callback([&start, &end](const PrintBase::SlicingStatus &status) {
+            if (status.percent == 25)
+                start = clock::now();
+            else if (status.percent == 35)
+                end = clock::now();
+        });
+        print.process();
+
+        r.infill_regions += std::chrono::duration<double>(end - start).count();
+        r.num_layers      = print.objects().front()->layers().size();
+    }
+    r.infill_regions /= double(num_runs);
+    return r;
+}
+
+} // namespace Slic3r
+
+int main(const int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    if (argc < 2) {
+        std::cerr << "Usage: vertical_shells_bench [--height <mm>] <model.obj|model.stl>..., e.g. tests/data/*.obj" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The models are stretched vertically, so that the thickest shells still leave some sparse infill in between.
+    double height   = 100.;
+    const size_t num_runs = 3;
+    const int    shell_layers[] = { 5, 20, 50 };
+
+    for (int i = 1; i < argc; ++ i) {
+        const std::string path = argv[i];
+        if (path == "--height" && i + 1 < argc) {
+            height = std::atof(argv[++ i]);
+            continue;
+        }
+        TriangleMesh mesh;
+        bool loaded = false;
+        if (path.size() > 4 && path.substr(path.size() - 4) == ".obj") {
+            ObjInfo     obj_info;
+            std::string message;
+            loaded = load_obj(path.c_str(), &mesh, obj_info, message);
+        } else
+            loaded = mesh.ReadSTLFile(path.c_str());
+        if (! loaded) {
+            std::cerr << "Failed to load " << path << std::endl;
+            continue;
+        }
+
+        std::cout << path << " (" << height << " mm)" << std::endl;
+        for (int num_shell_layers : shell_layers) {
+            MeasureResult r = measure_vertical_shells(mesh, height, num_shell_layers, num_runs);
+            std::cout << "  " << num_shell_layers << " top / bottom shell layers, " << r.num_layers << " layers: infill regions [s]: " << r.infill_regions << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -17,10 +17,13 @@
     #endif /* SLIC3R_GUI */
 #endif /* WIN32 */
 
+#include <chrono>
 #include <cstdio>
 #include <string>
 #include <cstring>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <math.h>
 
 #if defined(__linux__) || defined(__LINUX__)
@@ -43,6 +46,8 @@ using namespace nlohmann;
 #include <boost/dll/runtime_symbol_info.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/task_arena.h>
+
 #include "unix/fhs.hpp"  // Generated by CMake from ../platform/unix/fhs.hpp.in
 
 #include "libslic3r/libslic3r.h"
@@ -151,6 +156,8 @@ typedef struct  _sliced_plate_info{
     size_t sliced_time {0};
     size_t sliced_time_with_cache {0};
     size_t triangle_count{0};
+    // Peak resident memory of the process in bytes after the plate was exported.
+    size_t peak_memory {0};
     std::string warning_message;
 }sliced_plate_info_t;
 
@@ -166,6 +173,66 @@ typedef struct _sliced_info {
 }sliced_info_t;
 std::vector<PrintBase::SlicingStatus> g_slicing_warnings;
 
+// Settings files parsed by the previous jobs of the batch mode, see CLI::run_batch().
+// A file is parsed again once it is modified: the modification time, the size or the hash of the content differ.
+typedef struct _cached_settings_file {
+    std::time_t                         last_write_time;
+    uintmax_t                           file_size;
+    size_t                              content_hash;
+    DynamicPrintConfig                  config;
+    std::map<std::string, std::string>  key_values;
+}cached_settings_file_t;
+static bool g_cache_settings_files = false;
+static std::mutex g_settings_files_mutex;
+static std::map<std::string, cached_settings_file_t> g_settings_files;
+
+static ConfigSubstitutions load_settings_file(const std::string &file, ForwardCompatibilitySubstitutionRule rule, DynamicPrintConfig &config,
+    std::map<std::string, std::string> &key_values, std::string &reason)
+{
+    if (!g_cache_settings_files)
+        return config.load_from_json(file, rule, key_values, reason);
+
+    // The modification time alone is not reliable, its resolution may be coarse and it may be preserved by a copy.
+    boost::system::error_code ec;
+    const std::time_t last_write_time = boost::filesystem::last_write_time(file, ec);
+    const uintmax_t   file_size       = ec ? 0 : boost::filesystem::file_size(file, ec);
+    std::string       content;
+    if (! ec) {
+        boost::nowide::ifstream ifs(file, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        if (! ifs.good() && ! ifs.eof())
+            ec = boost::system::errc::make_error_code(boost::system::errc::io_error);
+    }
+    if (ec) {
+        reason = "can not read setting file " + file + ": " + ec.message();
+        return {};
+    }
+    const size_t content_hash = std::hash<std::string>{}(content);
+
+    std::lock_guard<std::mutex> lock(g_settings_files_mutex);
+    auto it = g_settings_files.find(file);
+    if (it != g_settings_files.end() && it->second.last_write_time == last_write_time && it->second.file_size == file_size &&
+        it->second.content_hash == content_hash) {
+        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": reuse the settings parsed from " << file;
+        config.apply(it->second.config);
+        key_values = it->second.key_values;
+        return {};
+    }
+    cached_settings_file_t loaded;
+    loaded.last_write_time = last_write_time;
+    loaded.file_size       = file_size;
+    loaded.content_hash    = content_hash;
+    ConfigSubstitutions substitutions = loaded.config.load_from_json(file, rule, loaded.key_values, reason);
+    config.apply(loaded.config);
+    key_values = loaded.key_values;
+    // The substitutions are reported by the job, which parsed the file. Don't cache the files with substitutions to report them for each job.
+    if (reason.empty() && substitutions.empty())
+        g_settings_files[file] = std::move(loaded);
+    else if (it != g_settings_files.end())
+        g_settings_files.erase(it);
+    return substitutions;
+}
+
 #if defined(__linux__) || defined(__LINUX__)
 #define PIPE_BUFFER_SIZE 512
 
@@ -427,6 +494,7 @@ void record_exit_reson(std::string outputdir, int code, int plate_id, std::strin
             plate_json["sliced_time"] = sliced_info.sliced_plates[index].sliced_time;
             plate_json["sliced_time_with_cache"] = sliced_info.sliced_plates[index].sliced_time_with_cache;
             plate_json["triangle_count"] = sliced_info.sliced_plates[index].triangle_count;
+            plate_json["peak_memory"] = sliced_info.sliced_plates[index].peak_memory;
             plate_json["warning_message"] = sliced_info.sliced_plates[index].warning_message;
             j["sliced_plates"].push_back(plate_json);
         }
@@ -1075,6 +1143,15 @@ int CLI::run(int argc, char **argv)
         return CLI_INVALID_PARAMS;
     }
     BOOST_LOG_TRIVIAL(info) << "finished setup params, argc="<< argc << std::endl;
+
+    const std::string batch_jobs = m_config.opt_string("batch", true);
+    if (!batch_jobs.empty()) {
+        if (m_batch_job) {
+            boost::nowide::cerr << "batch can not be started by a batch job" << std::endl;
+            return CLI_INVALID_PARAMS;
+        }
+        return this->run_batch(batch_jobs, argv[0]);
+    }
     std::string temp_path = wxFileName::GetTempDir().utf8_str().data();
     set_temporary_dir(temp_path);
 
@@ -1121,6 +1198,10 @@ int CLI::run(int argc, char **argv)
         downward_check = downward_check_option->value;
 
     bool start_gui = m_actions.empty() && !downward_check;
+    if (start_gui && m_batch_job) {
+        boost::nowide::cerr << "no action in the batch job" << std::endl;
+        return CLI_INVALID_PARAMS;
+    }
     if (start_gui) {
         BOOST_LOG_TRIVIAL(info) << "no action, start gui directly" << std::endl;
         ::Label::initSysFont();
@@ -1192,7 +1273,7 @@ int CLI::run(int argc, char **argv)
     std::vector<plate_obj_size_info_t> plate_obj_size_infos;
     int plate_to_slice = 0, filament_count = 0, duplicate_count = 0, real_duplicate_count = 0;
     bool first_file = true, is_bbl_3mf = false, need_arrange = true, has_thumbnails = false, up_config_to_date = false, normative_check = true, duplicate_single_object = false, use_first_fila_as_default = false, minimum_save = false, enable_timelapse = false;
-    bool allow_rotations = true, skip_modified_gcodes = false, avoid_extrusion_cali_region = false, skip_useless_pick = false, allow_newer_file = false;
+    bool allow_rotations = true, skip_modified_gcodes = false, avoid_extrusion_cali_region = false, skip_useless_pick = false, allow_newer_file = false, low_memory = false;
     Semver file_version;
     std::map<size_t, bool> orients_requirement;
     std::vector<Preset*> project_presets;
@@ -1250,6 +1331,10 @@ int CLI::run(int argc, char **argv)
     if (skip_useless_picks_option)
         skip_useless_pick = skip_useless_picks_option->value;
 
+    ConfigOptionBool* low_memory_option = m_config.option<ConfigOptionBool>("low_memory");
+    if (low_memory_option)
+        low_memory = low_memory_option->value;
+
     ConfigOptionBool* allow_newer_file_option = m_config.option<ConfigOptionBool>("allow_newer_file");
     if (allow_newer_file_option)
         allow_newer_file = allow_newer_file_option->value;
@@ -1679,10 +1764,11 @@ int CLI::run(int argc, char **argv)
             std::map<std::string, std::string> key_values;
             std::string reason;
 
-            config_substitutions = config.load_from_json(file, config_substitution_rule, key_values, reason);
+            config_substitutions = load_settings_file(file, config_substitution_rule, config, key_values, reason);
             if (!reason.empty()) {
                 BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<<  ":Can not load config from file "<<file<<"\n";
-                return CLI_CONFIG_FILE_ERROR;
+                // The file may have been removed since the check above.
+                return boost::filesystem::exists(file) ? CLI_CONFIG_FILE_ERROR : CLI_FILE_NOTFOUND;
             }
 
             config_name = key_values[BBL_JSON_KEY_NAME];
@@ -4784,6 +4870,9 @@ int CLI::run(int argc, char **argv)
                         part_plate->get_print(&print, &gcode_result, &print_index);
 
                         print_fff = dynamic_cast<Print *>(print);
+                        if (low_memory && export_slicedata)
+                            BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": low_memory is ignored, the layers are needed by export_slicedata";
+                        print_fff->set_release_layers_after_export(low_memory && !export_slicedata);
                         /*if (outfile_config.empty())
                         {
                             outfile = "plate_" + std::to_string(index + 1) + ".gcode";
@@ -5114,6 +5203,8 @@ int CLI::run(int argc, char **argv)
                                 end_time = (long long)Slic3r::Utils::get_current_time_utc();
                                 sliced_plate_info.sliced_time = end_time - start_time;
                                 sliced_plate_info.sliced_time_with_cache = time_using_cache;
+                                sliced_plate_info.peak_memory = peak_memory_usage();
+                                BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": peak memory usage " << format_memsize_MB(sliced_plate_info.peak_memory);
 
                                 if (max_slicing_time_per_plate != 0) {
                                     long long time_cost = end_time - start_time;
@@ -5942,6 +6033,142 @@ int CLI::run(int argc, char **argv)
     return 0;
 }
 
+// Batch mode: the jobs are read from a file, a named pipe or the standard input ("-"), one JSON object per line:
+//   {"id": "job1", "models": ["a.3mf"], "settings": ["machine.json", "process.json"], "filaments": ["pla.json"],
+//    "outputdir": "out/job1", "slice": 0, "args": ["--min_save", "1"]}
+// All the keys are optional, "args" are passed to the job as they are, "slice" defaults to 0 (all plates) unless "args" are given.
+// The jobs run one after the other in this process, which keeps the TBB worker threads and the parsed settings files
+// between the jobs. The result of each job is written as a single line JSON object to the batch_results file, or to the standard output.
+// In the latter case the standard output of the jobs is redirected to the standard error, thus the standard output contains the results only.
+int CLI::run_batch(const std::string &jobs_path, char *program_name)
+{
+    const ConfigOptionInt *opt_loglevel = m_config.opt<ConfigOptionInt>("debug");
+    set_logging_level(opt_loglevel ? opt_loglevel->value : 2);
+
+    boost::nowide::ifstream jobs_file;
+    if (jobs_path != "-") {
+        jobs_file.open(jobs_path);
+        if (!jobs_file) {
+            boost::nowide::cerr << "can not open batch jobs file: " << jobs_path << std::endl;
+            return CLI_FILE_NOTFOUND;
+        }
+    }
+    std::istream &jobs = (jobs_path == "-") ? boost::nowide::cin : jobs_file;
+
+    const std::string results_path = m_config.opt_string("batch_results", true);
+    boost::nowide::ofstream results_file;
+    if (!results_path.empty()) {
+        results_file.open(results_path);
+        if (!results_file) {
+            boost::nowide::cerr << "can not open batch results file: " << results_path << std::endl;
+            return CLI_FILE_NOTFOUND;
+        }
+    }
+    // Without a results file, keep the standard output for the results only.
+    std::streambuf *stdout_buf     = results_path.empty() ? boost::nowide::cout.rdbuf(boost::nowide::cerr.rdbuf()) : nullptr;
+    // On Windows boost::nowide::cout is a stream of its own.
+    std::streambuf *std_stdout_buf = stdout_buf != nullptr && &std::cout != &boost::nowide::cout ? std::cout.rdbuf(std::cerr.rdbuf()) : nullptr;
+    std::ostream    results_stdout(stdout_buf);
+    std::ostream   &results = results_path.empty() ? results_stdout : results_file;
+
+    // Cores used by the parallel algorithms of a single job, zero for all of them.
+    const int batch_threads = m_config.opt_int("batch_threads");
+    tbb::task_arena arena(batch_threads > 0 ? batch_threads : tbb::task_arena::automatic);
+    g_cache_settings_files = true;
+    BOOST_LOG_TRIVIAL(warning) << boost::format("batch mode, Current OrcaSlicer Version %1%, jobs from %2%, threads per job %3%")
+        %SLIC3R_VERSION %jobs_path %arena.max_concurrency();
+
+    size_t job_count = 0, failed_count = 0;
+    std::string line;
+    while (std::getline(jobs, line)) {
+        boost::algorithm::trim(line);
+        if (line.empty() || line.front() == '#')
+            continue;
+        json result;
+        result["id"] = std::to_string(job_count);
+        std::vector<std::string> args;
+        try {
+            json job = json::parse(line);
+            if (job.contains("id"))
+                result["id"] = job["id"].is_string() ? job["id"].get<std::string>() : job["id"].dump();
+            auto join_paths = [&job](const char *key) {
+                std::string paths;
+                for (const std::string path : job[key]) {
+                    if (!paths.empty())
+                        paths += ";";
+                    paths += path;
+                }
+                return paths;
+            };
+            if (job.contains("settings"))
+                args.insert(args.end(), { "--load_settings", join_paths("settings") });
+            if (job.contains("filaments"))
+                args.insert(args.end(), { "--load_filaments", join_paths("filaments") });
+            if (job.contains("outputdir"))
+                args.insert(args.end(), { "--outputdir", job["outputdir"].get<std::string>() });
+            if (job.contains("slice"))
+                args.insert(args.end(), { "--slice", std::to_string(job["slice"].get<int>()) });
+            else if (!job.contains("args"))
+                args.insert(args.end(), { "--slice", "0" });
+            if (job.contains("args"))
+                for (const std::string arg : job["args"])
+                    args.emplace_back(arg);
+            if (job.contains("models"))
+                for (const std::string model : job["models"])
+                    args.emplace_back(model);
+        }
+        catch (std::exception &ex) {
+            BOOST_LOG_TRIVIAL(error) << "batch job " << job_count << ": invalid job: " << ex.what();
+            args.clear();
+        }
+
+        int ret = CLI_INVALID_PARAMS;
+        // The peak memory of the job is only known if the high water mark of the process could be reset before the job.
+        const bool peak_memory_reset = reset_peak_memory_usage();
+        auto start = std::chrono::steady_clock::now();
+        if (!args.empty()) {
+            std::vector<char*> job_argv;
+            job_argv.reserve(args.size() + 2);
+            job_argv.emplace_back(program_name);
+            for (std::string &arg : args)
+                job_argv.emplace_back(arg.data());
+            job_argv.emplace_back(nullptr);
+
+            g_slicing_warnings.clear();
+            try {
+                ret = arena.execute([&job_argv]() {
+                    CLI job;
+                    job.m_batch_job = true;
+                    return job.run(int(job_argv.size() - 1), job_argv.data());
+                });
+            }
+            catch (std::exception &ex) {
+                BOOST_LOG_TRIVIAL(error) << "batch job " << job_count << ": " << ex.what();
+                ret = CLI_SLICING_ERROR;
+            }
+        }
+        result["return_code"] = ret;
+        result["error_string"] = cli_errors.count(ret) ? cli_errors[ret] : std::string();
+        result["time_ms"] = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        if (peak_memory_reset)
+            result["peak_memory"] = peak_memory_usage();
+        // High water mark of the whole batch process, it never decreases from job to job.
+        result["process_peak_memory"] = peak_memory_usage();
+        ++ job_count;
+        if (ret != CLI_SUCCESS)
+            ++ failed_count;
+        results << result.dump() << std::endl;
+    }
+
+    if (std_stdout_buf != nullptr)
+        std::cout.rdbuf(std_stdout_buf);
+    if (stdout_buf != nullptr)
+        boost::nowide::cout.rdbuf(stdout_buf);
+    g_cache_settings_files = false;
+    BOOST_LOG_TRIVIAL(warning) << boost::format("batch mode finished, %1% jobs, %2% failed") %job_count %failed_count;
+    return failed_count == 0 ? CLI_SUCCESS : CLI_SLICING_ERROR;
+}
+
 bool CLI::setup(int argc, char **argv)
 {
     // Detect the operating system flavor after SLIC3R_LOGLEVEL is set.
@@ -109,9 +109,14 @@ private:
     std::vector<std::string>    m_actions;
     std::vector<std::string>    m_transforms;
     std::vector<Model>          m_models;
+    // Started by run_batch() for a single job of the batch.
+    bool                        m_batch_job { false };
 
     bool setup(int argc, char **argv);
 
+    /// Runs the jobs of the batch mode one after the other, see the "batch" option.
+    int run_batch(const std::string &jobs_path, char *program_name);
+
     /// Prints usage of the CLI.
     void print_help(bool include_print_options = false, PrinterTechnology printer_technology = ptAny) const;
 
@@ -7,6 +7,8 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <limits>
 #include <type_traits>
 #include <vector>
@@ -305,6 +307,23 @@ namespace detail {
         return tmin < t1 && tmax > t0;
 	}
 
+	// Interval of the ray parameter inside a single slab of a bounding box, the slab being given by its bounds
+	// relative to the ray origin. A ray parallel to the slab (infinite inverse direction) is either inside
+	// the slab for any t or never, evaluating dmin * invdir would produce NaN for a box touching the origin.
+	template <typename Scalar>
+	inline void ray_slab_invdir(const Scalar dmin, const Scalar dmax, const Scalar invdir, Scalar &tnear, Scalar &tfar)
+	{
+		if (std::isinf(invdir)) {
+			const bool inside = dmin <= Scalar(0) && dmax >= Scalar(0);
+			tnear = inside ? - std::numeric_limits<Scalar>::infinity() : std::numeric_limits<Scalar>::infinity();
+			tfar  = - tnear;
+		} else {
+			const Scalar t0 = dmin * invdir, t1 = dmax * invdir;
+			tnear = std::min(t0, t1);
+			tfar  = std::max(t0, t1);
+		}
+	}
+
 	// The following intersect_triangle() is derived from raytri.c routine intersect_triangle1()
 	// Ray-Triangle Intersection Test Routines
 	// Different optimizations of my and Ben Trumbore's
@@ -787,6 +806,99 @@ inline bool intersect_ray_all_hits(
 	return ! hits.empty();
 }
 
+// Find first intersections of a packet of rays sharing a common origin with indexed triangle set.
+// The packet is traversed through the AABB tree at once: Each node bounding box is tested against all rays
+// of the packet stored as a structure of arrays, so that the slab test vectorizes, and a subtree is only
+// descended into if at least one ray of the packet may still hit a closer triangle inside it.
+// This is much cheaper than PacketSize calls to intersect_ray_first_hit() for coherent rays (for example
+// rays sampling a hemisphere above a surface point), as the top levels of the tree are only visited once.
+// Intersection test is calculated with the accuracy of VectorType::Scalar, the hits are the same
+// as if intersect_ray_first_hit() was called for each ray of the packet separately.
+// Rays not intersecting the mesh will have hit.id set to -1.
+// Returns number of rays intersecting the indexed triangle set.
+template<size_t PacketSize, typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline size_t intersect_ray_packet_first_hit(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Common origin of the rays.
+	const VectorType					&origin,
+	// Directions of the rays.
+	const std::array<VectorType, PacketSize> &dirs,
+	// First intersections of the rays with the indexed triangle set.
+	std::array<igl::Hit, PacketSize>	&hits,
+	// Epsilon for the ray-triangle intersection, it should be proportional to an average triangle edge length.
+	const double 						 eps = 0.000001)
+{
+    using Scalar = typename VectorType::Scalar;
+
+    for (igl::Hit &hit : hits)
+        hit = igl::Hit { -1, -1, 0.f, 0.f, 0.f };
+    if (tree.empty())
+        return 0;
+
+    // Structure of arrays of inverse directions and of the current closest hit parameters.
+    alignas(32) std::array<Scalar, PacketSize> invdir_x, invdir_y, invdir_z, t_max;
+    for (size_t i = 0; i < PacketSize; ++ i) {
+        invdir_x[i] = Scalar(1) / dirs[i].x();
+        invdir_y[i] = Scalar(1) / dirs[i].y();
+        invdir_z[i] = Scalar(1) / dirs[i].z();
+        t_max[i]    = std::numeric_limits<Scalar>::infinity();
+    }
+    std::array<bool, PacketSize> active;
+
+    // Depth of the balanced tree is bounded by log2 of the number of nodes, thus a fixed size stack is sufficient.
+    // Left child is pushed last to visit the nodes in the same order as intersect_ray_recursive_first_hit().
+    std::array<size_t, 2 * sizeof(size_t) * 8> stack;
+    size_t stack_size = 0;
+    stack[stack_size ++] = 0;
+    size_t num_hits = 0;
+    while (stack_size > 0) {
+        const size_t node_idx = stack[-- stack_size];
+        const auto  &node     = tree.node(node_idx);
+        assert(node.is_valid());
+        const auto bbox_min = node.bbox.min().template cast<Scalar>();
+        const auto bbox_max = node.bbox.max().template cast<Scalar>();
+        const Scalar dmin_x = bbox_min.x() - origin.x(), dmax_x = bbox_max.x() - origin.x();
+        const Scalar dmin_y = bbox_min.y() - origin.y(), dmax_y = bbox_max.y() - origin.y();
+        const Scalar dmin_z = bbox_min.z() - origin.z(), dmax_z = bbox_max.z() - origin.z();
+        // Slab test over the whole packet.
+        bool any_active = false;
+        for (size_t i = 0; i < PacketSize; ++ i) {
+            Scalar tnear_x, tfar_x, tnear_y, tfar_y, tnear_z, tfar_z;
+            detail::ray_slab_invdir(dmin_x, dmax_x, invdir_x[i], tnear_x, tfar_x);
+            detail::ray_slab_invdir(dmin_y, dmax_y, invdir_y[i], tnear_y, tfar_y);
+            detail::ray_slab_invdir(dmin_z, dmax_z, invdir_z[i], tnear_z, tfar_z);
+            const Scalar tnear = std::max(std::max(tnear_x, tnear_y), tnear_z);
+            const Scalar tfar  = std::min(std::min(tfar_x, tfar_y), tfar_z);
+            active[i]   = tnear <= tfar && tnear < t_max[i] && tfar > Scalar(0);
+            any_active |= active[i];
+        }
+        if (! any_active)
+            continue;
+        if (node.is_leaf()) {
+            auto face = faces[node.idx];
+            for (size_t i = 0; i < PacketSize; ++ i)
+                if (double t, u, v; active[i] &&
+                    detail::intersect_triangle(origin, dirs[i], vertices[face(0)], vertices[face(1)], vertices[face(2)], t, u, v, eps) &&
+                    t > 0. && t < t_max[i]) {
+                    if (hits[i].id == -1)
+                        ++ num_hits;
+                    hits[i]  = igl::Hit { int(node.idx), -1, float(u), float(v), float(t) };
+                    t_max[i] = hits[i].t;
+                }
+        } else {
+            size_t left = node_idx * 2 + 1;
+            stack[stack_size ++] = left + 1;
+            stack[stack_size ++] = left;
+        }
+    }
+    return num_hits;
+}
+
 // Finding a closest triangle, its closest point and squared distance to the closest point
 // on a 3D indexed triangle set using a pre-built AABBTreeIndirect::Tree.
 // Closest point to triangle test will be performed with the accuracy of VectorType::Scalar
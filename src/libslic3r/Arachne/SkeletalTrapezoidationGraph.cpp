@@ -3,7 +3,6 @@
 
 #include "SkeletalTrapezoidationGraph.hpp"
 #include "../Line.hpp"
-#include <ankerl/unordered_dense.h>
 
 
 #include <boost/log/trivial.hpp>
@@ -182,20 +181,8 @@ bool STHalfEdgeNode::isLocalMaximum(bool strict) const
 
 void SkeletalTrapezoidationGraph::collapseSmallEdges(coord_t snap_dist)
 {
-    ankerl::unordered_dense::map<edge_t*, std::list<edge_t>::iterator> edge_locator;
-    ankerl::unordered_dense::map<node_t*, std::list<node_t>::iterator> node_locator;
-    
-    for (auto edge_it = edges.begin(); edge_it != edges.end(); ++edge_it)
-    {
-        edge_locator.emplace(&*edge_it, edge_it);
-    }
-    
-    for (auto node_it = nodes.begin(); node_it != nodes.end(); ++node_it)
-    {
-        node_locator.emplace(&*node_it, node_it);
-    }
-    
-    auto safelyRemoveEdge = [this, &edge_locator](edge_t* to_be_removed, std::list<edge_t>::iterator& current_edge_it, bool& edge_it_is_updated)
+    // The pooled edges and nodes are located by their address directly, no lookup tables are needed.
+    auto safelyRemoveEdge = [this](edge_t* to_be_removed, PooledList<edge_t>::iterator& current_edge_it, bool& edge_it_is_updated)
     {
         if (current_edge_it != edges.end()
             && to_be_removed == &*current_edge_it)
@@ -205,7 +192,7 @@ void SkeletalTrapezoidationGraph::collapseSmallEdges(coord_t snap_dist)
         }
         else
         {
-            edges.erase(edge_locator[to_be_removed]);
+            edges.erase(edges.iterator_to(*to_be_removed));
         }
     };
 
@@ -267,7 +254,7 @@ void SkeletalTrapezoidationGraph::collapseSmallEdges(coord_t snap_dist)
                 }
             }
             
-            nodes.erase(node_locator[quad_mid->to]);
+            nodes.erase(nodes.iterator_to(*quad_mid->to));
 
             quad_mid->prev->next = quad_mid->next;
             quad_mid->next->prev = quad_mid->prev;
@@ -297,7 +284,7 @@ void SkeletalTrapezoidationGraph::collapseSmallEdges(coord_t snap_dist)
                     quad_end->from->incident_edge = quad_end->prev->twin;
                 }
             }
-            nodes.erase(node_locator[quad_start->from]);
+            nodes.erase(nodes.iterator_to(*quad_start->from));
 
             quad_start->twin->twin = quad_end->twin;
             quad_end->twin->twin = quad_start->twin;
@@ -18,6 +18,8 @@
 
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+
 //#define ARACHNE_STITCH_PATCH_DEBUG
 
 namespace Slic3r::Arachne
@@ -468,6 +470,60 @@ void removeColinearEdges(Polygons &thiss, const double max_deviation_angle = 0.0
     }
 }
 
+// Group the contours and holes of a union_() result into independent islands. The Voronoi diagram inside an island
+// only depends on the island's own polygons, therefore the islands may be skeletonized separately with the same result.
+// The polygons are copied unchanged and the islands follow the order of their contours in the input.
+// Returns a single group with all polygons if there is just one island or if a hole could not be assigned to a contour.
+static std::vector<Polygons> splitIntoIslands(const Polygons &outline)
+{
+    std::vector<size_t> contours;
+    std::vector<size_t> holes;
+    for (size_t poly_idx = 0; poly_idx < outline.size(); ++poly_idx)
+        (outline[poly_idx].is_counter_clockwise() ? contours : holes).emplace_back(poly_idx);
+
+    std::vector<Polygons> islands;
+    if (contours.size() <= 1) {
+        islands.emplace_back(outline);
+        return islands;
+    }
+
+    std::vector<BoundingBox> contour_bboxes;
+    std::vector<double>      contour_areas;
+    contour_bboxes.reserve(contours.size());
+    contour_areas.reserve(contours.size());
+    islands.reserve(contours.size());
+    for (size_t poly_idx : contours) {
+        contour_bboxes.emplace_back(get_extents(outline[poly_idx]));
+        contour_areas.emplace_back(outline[poly_idx].area());
+        islands.emplace_back();
+        islands.back().emplace_back(outline[poly_idx]);
+    }
+
+    for (size_t poly_idx : holes) {
+        const Polygon    &hole      = outline[poly_idx];
+        const BoundingBox hole_bbox = get_extents(hole);
+        // A hole belongs to the smallest contour enclosing it. Nested islands inside a hole are smaller than the hole
+        // and cannot enclose it.
+        size_t island_idx = size_t(-1);
+        for (size_t contour_idx = 0; contour_idx < contours.size(); ++contour_idx)
+            if ((island_idx == size_t(-1) || contour_areas[contour_idx] < contour_areas[island_idx]) &&
+                contour_bboxes[contour_idx].contains(hole_bbox) &&
+                std::any_of(hole.points.begin(), hole.points.end(), [&contour = outline[contours[contour_idx]]](const Point &pt) {
+                    return contour.contains(pt);
+                }))
+                island_idx = contour_idx;
+        if (island_idx == size_t(-1)) {
+            // Should not happen for a valid union_() result. Don't split the outline rather than producing invalid islands.
+            assert(false);
+            islands.assign(1, outline);
+            return islands;
+        }
+        islands[island_idx].emplace_back(hole);
+    }
+
+    return islands;
+}
+
 const std::vector<VariableWidthLines> &WallToolPaths::generate()
 {
     if (this->inset_count < 1)
@@ -529,17 +585,37 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
         );
     const coord_t transition_filter_dist   = scaled<coord_t>(100.f);
     const coord_t allowed_filter_deviation = wall_transition_filter_deviation;
-    SkeletalTrapezoidation wall_maker
-    (
-        prepared_outline,
-        *beading_strat,
-        beading_strat->getTransitioningAngle(),
-        discretization_step_size,
-        transition_filter_dist,
-        allowed_filter_deviation,
-        wall_transition_length
-    );
-    wall_maker.generateToolpaths(toolpaths);
+    auto generate_island_toolpaths = [&](const Polygons &island_outline, std::vector<VariableWidthLines> &island_toolpaths) {
+        SkeletalTrapezoidation wall_maker
+        (
+            island_outline,
+            *beading_strat,
+            beading_strat->getTransitioningAngle(),
+            discretization_step_size,
+            transition_filter_dist,
+            allowed_filter_deviation,
+            wall_transition_length
+        );
+        wall_maker.generateToolpaths(island_toolpaths);
+    };
+
+    // Independent islands (text, lattices, perforated plates) are skeletonized in parallel.
+    // The toolpaths are merged in the order of the islands, thus the result does not depend on scheduling.
+    if (std::vector<Polygons> islands = m_params.split_islands ? splitIntoIslands(prepared_outline) : std::vector<Polygons>(1); islands.size() == 1) {
+        generate_island_toolpaths(prepared_outline, toolpaths);
+    } else {
+        std::vector<std::vector<VariableWidthLines>> islands_toolpaths(islands.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, islands.size()), [&islands, &islands_toolpaths, &generate_island_toolpaths](const tbb::blocked_range<size_t> &range) {
+            for (size_t island_idx = range.begin(); island_idx < range.end(); ++island_idx)
+                generate_island_toolpaths(islands[island_idx], islands_toolpaths[island_idx]);
+        });
+        for (std::vector<VariableWidthLines> &island_toolpaths : islands_toolpaths) {
+            if (island_toolpaths.size() > toolpaths.size())
+                toolpaths.resize(island_toolpaths.size());
+            for (size_t inset_idx = 0; inset_idx < island_toolpaths.size(); ++inset_idx)
+                append(toolpaths[inset_idx], std::move(island_toolpaths[inset_idx]));
+        }
+    }
 
     stitchToolPaths(toolpaths, this->bead_width_x);
 
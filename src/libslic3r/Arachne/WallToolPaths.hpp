@@ -31,6 +31,9 @@ public:
     float   wall_transition_filter_deviation;
     int     wall_distribution_count;
     bool    is_top_or_bottom_layer;
+    // Skeletonize independent islands of the outline separately and in parallel.
+    // Disabled only by the tests to produce the reference result over the whole outline.
+    bool    split_islands { true };
 };
 
 WallToolPathsParams make_paths_params(const int layer_id, const PrintObjectConfig &print_object_config, const PrintConfig &print_config);
@@ -5,13 +5,13 @@
 #define UTILS_HALF_EDGE_GRAPH_H
 
 
-#include <list>
 #include <cassert>
 
 
 
 #include "HalfEdge.hpp"
 #include "HalfEdgeNode.hpp"
+#include "PooledList.hpp"
 
 namespace Slic3r::Arachne
 {
@@ -21,8 +21,10 @@ class HalfEdgeGraph
 public:
     using edge_t = derived_edge_t;
     using node_t = derived_node_t;
-    std::list<edge_t> edges;
-    std::list<node_t> nodes;
+    // Pooled storage: A graph is built for every island of every layer, allocating each edge and node separately
+    // was a significant part of the wall generation time.
+    PooledList<edge_t> edges;
+    PooledList<node_t> nodes;
 };
 
 } // namespace Slic3r::Arachne
@@ -0,0 +1,244 @@
+#ifndef UTILS_POOLED_LIST_H
+#define UTILS_POOLED_LIST_H
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Slic3r::Arachne
+{
+
+/*!
+ * Doubly linked list with the std::list interface used by the half-edge graphs, storing its elements in chunks
+ * of contiguous slots instead of allocating every element separately.
+ *
+ * Element addresses and slot indices are stable until the element is erased, the same as with std::list.
+ * Erased slots are reused by subsequent insertions. When the list is destroyed, its chunks are returned to a
+ * small per-thread cache, so that graphs built for the next layer on the same thread don't hit the allocator.
+ */
+template<typename T>
+class PooledList
+{
+    using index_t = uint32_t;
+    static constexpr const index_t invalid_index = std::numeric_limits<index_t>::max();
+    static constexpr const size_t  chunk_bits    = 10;
+    static constexpr const size_t  chunk_size    = size_t(1) << chunk_bits;
+    // Maximum number of chunks kept by the per-thread cache.
+    static constexpr const size_t  max_cached_chunks = 32;
+
+    struct Slot
+    {
+        // The element storage has to be the first member, so that iterator_to() may convert an element address to its slot.
+        alignas(T) unsigned char storage[sizeof(T)];
+        index_t                  prev;
+        index_t                  next;
+        index_t                  self;
+    };
+    using Chunk = std::unique_ptr<Slot[]>;
+
+    static std::vector<Chunk>& chunk_cache()
+    {
+        static thread_local std::vector<Chunk> cache;
+        return cache;
+    }
+
+    template<typename list_t, typename value_t>
+    class iterator_base
+    {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = value_t*;
+        using reference         = value_t&;
+
+        iterator_base() = default;
+        iterator_base(list_t *list, index_t idx) : m_list(list), m_idx(idx) {}
+        // Conversion of iterator to const_iterator.
+        template<typename other_list_t, typename other_value_t>
+        iterator_base(const iterator_base<other_list_t, other_value_t> &rhs) : m_list(rhs.m_list), m_idx(rhs.m_idx) {}
+
+        reference       operator*()  const { return m_list->value(m_idx); }
+        pointer         operator->() const { return &m_list->value(m_idx); }
+        iterator_base&  operator++()       { m_idx = m_list->slot(m_idx).next; return *this; }
+        iterator_base   operator++(int)    { iterator_base out(*this); ++ *this; return out; }
+        iterator_base&  operator--()       { m_idx = m_idx == invalid_index ? m_list->m_tail : m_list->slot(m_idx).prev; return *this; }
+        iterator_base   operator--(int)    { iterator_base out(*this); -- *this; return out; }
+        template<typename other_list_t, typename other_value_t>
+        bool            operator==(const iterator_base<other_list_t, other_value_t> &rhs) const { return m_idx == rhs.m_idx; }
+        template<typename other_list_t, typename other_value_t>
+        bool            operator!=(const iterator_base<other_list_t, other_value_t> &rhs) const { return m_idx != rhs.m_idx; }
+
+        // Stable index of the slot, valid until the element is erased.
+        size_t          index() const { return m_idx; }
+
+    private:
+        list_t  *m_list = nullptr;
+        index_t  m_idx  = invalid_index;
+
+        template<typename, typename> friend class iterator_base;
+        friend class PooledList;
+    };
+
+public:
+    using value_type      = T;
+    using reference       = T&;
+    using const_reference = const T&;
+    using size_type       = size_t;
+    using iterator        = iterator_base<PooledList, T>;
+    using const_iterator  = iterator_base<const PooledList, const T>;
+
+    PooledList() = default;
+    PooledList(const PooledList &) = delete;
+    PooledList(PooledList &&rhs) noexcept { this->swap(rhs); }
+    ~PooledList()
+    {
+        this->clear();
+        std::vector<Chunk> &cache = chunk_cache();
+        for (Chunk &chunk : m_chunks)
+            if (cache.size() < max_cached_chunks)
+                cache.emplace_back(std::move(chunk));
+    }
+
+    PooledList& operator=(const PooledList &) = delete;
+    PooledList& operator=(PooledList &&rhs) noexcept { this->swap(rhs); return *this; }
+
+    void swap(PooledList &rhs) noexcept
+    {
+        std::swap(m_chunks, rhs.m_chunks);
+        std::swap(m_head, rhs.m_head);
+        std::swap(m_tail, rhs.m_tail);
+        std::swap(m_free, rhs.m_free);
+        std::swap(m_num_slots, rhs.m_num_slots);
+        std::swap(m_size, rhs.m_size);
+    }
+
+    iterator        begin()        { return iterator(this, m_head); }
+    iterator        end()          { return iterator(this, invalid_index); }
+    const_iterator  begin()  const { return const_iterator(this, m_head); }
+    const_iterator  end()    const { return const_iterator(this, invalid_index); }
+    const_iterator  cbegin() const { return this->begin(); }
+    const_iterator  cend()   const { return this->end(); }
+
+    bool            empty()  const { return m_size == 0; }
+    size_t          size()   const { return m_size; }
+
+    T&              front()        { assert(! this->empty()); return this->value(m_head); }
+    const T&        front()  const { assert(! this->empty()); return this->value(m_head); }
+    T&              back()         { assert(! this->empty()); return this->value(m_tail); }
+    const T&        back()   const { assert(! this->empty()); return this->value(m_tail); }
+
+    template<typename... Args>
+    T& emplace_front(Args&&... args)
+    {
+        index_t idx = this->allocate_slot(std::forward<Args>(args)...);
+        this->link_before(idx, m_head);
+        return this->value(idx);
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        index_t idx = this->allocate_slot(std::forward<Args>(args)...);
+        this->link_before(idx, invalid_index);
+        return this->value(idx);
+    }
+
+    // Erase the element, return iterator to the following element.
+    iterator erase(const_iterator it)
+    {
+        assert(it.m_idx != invalid_index);
+        const index_t idx  = it.m_idx;
+        Slot         &s    = this->slot(idx);
+        const index_t next = s.next;
+        (s.prev == invalid_index ? m_head : this->slot(s.prev).next) = s.next;
+        (s.next == invalid_index ? m_tail : this->slot(s.next).prev) = s.prev;
+        std::launder(reinterpret_cast<T*>(s.storage))->~T();
+        s.next = m_free;
+        m_free = idx;
+        -- m_size;
+        return iterator(this, next);
+    }
+
+    // Iterator pointing to an element of this list, without a lookup.
+    iterator iterator_to(T &value)
+    {
+        const Slot *s = reinterpret_cast<const Slot*>(reinterpret_cast<const unsigned char*>(&value));
+        assert(&this->slot(s->self) == s);
+        return iterator(this, s->self);
+    }
+
+    // Destroys all elements. The chunks are kept for reuse.
+    void clear()
+    {
+        for (index_t idx = m_head; idx != invalid_index;) {
+            Slot &s = this->slot(idx);
+            idx = s.next;
+            std::launder(reinterpret_cast<T*>(s.storage))->~T();
+        }
+        m_head = m_tail = m_free = invalid_index;
+        m_num_slots = 0;
+        m_size = 0;
+    }
+
+private:
+    Slot&       slot(index_t idx)        { assert(idx < m_num_slots); return m_chunks[idx >> chunk_bits][idx & (chunk_size - 1)]; }
+    const Slot& slot(index_t idx)  const { assert(idx < m_num_slots); return m_chunks[idx >> chunk_bits][idx & (chunk_size - 1)]; }
+    T&          value(index_t idx)       { return *std::launder(reinterpret_cast<T*>(this->slot(idx).storage)); }
+    const T&    value(index_t idx) const { return *std::launder(reinterpret_cast<const T*>(this->slot(idx).storage)); }
+
+    template<typename... Args>
+    index_t allocate_slot(Args&&... args)
+    {
+        index_t idx;
+        if (m_free != invalid_index) {
+            idx    = m_free;
+            m_free = this->slot(idx).next;
+        } else {
+            assert(m_num_slots < invalid_index);
+            if ((m_num_slots >> chunk_bits) == m_chunks.size()) {
+                std::vector<Chunk> &cache = chunk_cache();
+                if (cache.empty())
+                    m_chunks.emplace_back(new Slot[chunk_size]);
+                else {
+                    m_chunks.emplace_back(std::move(cache.back()));
+                    cache.pop_back();
+                }
+            }
+            idx = m_num_slots ++;
+        }
+        Slot &s = this->slot(idx);
+        // Construct first, so that the list stays consistent if the constructor throws.
+        new (s.storage) T(std::forward<Args>(args)...);
+        s.self = idx;
+        ++ m_size;
+        return idx;
+    }
+
+    // Insert the slot idx in front of slot next, or at the end if next == invalid_index.
+    void link_before(index_t idx, index_t next)
+    {
+        Slot &s = this->slot(idx);
+        s.next = next;
+        s.prev = next == invalid_index ? m_tail : this->slot(next).prev;
+        (s.prev == invalid_index ? m_head : this->slot(s.prev).next) = idx;
+        (next   == invalid_index ? m_tail : this->slot(next).prev)   = idx;
+    }
+
+    std::vector<Chunk>  m_chunks;
+    index_t             m_head      = invalid_index;
+    index_t             m_tail      = invalid_index;
+    // Single linked list of erased slots through Slot::next.
+    index_t             m_free      = invalid_index;
+    // Number of slots handed out from m_chunks, including the erased ones.
+    index_t             m_num_slots = 0;
+    size_t              m_size      = 0;
+};
+
+} // namespace Slic3r::Arachne
+#endif // UTILS_POOLED_LIST_H
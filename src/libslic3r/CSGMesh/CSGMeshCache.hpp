@@ -0,0 +1,135 @@
+#ifndef CSGMESHCACHE_HPP
+#define CSGMESHCACHE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include <ankerl/unordered_dense.h>
+
+#include "libslic3r/TriangleMesh.hpp"
+
+namespace Slic3r { namespace csg {
+
+// Key of a mesh in the MeshCache. It describes the source of the mesh completely: the content of the source meshes
+// with their transformations and the tree of the operations applied to them, see csgpart_key().
+// The keys are compared on lookup, the hash of the key only selects the bucket.
+using MeshKey = std::vector<uint64_t>;
+
+struct MeshKeyHash
+{
+    using is_avalanching = void;
+    uint64_t operator()(const MeshKey &key) const
+    {
+        return ankerl::unordered_dense::hash<std::string_view>{}(
+            std::string_view(reinterpret_cast<const char *>(key.data()), key.size() * sizeof(uint64_t)));
+    }
+};
+
+// Append the content of a mesh to a key: the vertex and face counts and two hashes of the vertices and of the faces.
+inline void append_its_content(MeshKey &key, const indexed_triangle_set &its)
+{
+    auto hash_bytes = [](const auto &vec) {
+        return uint64_t(ankerl::unordered_dense::hash<std::string_view>{}(
+            std::string_view(reinterpret_cast<const char *>(vec.data()), vec.size() * sizeof(vec.front()))));
+    };
+    key.insert(key.end(), { uint64_t(its.vertices.size()), uint64_t(its.indices.size()), hash_bytes(its.vertices), hash_bytes(its.indices) });
+}
+
+// Append the bits of the float values to a key.
+template<class T> void append_floats(MeshKey &key, const T *data, size_t size)
+{
+    for (size_t i = 0; i < size; ++ i) {
+        uint32_t bits;
+        std::memcpy(&bits, data + i, sizeof(bits));
+        key.emplace_back(bits);
+    }
+}
+
+// Least recently used cache of the meshes converted to a mesh boolean backend (CGALMeshPtr or McutMeshPtr)
+// and of the results of the boolean operations on them, shared by all CSG evaluations of the process.
+// Evaluating the same CSG parts again reuses the meshes. The boolean operations modify their operands,
+// therefore get() returns a copy of the cached mesh. The cache is cleared when the project is closed,
+// see clear_mesh_caches().
+template<class MeshPtr> class MeshCache
+{
+public:
+    using Mesh = typename MeshPtr::element_type;
+
+    // The least recently used meshes are evicted once the cached meshes take more memory in total.
+    static constexpr size_t MaxBytes = 256 * 1024 * 1024;
+
+    // Copy of the cached mesh, nullptr if there is none.
+    MeshPtr get(const MeshKey &key)
+    {
+        std::shared_ptr<const Mesh> mesh;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_index.find(key);
+            if (it == m_index.end())
+                return nullptr;
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            mesh = it->second->mesh;
+        }
+        return clone(*mesh);
+    }
+
+    // Store a copy of the mesh.
+    void put(const MeshKey &key, const Mesh &mesh)
+    {
+        const size_t bytes = memory_size(mesh) + key.size() * sizeof(uint64_t);
+        if (bytes > MaxBytes / 4)
+            // Don't flush the whole cache for a single huge mesh.
+            return;
+        std::shared_ptr<const Mesh> copy = clone(mesh);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_index.find(key) != m_index.end())
+            return;
+        m_entries.push_front({ key, std::move(copy), bytes });
+        m_index.emplace(key, m_entries.begin());
+        m_bytes += bytes;
+        while (m_bytes > MaxBytes) {
+            const Entry &lru = m_entries.back();
+            m_bytes -= lru.bytes;
+            m_index.erase(lru.key);
+            m_entries.pop_back();
+        }
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        m_index.clear();
+        m_bytes = 0;
+    }
+
+private:
+    struct Entry
+    {
+        MeshKey                     key;
+        std::shared_ptr<const Mesh> mesh;
+        size_t                      bytes;
+    };
+
+    std::mutex                                                                            m_mutex;
+    // The most recently used first.
+    std::list<Entry>                                                                      m_entries;
+    ankerl::unordered_dense::map<MeshKey, typename std::list<Entry>::iterator, MeshKeyHash> m_index;
+    size_t                                                                                m_bytes { 0 };
+};
+
+// The process wide cache of a mesh boolean backend.
+template<class MeshPtr> MeshCache<MeshPtr>& mesh_cache()
+{
+    static MeshCache<MeshPtr> cache;
+    return cache;
+}
+
+}} // namespace Slic3r::csg
+
+#endif // CSGMESHCACHE_HPP
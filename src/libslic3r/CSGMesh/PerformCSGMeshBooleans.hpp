@@ -4,7 +4,11 @@
 #include <stack>
 #include <vector>
 
+#include <boost/log/trivial.hpp>
+#include <tbb/parallel_invoke.h>
+
 #include "CSGMesh.hpp"
+#include "CSGMeshCache.hpp"
 
 #include "libslic3r/Execution/ExecutionTBB.hpp"
 //#include "libslic3r/Execution/ExecutionSeq.hpp"
@@ -13,57 +17,84 @@
 namespace Slic3r { namespace csg {
     enum class BooleanFailReason { OK, MeshEmpty, NotBoundAVolume, SelfIntersect, NoIntersection};
 
-// This method can be overriden when a specific CSGPart type supports caching
-// of the voxel grid
+// Kinds of the keys in the mesh caches.
+enum class MeshKeyType : uint64_t { Part = 1, Group, Batch };
+
+// Key of a CSG part in the mesh caches: the content of its mesh and its transformation.
 template<class CSGPartT>
-MeshBoolean::cgal::CGALMeshPtr get_cgalmesh(const CSGPartT &csgpart)
+MeshKey csgpart_key(const CSGPartT &csgpart)
+{
+    MeshKey key { uint64_t(MeshKeyType::Part) };
+    if (const indexed_triangle_set *its = csg::get_mesh(csgpart); its)
+        append_its_content(key, *its);
+    else
+        key.insert(key.end(), 4, 0);
+    const Transform3f trafo = get_transform(csgpart);
+    append_floats(key, trafo.matrix().data(), trafo.matrix().size());
+    return key;
+}
+
+// Append the key of an operand of a group or of a batch to the key of the group or the batch.
+inline void append_operand_key(MeshKey &key, CSGType op, const MeshKey &operand_key)
 {
+    key.insert(key.end(), { uint64_t(op), uint64_t(operand_key.size()) });
+    key.insert(key.end(), operand_key.begin(), operand_key.end());
+}
+
+namespace detail {
+
+// Convert the transformed mesh of a CSG part, or take it from the mesh cache.
+template<class MeshPtr, class CSGPartT, class ConvertFn>
+MeshPtr get_cached_mesh(const CSGPartT &csgpart, ConvertFn &&convert)
+{
+    const MeshKey key = csgpart_key(csgpart);
+    if (MeshPtr cached = mesh_cache<MeshPtr>().get(key))
+        return cached;
+
     const indexed_triangle_set *its = csg::get_mesh(csgpart);
     indexed_triangle_set dummy;
 
     if (!its)
         its = &dummy;
 
-    MeshBoolean::cgal::CGALMeshPtr ret;
+    MeshPtr ret;
 
     indexed_triangle_set m = *its;
     its_transform(m, get_transform(csgpart), true);
 
     try {
-        ret = MeshBoolean::cgal::triangle_mesh_to_cgal(m);
+        ret = convert(m);
     } catch (...) {
         // errors are ignored, simply return null
         ret = nullptr;
     }
 
+    if (ret)
+        mesh_cache<MeshPtr>().put(key, *ret);
+
     return ret;
 }
 
+} // namespace detail
+
 // This method can be overriden when a specific CSGPart type supports caching
 // of the voxel grid
 template<class CSGPartT>
-MeshBoolean::mcut::McutMeshPtr get_mcutmesh(const CSGPartT& csgpart)
+MeshBoolean::cgal::CGALMeshPtr get_cgalmesh(const CSGPartT &csgpart)
 {
-    const indexed_triangle_set* its = csg::get_mesh(csgpart);
-    indexed_triangle_set dummy;
-
-    if (!its)
-        its = &dummy;
-
-    MeshBoolean::mcut::McutMeshPtr ret;
-
-    indexed_triangle_set m = *its;
-    its_transform(m, get_transform(csgpart), true);
-
-    try {
-        ret = MeshBoolean::mcut::triangle_mesh_to_mcut(m);
-    }
-    catch (...) {
-        // errors are ignored, simply return null
-        ret = nullptr;
-    }
+    return detail::get_cached_mesh<MeshBoolean::cgal::CGALMeshPtr>(csgpart, [](const indexed_triangle_set &its) {
+        return MeshBoolean::cgal::triangle_mesh_to_cgal(its);
+    });
+}
 
-    return ret;
+// This method can be overriden when a specific CSGPart type supports caching
+// of the voxel grid
+template<class CSGPartT>
+MeshBoolean::mcut::McutMeshPtr get_mcutmesh(const CSGPartT& csgpart)
+{
+    return detail::get_cached_mesh<MeshBoolean::mcut::McutMeshPtr>(csgpart, [](const indexed_triangle_set &its) {
+        return MeshBoolean::mcut::triangle_mesh_to_mcut(its);
+    });
 }
 
 namespace detail_cgal {
@@ -93,21 +124,6 @@ inline void perform_csg(CSGType op, CGALMeshPtr &dst, CGALMeshPtr &src)
     }
 }
 
-template<class Ex, class It>
-std::vector<CGALMeshPtr> get_cgalptrs(Ex policy, const Range<It> &csgrange)
-{
-    std::vector<CGALMeshPtr> ret(csgrange.size());
-    execution::for_each(policy, size_t(0), csgrange.size(),
-                        [&csgrange, &ret](size_t i) {
-        auto it = csgrange.begin();
-        std::advance(it, i);
-        auto &csgpart = *it;
-        ret[i]        = get_cgalmesh(csgpart);
-    });
-
-    return ret;
-}
-
 } // namespace detail
 
 namespace detail_mcut {
@@ -137,124 +153,223 @@ namespace detail_mcut {
         }
     }
 
-    template<class Ex, class It>
-    std::vector<McutMeshPtr> get_mcutptrs(Ex policy, const Range<It>& csgrange)
-    {
-        std::vector<McutMeshPtr> ret(csgrange.size());
-        execution::for_each(policy, size_t(0), csgrange.size(),
-            [&csgrange, &ret](size_t i) {
-                auto it = csgrange.begin();
-                std::advance(it, i);
-                auto& csgpart = *it;
-                ret[i] = get_mcutmesh(csgpart);
-            });
-
-        return ret;
-    }
-
 } // namespace mcut_detail
 
-// Process the sequence of CSG parts with CGAL.
-template<class It>
-void perform_csgmesh_booleans_cgal(MeshBoolean::cgal::CGALMeshPtr &cgalm,
-                              const Range<It>                &csgrange)
-{
-    using MeshBoolean::cgal::CGALMesh;
-    using MeshBoolean::cgal::CGALMeshPtr;
-    using namespace detail_cgal;
-
-    struct Frame {
-        CSGType op; CGALMeshPtr cgalptr;
-        explicit Frame(CSGType csgop = CSGType::Union)
-            : op{ csgop }
-            , cgalptr{ MeshBoolean::cgal::triangle_mesh_to_cgal(indexed_triangle_set{}) }
-        {}
-    };
-
-    std::stack opstack{ std::vector<Frame>{} };
+namespace detail {
 
-    opstack.push(Frame{});
+struct CGALBackend
+{
+    using MeshPtr = MeshBoolean::cgal::CGALMeshPtr;
 
-    std::vector<CGALMeshPtr> cgalmeshes = get_cgalptrs(ex_tbb, csgrange);
+    // The booleans are exact, A - B - C may be evaluated as A - (B + C).
+    static constexpr bool BatchOperands = true;
 
-    size_t csgidx = 0;
-    for (auto& csgpart : csgrange) {
+    static MeshPtr empty_mesh() { return MeshBoolean::cgal::triangle_mesh_to_cgal(indexed_triangle_set{}); }
+    template<class CSGPartT>
+    static MeshPtr get_mesh(const CSGPartT &csgpart) { return get_cgalmesh(csgpart); }
+    static bool    empty(const MeshPtr &m) { return MeshBoolean::cgal::empty(*m); }
+    static void    perform(CSGType op, MeshPtr &dst, MeshPtr &src) { detail_cgal::perform_csg(op, dst, src); }
+};
 
-        auto op = get_operation(csgpart);
-        CGALMeshPtr& cgalptr = cgalmeshes[csgidx++];
+struct McutBackend
+{
+    using MeshPtr = MeshBoolean::mcut::McutMeshPtr;
+
+    // The mcut union of meshes, which do not overlap, unions each component of one into each component of the other,
+    // thus (B + C) + (D + E) does not equal B + C + D + E. The operands are applied one after the other.
+    static constexpr bool BatchOperands = false;
+
+    static MeshPtr empty_mesh() { return MeshBoolean::mcut::triangle_mesh_to_mcut(indexed_triangle_set{}); }
+    template<class CSGPartT>
+    static MeshPtr get_mesh(const CSGPartT &csgpart) { return get_mcutmesh(csgpart); }
+    static bool    empty(const MeshPtr &m) { return MeshBoolean::mcut::empty(*m); }
+    static void    perform(CSGType op, MeshPtr &dst, MeshPtr &src) { detail_mcut::perform_csg(op, dst, src); }
+};
+
+// Evaluates a sequence of CSG parts with a mesh boolean backend.
+// The parts between a Push and the matching Pop form a group, which is applied to the result of the enclosing group
+// with the operation of the Push part. If the backend allows it (Backend::BatchOperands), the consecutive operands
+// of the same operation within a group are combined into a single operand first, as A - B - C == A - (B + C),
+// A + B + C == A + (B + C) and A * B * C == A * (B * C). Otherwise each operand forms a batch of its own.
+// The groups, the batches of operands and the operands of a batch are evaluated in parallel, only the batches
+// of a group are applied one after the other. The results of the groups and the batches are memoized in the mesh cache.
+template<class Backend, class It>
+class CSGEvaluator
+{
+public:
+    using MeshPtr = typename Backend::MeshPtr;
 
-        if (get_stack_operation(csgpart) == CSGStackOp::Push) {
-            opstack.push(Frame{ op });
-            op = CSGType::Union;
+    explicit CSGEvaluator(const Range<It> &csgrange)
+    {
+        // Parse the stack operations into groups, the root group first.
+        m_groups.emplace_back();
+        std::vector<size_t> stack{ 0 };
+        for (It it = csgrange.begin(); it != csgrange.end(); ++it) {
+            const auto  &csgpart = *it;
+            const size_t part_idx = m_parts.size();
+            m_parts.emplace_back(it);
+            if (get_stack_operation(csgpart) == CSGStackOp::Push) {
+                m_groups[stack.back()].items.push_back({ get_operation(csgpart), 0, int(m_groups.size()), {} });
+                stack.push_back(m_groups.size());
+                m_groups.emplace_back();
+            }
+            m_groups[stack.back()].items.push_back({ get_operation(csgpart), part_idx, -1, csgpart_key(csgpart) });
+            // An unmatched Pop is ignored, unclosed groups are closed at the end.
+            if (get_stack_operation(csgpart) == CSGStackOp::Pop && stack.size() > 1)
+                stack.pop_back();
         }
 
-        Frame* top = &opstack.top();
-
-        perform_csg(get_operation(csgpart), top->cgalptr, cgalptr);
-
-        if (get_stack_operation(csgpart) == CSGStackOp::Pop) {
-            CGALMeshPtr src = std::move(top->cgalptr);
-            auto popop = opstack.top().op;
-            opstack.pop();
-            CGALMeshPtr& dst = opstack.top().cgalptr;
-            perform_csg(popop, dst, src);
+        // The groups nested in a group follow it.
+        for (size_t group_idx = m_groups.size(); group_idx-- > 0;) {
+            Group &group = m_groups[group_idx];
+            group.key    = { uint64_t(MeshKeyType::Group), uint64_t(group.items.size()) };
+            for (Item &item : group.items) {
+                if (item.group_idx >= 0)
+                    item.key = m_groups[item.group_idx].key;
+                append_operand_key(group.key, item.op, item.key);
+            }
         }
     }
 
-    cgalm = std::move(opstack.top().cgalptr);
-}
+    MeshPtr evaluate() { return this->evaluate_group(0); }
 
-// Process the sequence of CSG parts with mcut.
-template<class It>
-void perform_csgmesh_booleans_mcut(MeshBoolean::mcut::McutMeshPtr& mcutm,
-    const Range<It>& csgrange)
-{
-    using MeshBoolean::mcut::McutMesh;
-    using MeshBoolean::mcut::McutMeshPtr;
-    using namespace detail_mcut;
-
-    struct Frame {
-        CSGType op; McutMeshPtr mcutptr;
-        explicit Frame(CSGType csgop = CSGType::Union)
-            : op{ csgop }
-            , mcutptr{ MeshBoolean::mcut::triangle_mesh_to_mcut(indexed_triangle_set{}) }
-        {}
+private:
+    struct Item
+    {
+        CSGType op;
+        // Index of the CSG part of a leaf.
+        size_t  part_idx;
+        // Index of the group, -1 for a leaf.
+        int     group_idx;
+        MeshKey key;
     };
 
-    std::stack opstack{ std::vector<Frame>{} };
+    struct Group
+    {
+        std::vector<Item> items;
+        MeshKey           key;
+    };
 
-    opstack.push(Frame{});
+    // Range of consecutive items of a group with the same operation.
+    struct Batch
+    {
+        size_t first;
+        size_t last;
+    };
+
+    static void apply(CSGType op, MeshPtr &dst, MeshPtr &src)
+    {
+        if (dst && src) {
+            // Short cut the booleans with an empty mesh.
+            if (Backend::empty(src)) {
+                if (op == CSGType::Intersection)
+                    dst = std::move(src);
+                return;
+            }
+            if (Backend::empty(dst)) {
+                if (op == CSGType::Union)
+                    dst = std::move(src);
+                return;
+            }
+        }
+        Backend::perform(op, dst, src);
+    }
 
-    std::vector<McutMeshPtr> McutMeshes = get_mcutptrs(ex_tbb, csgrange);
+    MeshPtr evaluate_item(const Item &item)
+    {
+        return item.group_idx < 0 ? Backend::get_mesh(*m_parts[item.part_idx]) : this->evaluate_group(size_t(item.group_idx));
+    }
 
-    size_t csgidx = 0;
-    for (auto& csgpart : csgrange) {
+    MeshPtr evaluate_group(size_t group_idx)
+    {
+        const Group &group = m_groups[group_idx];
+        if (MeshPtr cached = mesh_cache<MeshPtr>().get(group.key))
+            return cached;
+
+        std::vector<Batch> batches;
+        for (size_t i = 0; i < group.items.size(); ++i)
+            if (batches.empty() || ! Backend::BatchOperands || group.items[i].op != group.items[batches.back().first].op)
+                batches.push_back({ i, i + 1 });
+            else
+                batches.back().last = i + 1;
+
+        std::vector<MeshPtr> operands(batches.size());
+        execution::for_each(ex_tbb, size_t(0), batches.size(), [this, &group, &batches, &operands](size_t batch_idx) {
+            operands[batch_idx] = this->evaluate_batch(group, batches[batch_idx]);
+        });
+
+        MeshPtr ret = Backend::empty_mesh();
+        for (size_t batch_idx = 0; batch_idx < batches.size(); ++batch_idx)
+            apply(group.items[batches[batch_idx].first].op, ret, operands[batch_idx]);
+
+        if (ret)
+            mesh_cache<MeshPtr>().put(group.key, *ret);
+        return ret;
+    }
 
-        auto op = get_operation(csgpart);
-        McutMeshPtr& mcutptr = McutMeshes[csgidx++];
+    MeshPtr evaluate_batch(const Group &group, const Batch &batch)
+    {
+        if (batch.last - batch.first == 1)
+            return this->evaluate_item(group.items[batch.first]);
+
+        const CSGType op  = group.items[batch.first].op;
+        MeshKey       key { uint64_t(MeshKeyType::Batch), uint64_t(batch.last - batch.first) };
+        for (size_t i = batch.first; i < batch.last; ++i)
+            append_operand_key(key, op, group.items[i].key);
+        if (MeshPtr cached = mesh_cache<MeshPtr>().get(key))
+            return cached;
+
+        MeshPtr ret = this->reduce(group, batch.first, batch.last, op == CSGType::Intersection ? CSGType::Intersection : CSGType::Union);
+        if (ret)
+            mesh_cache<MeshPtr>().put(key, *ret);
+        return ret;
+    }
 
-        if (get_stack_operation(csgpart) == CSGStackOp::Push) {
-            opstack.push(Frame{ op });
-            op = CSGType::Union;
-        }
+    // Combine the items [first, last) with a balanced tree of boolean operations.
+    MeshPtr reduce(const Group &group, size_t first, size_t last, CSGType op)
+    {
+        if (last - first == 1)
+            return this->evaluate_item(group.items[first]);
+
+        const size_t mid = (first + last) / 2;
+        MeshPtr      a, b;
+        tbb::parallel_invoke([this, &group, first, mid, op, &a]() { a = this->reduce(group, first, mid, op); },
+                             [this, &group, mid, last, op, &b]() { b = this->reduce(group, mid, last, op); });
+        // A part, which failed to convert, is left out as by the sequential evaluation.
+        if (! a)
+            return b;
+        apply(op, a, b);
+        return a;
+    }
 
-        Frame* top = &opstack.top();
+    std::vector<It>    m_parts;
+    std::vector<Group> m_groups;
+};
 
-        perform_csg(get_operation(csgpart), top->mcutptr, mcutptr);
+} // namespace detail
 
-        if (get_stack_operation(csgpart) == CSGStackOp::Pop) {
-            McutMeshPtr src = std::move(top->mcutptr);
-            auto popop = opstack.top().op;
-            opstack.pop();
-            McutMeshPtr& dst = opstack.top().mcutptr;
-            perform_csg(popop, dst, src);
-        }
-    }
+// Release the meshes cached by the CSG evaluations, when the project is closed.
+inline void clear_mesh_caches()
+{
+    mesh_cache<MeshBoolean::cgal::CGALMeshPtr>().clear();
+    mesh_cache<MeshBoolean::mcut::McutMeshPtr>().clear();
+}
 
-    mcutm = std::move(opstack.top().mcutptr);
-    
+// Process the sequence of CSG parts with CGAL.
+template<class It>
+void perform_csgmesh_booleans_cgal(MeshBoolean::cgal::CGALMeshPtr &cgalm,
+                              const Range<It>                &csgrange)
+{
+    cgalm = detail::CSGEvaluator<detail::CGALBackend, It>(csgrange).evaluate();
 }
 
+// Process the sequence of CSG parts with mcut.
+template<class It>
+void perform_csgmesh_booleans_mcut(MeshBoolean::mcut::McutMeshPtr& mcutm,
+    const Range<It>& csgrange)
+{
+    mcutm = detail::CSGEvaluator<detail::McutBackend, It>(csgrange).evaluate();
+}
 
 template<class It, class Visitor>
 std::tuple<BooleanFailReason,std::string, It> check_csgmesh_booleans(const Range<It> &csgrange, Visitor &&vfn)
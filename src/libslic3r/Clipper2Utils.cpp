@@ -17,22 +17,68 @@ Slic3r::Polylines Paths64_to_polylines(const Clipper2Lib::Paths64& in)
     return out;
 }
 
+static inline const Slic3r::Points& path_points(const Slic3r::Points &points) { return points; }
+static inline const Slic3r::Points& path_points(const Slic3r::MultiPoint &path) { return path.points; }
+
 //BBS: FIXME
-template <typename T>
-Clipper2Lib::Paths64 Slic3rPoints_to_Paths64(const std::vector<T>& in)
+// Accepts a vector of Polygons / Polylines as well as the ClipperUtils paths providers.
+template <typename TPaths>
+Clipper2Lib::Paths64 Slic3rPoints_to_Paths64(TPaths&& in)
 {
     Clipper2Lib::Paths64 out;
     out.reserve(in.size());
-    for (const T& item: in) {
+    for (const auto& item : in) {
+        const Slic3r::Points& points = path_points(item);
         Clipper2Lib::Path64 path;
-        path.reserve(item.size());
-        for (const Slic3r::Point& point : item.points)
+        path.reserve(points.size());
+        for (const Slic3r::Point& point : points)
             path.emplace_back(std::move(Clipper2Lib::Point64(point.x(), point.y())));
         out.emplace_back(std::move(path));
     }
     return out;
 }
 
+static inline Slic3r::Polygon Path64_to_polygon(const Clipper2Lib::Path64& in)
+{
+    Slic3r::Polygon out;
+    out.points.reserve(in.size());
+    for (const Clipper2Lib::Point64& point64 : in)
+        out.points.emplace_back(coord_t(point64.x), coord_t(point64.y));
+    return out;
+}
+
+static Slic3r::Polygons Paths64_to_polygons(const Clipper2Lib::Paths64& in)
+{
+    Slic3r::Polygons out;
+    out.reserve(in.size());
+    for (const Clipper2Lib::Path64& path64 : in)
+        out.emplace_back(Path64_to_polygon(path64));
+    return out;
+}
+
+// Same traversal as PolyTreeToExPolygons(): children of an outer contour are its holes, children of a hole are new outer contours.
+static void PolyPath64_to_expolygons(const Clipper2Lib::PolyPath64& outer, Slic3r::ExPolygons& out)
+{
+    ExPolygon& expoly = out.emplace_back();
+    expoly.contour = Path64_to_polygon(outer.Polygon());
+    expoly.holes.reserve(outer.Count());
+    for (const Clipper2Lib::PolyPath64* hole : outer) {
+        expoly.holes.emplace_back(Path64_to_polygon(hole->Polygon()));
+        for (const Clipper2Lib::PolyPath64* island : *hole)
+            // expoly may be invalidated by the recursive call, it is not accessed anymore.
+            PolyPath64_to_expolygons(*island, out);
+    }
+}
+
+static Slic3r::ExPolygons PolyTree64_to_expolygons(const Clipper2Lib::PolyTree64& in)
+{
+    Slic3r::ExPolygons out;
+    out.reserve(in.Count());
+    for (const Clipper2Lib::PolyPath64* outer : in)
+        PolyPath64_to_expolygons(*outer, out);
+    return out;
+}
+
 Polylines _clipper2_pl_open(Clipper2Lib::ClipType clipType, const Slic3r::Polylines& subject, const Slic3r::Polygons& clip)
 {
     Clipper2Lib::Clipper64 c;
@@ -57,4 +103,98 @@ Slic3r::Polylines intersection_pl_2(const Slic3r::Polylines& subject, const Slic
 Slic3r::Polylines  diff_pl_2(const Slic3r::Polylines& subject, const Slic3r::Polygons& clip)
     { return _clipper2_pl_open(Clipper2Lib::ClipType::Difference, subject, clip); }
 
-}
\ No newline at end of file
+static inline Clipper2Lib::JoinType Clipper2_join_type(ClipperLib::JoinType joinType)
+{
+    switch (joinType) {
+    case ClipperLib::jtSquare: return Clipper2Lib::JoinType::Square;
+    case ClipperLib::jtRound:  return Clipper2Lib::JoinType::Round;
+    case ClipperLib::jtMiter:  return Clipper2Lib::JoinType::Miter;
+    }
+    assert(false);
+    return Clipper2Lib::JoinType::Miter;
+}
+
+// Offset of a set of closed paths as a single group: outer contours are expanded, holes shrunk, overlaps are merged.
+// Clipper2 flips the offset of a CW path and keeps its orientation on its own, thus no reversal is needed.
+// Miter limit is reused as arc tolerance for round joins, as in ClipperUtils raw_offset().
+static Clipper2Lib::Paths64 _clipper2_offset(const Clipper2Lib::Paths64& paths, float delta, ClipperLib::JoinType joinType, double miterLimit)
+{
+    if (paths.empty())
+        return {};
+    Clipper2Lib::ClipperOffset co = joinType == ClipperLib::jtRound ?
+        Clipper2Lib::ClipperOffset(DefaultMiterLimit, miterLimit) : Clipper2Lib::ClipperOffset(miterLimit);
+    co.AddPaths(paths, Clipper2_join_type(joinType), Clipper2Lib::EndType::Polygon);
+    return co.Execute(delta);
+}
+
+// TOut is either Clipper2Lib::Paths64 or Clipper2Lib::PolyTree64.
+template <typename TOut>
+static void _clipper2_do(Clipper2Lib::ClipType clipType, const Clipper2Lib::Paths64& subject, const Clipper2Lib::Paths64& clip, TOut& out)
+{
+    Clipper2Lib::Clipper64 c;
+    // Match ClipperLib, which removes collinear points from the output.
+    c.PreserveCollinear = false;
+    c.AddSubject(subject);
+    if (! clip.empty())
+        c.AddClip(clip);
+    c.Execute(clipType, Clipper2Lib::FillRule::NonZero, out);
+}
+
+template <typename TSubject, typename TClip>
+static Slic3r::ExPolygons _clipper2_ex(Clipper2Lib::ClipType clipType, TSubject&& subject, TClip&& clip, ApplySafetyOffset do_safety_offset)
+{
+    Clipper2Lib::Paths64 clip64 = Slic3rPoints_to_Paths64(std::forward<TClip>(clip));
+    if (do_safety_offset == ApplySafetyOffset::Yes) {
+        // Offset each clip path separately, the results are not united, as ClipperUtils clipper_do() does.
+        Clipper2Lib::Paths64 offsetted;
+        offsetted.reserve(clip64.size());
+        for (const Clipper2Lib::Path64& path : clip64)
+            for (Clipper2Lib::Path64& p : _clipper2_offset({ path }, ClipperSafetyOffset, DefaultJoinType, DefaultMiterLimit))
+                offsetted.emplace_back(std::move(p));
+        clip64 = std::move(offsetted);
+    }
+    Clipper2Lib::PolyTree64 polytree;
+    _clipper2_do(clipType, Slic3rPoints_to_Paths64(std::forward<TSubject>(subject)), clip64, polytree);
+    return PolyTree64_to_expolygons(polytree);
+}
+
+// ClipperOffset only returns paths, one more union sorts them into outer contours and holes.
+static Slic3r::ExPolygons _clipper2_offset_ex(const Clipper2Lib::Paths64& paths, float delta, ClipperLib::JoinType joinType, double miterLimit)
+{
+    Clipper2Lib::PolyTree64 polytree;
+    _clipper2_do(Clipper2Lib::ClipType::Union, _clipper2_offset(paths, delta, joinType, miterLimit), {}, polytree);
+    return PolyTree64_to_expolygons(polytree);
+}
+
+Slic3r::Polygons union_2(const Slic3r::Polygons& subject)
+{
+    Clipper2Lib::Paths64 out;
+    _clipper2_do(Clipper2Lib::ClipType::Union, Slic3rPoints_to_Paths64(subject), {}, out);
+    return Paths64_to_polygons(out);
+}
+Slic3r::ExPolygons union_ex_2(const Slic3r::Polygons& subject)
+    { return _clipper2_ex(Clipper2Lib::ClipType::Union, ClipperUtils::PolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ApplySafetyOffset::No); }
+Slic3r::ExPolygons union_ex_2(const Slic3r::ExPolygons& subject)
+    { return _clipper2_ex(Clipper2Lib::ClipType::Union, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::EmptyPathsProvider(), ApplySafetyOffset::No); }
+Slic3r::ExPolygons diff_ex_2(const Slic3r::ExPolygons& subject, const Slic3r::Polygons& clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper2_ex(Clipper2Lib::ClipType::Difference, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::PolygonsProvider(clip), do_safety_offset); }
+Slic3r::ExPolygons diff_ex_2(const Slic3r::ExPolygons& subject, const Slic3r::ExPolygons& clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper2_ex(Clipper2Lib::ClipType::Difference, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::ExPolygonsProvider(clip), do_safety_offset); }
+Slic3r::ExPolygons intersection_ex_2(const Slic3r::ExPolygons& subject, const Slic3r::Polygons& clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper2_ex(Clipper2Lib::ClipType::Intersection, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::PolygonsProvider(clip), do_safety_offset); }
+Slic3r::ExPolygons intersection_ex_2(const Slic3r::ExPolygons& subject, const Slic3r::ExPolygons& clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper2_ex(Clipper2Lib::ClipType::Intersection, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::ExPolygonsProvider(clip), do_safety_offset); }
+
+Slic3r::Polygons offset_2(const Slic3r::ExPolygons& expolygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return Paths64_to_polygons(_clipper2_offset(Slic3rPoints_to_Paths64(ClipperUtils::ExPolygonsProvider(expolygons)), delta, joinType, miterLimit)); }
+Slic3r::ExPolygons offset_ex_2(const Slic3r::Polygons& polygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return _clipper2_offset_ex(Slic3rPoints_to_Paths64(polygons), delta, joinType, miterLimit); }
+Slic3r::ExPolygons offset_ex_2(const Slic3r::ExPolygons& expolygons, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+    { return _clipper2_offset_ex(Slic3rPoints_to_Paths64(ClipperUtils::ExPolygonsProvider(expolygons)), delta, joinType, miterLimit); }
+Slic3r::ExPolygons offset2_ex_2(const Slic3r::ExPolygons& expolygons, const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit)
+{
+    return _clipper2_offset_ex(
+        _clipper2_offset(Slic3rPoints_to_Paths64(ClipperUtils::ExPolygonsProvider(expolygons)), delta1, joinType, miterLimit), delta2, joinType, miterLimit);
+}
+
+}
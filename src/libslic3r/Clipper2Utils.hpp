@@ -3,6 +3,8 @@
 
 #include "libslic3r.h"
 #include "clipper2/clipper.h"
+#include "ClipperUtils.hpp"
+#include "ExPolygon.hpp"
 #include "Polygon.hpp"
 #include "Polyline.hpp"
 
@@ -11,7 +13,26 @@ namespace Slic3r {
 Slic3r::Polylines  intersection_pl_2(const Slic3r::Polylines& subject, const Slic3r::Polygons& clip);
 Slic3r::Polylines  diff_pl_2(const Slic3r::Polylines& subject, const Slic3r::Polygons& clip);
 
+// Clipper2 counterparts of the ClipperUtils boolean and offset operations, taking and returning the same types,
+// so that the two libraries may be compared on the same data. Clipper2 builds the PolyTree directly, thus the _ex variants
+// do not need the two pass workaround of clipper_do_polytree().
+Slic3r::Polygons   union_2(const Slic3r::Polygons &subject);
+Slic3r::ExPolygons union_ex_2(const Slic3r::Polygons &subject);
+Slic3r::ExPolygons union_ex_2(const Slic3r::ExPolygons &subject);
+Slic3r::ExPolygons diff_ex_2(const Slic3r::ExPolygons &subject, const Slic3r::Polygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
+Slic3r::ExPolygons diff_ex_2(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
+Slic3r::ExPolygons intersection_ex_2(const Slic3r::ExPolygons &subject, const Slic3r::Polygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
+Slic3r::ExPolygons intersection_ex_2(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, ApplySafetyOffset do_safety_offset = ApplySafetyOffset::No);
+
+// The contours and holes of all ExPolygons are offsetted as a single group, which replaces the per ExPolygon offset
+// and the reversed bounding box trick of shrink_paths(). As with ClipperLib, the input ExPolygons shall not overlap.
+Slic3r::Polygons   offset_2(const Slic3r::ExPolygons &expolygons, const float delta, ClipperLib::JoinType joinType = DefaultJoinType, double miterLimit = DefaultMiterLimit);
+Slic3r::ExPolygons offset_ex_2(const Slic3r::Polygons &polygons, const float delta, ClipperLib::JoinType joinType = DefaultJoinType, double miterLimit = DefaultMiterLimit);
+Slic3r::ExPolygons offset_ex_2(const Slic3r::ExPolygons &expolygons, const float delta, ClipperLib::JoinType joinType = DefaultJoinType, double miterLimit = DefaultMiterLimit);
+Slic3r::ExPolygons offset2_ex_2(const Slic3r::ExPolygons &expolygons, const float delta1, const float delta2, ClipperLib::JoinType joinType = DefaultJoinType, double miterLimit = DefaultMiterLimit);
+inline Slic3r::ExPolygons opening_ex_2(const Slic3r::ExPolygons &expolygons, const float delta, ClipperLib::JoinType joinType = DefaultJoinType, double miterLimit = DefaultMiterLimit)
+    { assert(delta > 0); return offset2_ex_2(expolygons, - delta, delta, joinType, miterLimit); }
+
 }
 
 #endif
-
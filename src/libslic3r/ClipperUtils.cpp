@@ -2,6 +2,10 @@
 #include "Geometry.hpp"
 #include "ShortestPath.hpp"
 
+#include <numeric>
+
+#include <tbb/parallel_for.h>
+
 // #define CLIPPER_UTILS_DEBUG
 
 #ifdef CLIPPER_UTILS_DEBUG
@@ -813,6 +817,178 @@ Slic3r::ExPolygons xor_ex(const Slic3r::ExPolygons &subject, const Slic3r::ExPol
     return _clipper_ex(ClipperLib::ctXor, ClipperUtils::ExPolygonsProvider(subject), ClipperUtils::ExPolygonsProvider(clip), do_safety_offset);
 }
 
+namespace ClipperUtils {
+    // Paths referenced by pointers, to feed Clipper with a subset of the input polygons without copying them.
+    class PathPtrsProvider {
+    public:
+        PathPtrsProvider(const std::vector<const Points*> &paths) : m_paths(paths) {}
+
+        struct iterator : public PathsProviderIteratorBase {
+        public:
+            explicit iterator(std::vector<const Points*>::const_iterator it) : m_it(it) {}
+            const Points& operator*() const { return **m_it; }
+            bool operator==(const iterator &rhs) const { return m_it == rhs.m_it; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            const Points& operator++(int) { return **(m_it ++); }
+            iterator& operator++() { ++ m_it; return *this; }
+        private:
+            std::vector<const Points*>::const_iterator m_it;
+        };
+
+        iterator cbegin() const { return iterator(m_paths.begin()); }
+        iterator begin()  const { return this->cbegin(); }
+        iterator cend()   const { return iterator(m_paths.end()); }
+        iterator end()    const { return this->cend(); }
+        size_t   size()   const { return m_paths.size(); }
+
+    private:
+        const std::vector<const Points*> &m_paths;
+    };
+}
+
+// Items of the partitioned boolean operations: islands of the subject or of the clip.
+static inline const ExPolygon& partition_item(const ExPolygon &expoly) { return expoly; }
+static inline const ExPolygon& partition_item(const Surface &surface) { return surface.expolygon; }
+static inline const ExPolygon& partition_item(const Surface *surface) { return surface->expolygon; }
+static inline const Polygon&   partition_item(const Polygon &polygon) { return polygon; }
+
+static inline void partition_item_paths(const ExPolygon &expoly, std::vector<const Points*> &out)
+{
+    out.emplace_back(&expoly.contour.points);
+    for (const Polygon &hole : expoly.holes)
+        out.emplace_back(&hole.points);
+}
+static inline void partition_item_paths(const Polygon &polygon, std::vector<const Points*> &out) { out.emplace_back(&polygon.points); }
+
+// Copy a subject island not touched by the clip polygons to the output. A lone polygon is only valid if CCW, otherwise it has to be
+// reoriented by Clipper.
+static inline bool partition_item_pass_through(const ExPolygon &expoly, ExPolygons &out) { out.emplace_back(expoly); return true; }
+static inline bool partition_item_pass_through(const Polygon &polygon, ExPolygons &out)
+{
+    if (! polygon.is_counter_clockwise())
+        return false;
+    out.emplace_back(polygon);
+    return true;
+}
+
+// Group items with overlapping bounding boxes by sweeping the bounding boxes sorted by their left edge.
+// Returns the group index of each item, the groups are numbered in the order of their first item.
+static std::vector<size_t> group_overlapping_bboxes(const std::vector<BoundingBox> &bboxes, size_t &num_groups)
+{
+    std::vector<size_t> parent(bboxes.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find_root = [&parent](size_t i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+
+    std::vector<size_t> order(bboxes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&bboxes](size_t i, size_t j) { return bboxes[i].min.x() < bboxes[j].min.x(); });
+    std::vector<size_t> active;
+    for (size_t i : order) {
+        const BoundingBox &bbox = bboxes[i];
+        active.erase(std::remove_if(active.begin(), active.end(), [&bboxes, &bbox](size_t j) { return bboxes[j].max.x() < bbox.min.x(); }), active.end());
+        for (size_t j : active)
+            if (bboxes[j].overlap(bbox)) {
+                size_t ri = find_root(i);
+                size_t rj = find_root(j);
+                if (ri != rj)
+                    parent[std::max(ri, rj)] = std::min(ri, rj);
+            }
+        active.emplace_back(i);
+    }
+
+    // The root of a group is its item with the lowest index, thus the groups are numbered in the order of their first item.
+    std::vector<size_t> group(bboxes.size());
+    num_groups = 0;
+    for (size_t i = 0; i < bboxes.size(); ++ i)
+        group[i] = find_root(i) == i ? num_groups ++ : group[find_root(i)];
+    return group;
+}
+
+template<typename TSubject, typename TClip>
+static ExPolygons _clipper_ex_partitioned(ClipperLib::ClipType clipType, const TSubject &subject, const TClip &clip, ApplySafetyOffset do_safety_offset)
+{
+    assert(clipType == ClipperLib::ctDifference || clipType == ClipperLib::ctIntersection);
+
+    std::vector<BoundingBox> subject_bboxes;
+    subject_bboxes.reserve(subject.size());
+    for (const auto &item : subject)
+        subject_bboxes.emplace_back(get_extents(partition_item(item)));
+    size_t              num_groups;
+    std::vector<size_t> subject_group = group_overlapping_bboxes(subject_bboxes, num_groups);
+    if (num_groups < 2) {
+        // Nothing to partition.
+        std::vector<const Points*> subject_paths, clip_paths;
+        for (const auto &item : subject)
+            partition_item_paths(partition_item(item), subject_paths);
+        for (const auto &item : clip)
+            partition_item_paths(partition_item(item), clip_paths);
+        return _clipper_ex(clipType, ClipperUtils::PathPtrsProvider(subject_paths), ClipperUtils::PathPtrsProvider(clip_paths), do_safety_offset);
+    }
+
+    std::vector<std::vector<size_t>> groups(num_groups);
+    std::vector<BoundingBox>         group_bboxes(num_groups);
+    for (size_t i = 0; i < subject.size(); ++ i) {
+        groups[subject_group[i]].emplace_back(i);
+        group_bboxes[subject_group[i]].merge(subject_bboxes[i]);
+    }
+    std::vector<BoundingBox> clip_bboxes;
+    clip_bboxes.reserve(clip.size());
+    for (const auto &item : clip) {
+        BoundingBox bbox = get_extents(partition_item(item));
+        if (do_safety_offset == ApplySafetyOffset::Yes)
+            bbox.offset(coord_t(std::ceil(ClipperSafetyOffset)));
+        clip_bboxes.emplace_back(bbox);
+    }
+
+    std::vector<ExPolygons> results(num_groups);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_groups), [&](const tbb::blocked_range<size_t> &range) {
+        std::vector<const Points*> subject_paths, clip_paths;
+        for (size_t group_id = range.begin(); group_id < range.end(); ++ group_id) {
+            const std::vector<size_t> &group = groups[group_id];
+            clip_paths.clear();
+            auto it_clip = clip.begin();
+            for (size_t i = 0; i < clip.size(); ++ i, ++ it_clip)
+                if (clip_bboxes[i].overlap(group_bboxes[group_id]))
+                    partition_item_paths(partition_item(*it_clip), clip_paths);
+            if (clip_paths.empty()) {
+                if (clipType == ClipperLib::ctIntersection)
+                    continue;
+                if (group.size() == 1 && partition_item_pass_through(partition_item(*std::next(subject.begin(), group.front())), results[group_id]))
+                    continue;
+            }
+            subject_paths.clear();
+            for (size_t i : group)
+                partition_item_paths(partition_item(*std::next(subject.begin(), i)), subject_paths);
+            results[group_id] = _clipper_ex(clipType, ClipperUtils::PathPtrsProvider(subject_paths), ClipperUtils::PathPtrsProvider(clip_paths), do_safety_offset);
+        }
+    });
+
+    ExPolygons out;
+    out.reserve(std::accumulate(results.begin(), results.end(), size_t(0), [](size_t acc, const ExPolygons &r) { return acc + r.size(); }));
+    for (ExPolygons &r : results)
+        append(out, std::move(r));
+    return out;
+}
+
+Slic3r::ExPolygons diff_ex_partitioned(const Slic3r::ExPolygons &subject, const Slic3r::Polygons &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper_ex_partitioned(ClipperLib::ctDifference, subject, clip, do_safety_offset); }
+Slic3r::ExPolygons diff_ex_partitioned(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper_ex_partitioned(ClipperLib::ctDifference, subject, clip, do_safety_offset); }
+Slic3r::ExPolygons diff_ex_partitioned(const Slic3r::ExPolygons &subject, const Slic3r::Surfaces &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper_ex_partitioned(ClipperLib::ctDifference, subject, clip, do_safety_offset); }
+Slic3r::ExPolygons diff_ex_partitioned(const Slic3r::SurfacesPtr &subject, const Slic3r::Polygons &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper_ex_partitioned(ClipperLib::ctDifference, subject, clip, do_safety_offset); }
+Slic3r::ExPolygons diff_ex_partitioned(const Slic3r::SurfacesPtr &subject, const Slic3r::ExPolygons &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper_ex_partitioned(ClipperLib::ctDifference, subject, clip, do_safety_offset); }
+Slic3r::ExPolygons intersection_ex_partitioned(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper_ex_partitioned(ClipperLib::ctIntersection, subject, clip, do_safety_offset); }
+Slic3r::ExPolygons intersection_ex_partitioned(const Slic3r::Polygons &subject, const Slic3r::ExPolygons &clip, ApplySafetyOffset do_safety_offset)
+    { return _clipper_ex_partitioned(ClipperLib::ctIntersection, subject, clip, do_safety_offset); }
+
 template<typename PathsProvider1, typename PathsProvider2>
 Polylines _clipper_pl_open(ClipperLib::ClipType clipType, PathsProvider1 &&subject, PathsProvider2 &&clip)
 {
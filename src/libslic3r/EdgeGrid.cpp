@@ -294,40 +294,55 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 	// 4) Prefix sum the numbers of hits per cells to get an index into m_cell_data.
 	size_t cnt = m_cells.front().end;
 	for (size_t i = 1; i < m_cells.size(); ++ i) {
-		m_cells[i].begin = cnt;
+		m_cells[i].begin = uint32_t(cnt);
 		cnt += m_cells[i].end;
-		m_cells[i].end = cnt;
+		m_cells[i].end = uint32_t(cnt);
 	}
+	assert(cnt <= size_t(std::numeric_limits<uint32_t>::max()));
 
 	// 5) Allocate the cell data.
 	m_cell_data.assign(cnt, std::pair<size_t, size_t>(size_t(-1), size_t(-1)));
+	m_cell_line_ids.assign(cnt, uint32_t(-1));
+	size_t num_lines = 0;
+	for (const Contour &contour : m_contours)
+		num_lines += contour.num_segments();
+	assert(num_lines <= size_t(std::numeric_limits<uint32_t>::max()));
+	m_lines.clear();
+	m_lines.reserve(num_lines);
 
 	// 6) Finally fill in m_cell_data by rasterizing the lines once again.
 	for (size_t i = 0; i < m_cells.size(); ++i)
 		m_cells[i].end = m_cells[i].begin;
 
 	struct Visitor {
-		Visitor(std::vector<std::pair<size_t, size_t>> &cell_data, std::vector<Cell> &cells, size_t cols) :
-			cell_data(cell_data), cells(cells), cols(cols), i(0), j(0) {}
+		Visitor(std::vector<std::pair<size_t, size_t>> &cell_data, std::vector<uint32_t> &cell_line_ids, std::vector<Cell> &cells, size_t cols) :
+			cell_data(cell_data), cell_line_ids(cell_line_ids), cells(cells), cols(cols), i(0), j(0), line_id(0) {}
 
 		inline bool operator()(coord_t iy, coord_t ix) {
-			cell_data[cells[iy*cols + ix].end++] = std::pair<size_t, size_t>(i, j);
+			uint32_t idx = cells[iy*cols + ix].end++;
+			cell_data[idx]     = std::pair<size_t, size_t>(i, j);
+			cell_line_ids[idx] = line_id;
 			// Continue traversing the grid along the edge.
 			return true;
 		}
 
 		std::vector<std::pair<size_t, size_t>> &cell_data;
+		std::vector<uint32_t>				   &cell_line_ids;
 		std::vector<Cell> 					   &cells;
 		size_t									cols;
 		size_t 									i;
 		size_t 									j;
-	} visitor(m_cell_data, m_cells, m_cols);
+		uint32_t								line_id;
+	} visitor(m_cell_data, m_cell_line_ids, m_cells, m_cols);
 
 	assert(visitor.i == 0);
 	for (; visitor.i < m_contours.size(); ++ visitor.i) {
 		const Contour &contour = m_contours[visitor.i];
-		for (visitor.j = 0; visitor.j < contour.num_segments(); ++ visitor.j)
-			this->visit_cells_intersecting_line(contour.segment_start(visitor.j), contour.segment_end(visitor.j), visitor);
+		for (visitor.j = 0; visitor.j < contour.num_segments(); ++ visitor.j) {
+			visitor.line_id = uint32_t(m_lines.size());
+			const Line &line = m_lines.emplace_back(contour.segment_start(visitor.j), contour.segment_end(visitor.j));
+			this->visit_cells_intersecting_line(line.a, line.b, visitor);
+		}
 	}
 }
 
@@ -1042,6 +1057,45 @@ float EdgeGrid::Grid::signed_distance_bilinear(const Point &pt) const
 	return f;
 }
 
+// Number of line segments of a cell, for which the squared distances are calculated at once.
+static constexpr const size_t cell_lines_chunk_size = 16;
+
+// Lower bounds of the squared distances of a point to the line segments, clamped to the end points of the segments.
+// Branch free over the segments of a cell, gathered by their indices, so that the compiler vectorizes the loop.
+// The exact distance evaluation with integer arithmetic is only performed for the segments,
+// which may be closer than the closest segment found so far.
+static inline void lines_squared_distances(const Line *lines, const uint32_t *line_ids, size_t num_lines, const Vec2d &pt, double *out)
+{
+	assert(num_lines <= cell_lines_chunk_size);
+	for (size_t i = 0; i < num_lines; ++ i) {
+		const Line  &line = lines[line_ids[i]];
+		const double ax = double(line.a.x());
+		const double ay = double(line.a.y());
+		const double bx = double(line.b.x());
+		const double by = double(line.b.y());
+		const double vx = bx - ax;
+		const double vy = by - ay;
+		const double wx = pt.x() - ax;
+		const double wy = pt.y() - ay;
+		// Integer segments of non-zero length are at least 1 unit long.
+		const double l2 = std::max(vx * vx + vy * vy, 1.);
+		const double t  = std::clamp((vx * wx + vy * wy) / l2, 0., 1.);
+		const double dx = wx - t * vx;
+		const double dy = wy - t * vy;
+		// The 64bit coordinates are rounded when converted to doubles and so are their differences, both by less than
+		// 2^-53 of the magnitude of the coordinates. dx, dy accumulate a few of these errors, the margin covers hundreds of them.
+		const double margin = 1e-13 * (std::abs(ax) + std::abs(ay) + std::abs(bx) + std::abs(by) + std::abs(pt.x()) + std::abs(pt.y())) + 1.;
+		const double d      = std::max(0., std::sqrt(dx * dx + dy * dy) * (1. - 1e-12) - margin);
+		out[i] = d * d;
+	}
+}
+
+// Could a segment with a lower bound of the squared distance d2 be closer than d_min?
+static inline bool may_be_closer(double d2, double d_min)
+{
+	return d2 <= d_min * d_min;
+}
+
 EdgeGrid::Grid::ClosestPointResult EdgeGrid::Grid::closest_point_signed_distance(const Point &pt, coord_t search_radius) const 
 {
 	BoundingBox bbox;
@@ -1077,17 +1131,25 @@ EdgeGrid::Grid::ClosestPointResult EdgeGrid::Grid::closest_point_signed_distance
 	// Signum of the distance field at pt.
 	int sign_min = 0;
 	double l2_seg_min = 1.;
+	const Vec2d ptd  = pt.cast<double>();
+	double      dist2[cell_lines_chunk_size];
 	for (int r = bbox.min(1); r <= bbox.max(1); ++ r) {
 		for (int c = bbox.min(0); c <= bbox.max(0); ++ c) {
 			const Cell &cell = m_cells[r * m_cols + c];
 			for (size_t i = cell.begin; i < cell.end; ++ i) {
+				const size_t ichunk = (i - cell.begin) % cell_lines_chunk_size;
+				if (ichunk == 0)
+					lines_squared_distances(m_lines.data(), m_cell_line_ids.data() + i, std::min(cell_lines_chunk_size, cell.end - i), ptd, dist2);
+				if (! may_be_closer(dist2[ichunk], d_min))
+					continue;
 				const size_t   contour_idx = m_cell_data[i].first;
 				const Contour &contour     = m_contours[contour_idx];
 				assert(contour.closed());
 				size_t ipt = m_cell_data[i].second;
 				// End points of the line segment.
-				const Slic3r::Point &p1 = contour.segment_start(ipt);
-				const Slic3r::Point &p2 = contour.segment_end(ipt);
+				const Line          &line = m_lines[m_cell_line_ids[i]];
+				const Slic3r::Point &p1   = line.a;
+				const Slic3r::Point &p2   = line.b;
 				const Slic3r::Point v_seg = p2 - p1;
 				const Slic3r::Point v_pt  = pt - p1;
 				// dot(p2-p1, pt-p1)
@@ -1138,8 +1200,8 @@ EdgeGrid::Grid::ClosestPointResult EdgeGrid::Grid::closest_point_signed_distance
 						result.start_point_idx = ipt;
 						result.t = t_pt;
 #ifndef NDEBUG
-						Vec2d foot = p1.cast<double>() * (1. - result.t / l2_seg_min) + p2.cast<double>() * (result.t / l2_seg_min);
-						Vec2d vfoot = foot - pt.cast<double>();
+						// Relative to p1, large coordinates would round the foot point.
+						Vec2d vfoot = (p1 - pt).cast<double>() + v_seg.cast<double>() * (result.t / l2_seg_min);
 						double dist_foot = vfoot.norm();
 						double dist_foot_err = dist_foot - d_min;
 						assert(std::abs(dist_foot_err) < 1e-7 || std::abs(dist_foot_err) < 1e-7 * d_min);
@@ -1160,9 +1222,9 @@ EdgeGrid::Grid::ClosestPointResult EdgeGrid::Grid::closest_point_signed_distance
 			const Slic3r::Point &p2  = contour.segment_end(result.start_point_idx);
 			Vec2d vfoot;
 			if (result.t == 0)
-				vfoot = p1.cast<double>() - pt.cast<double>();
+				vfoot = (p1 - pt).cast<double>();
 			else
-				vfoot = p1.cast<double>() * (1. - result.t) + p2.cast<double>() * result.t - pt.cast<double>();
+				vfoot = (p1 - pt).cast<double>() + (p2 - p1).cast<double>() * result.t;
 			double dist_foot = vfoot.norm();
 			double dist_foot_err = dist_foot - std::abs(result.distance);
 			assert(std::abs(dist_foot_err) < 1e-7 || std::abs(dist_foot_err) < 1e-7 * std::abs(result.distance));
@@ -1207,16 +1269,24 @@ bool EdgeGrid::Grid::signed_distance_edges(const Point &pt, coord_t search_radiu
 	// Signum of the distance field at pt.
 	int sign_min = 0;
 	bool on_segment = false;
+	const Vec2d ptd = pt.cast<double>();
+	double      dist2[cell_lines_chunk_size];
 	for (int r = bbox.min(1); r <= bbox.max(1); ++ r) {
 		for (int c = bbox.min(0); c <= bbox.max(0); ++ c) {
 			const Cell &cell = m_cells[r * m_cols + c];
 			for (size_t i = cell.begin; i < cell.end; ++ i) {
+				const size_t ichunk = (i - cell.begin) % cell_lines_chunk_size;
+				if (ichunk == 0)
+					lines_squared_distances(m_lines.data(), m_cell_line_ids.data() + i, std::min(cell_lines_chunk_size, cell.end - i), ptd, dist2);
+				if (! may_be_closer(dist2[ichunk], d_min))
+					continue;
 				const Contour &contour = m_contours[m_cell_data[i].first];
 				assert(contour.closed());
 				size_t ipt = m_cell_data[i].second;
 				// End points of the line segment.
-				const Slic3r::Point &p1 = contour.segment_start(ipt);
-				const Slic3r::Point &p2 = contour.segment_end(ipt);
+				const Line          &line = m_lines[m_cell_line_ids[i]];
+				const Slic3r::Point &p1   = line.a;
+				const Slic3r::Point &p2   = line.b;
 				Slic3r::Point v_seg = p2 - p1;
 				Slic3r::Point v_pt  = pt - p1;
 				// dot(p2-p1, pt-p1)
@@ -1409,6 +1479,46 @@ Polygons EdgeGrid::Grid::contours_simplified(coord_t offset, bool fill_holes) co
 	return out;
 }
 
+bool EdgeGrid::Grid::cell_intersects_line(coord_t row, coord_t col, const Slic3r::Point &p1, const Slic3r::Point &p2) const
+{
+	assert(row >= 0 && size_t(row) < m_rows && col >= 0 && size_t(col) < m_cols);
+	const Cell  &cell = m_cells[row * m_cols + col];
+	const double ax   = double(p1.x());
+	const double ay   = double(p1.y());
+	const double vx   = double(p2.x()) - ax;
+	const double vy   = double(p2.y()) - ay;
+	// Orientations of the cell segments' end points against (p1, p2) are evaluated in doubles first,
+	// the exact integer test is only run if both end points may be on the same side.
+	// The 64bit coordinates below 2^52 and their differences are exact in doubles, then the products are only rounded,
+	// therefore the filter keeps a margin relative to the magnitude of the products. The segments of the grid
+	// are inside its bounding box. Larger coordinates are rounded, they are always tested exactly.
+	static constexpr const coord_t max_exact = coord_t(1) << 52;
+	auto exact = [](const Point &pt) { return std::abs(pt.x()) < max_exact && std::abs(pt.y()) < max_exact; };
+	const bool filter = exact(p1) && exact(p2) && exact(m_bbox.min) && exact(m_bbox.max);
+	for (size_t i = cell.begin; i < cell.end; ++ i) {
+		const Line  &l   = m_lines[m_cell_line_ids[i]];
+		if (! filter) {
+			if (Geometry::segments_intersect(l.a, l.b, p1, p2))
+				return true;
+			continue;
+		}
+		const double dx1 = double(l.a.x()) - ax;
+		const double dy1 = double(l.a.y()) - ay;
+		const double dx2 = double(l.b.x()) - ax;
+		const double dy2 = double(l.b.y()) - ay;
+		const double c1  = vx * dy1 - vy * dx1;
+		const double c2  = vx * dy2 - vy * dx2;
+		const double e1  = 1e-12 * (std::abs(vx * dy1) + std::abs(vy * dx1));
+		const double e2  = 1e-12 * (std::abs(vx * dy2) + std::abs(vy * dx2));
+		if ((c1 > e1 && c2 > e2) || (c1 < - e1 && c2 < - e2))
+			// Both end points strictly on the same side of the line (p1, p2).
+			continue;
+		if (Geometry::segments_intersect(l.a, l.b, p1, p2))
+			return true;
+	}
+	return false;
+}
+
 std::vector<std::pair<EdgeGrid::Grid::ContourEdge, EdgeGrid::Grid::ContourEdge>> EdgeGrid::Grid::intersecting_edges() const
 {
 	std::vector<std::pair<ContourEdge, ContourEdge>> out;
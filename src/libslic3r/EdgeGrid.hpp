@@ -5,6 +5,7 @@
 #include <math.h>
 
 #include "Point.hpp"
+#include "Line.hpp"
 #include "BoundingBox.hpp"
 #include "ExPolygon.hpp"
 
@@ -341,6 +342,17 @@ public:
 		return std::make_pair(m_cell_data.begin() + cell.begin, m_cell_data.begin() + cell.end);
 	}
 
+	// Line segment referenced by an item of cell_data_range(). The segments are read from the flat m_lines
+	// instead of chasing pointers through m_contours.
+	const Line& cell_line(std::vector<std::pair<size_t, size_t>>::const_iterator it_cell_data) const
+	{
+		assert(it_cell_data >= m_cell_data.begin() && it_cell_data < m_cell_data.end());
+		return m_lines[m_cell_line_ids[it_cell_data - m_cell_data.begin()]];
+	}
+
+	// Does the line segment (p1, p2) intersect any edge crossing the cell (row, col)?
+	bool cell_intersects_line(coord_t row, coord_t col, const Slic3r::Point &p1, const Slic3r::Point &p2) const;
+
 	std::pair<const Slic3r::Point&, const Slic3r::Point&> segment(const std::pair<size_t, size_t> &contour_and_segment_idx) const
 	{
 		const Contour &contour = m_contours[contour_and_segment_idx.first];
@@ -356,10 +368,12 @@ public:
 	}
 
 protected:
+	// Range of a cell in m_cell_data and m_cell_line_ids. 32bit indices keep the full grid compact,
+	// a single layer never references more than 4G edge / cell pairs.
 	struct Cell {
 		Cell() : begin(0), end(0) {}
-		size_t begin;
-		size_t end;
+		uint32_t begin;
+		uint32_t end;
 	};
 
 	void create_from_m_contours(coord_t resolution);
@@ -393,6 +407,11 @@ protected:
 
 	// Referencing a contour and a line segment of m_contours.
 	std::vector<std::pair<size_t, size_t> >		m_cell_data;
+	// Line segments of m_contours, each stored once, in the order of the contours and of their segments.
+	std::vector<Line>							m_lines;
+	// Index into m_lines of each item of m_cell_data, in the same order. A segment crossing several cells is referenced by each of them,
+	// thus the segments are not copied per cell: 4 bytes per cell entry instead of sizeof(Line) = 32 bytes.
+	std::vector<uint32_t>						m_cell_line_ids;
 
 	// Full grid of cells.
 	std::vector<Cell> 							m_cells;
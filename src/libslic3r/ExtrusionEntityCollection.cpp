@@ -92,7 +92,8 @@ ExtrusionEntityCollection ExtrusionEntityCollection::chained_path_from(const Ext
 	// Clone the extrusion entities.
 	for (auto &ptr : out.entities)
 		ptr = ptr->clone();
-	chain_and_reorder_extrusion_entities(out.entities, &start_near);
+	// Large collections (dense support) are chained in parallel.
+	chain_and_reorder_extrusion_entities_parallel(out.entities, &start_near);
     return out;
 }
 
@@ -1,7 +1,10 @@
 #include <assert.h>
 #include <stdio.h>
+#include <chrono>
 #include <memory>
 
+#include <boost/log/trivial.hpp>
+
 #include "../ClipperUtils.hpp"
 #include "../Geometry.hpp"
 #include "../Layer.hpp"
@@ -732,6 +735,8 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
 	for (LayerRegion *layerm : m_regions)
 		layerm->fills.clear();
 
+	auto   t_start     = std::chrono::steady_clock::now();
+	size_t num_batched = 0;
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
 //	this->export_region_fill_surfaces_to_svg_debug("10_fill-initial");
@@ -801,16 +806,22 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
 		params.config = &layerm->region().config();
 		if (surface_fill.params.pattern == ipGrid)
 			params.can_reverse = false;
+		if(surface_fill.params.bridge && surface_fill.surface.is_external() && surface_fill.params.density > 99.0){
+			params.density = layerm->region().config().bridge_density.get_abs_value(1.0);
+			params.dont_adjust = true;
+		}
+		if (f->supports_batched_clipping() && surface_fill.expolygons.size() > 1) {
+			// Clip the pattern against all the islands sharing the pattern and its parameters in a single pass.
+			f->spacing = surface_fill.params.spacing;
+			f->prepare_batched_clipping(surface_fill.surface, surface_fill.expolygons, params);
+			num_batched += f->num_batched_clipping();
+		}
 		for (ExPolygon& expoly : surface_fill.expolygons) {
             f->no_overlap_expolygons = intersection_ex(surface_fill.no_overlap_expolygons, ExPolygons() = {expoly}, ApplySafetyOffset::Yes);
 			// Spacing is modified by the filler to indicate adjustments. Reset it for each expolygon.
 			f->spacing = surface_fill.params.spacing;
 			surface_fill.surface.expolygon = std::move(expoly);
 
-			if(surface_fill.params.bridge && surface_fill.surface.is_external() && surface_fill.params.density > 99.0){
-				params.density = layerm->region().config().bridge_density.get_abs_value(1.0);
-				params.dont_adjust = true;
-			}
 			// BBS: make fill
 			f->fill_surface_extrusion(&surface_fill.surface,
 				params,
@@ -834,6 +845,10 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
 	    for (size_t i = 0; i < layerm->fills.entities.size(); ++ i)
     	    assert(dynamic_cast<ExtrusionEntityCollection*>(layerm->fills.entities[i]) != nullptr);
 #endif
+
+	BOOST_LOG_TRIVIAL(trace) << "Layer " << this->id() << " make_fills: " << surface_fills.size() << " surface groups, "
+		<< num_batched << " islands clipped in batches, "
+		<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_start).count() << " ms";
 }
 
 Polylines Layer::generate_sparse_infill_polylines_for_anchoring(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive::Octree* support_fill_octree,  FillLightning::Generator* lightning_generator) const
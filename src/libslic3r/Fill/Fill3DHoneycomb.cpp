@@ -3,6 +3,7 @@
 #include "../Surface.hpp"
 
 #include "Fill3DHoneycomb.hpp"
+#include "FillPatternCache.hpp"
 
 namespace Slic3r {
 
@@ -187,18 +188,18 @@ static Polylines makeGrid(coordf_t z, coordf_t gridSize, coordf_t boundWidth, co
 // monotonic         [fill strictly left to right]
 // complete          [complete each loop]
 
-void Fill3DHoneycomb::_fill_surface_single(
-    const FillParams                &params,
-    unsigned int                     thickness_layers,
-    const std::pair<float, Point>   &direction,
-    ExPolygon                        expolygon,
-    Polylines                       &polylines_out)
+void Fill3DHoneycomb::_to_pattern_coordinates(const FillParams & /* params */, const std::pair<float, Point> & /* direction */, ExPolygon &expolygon)
 {
     // no rotation is supported for this infill pattern
     // Support infill angle 
     auto infill_angle   = float(this->angle);
     if (std::abs(infill_angle) >= EPSILON) expolygon.rotate(-infill_angle);
-    BoundingBox bb = expolygon.contour.bounding_box();
+}
+
+std::pair<FillPatternCache::Tile, Point> Fill3DHoneycomb::_pattern_tile(
+    const FillParams &params, unsigned int thickness_layers, const std::pair<float, Point> & /* direction */, const BoundingBox &bbox)
+{
+    BoundingBox bb = bbox;
 
     // Note: with equally-scaled X/Y/Z, the pattern will create a vertically-stretched
     // truncated octahedron; so Z is pre-adjusted first by scaling by sqrt(2)
@@ -252,22 +253,37 @@ void Fill3DHoneycomb::_fill_surface_single(
     // growing while the other $gridSize half-module is shrinking)
     bb.merge(align_to_grid(bb.min, Point(gridSize*4, gridSize*4)));
 
-    // generate pattern
-    Polylines polylines =
-      makeGrid(
-	       scale_(this->z) * zScale,
-	       gridSize,
-	       bb.size()(0),
-	       bb.size()(1),
-	       !params.dont_adjust);
+    // generate pattern as a shared tile, the curves repeat with z modulo (gridSize * 2)
+    FillPatternCache::Key key;
+    key.pattern   = ip3DHoneycomb;
+    key.params    = { gridSize, double(params.dont_adjust), 0., 0. };
+    key.z_phase   = FillPatternCache::z_phase(scale_(this->z) * zScale, gridSize * 2.);
+    key.modules_x = FillPatternCache::round_up_modules(bb.size()(0) / (gridSize * 4.));
+    key.modules_y = FillPatternCache::round_up_modules(bb.size()(1) / (gridSize * 4.));
+    FillPatternCache::Tile tile = FillPatternCache::get(key, [&key]() {
+      return makeGrid(
+	       double(key.z_phase),
+	       key.params[0],
+	       key.modules_x * key.params[0] * 4.,
+	       key.modules_y * key.params[0] * 4.,
+	       key.params[1] == 0.);
+    });
+    // the tile is placed at the grid origin
+    return { std::move(tile), bb.min };
+}
 
-    // move pattern in place
-    for (Polyline &pl : polylines){
-      pl.translate(bb.min);
-    }
+void Fill3DHoneycomb::_fill_surface_single(
+    const FillParams                &params,
+    unsigned int                     thickness_layers,
+    const std::pair<float, Point>   &direction,
+    ExPolygon                        expolygon,
+    Polylines                       &polylines_out)
+{
+    auto infill_angle   = float(this->angle);
+    this->_to_pattern_coordinates(params, direction, expolygon);
 
-    // clip pattern to boundaries, chain the clipped polylines
-    polylines = intersection_pl(polylines, to_polygons(expolygon));
+    // clip the pattern to boundaries
+    Polylines polylines = this->_clip_pattern(params, thickness_layers, direction, expolygon);
 
     // copy from fliplines
     if (!polylines.empty()) {
@@ -16,9 +16,8 @@
 #include <algorithm>
 #include <numeric>
 
-// Boost pool: Don't use mutexes to synchronize memory allocation.
-#define BOOST_POOL_NO_MT
-#include <boost/pool/object_pool.hpp>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
 
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point.hpp>
@@ -237,14 +236,25 @@ static constexpr std::array<std::array<int, 8>, 3> child_traversal_order {
 
 struct Cube
 {
-    Vec3d center;
+    Vec3d    center;
 #ifndef NDEBUG
-    Vec3d center_octree;
+    Vec3d    center_octree;
 #endif // NDEBUG
-    std::array<Cube*, 8> children {}; // initialized to nullptrs
-    Cube(const Vec3d &center) : center(center) {}
+    // Children are stored consecutively in the order of child_centers, starting at first_child.
+    uint32_t first_child { 0 };
+    // Bit i is set if the child i exists.
+    uint8_t  child_mask  { 0 };
 };
 
+// Number of children stored in front of child idx.
+static inline uint32_t child_rank(uint8_t child_mask, int idx)
+{
+    uint32_t v = child_mask & ((1u << idx) - 1u);
+    v = v - ((v >> 1) & 0x55u);
+    v = (v & 0x33u) + ((v >> 2) & 0x33u);
+    return (v + (v >> 4)) & 0x0Fu;
+}
+
 struct CubeProperties
 {
     double edge_length;     // Lenght of edge of a cube
@@ -256,17 +266,18 @@ struct CubeProperties
 
 struct Octree
 {
-    // Octree will allocate its Cubes from the pool. The pool only supports deletion of the complete pool,
-    // perfect for building up our octree.
-    boost::object_pool<Cube>    pool;
-    Cube*                       root_cube { nullptr };
+    // Cubes in breadth first order, the root cube first. Siblings are stored next to each other,
+    // therefore the layer queries walk the memory mostly forward.
+    std::vector<Cube>           cubes;
     Vec3d                       origin;
     std::vector<CubeProperties> cubes_properties;
 
     Octree(const Vec3d &origin, const std::vector<CubeProperties> &cubes_properties)
-        : root_cube(pool.construct(origin)), origin(origin), cubes_properties(cubes_properties) {}
+        : origin(origin), cubes_properties(cubes_properties) { cubes.push_back({ origin }); }
 
-    void insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth);
+    const Cube* root_cube() const { return &cubes.front(); }
+    const Cube* child(const Cube &cube, int idx) const
+        { return (cube.child_mask & (1 << idx)) ? &cubes[cube.first_child + child_rank(cube.child_mask, idx)] : nullptr; }
 };
 
 void OctreeDeleter::operator()(Octree *p) {
@@ -368,6 +379,7 @@ struct FillContext
     };
 
     FillContext(const Octree &octree, double z_position, int direction_idx) :
+        octree(octree),
         cubes_properties(octree.cubes_properties),
         z_position(z_position),
         traversal_order(child_traversal_order[direction_idx]),
@@ -381,6 +393,7 @@ struct FillContext
     // Rotate the point, uses the same convention as Point::rotate().
     Vec2d rotate(const Vec2d& v) { return Vec2d(this->cos_a * v.x() - this->sin_a * v.y(), this->sin_a * v.x() + this->cos_a * v.y()); }
 
+    const Octree                       &octree;
     const std::vector<CubeProperties>  &cubes_properties;
     // Top of the current layer.
     const double                        z_position;
@@ -424,7 +437,7 @@ static bool verify_traversal_order(
     for (int i = 0; i < 8; ++i) {
         int j = context.traversal_order[i];
         Vec3d cntr = to_world * (cube->center_octree + (child_centers[j] * (context.cubes_properties[depth].edge_length / 4.)));
-        assert(!cube->children[j] || cube->children[j]->center.isApprox(cntr));
+        assert(!context.octree.child(*cube, j) || context.octree.child(*cube, j)->center.isApprox(cntr));
         c[i] = cntr;
     }
     std::array<Vec3d, 10> dirs = {
@@ -495,7 +508,7 @@ static void generate_infill_lines_recursive(
     -- depth;
     size_t i = 0;
     for (const int child_idx : context.traversal_order) {
-        const Cube *child = cube->children[child_idx];
+        const Cube *child = context.octree.child(*cube, child_idx);
         if (child != nullptr)
             generate_infill_lines_recursive(context, child, address, depth);
         if (++ i == 4)
@@ -1337,7 +1350,7 @@ void Filler::_fill_surface_single(
         // Generate the infill lines along the octree cells, merge touching lines of the same direction.
         size_t num_lines = 0;
         for (auto &context : contexts) {
-            generate_infill_lines_recursive(context, adapt_fill_octree->root_cube, 0, int(adapt_fill_octree->cubes_properties.size()) - 1);
+            generate_infill_lines_recursive(context, adapt_fill_octree->root_cube(), 0, int(adapt_fill_octree->cubes_properties.size()) - 1);
             num_lines += context.output_lines.size() + context.temp_lines.size();
         }
 
@@ -1451,15 +1464,108 @@ static inline bool is_overhang_triangle(const Vec3d &a, const Vec3d &b, const Ve
     return n.dot(up) > 0.707 * n.norm();
 }
 
-static void transform_center(Cube *current_cube, const Eigen::Matrix3d &rot)
+// Geometry of the child idx of a cube. The bounding box is slightly expanded to cope with triangles touching
+// a cube wall and other numeric errors. We will rather densify the octree a bit more than necessary instead of missing a triangle.
+static inline std::pair<Vec3d, BoundingBoxf3> child_cube(const Vec3d &center, const BoundingBoxf3 &current_bbox, int idx, double child_edge_length)
 {
-#ifndef NDEBUG
-    current_cube->center_octree = current_cube->center;
-#endif // NDEBUG
-    current_cube->center = rot * current_cube->center;
-    for (auto *child : current_cube->children)
-        if (child)
-            transform_center(child, rot);
+    const Vec3d &child_center_dir = child_centers[idx];
+    BoundingBoxf3 bbox;
+    for (int k = 0; k < 3; ++ k) {
+        if (child_center_dir[k] == -1.) {
+            bbox.min[k] = current_bbox.min[k];
+            bbox.max[k] = center[k] + EPSILON;
+        } else {
+            bbox.min[k] = center[k] - EPSILON;
+            bbox.max[k] = current_bbox.max[k];
+        }
+    }
+    return { center + (child_center_dir * (child_edge_length / 2.)), bbox };
+}
+
+// Call fn(child_idx, child_center, child_bbox) for all children of a cube intersected by a triangle.
+// The center is passed by value, fn may reallocate the storage it was taken from.
+template<typename Fn>
+static inline void for_each_intersected_child(
+    const Vec3d &a, const Vec3d &b, const Vec3d &c, const Vec3d center, const BoundingBoxf3 &current_bbox, double child_edge_length, Fn &&fn)
+{
+    // Squared radius of a sphere around the child cube.
+    // const double r2_cube = Slic3r::sqr(0.5 * this->cubes_properties[depth].height + EPSILON);
+    for (int i = 0; i < 8; ++ i) {
+        auto [child_center, bbox] = child_cube(center, current_bbox, i, child_edge_length);
+        //if (dist2_to_triangle(a, b, c, child_center) < r2_cube) {
+        // dist2_to_triangle and r2_cube are commented out too.
+        if (triangle_AABB_intersects(a, b, c, bbox))
+            fn(i, child_center, bbox);
+    }
+}
+
+// Subtree of the octree under construction. Children are indices into nodes, zero if the child does not exist
+// as the root of the subtree is never a child.
+struct OctreeBuilder
+{
+    struct Node
+    {
+        Vec3d                   center;
+        std::array<uint32_t, 8> children {};
+    };
+
+    OctreeBuilder(const std::vector<CubeProperties> &cubes_properties, const Vec3d &root_center) :
+        cubes_properties(cubes_properties) { nodes.push_back({ root_center }); }
+
+    void insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, uint32_t node_idx, const BoundingBoxf3 &current_bbox, int depth)
+    {
+        assert(depth > 0);
+        -- depth;
+        for_each_intersected_child(a, b, c, nodes[node_idx].center, current_bbox, cubes_properties[depth].edge_length,
+            [this, &a, &b, &c, node_idx, depth](int i, const Vec3d &child_center, const BoundingBoxf3 &child_bbox) {
+                uint32_t child_idx = this->nodes[node_idx].children[i];
+                if (child_idx == 0) {
+                    child_idx = uint32_t(this->nodes.size());
+                    this->nodes.push_back({ child_center });
+                    this->nodes[node_idx].children[i] = child_idx;
+                }
+                if (depth > 0)
+                    this->insert_triangle(a, b, c, child_idx, child_bbox, depth);
+            });
+    }
+
+    const std::vector<CubeProperties>  &cubes_properties;
+    std::vector<Node>                   nodes;
+};
+
+// Number of the top levels of the octree, which are subdivided before the subtrees below them are built in parallel.
+// At most 8^2 subtrees.
+static constexpr const int octree_top_levels = 2;
+
+// Index of the first cube of a top level (1 to octree_top_levels - 1) in the flags of cubes reached by triangles.
+// Cubes of the top levels are addressed by the path of child indices from the root, three bits per level.
+static inline uint32_t top_level_offset(int level)
+{
+    uint32_t offset = 0;
+    for (int l = 1; l < level; ++ l)
+        offset += 1u << (3 * l);
+    return offset;
+}
+
+// Insert a triangle into the top levels. Marks the reached cubes above the last top level,
+// returns the paths of the reached cubes of the last top level.
+static void insert_triangle_top_levels(
+    const Vec3d &a, const Vec3d &b, const Vec3d &c, const Vec3d &center, const BoundingBoxf3 &current_bbox, int depth, int level, uint32_t path,
+    const std::vector<CubeProperties> &cubes_properties, int top_levels, std::vector<uint8_t> &reached, std::vector<uint32_t> &frontier)
+{
+    assert(depth > 0);
+    -- depth;
+    ++ level;
+    for_each_intersected_child(a, b, c, center, current_bbox, cubes_properties[depth].edge_length,
+        [&](int i, const Vec3d &child_center, const BoundingBoxf3 &child_bbox) {
+            const uint32_t child_path = (path << 3) + uint32_t(i);
+            if (level == top_levels)
+                frontier.emplace_back(child_path);
+            else {
+                reached[top_level_offset(level) + child_path] = 1;
+                insert_triangle_top_levels(a, b, c, child_center, child_bbox, depth, level, child_path, cubes_properties, top_levels, reached, frontier);
+            }
+        });
 }
 
 OctreePtr build_octree(
@@ -1469,7 +1575,8 @@ OctreePtr build_octree(
     // rotated to the coordinate system of the octree.
     const std::vector<Vec3d>    &overhang_triangles, 
     coordf_t                     line_spacing,
-    bool                         support_overhangs_only)
+    bool                         support_overhangs_only,
+    bool                         parallel)
 {
     assert(line_spacing > 0);
     assert(! std::isnan(line_spacing));
@@ -1480,31 +1587,158 @@ OctreePtr build_octree(
     auto                        octree           = OctreePtr(new Octree(cube_center, cubes_properties));
 
     if (cubes_properties.size() > 1) {
-        Octree *octree_ptr = octree.get();
         double edge_length_half = 0.5 * cubes_properties.back().edge_length;
         Vec3d  diag_half(edge_length_half, edge_length_half, edge_length_half);
-        int    max_depth = int(cubes_properties.size()) - 1;
-        auto process_triangle = [octree_ptr, max_depth, diag_half](const Vec3d &a, const Vec3d &b, const Vec3d &c) {
-            octree_ptr->insert_triangle(
-                a, b, c,
-                octree_ptr->root_cube,
-                BoundingBoxf3(octree_ptr->root_cube->center - diag_half, octree_ptr->root_cube->center + diag_half),
-                max_depth);
+        int    max_depth  = int(cubes_properties.size()) - 1;
+        // Without the top levels, the whole octree is a single subtree built sequentially.
+        int    top_levels = parallel ? std::min(max_depth, octree_top_levels) : 0;
+        auto   up_vector  = support_overhangs_only ? Vec3d(transform_to_octree() * Vec3d(0., 0., 1.)) : Vec3d();
+
+        // Triangles of the mesh followed by the overhang triangles.
+        const size_t num_mesh_triangles = triangle_mesh.indices.size();
+        const size_t num_triangles      = num_mesh_triangles + overhang_triangles.size() / 3;
+        auto triangle = [&triangle_mesh, &overhang_triangles, num_mesh_triangles](size_t idx) -> std::array<Vec3d, 3> {
+            if (idx < num_mesh_triangles) {
+                const stl_triangle_vertex_indices &tri = triangle_mesh.indices[idx];
+                return { triangle_mesh.vertices[tri[0]].cast<double>(), triangle_mesh.vertices[tri[1]].cast<double>(), triangle_mesh.vertices[tri[2]].cast<double>() };
+            }
+            idx = 3 * (idx - num_mesh_triangles);
+            return { overhang_triangles[idx], overhang_triangles[idx + 1], overhang_triangles[idx + 2] };
+        };
+        // Center and bounding box of a cube of the top levels.
+        auto top_cube = [&cubes_properties, &cube_center, &diag_half, max_depth](int level, uint32_t path) {
+            std::pair<Vec3d, BoundingBoxf3> cube { cube_center, BoundingBoxf3(cube_center - diag_half, cube_center + diag_half) };
+            for (int l = level - 1, depth = max_depth - 1; l >= 0; -- l, -- depth)
+                cube = child_cube(cube.first, cube.second, int((path >> (3 * l)) & 7), cubes_properties[depth].edge_length);
+            return cube;
         };
-        auto up_vector = support_overhangs_only ? Vec3d(transform_to_octree() * Vec3d(0., 0., 1.)) : Vec3d();
-        for (auto &tri : triangle_mesh.indices) {
-            auto a = triangle_mesh.vertices[tri[0]].cast<double>();
-            auto b = triangle_mesh.vertices[tri[1]].cast<double>();
-            auto c = triangle_mesh.vertices[tri[2]].cast<double>();
-            if (! support_overhangs_only || is_overhang_triangle(a, b, c, up_vector))
-                process_triangle(a, b, c);
+
+        std::vector<uint8_t>       reached(top_level_offset(top_levels), 0);
+        std::vector<OctreeBuilder> subtrees;
+        std::vector<int>           frontier_subtree;
+        if (top_levels == 0) {
+            // Reference build: insert the triangles one by one from the root.
+            OctreeBuilder &root = subtrees.emplace_back(cubes_properties, cube_center);
+            for (size_t triangle_idx = 0; triangle_idx < num_triangles; ++ triangle_idx) {
+                auto [a, b, c] = triangle(triangle_idx);
+                if (support_overhangs_only && triangle_idx < num_mesh_triangles && ! is_overhang_triangle(a, b, c, up_vector))
+                    continue;
+                root.insert_triangle(a, b, c, 0, BoundingBoxf3(cube_center - diag_half, cube_center + diag_half), max_depth);
+            }
+        } else {
+            // 1) Sort the triangles into the cubes of the last top level.
+            struct TopLevels {
+                std::vector<uint8_t>                         reached;
+                // Pairs of (path of a cube of the last top level, triangle index).
+                std::vector<std::pair<uint32_t, uint32_t>>   frontier;
+            };
+            const size_t num_frontier = size_t(1) << (3 * top_levels);
+            tbb::enumerable_thread_specific<TopLevels> top_levels_thread([top_levels]() { return TopLevels{ std::vector<uint8_t>(top_level_offset(top_levels), 0), {} }; });
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, num_triangles), [&](const tbb::blocked_range<size_t> &range) {
+                TopLevels            &tls = top_levels_thread.local();
+                std::vector<uint32_t> frontier;
+                for (size_t triangle_idx = range.begin(); triangle_idx < range.end(); ++ triangle_idx) {
+                    auto [a, b, c] = triangle(triangle_idx);
+                    if (support_overhangs_only && triangle_idx < num_mesh_triangles && ! is_overhang_triangle(a, b, c, up_vector))
+                        continue;
+                    frontier.clear();
+                    insert_triangle_top_levels(a, b, c, cube_center, BoundingBoxf3(cube_center - diag_half, cube_center + diag_half),
+                        max_depth, 0, 0, cubes_properties, top_levels, tls.reached, frontier);
+                    for (uint32_t path : frontier)
+                        tls.frontier.emplace_back(path, uint32_t(triangle_idx));
+                }
+            });
+            std::vector<std::vector<uint32_t>> frontier_triangles(num_frontier);
+            for (const TopLevels &tls : top_levels_thread) {
+                for (size_t i = 0; i < reached.size(); ++ i)
+                    reached[i] |= tls.reached[i];
+                for (const std::pair<uint32_t, uint32_t> &path_triangle : tls.frontier)
+                    frontier_triangles[path_triangle.first].emplace_back(path_triangle.second);
+            }
+
+            // 2) Build the subtrees below the cubes of the last top level in parallel.
+            frontier_subtree.assign(num_frontier, -1);
+            for (uint32_t path = 0; path < num_frontier; ++ path)
+                if (! frontier_triangles[path].empty()) {
+                    frontier_subtree[path] = int(subtrees.size());
+                    subtrees.emplace_back(cubes_properties, top_cube(top_levels, path).first);
+                }
+            if (max_depth > top_levels)
+                tbb::parallel_for(tbb::blocked_range<size_t>(0, num_frontier, 1), [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t path = range.begin(); path < range.end(); ++ path)
+                        if (frontier_subtree[path] != -1) {
+                            OctreeBuilder &subtree = subtrees[frontier_subtree[path]];
+                            const BoundingBoxf3 subtree_bbox = top_cube(top_levels, uint32_t(path)).second;
+                            for (uint32_t triangle_idx : frontier_triangles[path]) {
+                                auto [a, b, c] = triangle(triangle_idx);
+                                subtree.insert_triangle(a, b, c, 0, subtree_bbox, max_depth - top_levels);
+                            }
+                        }
+                });
+        }
+
+        // 3) Merge the top levels and the subtrees into a single breadth first array of cubes.
+        {
+            // Cube of the top levels addressed by its level and path, or a cube of a subtree.
+            struct CubeRef {
+                int                  level;
+                uint32_t             path;
+                const OctreeBuilder *subtree;
+                uint32_t             idx;
+            };
+            // The root is a cube of the top levels, or the root of the only subtree.
+            size_t num_cubes = (top_levels == 0 ? 0 : 1) + std::count(reached.begin(), reached.end(), uint8_t(1));
+            for (const OctreeBuilder &subtree : subtrees)
+                num_cubes += subtree.nodes.size();
+            std::vector<CubeRef> queue;
+            queue.reserve(num_cubes);
+            queue.push_back({ 0, 0, top_levels == 0 ? &subtrees.front() : nullptr, 0 });
+            octree->cubes.clear();
+            octree->cubes.reserve(num_cubes);
+            for (size_t i = 0; i < queue.size(); ++ i) {
+                const CubeRef ref = queue[i];
+                Cube          cube;
+                cube.first_child = uint32_t(queue.size());
+                if (ref.subtree) {
+                    const OctreeBuilder::Node &node = ref.subtree->nodes[ref.idx];
+                    cube.center = node.center;
+                    for (int k = 0; k < 8; ++ k)
+                        if (node.children[k]) {
+                            cube.child_mask |= uint8_t(1 << k);
+                            queue.push_back({ 0, 0, ref.subtree, node.children[k] });
+                        }
+                } else {
+                    cube.center = top_cube(ref.level, ref.path).first;
+                    for (int k = 0; k < 8; ++ k) {
+                        const uint32_t child_path = (ref.path << 3) + uint32_t(k);
+                        if (ref.level + 1 < top_levels) {
+                            if (reached[top_level_offset(ref.level + 1) + child_path]) {
+                                cube.child_mask |= uint8_t(1 << k);
+                                queue.push_back({ ref.level + 1, child_path, nullptr, 0 });
+                            }
+                        } else if (int subtree_idx = frontier_subtree[child_path]; subtree_idx != -1) {
+                            cube.child_mask |= uint8_t(1 << k);
+                            queue.push_back({ 0, 0, &subtrees[subtree_idx], 0 });
+                        }
+                    }
+                }
+                octree->cubes.push_back(cube);
+            }
+            assert(octree->cubes.size() == num_cubes);
         }
-        for (size_t i = 0; i < overhang_triangles.size(); i += 3)
-            process_triangle(overhang_triangles[i], overhang_triangles[i + 1], overhang_triangles[i + 2]);
+
         {
             // Transform the octree to world coordinates to reduce computation when extracting infill lines.
             auto rot = transform_to_world().toRotationMatrix();
-            transform_center(octree->root_cube, rot);
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, octree->cubes.size()), [&octree, &rot](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
+                    Cube &cube = octree->cubes[i];
+#ifndef NDEBUG
+                    cube.center_octree = cube.center;
+#endif // NDEBUG
+                    cube.center = rot * cube.center;
+                }
+            });
             octree->origin = rot * octree->origin;
         }
     }
@@ -1512,40 +1746,20 @@ OctreePtr build_octree(
     return octree;
 }
 
-void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth)
+std::vector<size_t> octree_cubes_per_depth(const Octree &octree)
 {
-    assert(current_cube);
-    assert(depth > 0);
-
-    --depth;
-
-    // Squared radius of a sphere around the child cube.
-    // const double r2_cube = Slic3r::sqr(0.5 * this->cubes_properties[depth].height + EPSILON);
-
-    for (size_t i = 0; i < 8; ++ i) {
-        const Vec3d &child_center_dir = child_centers[i];
-        // Calculate a slightly expanded bounding box of a child cube to cope with triangles touching a cube wall and other numeric errors.
-        // We will rather densify the octree a bit more than necessary instead of missing a triangle.
-        BoundingBoxf3 bbox;
-        for (int k = 0; k < 3; ++ k) {
-            if (child_center_dir[k] == -1.) {
-                bbox.min[k] = current_bbox.min[k];
-                bbox.max[k] = current_cube->center[k] + EPSILON;
-            } else {
-                bbox.min[k] = current_cube->center[k] - EPSILON;
-                bbox.max[k] = current_bbox.max[k];
-            }
-        }
-        Vec3d child_center = current_cube->center + (child_center_dir * (this->cubes_properties[depth].edge_length / 2.));
-        //if (dist2_to_triangle(a, b, c, child_center) < r2_cube) {
-        // dist2_to_triangle and r2_cube are commented out too.
-        if (triangle_AABB_intersects(a, b, c, bbox)) {
-            if (! current_cube->children[i])
-                current_cube->children[i] = this->pool.construct(child_center);
-            if (depth > 0)
-                this->insert_triangle(a, b, c, current_cube->children[i], bbox, depth);
-        }
+    std::vector<size_t> out;
+    // Breadth first array: The cubes of a depth follow the cubes of the depth above.
+    for (size_t begin = 0, end = octree.cubes.empty() ? 0 : 1; begin < end;) {
+        out.emplace_back(end - begin);
+        size_t next_end = end;
+        for (size_t i = begin; i < end; ++ i)
+            if (const Cube &cube = octree.cubes[i]; cube.child_mask)
+                next_end = std::max(next_end, size_t(cube.first_child) + size_t(child_rank(cube.child_mask, 8)));
+        begin = end;
+        end   = next_end;
     }
+    return out;
 }
 
 } // namespace FillAdaptive
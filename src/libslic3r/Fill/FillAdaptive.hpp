@@ -46,7 +46,13 @@ FillAdaptive::OctreePtr         build_octree(
     const std::vector<Vec3d>    &overhang_triangles, 
     coordf_t                     line_spacing, 
     // If true, octree is densified below internal overhangs only.
-    bool                         support_overhangs_only);
+    bool                         support_overhangs_only,
+    // If false, the triangles are inserted one by one from the root on the calling thread. The octree is the same,
+    // the sequential build serves as a reference of the parallel one.
+    bool                         parallel = true);
+
+// Number of the cubes of the octree at each depth, starting with the root.
+std::vector<size_t>             octree_cubes_per_depth(const Octree &octree);
 
 //
 // Some of the algorithms used by class FillAdaptive were inspired by
@@ -107,6 +107,86 @@ Polylines Fill::fill_surface(const Surface *surface, const FillParams &params)
     return polylines_out;
 }
 
+void Fill::prepare_batched_clipping(const Surface &surface, const ExPolygons &expolygons, const FillParams &params)
+{
+    m_batched_clipping.clear();
+    m_batched_clipping_next = 0;
+
+    const float delta = float(scale_(this->overlap - 0.5 * this->spacing));
+    if (! this->supports_batched_clipping() || expolygons.size() < 2 || delta > 0 || empty(this->bounding_box))
+        // Grown expolygons may overlap and a fill direction without bounding box depends on the expolygon,
+        // such surfaces are clipped one by one.
+        return;
+
+    // Same offset and direction as fill_surface().
+    const std::pair<float, Point> direction = _infill_direction(&surface);
+    ExPolygons pattern_expolygons;
+    pattern_expolygons.reserve(expolygons.size());
+    for (const ExPolygon &expolygon : expolygons)
+        for (ExPolygon &expoly : offset_ex(expolygon, delta)) {
+            this->_to_pattern_coordinates(params, direction, expoly);
+            pattern_expolygons.emplace_back(std::move(expoly));
+        }
+    if (pattern_expolygons.size() < 2)
+        return;
+
+    // Don't generate a pattern tile covering mostly empty space between far away islands.
+    const BoundingBox bbox = get_extents(pattern_expolygons);
+    double area_islands = 0.;
+    for (const ExPolygon &expoly : pattern_expolygons)
+        area_islands += double(get_extents(expoly.contour).size().cast<double>().prod());
+    if (area_islands < 0.25 * bbox.size().cast<double>().prod())
+        return;
+
+    auto [tile, origin] = this->_pattern_tile(params, surface.thickness_layers, direction, bbox);
+    if (! tile)
+        return;
+    Polylines clipped = FillPatternCache::clip_tile(*tile, origin, pattern_expolygons);
+
+    // Distribute the clipped lines to the expolygons they were clipped by. The expolygons are disjoint,
+    // the first segment of a clipped line is inside its expolygon.
+    m_batched_clipping.reserve(pattern_expolygons.size());
+    for (const ExPolygon &expoly : pattern_expolygons)
+        m_batched_clipping.push_back({ get_extents(expoly.contour), expoly.contour.front() });
+    for (Polyline &pl : clipped) {
+        if (pl.size() < 2)
+            continue;
+        const Point probe = (pl.points[0] + pl.points[1]) / 2;
+        size_t      idx   = size_t(-1);
+        for (size_t i = 0; i < pattern_expolygons.size() && idx == size_t(-1); ++ i)
+            if (m_batched_clipping[i].bbox.contains(probe) && pattern_expolygons[i].contains(probe))
+                idx = i;
+        if (idx == size_t(-1)) {
+            // Should not happen. Clip the expolygons one by one.
+            m_batched_clipping.clear();
+            return;
+        }
+        m_batched_clipping[idx].polylines.emplace_back(std::move(pl));
+    }
+}
+
+Polylines Fill::_clip_pattern(const FillParams &params, unsigned int thickness_layers, const std::pair<float, Point> &direction, const ExPolygon &expolygon)
+{
+    const BoundingBox bbox = get_extents(expolygon.contour);
+    if (! m_batched_clipping.empty()) {
+        auto matches = [&bbox, &expolygon](const BatchedClipping &batched) {
+            return ! batched.consumed && batched.bbox.min == bbox.min && batched.bbox.max == bbox.max && batched.first_point == expolygon.contour.front();
+        };
+        size_t idx = m_batched_clipping_next;
+        if (idx >= m_batched_clipping.size() || ! matches(m_batched_clipping[idx]))
+            idx = std::find_if(m_batched_clipping.begin(), m_batched_clipping.end(), matches) - m_batched_clipping.begin();
+        if (idx < m_batched_clipping.size()) {
+            BatchedClipping &batched = m_batched_clipping[idx];
+            batched.consumed = true;
+            m_batched_clipping_next = idx + 1;
+            return std::move(batched.polylines);
+        }
+    }
+    auto [tile, origin] = this->_pattern_tile(params, thickness_layers, direction, bbox);
+    assert(tile);
+    return FillPatternCache::clip_tile(*tile, origin, expolygon);
+}
+
 ThickPolylines Fill::fill_surface_arachne(const Surface* surface, const FillParams& params)
 {
     // Perform offset.
@@ -20,6 +20,7 @@
 #include "../ExtrusionEntity.hpp"
 #include "../ExtrusionEntityCollection.hpp"
 #include "../ShortestPath.hpp"
+#include "FillPatternCache.hpp"
 
 namespace Slic3r {
 
@@ -143,6 +144,17 @@ public:
     // It call fill_surface by default
     virtual void fill_surface_extrusion(const Surface* surface, const FillParams& params, ExtrusionEntitiesPtr& out);
 
+    // Periodic patterns (gyroid, honeycomb, 3D honeycomb, cross hatch) may clip their pattern tile
+    // against all expolygons of a surface group in a single Clipper pass.
+    virtual bool supports_batched_clipping() const { return false; }
+    // Clip the pattern for all the expolygons, which are going to be filled one by one by fill_surface() or
+    // fill_surface_extrusion() with a copy of surface and the same parameters. _fill_surface_single()
+    // picks up the clipped lines of its expolygon, expolygons not prepared here are clipped as usual.
+    void         prepare_batched_clipping(const Surface &surface, const ExPolygons &expolygons, const FillParams &params);
+    void         clear_batched_clipping() { m_batched_clipping.clear(); }
+    // Number of expolygons prepared by the last call to prepare_batched_clipping().
+    size_t       num_batched_clipping() const { return m_batched_clipping.size(); }
+
 protected:
     Fill() :
         layer_id(size_t(-1)),
@@ -177,6 +189,16 @@ protected:
     virtual float _layer_angle(size_t idx) const { return (rotate_angle && (idx & 1)) ? float(M_PI/2.) : 0; }
 
     virtual std::pair<float, Point> _infill_direction(const Surface *surface) const;
+
+    // Batched clipping: Transform an expolygon into the coordinate system of the pattern tile.
+    virtual void _to_pattern_coordinates(const FillParams & /* params */, const std::pair<float, Point> & /* direction */, ExPolygon & /* expolygon */) {}
+    // Batched clipping: Pattern tile covering bbox given in the pattern coordinate system, and the origin to place the tile at.
+    virtual std::pair<FillPatternCache::Tile, Point> _pattern_tile(
+        const FillParams & /* params */, unsigned int /* thickness_layers */, const std::pair<float, Point> & /* direction */, const BoundingBox & /* bbox */)
+        { return {}; }
+    // Pattern clipped by expolygon given in the pattern coordinate system,
+    // either prepared by prepare_batched_clipping() or clipped now.
+    Polylines _clip_pattern(const FillParams &params, unsigned int thickness_layers, const std::pair<float, Point> &direction, const ExPolygon &expolygon);
     
     // Orca: Dedicated function to calculate gap fill lines for the provided surface, according to the print object parameters
     // and append them to the out ExtrusionEntityCollection.
@@ -191,6 +213,19 @@ public:
     static void connect_base_support(Polylines &&infill_ordered, const Polygons &boundary_src, const BoundingBox &bbox, Polylines &polylines_out, const double spacing, const FillParams &params);
 
     static coord_t  _adjust_solid_spacing(const coord_t width, const coord_t distance);
+
+private:
+    struct BatchedClipping
+    {
+        // Identification of the expolygon in the pattern coordinate system.
+        BoundingBox bbox;
+        Point       first_point;
+        Polylines   polylines;
+        bool        consumed { false };
+    };
+    std::vector<BatchedClipping> m_batched_clipping;
+    // The expolygons are usually filled in the order they were prepared.
+    size_t                       m_batched_clipping_next { 0 };
 };
 
 } // namespace Slic3r
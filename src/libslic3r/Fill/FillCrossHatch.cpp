@@ -4,6 +4,7 @@
 #include <cmath>
 
 #include "FillCrossHatch.hpp"
+#include "FillPatternCache.hpp"
 
 namespace Slic3r {
 
@@ -175,15 +176,18 @@ static Polylines generate_infill_layers(coordf_t z_height, double repeat_ratio,
     return result;
 }
 
-void FillCrossHatch ::_fill_surface_single(
-    const FillParams &params, unsigned int thickness_layers, const std::pair<float, Point> &direction, ExPolygon expolygon, Polylines &polylines_out)
+void FillCrossHatch::_to_pattern_coordinates(const FillParams & /* params */, const std::pair<float, Point> & /* direction */, ExPolygon &expolygon)
 {
     // rotate angle
     auto infill_angle = float(this->angle);
     if (std::abs(infill_angle) >= EPSILON) expolygon.rotate(-infill_angle);
+}
 
-    // get the rotated bounding box
-    BoundingBox bb = expolygon.contour.bounding_box();
+std::pair<FillPatternCache::Tile, Point> FillCrossHatch::_pattern_tile(
+    const FillParams &params, unsigned int /* thickness_layers */, const std::pair<float, Point> & /* direction */, const BoundingBox &bbox)
+{
+    // the rotated bounding box
+    BoundingBox bb = bbox;
 
     // linespace modifier
     coord_t line_spacing = coord_t(scale_(this->spacing) / params.density);
@@ -199,12 +203,28 @@ void FillCrossHatch ::_fill_surface_single(
     if (params.density < 0.3)
         repeat_ratio = std::clamp(1.0 - std::exp(-5 * params.density), 0.2, 1.0);
 
-    Polylines polylines = generate_infill_layers(scale_(this->z), repeat_ratio, line_spacing, bb.size()(0), bb.size()(1));
+    // The pattern repeats with z modulo twice the period of a repeat and a transform layer, it is generated as a shared tile.
+    FillPatternCache::Key key;
+    key.pattern   = ipCrossHatch;
+    key.params    = { double(line_spacing), repeat_ratio, 0., 0. };
+    key.z_phase   = FillPatternCache::z_phase(scale_(this->z), 2. * line_spacing * (0.4 + repeat_ratio));
+    key.modules_x = FillPatternCache::round_up_modules(double(bb.size()(0)) / double(line_spacing * 4));
+    key.modules_y = FillPatternCache::round_up_modules(double(bb.size()(1)) / double(line_spacing * 4));
+    FillPatternCache::Tile tile = FillPatternCache::get(key, [&key, line_spacing, repeat_ratio]() {
+        return generate_infill_layers(double(key.z_phase), repeat_ratio, line_spacing, key.modules_x * line_spacing * 4., key.modules_y * line_spacing * 4.);
+    });
+    // the tile is placed at the grid origin
+    return { std::move(tile), bb.min };
+}
 
-    // shift the pattern to the actual space
-    for (Polyline &pl : polylines) { pl.translate(bb.min); }
+void FillCrossHatch ::_fill_surface_single(
+    const FillParams &params, unsigned int thickness_layers, const std::pair<float, Point> &direction, ExPolygon expolygon, Polylines &polylines_out)
+{
+    auto infill_angle = float(this->angle);
+    this->_to_pattern_coordinates(params, direction, expolygon);
 
-    polylines = intersection_pl(polylines, to_polygons(expolygon));
+    // clip the pattern
+    Polylines polylines = this->_clip_pattern(params, thickness_layers, direction, expolygon);
 
     // --- remove small remains from gyroid infill
     if (!polylines.empty()) {
@@ -15,6 +15,8 @@ public:
     Fill *clone() const override { return new FillCrossHatch(*this); };
     ~FillCrossHatch() override {}
 
+    bool supports_batched_clipping() const override { return true; }
+
 protected:
 	void _fill_surface_single(
 	    const FillParams                &params, 
@@ -22,6 +24,9 @@ protected:
 	    const std::pair<float, Point>   &direction, 
 	    ExPolygon                 		 expolygon,
 	    Polylines                       &polylines_out) override;
+    void _to_pattern_coordinates(const FillParams &params, const std::pair<float, Point> &direction, ExPolygon &expolygon) override;
+    std::pair<FillPatternCache::Tile, Point> _pattern_tile(
+        const FillParams &params, unsigned int thickness_layers, const std::pair<float, Point> &direction, const BoundingBox &bbox) override;
 };
 
 } // namespace Slic3r
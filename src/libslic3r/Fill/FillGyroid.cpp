@@ -6,6 +6,7 @@
 #include <iostream>
 
 #include "FillGyroid.hpp"
+#include "FillPatternCache.hpp"
 
 namespace Slic3r {
 
@@ -102,7 +103,7 @@ static std::vector<Vec2d> make_one_period(double width, double scaleFactor, doub
     return points;
 }
 
-static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height)
+Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height)
 {
     const double scaleFactor = scale_(line_spacing) / density_adjusted;
 
@@ -148,18 +149,17 @@ static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double
 // FIXME: needed to fix build on Mac on buildserver
 constexpr double FillGyroid::PatternTolerance;
 
-void FillGyroid::_fill_surface_single(
-    const FillParams                &params, 
-    unsigned int                     thickness_layers,
-    const std::pair<float, Point>   &direction, 
-    ExPolygon                        expolygon, 
-    Polylines                       &polylines_out)
+void FillGyroid::_to_pattern_coordinates(const FillParams & /* params */, const std::pair<float, Point> & /* direction */, ExPolygon &expolygon)
 {
     auto infill_angle = float(this->angle + (CorrectionAngle * 2*M_PI) / 360.);
     if(std::abs(infill_angle) >= EPSILON)
         expolygon.rotate(-infill_angle);
+}
 
-    BoundingBox bb = expolygon.contour.bounding_box();
+std::pair<FillPatternCache::Tile, Point> FillGyroid::_pattern_tile(
+    const FillParams &params, unsigned int /* thickness_layers */, const std::pair<float, Point> & /* direction */, const BoundingBox &bbox)
+{
+    BoundingBox bb = bbox;
     // Density adjusted to have a good %of weight.
     double      density_adjusted = std::max(0., params.density * DensityAdjust);
     // Distance between the gyroid waves in scaled coordinates.
@@ -168,19 +168,39 @@ void FillGyroid::_fill_surface_single(
     // align bounding box to a multiple of our grid module
     bb.merge(align_to_grid(bb.min, Point(2*M_PI*distance, 2*M_PI*distance)));
 
-    // generate pattern
-    Polylines polylines = make_gyroid_waves(
-        scale_(this->z),
-        density_adjusted,
-        this->spacing,
-        ceil(bb.size()(0) / distance) + 1.,
-        ceil(bb.size()(1) / distance) + 1.);
+    // Generate the pattern as a shared tile: The waves only depend on z modulo the pattern period
+    // and on the number of grid modules covered.
+    const double scale_factor = scale_(this->spacing) / density_adjusted;
+    FillPatternCache::Key key;
+    key.pattern   = ipGyroid;
+    key.params    = { density_adjusted, this->spacing, 0., 0. };
+    key.z_phase   = FillPatternCache::z_phase(scale_(this->z), 2. * M_PI * scale_factor);
+    key.modules_x = FillPatternCache::round_up_modules((ceil(bb.size()(0) / distance) + 1.) / (2. * M_PI));
+    key.modules_y = FillPatternCache::round_up_modules((ceil(bb.size()(1) / distance) + 1.) / (2. * M_PI));
+    FillPatternCache::Tile tile = FillPatternCache::get(key, [&key]() {
+        return make_gyroid_waves(
+            double(key.z_phase),
+            key.params[0],
+            key.params[1],
+            ceil(key.modules_x * 2. * M_PI),
+            ceil(key.modules_y * 2. * M_PI));
+    });
+    // the tile is placed at the grid origin
+    return { std::move(tile), bb.min };
+}
 
-	// shift the polyline to the grid origin
-	for (Polyline &pl : polylines)
-		pl.translate(bb.min);
+void FillGyroid::_fill_surface_single(
+    const FillParams                &params, 
+    unsigned int                     thickness_layers,
+    const std::pair<float, Point>   &direction, 
+    ExPolygon                        expolygon, 
+    Polylines                       &polylines_out)
+{
+    auto infill_angle = float(this->angle + (CorrectionAngle * 2*M_PI) / 360.);
+    this->_to_pattern_coordinates(params, direction, expolygon);
 
-	polylines = intersection_pl(polylines, expolygon);
+	// clip the pattern tile
+	Polylines polylines = this->_clip_pattern(params, thickness_layers, direction, expolygon);
 
     if (! polylines.empty()) {
 		// Remove very small bits, but be careful to not remove infill lines connecting thin walls!
@@ -26,8 +26,12 @@ public:
     // Gyroid upper resolution tolerance (mm^-2)
     static constexpr double PatternTolerance = 0.2;
 
+    bool supports_batched_clipping() const override { return true; }
 
 protected:
+    void _to_pattern_coordinates(const FillParams &params, const std::pair<float, Point> &direction, ExPolygon &expolygon) override;
+    std::pair<FillPatternCache::Tile, Point> _pattern_tile(
+        const FillParams &params, unsigned int thickness_layers, const std::pair<float, Point> &direction, const BoundingBox &bbox) override;
     void _fill_surface_single(
         const FillParams                &params, 
         unsigned int                     thickness_layers,
@@ -36,6 +40,9 @@ protected:
         Polylines                       &polylines_out) override;
 };
 
+// Gyroid waves at the scaled height gridZ, covering width x height of the wave distance starting at (0, 0).
+Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height);
+
 } // namespace Slic3r
 
 #endif // slic3r_FillGyroid_hpp_
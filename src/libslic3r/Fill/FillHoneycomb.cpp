@@ -3,15 +3,11 @@
 #include "../Surface.hpp"
 
 #include "FillHoneycomb.hpp"
+#include "FillPatternCache.hpp"
 
 namespace Slic3r {
 
-void FillHoneycomb::_fill_surface_single(
-    const FillParams                &params, 
-    unsigned int                     thickness_layers,
-    const std::pair<float, Point>   &direction, 
-    ExPolygon                        expolygon,
-    Polylines                       &polylines_out)
+const FillHoneycomb::CacheData& FillHoneycomb::cache_data(const FillParams &params)
 {
     // cache hexagons math
     CacheID cache_id(params.density, this->spacing);
@@ -30,33 +26,44 @@ void FillHoneycomb::_fill_surface_single(
         m.y_offset          = coord_t(m.x_offset * sqrt(3)/3);
         m.hex_center        = Point(m.hex_width/2, m.hex_side);
     }
-    CacheData &m = it_m->second;
+    return it_m->second;
+}
 
-    Polylines all_polylines;
-    {
-        // adjust actual bounding box to the nearest multiple of our hex pattern
-        // and align it so that it matches across layers
-        
-        BoundingBox bounding_box = expolygon.contour.bounding_box();
-        {
-            // rotate bounding box according to infill direction
-            Polygon bb_polygon = bounding_box.polygon();
-            bb_polygon.rotate(direction.first, m.hex_center);
-            bounding_box = bb_polygon.bounding_box();
-            
-            // extend bounding box so that our pattern will be aligned with other layers
-            // $bounding_box->[X1] and [Y1] represent the displacement between new bounding box offset and old one
-            // The infill is not aligned to the object bounding box, but to a world coordinate system. Supposedly good enough.
-            bounding_box.merge(align_to_grid(bounding_box.min, Point(m.hex_width, m.pattern_height)));
-        }
+void FillHoneycomb::_to_pattern_coordinates(const FillParams &params, const std::pair<float, Point> &direction, ExPolygon &expolygon)
+{
+    // The hexagons are generated in the coordinate system rotated according to infill direction,
+    // the surface is rotated into the pattern instead of rotating the pattern.
+    expolygon.rotate(direction.first, this->cache_data(params).hex_center);
+}
+
+std::pair<FillPatternCache::Tile, Point> FillHoneycomb::_pattern_tile(
+    const FillParams &params, unsigned int /* thickness_layers */, const std::pair<float, Point> & /* direction */, const BoundingBox &bbox)
+{
+    const CacheData &m = this->cache_data(params);
 
-        coord_t x = bounding_box.min(0);
-        while (x <= bounding_box.max(0)) {
+    // adjust actual bounding box to the nearest multiple of our hex pattern
+    // and align it so that it matches across layers
+    // The infill is not aligned to the object bounding box, but to a world coordinate system. Supposedly good enough.
+    BoundingBox bounding_box = bbox;
+    bounding_box.merge(align_to_grid(bounding_box.min, Point(m.hex_width, m.pattern_height)));
+
+    // The hexagons are generated as a shared tile starting at the aligned bounding box corner.
+    FillPatternCache::Key key;
+    key.pattern   = ipHoneycomb;
+    key.params    = { params.density, this->spacing, 0., 0. };
+    key.modules_x = FillPatternCache::round_up_modules(double(bounding_box.size()(0)) / double(m.hex_width));
+    key.modules_y = FillPatternCache::round_up_modules(double(bounding_box.size()(1)) / double(m.pattern_height));
+    FillPatternCache::Tile tile = FillPatternCache::get(key, [&key, &m]() {
+        Polylines polylines;
+        const coord_t width  = key.modules_x * m.hex_width;
+        const coord_t height = key.modules_y * m.pattern_height;
+        coord_t x = 0;
+        while (x <= width) {
             Polyline p;
             coord_t ax[2] = { x + m.x_offset, x + m.distance - m.x_offset };
             for (size_t i = 0; i < 2; ++ i) {
                 std::reverse(p.points.begin(), p.points.end()); // turn first half upside down
-                for (coord_t y = bounding_box.min(1); y <= bounding_box.max(1); y += m.y_short + m.hex_side + m.y_short + m.hex_side) {
+                for (coord_t y = 0; y <= height; y += m.y_short + m.hex_side + m.y_short + m.hex_side) {
                     p.points.push_back(Point(ax[1], y + m.y_offset));
                     p.points.push_back(Point(ax[0], y + m.y_short - m.y_offset));
                     p.points.push_back(Point(ax[0], y + m.y_short + m.hex_side + m.y_offset));
@@ -68,12 +75,27 @@ void FillHoneycomb::_fill_surface_single(
                 std::swap(ax[0], ax[1]); // draw symmetrical pattern
                 x += m.distance;
             }
-            p.rotate(-direction.first, m.hex_center);
-            all_polylines.push_back(p);
+            polylines.push_back(p);
         }
-    }
+        return polylines;
+    });
+    return { std::move(tile), bounding_box.min };
+}
+
+void FillHoneycomb::_fill_surface_single(
+    const FillParams                &params, 
+    unsigned int                     thickness_layers,
+    const std::pair<float, Point>   &direction, 
+    ExPolygon                        expolygon,
+    Polylines                       &polylines_out)
+{
+    const Point hex_center = this->cache_data(params).hex_center;
+    ExPolygon   rotated    = expolygon;
+    this->_to_pattern_coordinates(params, direction, rotated);
+    Polylines all_polylines = this->_clip_pattern(params, thickness_layers, direction, rotated);
+    for (Polyline &pl : all_polylines)
+        pl.rotate(-direction.first, hex_center);
     
-    all_polylines = intersection_pl(std::move(all_polylines), expolygon);
     if (params.dont_connect() || all_polylines.size() <= 1)
         append(polylines_out, chain_polylines(std::move(all_polylines)));
     else
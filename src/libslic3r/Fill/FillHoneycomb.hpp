@@ -14,6 +14,8 @@ class FillHoneycomb : public Fill
 public:
     ~FillHoneycomb() override {}
 
+    bool supports_batched_clipping() const override { return true; }
+
 protected:
     Fill* clone() const override { return new FillHoneycomb(*this); };
 	void _fill_surface_single(
@@ -22,6 +24,9 @@ protected:
 	    const std::pair<float, Point>   &direction, 
 	    ExPolygon                 		 expolygon,
 	    Polylines                       &polylines_out) override;
+    void _to_pattern_coordinates(const FillParams &params, const std::pair<float, Point> &direction, ExPolygon &expolygon) override;
+    std::pair<FillPatternCache::Tile, Point> _pattern_tile(
+        const FillParams &params, unsigned int thickness_layers, const std::pair<float, Point> &direction, const BoundingBox &bbox) override;
 
 	// Caching the 
 	struct CacheID 
@@ -48,6 +53,7 @@ protected:
     };
     typedef std::map<CacheID, CacheData> Cache;
 	Cache cache;
+    const CacheData& cache_data(const FillParams &params);
 
     float _layer_angle(size_t idx) const override { return float(M_PI/3.) * (idx % 3); }
 };
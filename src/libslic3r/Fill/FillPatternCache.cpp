@@ -0,0 +1,124 @@
+#include "FillPatternCache.hpp"
+
+#include "../ClipperUtils.hpp"
+#include "../ExPolygon.hpp"
+
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace Slic3r {
+namespace FillPatternCache {
+
+// Limit of the number of points of all cached tiles. A scaled Point takes 16 bytes, thus about 128MB.
+static constexpr const size_t max_cached_points = 8 * 1024 * 1024;
+
+struct Cache
+{
+    struct Entry
+    {
+        Tile                     tile;
+        // Position of the key in Cache::lru.
+        std::list<Key>::iterator lru_it;
+    };
+    std::mutex           mutex;
+    std::map<Key, Entry> tiles;
+    // Keys from the least recently used to the most recently used, the least recently used tiles are dropped first.
+    std::list<Key>       lru;
+    size_t               num_points { 0 };
+};
+
+static Cache& cache()
+{
+    static Cache cache;
+    return cache;
+}
+
+static size_t num_points(const Polylines &polylines)
+{
+    size_t n = 0;
+    for (const Polyline &pl : polylines)
+        n += pl.size();
+    return n;
+}
+
+Tile get(const Key &key, const std::function<Polylines()> &generate)
+{
+    Cache &c = cache();
+    {
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (auto it = c.tiles.find(key); it != c.tiles.end()) {
+            c.lru.splice(c.lru.end(), c.lru, it->second.lru_it);
+            return it->second.tile;
+        }
+    }
+
+    // Generate outside of the lock. If two threads generate the same tile, the first one inserted wins,
+    // both tiles are identical anyway.
+    auto         tile   = std::make_shared<const Polylines>(generate());
+    const size_t points = num_points(*tile);
+    if (points > max_cached_points)
+        // Too big to be cached.
+        return tile;
+
+    std::lock_guard<std::mutex> lock(c.mutex);
+    if (auto it = c.tiles.find(key); it != c.tiles.end()) {
+        c.lru.splice(c.lru.end(), c.lru, it->second.lru_it);
+        return it->second.tile;
+    }
+    c.num_points += points;
+    while (c.num_points > max_cached_points) {
+        auto it_oldest = c.tiles.find(c.lru.front());
+        c.num_points -= num_points(*it_oldest->second.tile);
+        c.tiles.erase(it_oldest);
+        c.lru.pop_front();
+    }
+    c.tiles.emplace(key, Cache::Entry{ tile, c.lru.insert(c.lru.end(), key) });
+    return tile;
+}
+
+void clear()
+{
+    Cache &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    c.tiles.clear();
+    c.lru.clear();
+    c.num_points = 0;
+}
+
+int round_up_modules(double num_modules)
+{
+    const int n = std::max(1, int(std::ceil(num_modules)));
+    // 1, 2, 3, 4, 6, 8, 12, 16, 24 ...
+    for (int pow2 = 1;; pow2 *= 2) {
+        if (n <= pow2)
+            return pow2;
+        if (n <= pow2 + pow2 / 2)
+            return pow2 + pow2 / 2;
+    }
+}
+
+Polylines clip_tile(const Polylines &tile, const Point &origin, const ExPolygon &expolygon)
+{
+    // Move the clipping polygon into the tile coordinate system rather than copying the tile.
+    ExPolygon clip = expolygon;
+    clip.translate(- origin);
+    Polylines out = intersection_pl(tile, clip);
+    for (Polyline &pl : out)
+        pl.translate(origin);
+    return out;
+}
+
+Polylines clip_tile(const Polylines &tile, const Point &origin, const ExPolygons &expolygons)
+{
+    ExPolygons clip = expolygons;
+    for (ExPolygon &expoly : clip)
+        expoly.translate(- origin);
+    Polylines out = intersection_pl(tile, clip);
+    for (Polyline &pl : out)
+        pl.translate(origin);
+    return out;
+}
+
+} // namespace FillPatternCache
+} // namespace Slic3r
@@ -0,0 +1,65 @@
+#ifndef slic3r_FillPatternCache_hpp_
+#define slic3r_FillPatternCache_hpp_
+
+#include <array>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <tuple>
+
+#include "../libslic3r.h"
+#include "../Polyline.hpp"
+#include "../ExPolygon.hpp"
+#include "../PrintConfig.hpp"
+
+namespace Slic3r {
+
+// Shared cache of pre-generated tiles of the periodic infill patterns (gyroid, honeycomb, 3D honeycomb, cross hatch).
+// A tile is the pattern generated in its own coordinate system starting at (0, 0) and aligned to the pattern module.
+// It only depends on the pattern parameters, on the phase of the print Z inside the pattern period and on the number
+// of modules covered, therefore identical objects or regions filled at the same height clip the same tile
+// instead of generating the pattern again. Thread safe.
+namespace FillPatternCache {
+
+struct Key
+{
+    InfillPattern            pattern;
+    // Pattern parameters as used by the generator, compared exactly.
+    std::array<double, 4>    params { 0., 0., 0., 0. };
+    // Phase of Z inside the pattern period, quantized to scaled coordinates. The generator shall only use this value.
+    coord_t                  z_phase { 0 };
+    // Tile size in pattern modules, see round_up_modules().
+    int                      modules_x { 0 };
+    int                      modules_y { 0 };
+
+    bool operator<(const Key &rhs) const {
+        return std::tie(pattern, params, z_phase, modules_x, modules_y) < std::tie(rhs.pattern, rhs.params, rhs.z_phase, rhs.modules_x, rhs.modules_y);
+    }
+};
+
+using Tile = std::shared_ptr<const Polylines>;
+
+// Returns the cached tile for the key, calling generate() to create it if it is not cached yet.
+Tile get(const Key &key, const std::function<Polylines()> &generate);
+
+// Drops all cached tiles. The cache is shared by all the prints of the process and its size is limited,
+// thus the tiles are not dropped after slicing.
+void clear();
+
+// Round the number of pattern modules covering a surface up to 1, 2, 3, 4, 6, 8, 12, 16, 24 ... modules,
+// so that surfaces of a similar size share a tile while the tile overshoots the surface by 50% at most.
+int round_up_modules(double num_modules);
+
+// Quantized phase of z inside a pattern period, both in scaled coordinates.
+inline coord_t z_phase(double z, double period) { return coord_t(std::llround(std::fmod(z, period))); }
+
+// Clip a tile placed at origin by expolygon.
+Polylines clip_tile(const Polylines &tile, const Point &origin, const ExPolygon &expolygon);
+// Clip a tile placed at origin by all expolygons in a single pass.
+Polylines clip_tile(const Polylines &tile, const Point &origin, const ExPolygons &expolygons);
+
+} // namespace FillPatternCache
+
+} // namespace Slic3r
+
+#endif // slic3r_FillPatternCache_hpp_
@@ -44,31 +44,47 @@ DistanceField::DistanceField(const coord_t& radius, const Polygons& current_outl
     // Sample source polygons with a regular grid sampling pattern.
     const BoundingBox overhang_bbox = get_extents(current_overhang);
     ExPolygons expolys = offset2_ex(union_ex(current_overhang), -m_cell_size / 2, m_cell_size / 2); // remove dangling lines which causes sample_grid_pattern crash (fails the OUTER_LOW assertions)
-    for (const ExPolygon &expoly : expolys) {
-        const Points sampled_points               = sample_grid_pattern(expoly, m_cell_size, overhang_bbox);
-        const size_t unsupported_points_prev_size = m_unsupported_points.size();
-        m_unsupported_points.resize(unsupported_points_prev_size + sampled_points.size());
-
-        tbb::parallel_for(tbb::blocked_range<size_t>(0, sampled_points.size()), [&self = *this, &expoly = std::as_const(expoly), &sampled_points = std::as_const(sampled_points), &unsupported_points_prev_size = std::as_const(unsupported_points_prev_size)](const tbb::blocked_range<size_t> &range) -> void {
-            for (size_t sp_idx = range.begin(); sp_idx < range.end(); ++sp_idx) {
-                const Point &sp = sampled_points[sp_idx];
-                // Find a squared distance to the source expolygon boundary.
-                double d2 = std::numeric_limits<double>::max();
-                for (size_t icontour = 0; icontour <= expoly.holes.size(); ++icontour) {
-                    const Polygon &contour = icontour == 0 ? expoly.contour : expoly.holes[icontour - 1];
-                    if (contour.size() > 2) {
-                        Point prev = contour.points.back();
-                        for (const Point &p2 : contour.points) {
-                            d2   = std::min(d2, Line::distance_to_squared(sp, prev, p2));
-                            prev = p2;
+    // The islands are sampled in parallel, each into its own list of cells, which are then concatenated in the order of the islands.
+    std::vector<std::vector<UnsupportedCell>> unsupported_points_per_expoly(expolys.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, expolys.size()), [&expolys = std::as_const(expolys), &overhang_bbox, &unsupported_points_per_expoly, cell_size = m_cell_size](const tbb::blocked_range<size_t> &expolys_range) -> void {
+        for (size_t expoly_idx = expolys_range.begin(); expoly_idx < expolys_range.end(); ++ expoly_idx) {
+            const ExPolygon              &expoly             = expolys[expoly_idx];
+            const Points                  sampled_points     = sample_grid_pattern(expoly, cell_size, overhang_bbox);
+            std::vector<UnsupportedCell> &unsupported_points = unsupported_points_per_expoly[expoly_idx];
+            unsupported_points.resize(sampled_points.size());
+
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, sampled_points.size()), [&expoly, &sampled_points = std::as_const(sampled_points), &unsupported_points](const tbb::blocked_range<size_t> &range) -> void {
+                for (size_t sp_idx = range.begin(); sp_idx < range.end(); ++sp_idx) {
+                    const Point &sp = sampled_points[sp_idx];
+                    // Find a squared distance to the source expolygon boundary.
+                    double d2 = std::numeric_limits<double>::max();
+                    for (size_t icontour = 0; icontour <= expoly.holes.size(); ++icontour) {
+                        const Polygon &contour = icontour == 0 ? expoly.contour : expoly.holes[icontour - 1];
+                        if (contour.size() > 2) {
+                            Point prev = contour.points.back();
+                            for (const Point &p2 : contour.points) {
+                                d2   = std::min(d2, Line::distance_to_squared(sp, prev, p2));
+                                prev = p2;
+                            }
                         }
                     }
+                    unsupported_points[sp_idx] = {sp, coord_t(std::sqrt(d2))};
                 }
-                self.m_unsupported_points[unsupported_points_prev_size + sp_idx] = {sp, coord_t(std::sqrt(d2))};
-                assert(self.m_unsupported_points_bbox.contains(sp));
-            }
-        }); // end of parallel_for
-    }
+            }); // end of parallel_for
+        }
+    }); // end of parallel_for
+
+    size_t num_unsupported_points = 0;
+    for (const std::vector<UnsupportedCell> &unsupported_points : unsupported_points_per_expoly)
+        num_unsupported_points += unsupported_points.size();
+    m_unsupported_points.reserve(num_unsupported_points);
+    for (const std::vector<UnsupportedCell> &unsupported_points : unsupported_points_per_expoly)
+        m_unsupported_points.insert(m_unsupported_points.end(), unsupported_points.begin(), unsupported_points.end());
+#ifndef NDEBUG
+    for (const UnsupportedCell &cell : m_unsupported_points)
+        assert(m_unsupported_points_bbox.contains(cell.loc));
+#endif // NDEBUG
+
     std::stable_sort(m_unsupported_points.begin(), m_unsupported_points.end(), [&radius](const UnsupportedCell &a, const UnsupportedCell &b) {
         constexpr coord_t prime_for_hash = 191;
         return std::abs(b.dist_to_boundary - a.dist_to_boundary) > radius ?
@@ -10,6 +10,8 @@
 
 #include "ExPolygon.hpp"
 
+#include <tbb/parallel_for.h>
+
 /* Possible future tasks/optimizations,etc.:
  * - Improve connecting heuristic to favor connecting to shorter trees
  * - Change which node of a tree is the root when that would be better in reconnectRoots.
@@ -142,31 +144,42 @@ Generator::Generator(PrintObject* m_object, std::vector<Polygons>& contours, std
     //for (size_t i = 0; i < overhangs.size(); i++)
     //{
     //    auto svg = draw_two_overhangs_to_svg(i, to_expolygons(contours[i]), to_expolygons(overhangs[i]));
-    //    for (auto& root : m_lightning_layers[i].tree_roots)
-    //        root->draw_tree(svg);
+    //    for (NodeIdx root : m_lightning_layers[i].tree_roots)
+    //        m_lightning_layers[i].nodes.draw_tree(root, svg);
     //}
 }
 
+// Collect the areas of sparse infill of all layers in parallel.
+static std::vector<Polygons> collect_infill_outlines(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
+{
+    std::vector<Polygons> infill_outlines(print_object.layers().size(), Polygons());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, print_object.layers().size()), [&print_object, &infill_outlines, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+            throw_on_cancel_callback();
+            for (const LayerRegion *layerm : print_object.get_layer(int(layer_id))->regions())
+                for (const Surface &surface : layerm->fill_surfaces.surfaces)
+                    if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
+                        append(infill_outlines[layer_id], to_polygons(surface.expolygon));
+        }
+    });
+    return infill_outlines;
+}
+
 void Generator::generateInitialInternalOverhangs(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
 {
+    const std::vector<Polygons> infill_areas = collect_infill_outlines(print_object, throw_on_cancel_callback);
     m_overhang_per_layer.resize(print_object.layers().size());
 
-    Polygons infill_area_above;
-    //Iterate from top to bottom, to subtract the overhang areas above from the overhang areas on the layer below, to get only overhang in the top layer where it is overhanging.
-    for (int layer_nr = int(print_object.layers().size()) - 1; layer_nr >= 0; --layer_nr) {
-        throw_on_cancel_callback();
-        Polygons infill_area_here;
-        for (const LayerRegion* layerm : print_object.get_layer(layer_nr)->regions())
-            for (const Surface& surface : layerm->fill_surfaces.surfaces)
-                if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
-                    append(infill_area_here, to_polygons(surface.expolygon));
-
-        //Remove the part of the infill area that is already supported by the walls.
-        Polygons overhang = diff(offset(infill_area_here, -float(m_wall_supporting_radius)), infill_area_above);
-
-        m_overhang_per_layer[layer_nr] = overhang;
-        infill_area_above = std::move(infill_area_here);
-    }
+    // Subtract the infill areas above from the overhang areas on the layer below, to get only overhang in the top layer where it is overhanging.
+    // Each layer only depends on the infill area of the layer above, thus the layers are processed in parallel.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, infill_areas.size()), [this, &infill_areas, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++ layer_nr) {
+            throw_on_cancel_callback();
+            //Remove the part of the infill area that is already supported by the walls.
+            m_overhang_per_layer[layer_nr] = diff(offset(infill_areas[layer_nr], -float(m_wall_supporting_radius)),
+                                                  layer_nr + 1 < infill_areas.size() ? infill_areas[layer_nr + 1] : Polygons());
+        }
+    });
 }
 
 const Layer& Generator::getTreesForLayer(const size_t& layer_id) const
@@ -177,22 +190,24 @@ const Layer& Generator::getTreesForLayer(const size_t& layer_id) const
 
 void Generator::generateTrees(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
 {
-    const auto _locator_cell_size = locator_cell_size();
-    m_lightning_layers.resize(print_object.layers().size());
-    bboxs.resize(print_object.layers().size());
-    std::vector<Polygons> infill_outlines(print_object.layers().size(), Polygons());
+    propagateTrees(collect_infill_outlines(print_object, throw_on_cancel_callback), throw_on_cancel_callback);
+}
 
-    // For-each layer from top to bottom:
-    for (int layer_id = int(print_object.layers().size()) - 1; layer_id >= 0; layer_id--) {
-        throw_on_cancel_callback();
-        for (const LayerRegion *layerm : print_object.get_layer(layer_id)->regions())
-            for (const Surface &surface : layerm->fill_surfaces.surfaces)
-                if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
-                    append(infill_outlines[layer_id], to_polygons(surface.expolygon));
-    }
+void Generator::generateTreesforSupport(std::vector<Polygons>& contours, const std::function<void()> &throw_on_cancel_callback)
+{
+    if (contours.empty()) return;
+
+    propagateTrees(contours, throw_on_cancel_callback);
+}
+
+void Generator::propagateTrees(const std::vector<Polygons> &infill_outlines, const std::function<void()> &throw_on_cancel_callback)
+{
+    m_lightning_layers.resize(infill_outlines.size());
+    bboxs.resize(infill_outlines.size());
 
+    const auto _locator_cell_size = locator_cell_size();
     // For various operations its beneficial to quickly locate nearby features on the polygon:
-    const size_t top_layer_id = print_object.layers().size() - 1;
+    const size_t top_layer_id = infill_outlines.size() - 1;
     EdgeGrid::Grid outlines_locator(get_extents(infill_outlines[top_layer_id]).inflated(SCALED_EPSILON));
     outlines_locator.create(infill_outlines[top_layer_id], _locator_cell_size);
 
@@ -203,10 +218,10 @@ void Generator::generateTrees(const PrintObject &print_object, const std::functi
         const Polygons    &current_outlines        = infill_outlines[layer_id];
         const BoundingBox &current_outlines_bbox   = get_extents(current_outlines);
 
-        bboxs[layer_id] = get_extents(current_outlines);
+        bboxs[layer_id] = current_outlines_bbox;
 
         // register all trees propagated from the previous layer as to-be-reconnected
-        std::vector<NodeSPtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
+        const std::vector<NodeIdx> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
 
         current_lightning_layer.generateNewTrees(m_overhang_per_layer[layer_id], current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius, throw_on_cancel_callback);
         current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius);
@@ -221,63 +236,16 @@ void Generator::generateTrees(const PrintObject &print_object, const std::functi
             below_outlines_bbox.merge(outlines_locator_bbox);
 
         if (!current_lightning_layer.tree_roots.empty())
-            below_outlines_bbox.merge(get_extents(current_lightning_layer.tree_roots).inflated(SCALED_EPSILON));
-
-        outlines_locator.set_bbox(below_outlines_bbox);
-        outlines_locator.create(below_outlines, _locator_cell_size);
-
-        std::vector<NodeSPtr>& lower_trees = m_lightning_layers[layer_id - 1].tree_roots;
-        for (auto& tree : current_lightning_layer.tree_roots)
-            tree->propagateToNextLayer(lower_trees, below_outlines, outlines_locator, m_prune_length, m_straightening_max_distance, _locator_cell_size / 2);
-    }
-}
-
-void Generator::generateTreesforSupport(std::vector<Polygons>& contours, const std::function<void()> &throw_on_cancel_callback)
-{
-    if (contours.empty()) return;
-
-    m_lightning_layers.resize(contours.size());
-    bboxs.resize(contours.size());
-
-    const auto _locator_cell_size = locator_cell_size();
-    // For various operations its beneficial to quickly locate nearby features on the polygon:
-    const size_t top_layer_id = contours.size() - 1;
-    EdgeGrid::Grid outlines_locator(get_extents(contours[top_layer_id]).inflated(SCALED_EPSILON));
-    outlines_locator.create(contours[top_layer_id], _locator_cell_size);
-
-    // For-each layer from top to bottom:
-    for (int layer_id = int(top_layer_id); layer_id >= 0; layer_id--) {
-		throw_on_cancel_callback();
-        Layer& current_lightning_layer = m_lightning_layers[layer_id];
-        const Polygons& current_outlines = contours[layer_id];
-        const BoundingBox& current_outlines_bbox = get_extents(current_outlines);
-
-        bboxs[layer_id] = get_extents(current_outlines);
-
-        // register all trees propagated from the previous layer as to-be-reconnected
-        std::vector<NodeSPtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
-
-        current_lightning_layer.generateNewTrees(m_overhang_per_layer[layer_id], current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius, throw_on_cancel_callback);
-        current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius);
-
-        // Initialize trees for next lower layer from the current one.
-        if (layer_id == 0)
-            return;
-
-        const Polygons& below_outlines = contours[layer_id - 1];
-        BoundingBox     below_outlines_bbox = get_extents(below_outlines).inflated(SCALED_EPSILON);
-        if (const BoundingBox& outlines_locator_bbox = outlines_locator.bbox(); outlines_locator_bbox.defined)
-            below_outlines_bbox.merge(outlines_locator_bbox);
-
-        if (!current_lightning_layer.tree_roots.empty())
-            below_outlines_bbox.merge(get_extents(current_lightning_layer.tree_roots).inflated(SCALED_EPSILON));
+            below_outlines_bbox.merge(get_extents(current_lightning_layer.nodes, current_lightning_layer.tree_roots).inflated(SCALED_EPSILON));
 
         outlines_locator.set_bbox(below_outlines_bbox);
         outlines_locator.create(below_outlines, _locator_cell_size);
 
-        std::vector<NodeSPtr>& lower_trees = m_lightning_layers[layer_id - 1].tree_roots;
-        for (auto& tree : current_lightning_layer.tree_roots)
-            tree->propagateToNextLayer(lower_trees, below_outlines, outlines_locator, m_prune_length, m_straightening_max_distance, _locator_cell_size / 2);
+        // The trees below are copies of the trees of this layer, reduced by pruning and straightening.
+        Layer &lower_layer = m_lightning_layers[layer_id - 1];
+        lower_layer.nodes.reserve(current_lightning_layer.nodes.size());
+        for (NodeIdx tree : current_lightning_layer.tree_roots)
+            current_lightning_layer.nodes.propagateToNextLayer(tree, lower_layer.nodes, lower_layer.tree_roots, below_outlines, outlines_locator, m_prune_length, m_straightening_max_distance, _locator_cell_size / 2);
     }
 }
 
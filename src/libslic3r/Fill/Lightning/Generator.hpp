@@ -80,6 +80,14 @@ protected:
     void generateTrees(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
     void generateTreesforSupport(std::vector<Polygons>& contours, const std::function<void()> &throw_on_cancel_callback);
 
+    /*!
+     * Generate the trees of each layer from top to bottom and propagate them
+     * to the layer below, which is shared by \ref generateTrees and
+     * \ref generateTreesforSupport.
+     * \param infill_outlines For each layer, the area to be filled.
+     */
+    void propagateTrees(const std::vector<Polygons> &infill_outlines, const std::function<void()> &throw_on_cancel_callback);
+
     float m_infill_extrusion_width;
 
     /*!
@@ -6,25 +6,23 @@
 
 #include "../../EdgeGrid.hpp"
 #include "../../Polygon.hpp"
+#include "TreeNode.hpp"
 
-#include <memory>
+#include <functional>
 #include <vector>
-#include <list>
 #include <unordered_map>
 #include <optional>
 
 namespace Slic3r::FillLightning
 {
 
-class Node;
-using NodeSPtr = std::shared_ptr<Node>;
-using SparseNodeGrid = std::unordered_multimap<Point, std::weak_ptr<Node>, PointHash>;
+using SparseNodeGrid = std::unordered_multimap<Point, NodeIdx, PointHash>;
 
 struct GroundingLocation
 {
-    NodeSPtr tree_node; //!< not null if the gounding location is on a tree
+    NodeIdx tree_node; //!< not InvalidNodeIdx if the gounding location is on a tree
     std::optional<Point> boundary_location; //!< in case the gounding location is on the boundary
-    Point p() const;
+    Point p(const NodePool &nodes) const;
 };
 
 /*!
@@ -35,7 +33,9 @@ struct GroundingLocation
 class Layer
 {
 public:
-    std::vector<NodeSPtr> tree_roots;
+    //! Storage of all nodes of the trees of this layer.
+    NodePool             nodes;
+    std::vector<NodeIdx> tree_roots;
 
     void generateNewTrees
     (
@@ -60,7 +60,7 @@ public:
         coord_t supporting_radius,
         coord_t wall_supporting_radius,
         const SparseNodeGrid& tree_node_locator,
-        const NodeSPtr& exclude_tree = nullptr
+        NodeIdx exclude_tree = InvalidNodeIdx
     );
 
     /*!
@@ -68,11 +68,11 @@ public:
      * \param[out] new_root The new root node if one had been made
      * \return Whether a new root was added
      */
-    bool attach(const Point& unsupported_location, const GroundingLocation& ground, NodeSPtr& new_child, NodeSPtr& new_root);
+    bool attach(const Point& unsupported_location, const GroundingLocation& ground, NodeIdx& new_child, NodeIdx& new_root);
 
     void reconnectRoots
     (
-        std::vector<NodeSPtr>& to_be_reconnected_tree_roots,
+        const std::vector<NodeIdx>& to_be_reconnected_tree_roots,
         const Polygons& current_outlines,
         const BoundingBox& current_outlines_bbox,
         const EdgeGrid::Grid& outline_locator,
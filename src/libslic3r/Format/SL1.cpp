@@ -506,7 +506,8 @@ void SL1Archive::export_print(Zipper& zipper,
             std::string imgname = project + string_printf("%.5d", i++) + "." +
                                   rst.extension();
             
-            zipper.add_entry(imgname.c_str(), rst.data(), rst.size());
+            // The PNG data is deflated already, don't compress it again.
+            zipper.add_entry(imgname.c_str(), rst.data(), rst.size(), Zipper::NO_COMPRESSION);
         }
     } catch(std::exception& e) {
         BOOST_LOG_TRIVIAL(error) << e.what();
@@ -1300,6 +1300,71 @@ std::vector<std::pair<coordf_t, std::vector<GCode::LayerToPrint>>> GCode::collec
     return layers_to_print;
 }
 
+// Maximum number of moves tried by the 2-opt refinement of a single tour of islands or instances. A move is a constant time
+// check, a sweep over a tour of n islands tries up to 64 n moves. A move budget rather than a time budget keeps the G-code deterministic.
+static constexpr const size_t LAYER_VISIT_ORDER_REFINE_MOVES = 200000;
+
+// Plan the order of the instances and islands printed on a single print_z to minimize the travel moves. Called in parallel ahead of the G-code generator.
+// The islands of an instance are printed in a single run, as the instance is labeled for the exclude object feature, thus the islands of each object layer
+// are ordered first by a tour over the centers of their bounding boxes, then the instances are chained as segments leading from the first island
+// of their tour to the last one. Instances chained in the reverse direction visit their islands in the reverse order.
+GCode::LayerVisitOrder GCode::plan_layer_visit_order(const std::vector<LayerToPrint> &layers, const std::vector<const PrintInstance*> &print_object_instances_ordering)
+{
+    LayerVisitOrder out;
+    // First and last point of the tour of islands of each object layer, in the object coordinates. Sliced PrintObjects are centered,
+    // thus an instance printing just support is represented by its shift.
+    std::vector<std::pair<Point, Point>> island_tour_ends(layers.size(), { Point::Zero(), Point::Zero() });
+    out.islands.assign(layers.size(), {});
+    for (size_t layer_id = 0; layer_id < layers.size(); ++ layer_id) {
+        const Layer *layer = layers[layer_id].object_layer;
+        if (layer == nullptr || layer->lslices.empty() || layer->lslices_bboxes.size() != layer->lslices.size())
+            continue;
+        std::vector<std::pair<Point, Point>> centers;
+        centers.reserve(layer->lslices_bboxes.size());
+        for (const BoundingBox &bbox : layer->lslices_bboxes) {
+            const Point center = bbox.center();
+            centers.emplace_back(center, center);
+        }
+        std::vector<size_t> &order = out.islands[layer_id];
+        order.reserve(centers.size() + 1);
+        for (const std::pair<size_t, bool> &island : chain_segments_two_opt(centers, nullptr, LAYER_VISIT_ORDER_REFINE_MOVES))
+            order.emplace_back(island.first);
+        island_tour_ends[layer_id] = { centers[order.front()].first, centers[order.back()].first };
+        // The extrusions, which do not fit into any slice, are collected into the last island.
+        order.emplace_back(centers.size());
+    }
+
+    // Map PrintObject to the index of its LayerToPrint.
+    std::vector<std::pair<const PrintObject*, size_t>> object_layers;
+    object_layers.reserve(layers.size());
+    for (size_t layer_id = 0; layer_id < layers.size(); ++ layer_id)
+        if (layers[layer_id].original_object != nullptr)
+            object_layers.emplace_back(layers[layer_id].original_object, layer_id);
+    std::sort(object_layers.begin(), object_layers.end());
+
+    std::vector<const PrintInstance*>    instances;
+    std::vector<std::pair<Point, Point>> segments;
+    for (const PrintInstance *instance : print_object_instances_ordering) {
+        auto it = std::lower_bound(object_layers.begin(), object_layers.end(), std::pair<const PrintObject*, size_t>(instance->print_object, 0));
+        if (it != object_layers.end() && it->first == instance->print_object) {
+            const std::pair<Point, Point> &ends = island_tour_ends[it->second];
+            instances.emplace_back(instance);
+            segments.emplace_back(ends.first + instance->shift, ends.second + instance->shift);
+        }
+    }
+    if (! instances.empty()) {
+        // Start with the instance the default ordering starts with.
+        const Point start_near = segments.front().first;
+        for (const std::pair<size_t, bool> &segment : chain_segments_two_opt(segments, &start_near, LAYER_VISIT_ORDER_REFINE_MOVES)) {
+            out.instances.emplace_back(instances[segment.first]);
+            if (segment.second)
+                out.reversed_instances.emplace_back(instances[segment.first]);
+        }
+        std::sort(out.reversed_instances.begin(), out.reversed_instances.end());
+    }
+    return out;
+}
+
 // free functions called by GCode::do_export()
 namespace DoExport {
 //    static void update_print_estimated_times_stats(const GCodeProcessor& processor, PrintStatistics& print_statistics)
@@ -2526,7 +2591,12 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
                 // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
                 // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
                 // and export G-code into file.
-                this->process_layers(print, tool_ordering, collect_layers_to_print(object), *print_object_instance_sequential_active - object.instances().data(), file, prime_extruder);
+                // The layers are released after the last instance of the object, or of the objects sharing its layers, is printed.
+                auto layers_owner = [](const PrintObject *object) { return object->get_shared_object() ? object->get_shared_object() : object; };
+                const bool release_layers = print.release_layers_after_export() &&
+                    std::none_of(print_object_instance_sequential_active + 1, print_object_instances_ordering.cend(),
+                        [&object, &layers_owner](const PrintInstance *instance) { return layers_owner(instance->print_object) == layers_owner(&object); });
+                this->process_layers(print, tool_ordering, collect_layers_to_print(object), *print_object_instance_sequential_active - object.instances().data(), file, prime_extruder, release_layers);
                 //BBS: close powerlost recovery
                 {
                     if (is_bbl_printers && m_second_layer_things_done) {
@@ -2728,6 +2798,25 @@ void GCode::check_placeholder_parser_failed()
     }
 }
 
+// Index of a layer to print and the travel planning data precomputed for its objects.
+struct LayerTravelPlanning {
+    size_t                                              layer_idx;
+    std::vector<AvoidCrossingPerimeters::LayerDataPtr>  layer_data;
+    GCode::LayerVisitOrder                              visit_order;
+};
+
+// Free the extrusions of the layers, whose G-code has been emitted, see Print::set_release_layers_after_export().
+// The G-code generator works on a const Print, the layers are owned by the Print passed to do_export() as mutable.
+static void release_layers_to_print(const std::vector<GCode::LayerToPrint> &layers)
+{
+    for (const GCode::LayerToPrint &layer : layers) {
+        if (layer.object_layer)
+            const_cast<Layer*>(layer.object_layer)->release_extrusions();
+        if (layer.support_layer)
+            const_cast<SupportLayer*>(layer.support_layer)->release_extrusions();
+    }
+}
+
 // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
 // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
 // and export G-code into file.
@@ -2740,30 +2829,54 @@ void GCode::process_layers(
 {
     // The pipeline is variable: The vase mode filter is optional.
     size_t layer_to_print_idx = 0;
-    const auto generator = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> LayerResult {
-            if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
-                    fc.stop();
-                    return {};
-                } else {
-                    // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
-                    ++layer_to_print_idx;
-                    return LayerResult::make_nop_layer_result();
-                }
+    const auto layer_source = tbb::make_filter<void, size_t>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> size_t {
+            // Pressure equalizer need insert empty input. Because it returns one layer back.
+            if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0))
+                fc.stop();
+            return layer_to_print_idx ++;
+        });
+    // Travel planning data only depend on the layers, thus they are built in parallel ahead of the serial generator.
+    const auto travel_planning = tbb::make_filter<size_t, LayerTravelPlanning>(slic3r_tbb_filtermode::parallel,
+        [&print, &print_object_instances_ordering, &layers_to_print](size_t layer_idx) -> LayerTravelPlanning {
+            LayerTravelPlanning out { layer_idx, {}, {} };
+            if (layer_idx < layers_to_print.size() && print.config().reduce_crossing_wall) {
+                print.throw_if_canceled();
+                for (const LayerToPrint &layer_to_print : layers_to_print[layer_idx].second)
+                    if (const Layer *layer = layer_to_print.layer(); layer)
+                        out.layer_data.emplace_back(AvoidCrossingPerimeters::precompute_layer_data(*layer));
+            }
+            // The order of the object list set by the user is kept.
+            if (layer_idx < layers_to_print.size() && print.config().optimize_travel_order && print.config().print_order == PrintOrder::Default) {
+                print.throw_if_canceled();
+                out.visit_order = plan_layer_visit_order(layers_to_print[layer_idx].second, print_object_instances_ordering);
+            }
+            return out;
+        });
+    const auto layer_generator = tbb::make_filter<LayerTravelPlanning, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print](LayerTravelPlanning in) -> LayerResult {
+            if (in.layer_idx >= layers_to_print.size()) {
+                // Insert NOP (no operation) layer for the pressure equalizer;
+                return LayerResult::make_nop_layer_result();
             } else {
-                const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[layer_to_print_idx++];
+                const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[in.layer_idx];
                 const LayerTools& layer_tools = tool_ordering.tools_for_layer(layer.first);
-                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
+                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(in.layer_idx + 1)));
                 if (m_wipe_tower && layer_tools.has_wipe_tower)
                     m_wipe_tower->next_layer();
                 //BBS
                 check_placeholder_parser_failed();
                 print.throw_if_canceled();
-                return this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1));
+                m_avoid_crossing_perimeters.set_precomputed_layer_data(std::move(in.layer_data));
+                LayerResult result = this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1), false,
+                    in.visit_order.empty() ? nullptr : &in.visit_order);
+                // All the objects are printed layer by layer, nothing reads the extrusions of this layer anymore.
+                if (print.release_layers_after_export())
+                    release_layers_to_print(layer.second);
+                return result;
             }
         });
+    const auto generator = layer_source & travel_planning & layer_generator;
     if (m_spiral_vase) {
         float nozzle_diameter  = EXTRUDER_CONFIG(nozzle_diameter);
         float max_xy_smoothing = m_config.get_abs_value("spiral_mode_max_xy_smoothing", nozzle_diameter);
@@ -2839,31 +2952,49 @@ void GCode::process_layers(
     const size_t                             single_object_idx,
     GCodeOutputStream                       &output_stream,
     // BBS
-    const bool                               prime_extruder)
+    const bool                               prime_extruder,
+    const bool                               release_layers)
 {
     // The pipeline is variable: The vase mode filter is optional.
     size_t layer_to_print_idx = 0;
-    const auto generator = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &layers_to_print, &layer_to_print_idx, single_object_idx, prime_extruder](tbb::flow_control& fc) -> LayerResult {
-            if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
-                    fc.stop();
-                    return {};
-                } else {
-                    // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
-                    ++layer_to_print_idx;
-                    return LayerResult::make_nop_layer_result();
-                }
+    const auto layer_source = tbb::make_filter<void, size_t>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> size_t {
+            // Pressure equalizer need insert empty input. Because it returns one layer back.
+            if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0))
+                fc.stop();
+            return layer_to_print_idx ++;
+        });
+    // Travel planning data only depend on the layers, thus they are built in parallel ahead of the serial generator.
+    const auto travel_planning = tbb::make_filter<size_t, LayerTravelPlanning>(slic3r_tbb_filtermode::parallel,
+        [&print, &layers_to_print](size_t layer_idx) -> LayerTravelPlanning {
+            LayerTravelPlanning out { layer_idx, {} };
+            if (layer_idx < layers_to_print.size() && print.config().reduce_crossing_wall) {
+                print.throw_if_canceled();
+                if (const Layer *layer = layers_to_print[layer_idx].layer(); layer)
+                    out.layer_data.emplace_back(AvoidCrossingPerimeters::precompute_layer_data(*layer));
+            }
+            return out;
+        });
+    const auto layer_generator = tbb::make_filter<LayerTravelPlanning, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &print, &tool_ordering, &layers_to_print, single_object_idx, prime_extruder, release_layers](LayerTravelPlanning in) -> LayerResult {
+            if (in.layer_idx >= layers_to_print.size()) {
+                // Insert NOP (no operation) layer for the pressure equalizer;
+                return LayerResult::make_nop_layer_result();
             } else {
-                LayerToPrint &layer = layers_to_print[layer_to_print_idx ++];
-                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
+                LayerToPrint &layer = layers_to_print[in.layer_idx];
+                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(in.layer_idx + 1)));
                 //BBS
                 check_placeholder_parser_failed();
                 print.throw_if_canceled();
-                return this->process_layer(print, { std::move(layer) }, tool_ordering.tools_for_layer(layer.print_z()), &layer == &layers_to_print.back(), nullptr, single_object_idx, prime_extruder);
+                m_avoid_crossing_perimeters.set_precomputed_layer_data(std::move(in.layer_data));
+                std::vector<LayerToPrint> layers { std::move(layer) };
+                LayerResult result = this->process_layer(print, layers, tool_ordering.tools_for_layer(layers.front().print_z()), &layer == &layers_to_print.back(), nullptr, single_object_idx, prime_extruder);
+                if (release_layers)
+                    release_layers_to_print(layers);
+                return result;
             }
         });
+    const auto generator = layer_source & travel_planning & layer_generator;
     if (m_spiral_vase) {
         float nozzle_diameter  = EXTRUDER_CONFIG(nozzle_diameter);
         float max_xy_smoothing = m_config.get_abs_value("spiral_mode_max_xy_smoothing", nozzle_diameter);
@@ -3554,7 +3685,9 @@ LayerResult GCode::process_layer(
     // Otherwise print a single copy of a single object.
     const size_t                     		 single_object_instance_idx,
     // BBS
-    const bool                               prime_extruder)
+    const bool                               prime_extruder,
+    // Optional travel optimized order of the instances and islands.
+    const LayerVisitOrder                   *visit_order)
 {
     assert(! layers.empty());
     // Either printing all copies of all objects, or just a single copy of a single object.
@@ -4091,7 +4224,7 @@ LayerResult GCode::process_layer(
             instances_to_print = sort_print_object_instances(objects_by_extruder_it->second, layers, &new_ordering, single_object_instance_idx);
         }
         else {
-            instances_to_print = sort_print_object_instances(objects_by_extruder_it->second, layers, ordering, single_object_instance_idx);
+            instances_to_print = sort_print_object_instances(objects_by_extruder_it->second, layers, visit_order ? &visit_order->instances : ordering, single_object_instance_idx);
         }
 
         // BBS
@@ -4231,9 +4364,14 @@ LayerResult GCode::process_layer(
                     m_layer = layer_to_print.layer();
                     m_object_layer_over_raft = object_layer_over_raft;
                 }
-                //FIXME order islands?
                 // Sequential tool path ordering of multiple parts within the same object, aka. perimeter tracking (#5511)
-                for (ObjectByExtruder::Island &island : instance_to_print.object_by_extruder.islands) {
+                // The islands are printed in the order of the slices, unless their travel optimized order was planned.
+                std::vector<ObjectByExtruder::Island> &islands = instance_to_print.object_by_extruder.islands;
+                const std::vector<size_t> *island_order = visit_order && visit_order->islands[instance_to_print.layer_id].size() == islands.size() ?
+                    &visit_order->islands[instance_to_print.layer_id] : nullptr;
+                const bool islands_reversed = island_order && visit_order->is_reversed(&instance_to_print.print_object.instances()[instance_to_print.instance_id]);
+                for (size_t i = 0; i < islands.size(); ++ i) {
+                    ObjectByExtruder::Island &island = islands[island_order == nullptr ? i : (*island_order)[islands_reversed ? islands.size() - 1 - i : i]];
                     const auto& by_region_specific = is_anything_overridden ? island.by_region_per_copy(by_region_per_copy_cache, static_cast<unsigned int>(instance_to_print.instance_id), extruder_id, print_wipe_extrusions != 0) : island.by_region;
                     //BBS: add brim by obj by extruder
                     if (this->m_objsWithBrim.find(instance_to_print.print_object.id()) != this->m_objsWithBrim.end() && !print_wipe_extrusions) {
@@ -27,6 +27,7 @@
 // ORCA: post processor below used for Dynamic Pressure advance
 #include "GCode/AdaptivePAProcessor.hpp"
 
+#include <algorithm>
 #include <memory>
 #include <map>
 #include <set>
@@ -275,6 +276,21 @@ public:
         }
     };
 
+    // Travel optimized order of the instances and of their islands on a single print_z, see the optimize_travel_order option.
+    // Planned ahead of the serial G-code generator by plan_layer_visit_order().
+    struct LayerVisitOrder
+    {
+        // Replaces the per print ordering of the instances.
+        std::vector<const PrintInstance*>   instances;
+        // Sorted instances, which islands are visited in the reverse order.
+        std::vector<const PrintInstance*>   reversed_instances;
+        // Order of the islands of each object layer, indexed by LayerToPrint. Empty if the default order is kept.
+        std::vector<std::vector<size_t>>    islands;
+
+        bool empty() const { return instances.empty(); }
+        bool is_reversed(const PrintInstance *instance) const { return std::binary_search(reversed_instances.begin(), reversed_instances.end(), instance); }
+    };
+
 private:
     class GCodeOutputStream {
     public:
@@ -307,6 +323,8 @@ private:
 
     static std::vector<LayerToPrint>        		                   collect_layers_to_print(const PrintObject &object);
     static std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>> collect_layers_to_print(const Print &print);
+    static LayerVisitOrder                                             plan_layer_visit_order(const std::vector<LayerToPrint> &layers,
+        const std::vector<const PrintInstance*> &print_object_instances_ordering);
 
     std::string generate_skirt(const Print &print,
         const ExtrusionEntityCollection &skirt,
@@ -327,7 +345,9 @@ private:
         // Otherwise print a single copy of a single object.
         const size_t                     single_object_idx = size_t(-1),
         // BBS
-        const bool                       prime_extruder = false);
+        const bool                       prime_extruder = false,
+        // Optional travel optimized order of the instances and islands.
+        const LayerVisitOrder           *visit_order = nullptr);
     // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
     // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
     // and export G-code into file.
@@ -347,7 +367,9 @@ private:
         const size_t                             single_object_idx,
         GCodeOutputStream                       &output_stream,
         // BBS
-        const bool                               prime_extruder = false);
+        const bool                               prime_extruder = false,
+        // Free the extrusions of the layers once their G-code is emitted, see Print::set_release_layers_after_export().
+        const bool                               release_layers = false);
 
     //BBS
     void check_placeholder_parser_failed();
@@ -9,6 +9,7 @@
 #include "../SVG.hpp"
 #include "AvoidCrossingPerimeters.hpp"
 
+#include <algorithm>
 #include <numeric>
 #include <unordered_set>
 #include <boost/range/adaptor/reversed.hpp>
@@ -74,7 +75,7 @@ struct AllIntersectionsVisitor
         auto cell_data_range = grid.cell_data_range(iy, ix);
         for (auto it_contour_and_segment = cell_data_range.first; it_contour_and_segment != cell_data_range.second; ++it_contour_and_segment) {
             Point intersection_point;
-            if (travel_line.intersection(grid.line(*it_contour_and_segment), &intersection_point) &&
+            if (travel_line.intersection(grid.cell_line(it_contour_and_segment), &intersection_point) &&
                 intersection_set.find(*it_contour_and_segment) == intersection_set.end()) {
                 intersections.push_back({ it_contour_and_segment->first, it_contour_and_segment->second, intersection_point });
                 intersection_set.insert(*it_contour_and_segment);
@@ -100,18 +101,9 @@ struct FirstIntersectionVisitor
         assert(pt_current != nullptr);
         assert(pt_next != nullptr);
         // Called with a row and column of the grid cell, which is intersected by a line.
-        auto cell_data_range = grid.cell_data_range(iy, ix);
-        this->intersect      = false;
-        for (auto it_contour_and_segment = cell_data_range.first; it_contour_and_segment != cell_data_range.second; ++it_contour_and_segment) {
-            // End points of the line segment and their vector.
-            auto segment = grid.segment(*it_contour_and_segment);
-            if (Geometry::segments_intersect(segment.first, segment.second, *pt_current, *pt_next)) {
-                this->intersect = true;
-                return false;
-            }
-        }
-        // Continue traversing the grid along the edge.
-        return true;
+        this->intersect = grid.cell_intersects_line(iy, ix, *pt_current, *pt_next);
+        // Continue traversing the grid along the edge until the first intersection is found.
+        return ! this->intersect;
     }
 
     const EdgeGrid::Grid &grid;
@@ -138,11 +130,9 @@ struct MinDistanceVisitor
         // Called with a row and column of the grid cell, which is inside a bounding box.
         auto cell_data_range = grid.cell_data_range(iy, ix);
         for (auto it_contour_and_segment = cell_data_range.first; it_contour_and_segment != cell_data_range.second; ++it_contour_and_segment) {
-            // End points of the line segment and their vector.
-            auto  segment = grid.segment(*it_contour_and_segment);
             Point closest_point;
             if (closest_lines_set.find(*it_contour_and_segment) == closest_lines_set.end() &&
-                line_alg::distance_to_squared(Line(segment.first, segment.second), center, &closest_point) <= this->max_distance_squared) {
+                line_alg::distance_to_squared(grid.cell_line(it_contour_and_segment), center, &closest_point) <= this->max_distance_squared) {
                 closest_lines.push_back({it_contour_and_segment->first, it_contour_and_segment->second, closest_point});
                 closest_lines_set.insert(*it_contour_and_segment);
             }
@@ -861,7 +851,8 @@ static std::vector<float> contour_distance(const EdgeGrid::Grid     &grid,
                 for (auto it_contour_and_segment = cell_data_range.first; it_contour_and_segment != cell_data_range.second;
                      ++it_contour_and_segment) {
                     // End points of the line segment and their vector.
-                    std::pair<const Point &, const Point &> segment = this->grid.segment(*it_contour_and_segment);
+                    const Line  &line     = this->grid.cell_line(it_contour_and_segment);
+                    std::pair<const Point &, const Point &> segment(line.a, line.b);
                     const Vec2d  v        = (segment.second - segment.first).cast<double>();
                     const Vec2d  va       = (this->point - segment.first).cast<double>();
                     const double l2       = v.squaredNorm(); // avoid a sqrt
@@ -1182,15 +1173,20 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     Vec2d startf = start.cast<double>();
     Vec2d endf   = end  .cast<double>();
 
-    bool is_support_layer = dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr;
-    if (!use_external && (is_support_layer || (!m_lslices_offset.empty() && !any_expolygon_contains(m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel)))) {
-        // Initialize m_internal only when it is necessary.
-        if (m_internal.boundaries.empty())
-            init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer())));
+    assert(m_layer_data);
+    LayerData &layer_data       = *m_layer_data;
+    bool       is_support_layer = dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr;
+    if (!use_external && (is_support_layer || (!layer_data.lslices_offset.empty() && !any_expolygon_contains(layer_data.lslices_offset, layer_data.lslices_offset_bboxes, layer_data.grid_lslices_offset, travel)))) {
+        // Initialize the internal boundary only when it is necessary.
+        Boundary &internal = layer_data.internal;
+        if (! layer_data.internal_valid) {
+            init_boundary(&internal, to_polygons(get_boundary(*gcodegen.layer())));
+            layer_data.internal_valid = true;
+        }
 
         // Trim the travel line by the bounding box.
-        if (!m_internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_internal.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_internal, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
+        if (!internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, internal.bbox)) {
+            travel_intersection_count = avoid_perimeters(internal, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
@@ -1233,32 +1229,89 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     } else if (max_detour_length_exceeded) {
         *could_be_wipe_disabled = false;
     } else
-        *could_be_wipe_disabled = !need_wipe(gcodegen, m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel, result_pl, travel_intersection_count);
+        *could_be_wipe_disabled = !need_wipe(gcodegen, layer_data.lslices_offset, layer_data.lslices_offset_bboxes, layer_data.grid_lslices_offset, travel, result_pl, travel_intersection_count);
 
     return result_pl;
 }
 
 // ************************************* AvoidCrossingPerimeters::init_layer() *****************************************
 
-void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+static bool layer_has_top_surfaces(const Layer &layer)
 {
-    m_internal.clear();
-    m_external.clear();
-    m_lslices_offset.clear();
-    m_lslices_offset_bboxes.clear();
+    for (const LayerRegion *layer_region : layer.regions())
+        for (const Surface &surface : layer_region->fill_surfaces.surfaces)
+            if (surface.is_top())
+                return true;
+    return false;
+}
 
-    float perimeter_offset = -get_external_perimeter_width(layer) / float(2.);
-    m_lslices_offset        = offset_ex(layer.lslices, perimeter_offset);
+bool AvoidCrossingPerimeters::LayerData::reusable_for(const Layer &layer) const
+{
+    if (&layer == this->layer)
+        return true;
+    return this->layer != nullptr && this->layer->object() == layer.object() &&
+           ! this->is_support_layer && dynamic_cast<const SupportLayer*>(&layer) == nullptr &&
+           ! this->has_top_surfaces && ! layer_has_top_surfaces(layer) &&
+           this->external_perimeter_width == get_external_perimeter_width(layer) &&
+           this->perimeter_spacing == get_perimeter_spacing(layer) &&
+           this->layer->lslices == layer.lslices;
+}
 
-    m_lslices_offset_bboxes.reserve(m_lslices_offset.size());
-    for (const ExPolygon &ex_poly : m_lslices_offset)
-        m_lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
+static AvoidCrossingPerimeters::LayerDataPtr make_layer_data(const Layer &layer)
+{
+    auto data = std::make_shared<AvoidCrossingPerimeters::LayerData>();
+    data->layer                    = &layer;
+    data->external_perimeter_width = get_external_perimeter_width(layer);
+    data->perimeter_spacing        = get_perimeter_spacing(layer);
+    data->has_top_surfaces         = layer_has_top_surfaces(layer);
+    data->is_support_layer         = dynamic_cast<const SupportLayer*>(&layer) != nullptr;
+
+    data->lslices_offset = offset_ex(layer.lslices, - data->external_perimeter_width / float(2.));
+    data->lslices_offset_bboxes.reserve(data->lslices_offset.size());
+    for (const ExPolygon &ex_poly : data->lslices_offset)
+        data->lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
 
     BoundingBox bbox_slice(get_extents(layer.lslices));
     bbox_slice.offset(SCALED_EPSILON);
 
-    m_grid_lslices_offset.set_bbox(bbox_slice);
-    m_grid_lslices_offset.create(m_lslices_offset, coord_t(scale_(1.)));
+    data->grid_lslices_offset.set_bbox(bbox_slice);
+    data->grid_lslices_offset.create(data->lslices_offset, coord_t(scale_(1.)));
+    return data;
+}
+
+AvoidCrossingPerimeters::LayerDataPtr AvoidCrossingPerimeters::precompute_layer_data(const Layer &layer)
+{
+    // Most layers of prismatic objects are identical to the layer below, reuse the data of the layer below instead of building it again.
+    if (layer.lower_layer != nullptr) {
+        LayerData lower_layer_key;
+        lower_layer_key.layer                    = layer.lower_layer;
+        lower_layer_key.external_perimeter_width = get_external_perimeter_width(*layer.lower_layer);
+        lower_layer_key.perimeter_spacing        = get_perimeter_spacing(*layer.lower_layer);
+        lower_layer_key.has_top_surfaces         = layer_has_top_surfaces(*layer.lower_layer);
+        lower_layer_key.is_support_layer         = dynamic_cast<const SupportLayer*>(layer.lower_layer) != nullptr;
+        if (lower_layer_key.reusable_for(layer))
+            return nullptr;
+    }
+    return make_layer_data(layer);
+}
+
+void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+{
+    if (m_layer != &layer)
+        m_external.clear();
+    m_layer = &layer;
+
+    // Layer data precomputed ahead of the G-code generator.
+    auto it_precomputed = std::find_if(m_precomputed_layer_data.begin(), m_precomputed_layer_data.end(),
+        [&layer](const LayerDataPtr &data) { return data && data->layer == &layer; });
+    LayerDataPtr &last_layer_data = m_last_layer_data[{ layer.object(), dynamic_cast<const SupportLayer*>(&layer) != nullptr }];
+    if (it_precomputed != m_precomputed_layer_data.end())
+        m_layer_data = *it_precomputed;
+    else if (last_layer_data && last_layer_data->reusable_for(layer))
+        m_layer_data = last_layer_data;
+    else
+        m_layer_data = make_layer_data(layer);
+    last_layer_data = m_layer_data;
 }
 
 #if 0
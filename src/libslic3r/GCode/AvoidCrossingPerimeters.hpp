@@ -5,12 +5,16 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <map>
+#include <memory>
+
 namespace Slic3r {
 
 // Forward declarations.
 class GCode;
 class Layer;
 class Point;
+class PrintObject;
 
 class AvoidCrossingPerimeters
 {
@@ -23,7 +27,23 @@ public:
     bool        disabled_once() const   { return m_disabled_once; }
     void        reset_once_modifiers()  { m_use_external_mp_once = false; m_disabled_once = false; }
 
+    struct LayerData;
+    using LayerDataPtr = std::shared_ptr<LayerData>;
+
+    // Select or build the travel planning data for the layer. The data is taken from the layer data passed by
+    // set_precomputed_layer_data(), or it is reused from the previous layer of the same object
+    // if both layers produce the same data (see LayerData::reusable_for()). Otherwise it is built.
     void        init_layer(const Layer &layer);
+    // Travel planning data selected by the last init_layer().
+    const LayerDataPtr& layer_data() const { return m_layer_data; }
+
+    // Build the travel planning data of a layer. It depends on the layer only, so this is thread safe and
+    // GCode::process_layers() calls it in parallel before the serial G-code generator reaches the layer.
+    // Returns nullptr if the layer below has the same data, because init_layer() then reuses that layer's data.
+    // The internal boundary is not built here, but by the first travel, which needs it.
+    static LayerDataPtr precompute_layer_data(const Layer &layer);
+    // Layer data precomputed for the layers to be printed next. Replaces the previously passed layer data.
+    void        set_precomputed_layer_data(std::vector<LayerDataPtr> &&layer_data) { m_precomputed_layer_data = std::move(layer_data); }
 
     Polyline    travel_to(const GCode& gcodegen, const Point& point)
     {
@@ -50,6 +70,30 @@ public:
         }
     };
 
+    // Travel planning data derived from a single layer of a single object.
+    struct LayerData {
+        // Layer this data was built for.
+        const Layer             *layer { nullptr };
+        // Inputs of the data besides the layer slices, used to detect whether another layer produces the same data.
+        float                    external_perimeter_width { 0.f };
+        float                    perimeter_spacing { 0.f };
+        bool                     has_top_surfaces { false };
+        bool                     is_support_layer { false };
+
+        // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
+        ExPolygons               lslices_offset;
+        std::vector<BoundingBox> lslices_offset_bboxes;
+        // Used for detection of line or polyline is inside of any polygon.
+        EdgeGrid::Grid           grid_lslices_offset;
+        // Store all needed data for travels inside object. Built on demand by the first travel, which needs it.
+        Boundary                 internal;
+        bool                     internal_valid { false };
+
+        // Would the layer produce the same data as the layer this data was built for?
+        // Support layers and layers with top surfaces are never shared, as their boundaries depend on more than the slices.
+        bool reusable_for(const Layer &layer) const;
+    };
+
 private:
     bool           m_use_external_mp { false };
     // just for the next travel move
@@ -58,13 +102,15 @@ private:
     // we enable it by default for the first travel move in print
     bool           m_disabled_once { true };
 
-    // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
-    ExPolygons               m_lslices_offset;
-    std::vector<BoundingBox> m_lslices_offset_bboxes;
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid           m_grid_lslices_offset;
-    // Store all needed data for travels inside object
-    Boundary m_internal;
+    // Layer passed to the last init_layer().
+    const Layer             *m_layer { nullptr };
+    // Travel planning data of the active layer.
+    LayerDataPtr             m_layer_data;
+    // Last travel planning data of each object and of its support, kept for reuse by the next layer of that object.
+    // The object layers and the support layers are keyed separately, as they are interleaved.
+    std::map<std::pair<const PrintObject*, bool>, LayerDataPtr> m_last_layer_data;
+    // Travel planning data precomputed for the layers to be printed next.
+    std::vector<LayerDataPtr> m_precomputed_layer_data;
     // Store all needed data for travels outside object
     Boundary m_external;
 };
@@ -8,6 +8,7 @@
 #include <boost/log/trivial.hpp>
 #include <random>
 #include <algorithm>
+#include <array>
 #include <queue>
 
 #include "libslic3r/AABBTreeLines.hpp"
@@ -134,9 +135,9 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
       << " triangles: end";
 
   //prepare uniform samples of a hemisphere
+  constexpr size_t rays_per_sample_point = SeamPlacer::sqr_rays_per_sample_point * SeamPlacer::sqr_rays_per_sample_point;
   float step_size = 1.0f / SeamPlacer::sqr_rays_per_sample_point;
-  std::vector<Vec3f> precomputed_sample_directions(
-      SeamPlacer::sqr_rays_per_sample_point * SeamPlacer::sqr_rays_per_sample_point);
+  std::array<Vec3f, rays_per_sample_point> precomputed_sample_directions;
   for (size_t x_idx = 0; x_idx < SeamPlacer::sqr_rays_per_sample_point; ++x_idx) {
     float sample_x = x_idx * step_size + step_size / 2.0;
     for (size_t y_idx = 0; y_idx < SeamPlacer::sqr_rays_per_sample_point; ++y_idx) {
@@ -154,10 +155,11 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                      &raycasting_tree, &result, &samples](tbb::blocked_range<size_t> r) {
                       // Maintaining hits memory outside of the loop, so it does not have to be reallocated for each query.
                       std::vector<igl::Hit> hits;
+                      std::array<Vec3d, rays_per_sample_point> packet_dirs;
+                      std::array<igl::Hit, rays_per_sample_point> packet_hits;
                       for (size_t s_idx = r.begin(); s_idx < r.end(); ++s_idx) {
                         result[s_idx] = 1.0f;
-                        constexpr float decrease_step = 1.0f
-                                                        / (SeamPlacer::sqr_rays_per_sample_point * SeamPlacer::sqr_rays_per_sample_point);
+                        constexpr float decrease_step = 1.0f / rays_per_sample_point;
 
                         const Vec3f &center = samples.positions[s_idx];
                         const Vec3f &normal = samples.normals[s_idx];
@@ -165,49 +167,57 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                         Frame f;
                         f.set_from_z(normal);
 
+                        if (!model_contains_negative_parts) {
+                          // All rays of a sample share the origin and cover a single hemisphere, thus they are coherent enough
+                          // to be traced through the AABB tree as a single packet.
+                          // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
+                          // direction.
+                          for (size_t dir_idx = 0; dir_idx < rays_per_sample_point; ++dir_idx)
+                            packet_dirs[dir_idx] = f.to_world(precomputed_sample_directions[dir_idx]).cast<double>();
+                          Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                          if (AABBTreeIndirect::intersect_ray_packet_first_hit(triangles.vertices, triangles.indices, raycasting_tree,
+                                                                               ray_origin_d, packet_dirs, packet_hits) > 0) {
+                            for (size_t dir_idx = 0; dir_idx < rays_per_sample_point; ++dir_idx) {
+                              const igl::Hit &hitpoint = packet_hits[dir_idx];
+                              if (hitpoint.id >= 0 && its_face_normal(triangles, hitpoint.id).dot(packet_dirs[dir_idx].cast<float>()) <= 0) {
+                                result[s_idx] -= decrease_step;
+                              }
+                            }
+                          }
+                          continue;
+                        }
+
                         for (const auto &dir : precomputed_sample_directions) {
                           Vec3f final_ray_dir = (f.to_world(dir));
-                          if (!model_contains_negative_parts) {
-                            igl::Hit hitpoint;
-                            // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
-                            // direction.
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            bool hit = AABBTreeIndirect::intersect_ray_first_hit(triangles.vertices,
-                                                                                 triangles.indices, raycasting_tree, ray_origin_d, final_ray_dir_d, hitpoint);
-                            if (hit && its_face_normal(triangles, hitpoint.id).dot(final_ray_dir) <= 0) {
-                              result[s_idx] -= decrease_step;
-                            }
-                          } else { //TODO improve logic for order based boolean operations - consider order of volumes
-                            bool casting_from_negative_volume = samples.triangle_indices[s_idx]
-                                                                >= negative_volumes_start_index;
-
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
-                              final_ray_dir = -1.0 * final_ray_dir;
-                              ray_origin_d = (center - normal * 0.01f).cast<double>();
-                            }
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
-                                                                                     triangles.indices, raycasting_tree,
-                                                                                     ray_origin_d, final_ray_dir_d, hits);
-                            if (some_hit) {
-                              int counter = 0;
-                              // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
-                              //  It cannot be inside model, and it cannot be inside negative volume
-                              for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
-                                Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
-                                if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
-                                  counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
-                                                                                               // which in reverse hit analysis means, that we are entering negative space :) and vice versa
-                                } else {
-                                  counter += sgn(face_normal.dot(final_ray_dir));
-                                }
-                              }
-                              if (counter == 0) {
-                                result[s_idx] -= decrease_step;
+                          //TODO improve logic for order based boolean operations - consider order of volumes
+                          bool casting_from_negative_volume = samples.triangle_indices[s_idx]
+                                                              >= negative_volumes_start_index;
+
+                          Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                          if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
+                            final_ray_dir = -1.0 * final_ray_dir;
+                            ray_origin_d = (center - normal * 0.01f).cast<double>();
+                          }
+                          Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
+                          bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
+                                                                                   triangles.indices, raycasting_tree,
+                                                                                   ray_origin_d, final_ray_dir_d, hits);
+                          if (some_hit) {
+                            int counter = 0;
+                            // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
+                            //  It cannot be inside model, and it cannot be inside negative volume
+                            for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
+                              Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
+                              if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
+                                counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
+                                                                                             // which in reverse hit analysis means, that we are entering negative space :) and vice versa
+                              } else {
+                                counter += sgn(face_normal.dot(final_ray_dir));
                               }
                             }
+                            if (counter == 0) {
+                              result[s_idx] -= decrease_step;
+                            }
                           }
                         }
                       }
@@ -1000,13 +1010,15 @@ void pick_random_seam_point(const std::vector<SeamCandidate> &perimeter_points,
 // Parallel process and extract each perimeter polygon of the given print object.
 // Gather SeamCandidates of each layer into vector and build KDtree over them
 // Store results in the SeamPlacer variables m_seam_per_object
-void SeamPlacer::gather_seam_candidates(const PrintObject *po, const SeamPlacerImpl::GlobalModelInfo &global_model_info) {
+// If compute_visibility is set, visibility of the candidates is calculated in the same pass, while the layer data are hot in cache.
+void SeamPlacer::gather_seam_candidates(const PrintObject *po, const SeamPlacerImpl::GlobalModelInfo &global_model_info,
+                                        bool compute_visibility) {
   using namespace SeamPlacerImpl;
-  PrintObjectSeamData &seam_data = m_seam_per_object.emplace(po, PrintObjectSeamData { }).first->second;
+  PrintObjectSeamData &seam_data = m_seam_per_object.at(po);
   seam_data.layers.resize(po->layer_count());
 
   tbb::parallel_for(tbb::blocked_range<size_t>(0, po->layers().size()),
-                    [po, &global_model_info, &seam_data]
+                    [po, &global_model_info, &seam_data, compute_visibility]
                     (tbb::blocked_range<size_t> r) {
                       for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
                         PrintObjectSeamData::LayerSeams &layer_seams = seam_data.layers[layer_idx];
@@ -1023,34 +1035,26 @@ void SeamPlacer::gather_seam_candidates(const PrintObject *po, const SeamPlacerI
                         seam_data.layers[layer_idx].points_tree =
                             std::make_unique<PrintObjectSeamData::SeamCandidatesTree>(functor,
                                                                                       layer_seams.points.size());
+                        if (compute_visibility) {
+                          for (auto &perimeter_point : layer_seams.points) {
+                            perimeter_point.visibility = global_model_info.calculate_point_visibility(
+                                perimeter_point.position);
+                          }
+                        }
                       }
                     }
   );
 }
 
-void SeamPlacer::calculate_candidates_visibility(const PrintObject *po,
-                                                 const SeamPlacerImpl::GlobalModelInfo &global_model_info) {
-  using namespace SeamPlacerImpl;
-
-  std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
-  tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
-                    [&layers, &global_model_info](tbb::blocked_range<size_t> r) {
-                      for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
-                        for (auto &perimeter_point : layers[layer_idx].points) {
-                          perimeter_point.visibility = global_model_info.calculate_point_visibility(
-                              perimeter_point.position);
-                        }
-                      }
-                    });
-}
-
-void SeamPlacer::calculate_overhangs_and_layer_embedding(const PrintObject *po) {
+// Overhangs and layer embedding only depend on the layer itself and on the layer below, thus the initial seam point
+// is picked in the same pass for all seam preferences except for spNearest (picked in place_seam with actual nozzle position).
+void SeamPlacer::calculate_overhangs_and_pick_seams(const PrintObject *po, const SeamPlacerImpl::SeamComparator &comparator) {
   using namespace SeamPlacerImpl;
   using PerimeterDistancer = AABBTreeLines::LinesDistancer<Linef>;
 
-  std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+  std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.at(po).layers;
   tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
-                    [po, &layers](tbb::blocked_range<size_t> r) {
+                    [po, &layers, &comparator](tbb::blocked_range<size_t> r) {
                       std::unique_ptr<PerimeterDistancer> prev_layer_distancer;
                       if (r.begin() > 0) { // previous layer exists
                         prev_layer_distancer = std::make_unique<PerimeterDistancer>(to_unscaled_linesf(po->layers()[r.begin() - 1]->lslices));
@@ -1088,6 +1092,17 @@ void SeamPlacer::calculate_overhangs_and_layer_embedding(const PrintObject *po)
                         }
 
                         prev_layer_distancer.swap(current_layer_distancer);
+
+                        std::vector<SeamCandidate> &layer_perimeter_points = layer_seams.points;
+                        if (comparator.setup != spNearest) {
+                          for (size_t current = 0; current < layer_perimeter_points.size();
+                               current = layer_perimeter_points[current].perimeter.end_index) {
+                            if (comparator.setup == spRandom)
+                              pick_random_seam_point(layer_perimeter_points, current);
+                            else
+                              pick_seam_point(layer_perimeter_points, current, comparator);
+                          }
+                        }
                       }
                     }
   );
@@ -1246,7 +1261,7 @@ void SeamPlacer::align_seam_points(const PrintObject *po, const SeamPlacerImpl::
 #endif
 
   //gather vector of all seams on the print_object - pair of layer_index and seam__index within that layer
-  const std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
+  const std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object.at(po).layers;
   std::vector<std::pair<size_t, size_t>> seams;
   for (size_t layer_idx = 0; layer_idx < layers.size(); ++layer_idx) {
     const std::vector<SeamCandidate> &layer_perimeter_points = layers[layer_idx].points;
@@ -1417,73 +1432,66 @@ void SeamPlacer::init(const Print &print, std::function<void(void)> throw_if_can
   using namespace SeamPlacerImpl;
   m_seam_per_object.clear();
 
-  for (const PrintObject *po : print.objects()) {
-    throw_if_canceled_func();
-    SeamPosition configured_seam_preference = po->config().seam_position.value;
-    SeamComparator comparator { configured_seam_preference };
+  // Seam placement of one object does not depend on the other objects. Allocate the per object data upfront,
+  // so that the map is not modified while the objects are processed concurrently.
+  for (const PrintObject *po : print.objects())
+    m_seam_per_object.emplace(po, PrintObjectSeamData { });
 
-    {
-      GlobalModelInfo global_model_info { };
-      gather_enforcers_blockers(global_model_info, po);
-      throw_if_canceled_func();
-      if (configured_seam_preference == spAligned || configured_seam_preference == spNearest) {
-        compute_global_occlusion(global_model_info, po, throw_if_canceled_func);
-      }
-      throw_if_canceled_func();
-      BOOST_LOG_TRIVIAL(debug)
-          << "SeamPlacer: gather_seam_candidates: start";
-      gather_seam_candidates(po, global_model_info);
-      BOOST_LOG_TRIVIAL(debug)
-          << "SeamPlacer: gather_seam_candidates: end";
-      throw_if_canceled_func();
-      if (configured_seam_preference == spAligned || configured_seam_preference == spNearest) {
-        BOOST_LOG_TRIVIAL(debug)
-            << "SeamPlacer: calculate_candidates_visibility : start";
-        calculate_candidates_visibility(po, global_model_info);
-        BOOST_LOG_TRIVIAL(debug)
-            << "SeamPlacer: calculate_candidates_visibility : end";
-      }
-    } // destruction of global_model_info (large structure, no longer needed)
+  // The occlusion mesh, its raycasting AABB tree and the visibility samples are large, thus the seam candidates
+  // are gathered one object after the other, each stage running in parallel over the samples or layers, and
+  // the global model info of an object is released before the next object's one is built.
+  for (const PrintObject *po : print.objects()) {
     throw_if_canceled_func();
-    BOOST_LOG_TRIVIAL(debug)
-        << "SeamPlacer: calculate_overhangs and layer embdedding : start";
-    calculate_overhangs_and_layer_embedding(po);
-    BOOST_LOG_TRIVIAL(debug)
-        << "SeamPlacer: calculate_overhangs and layer embdedding: end";
+    const SeamPosition configured_seam_preference = po->config().seam_position.value;
+    GlobalModelInfo global_model_info { };
+    gather_enforcers_blockers(global_model_info, po);
     throw_if_canceled_func();
-    if (configured_seam_preference != spNearest) { // For spNearest, the seam is picked in the place_seam method with actual nozzle position information
-      BOOST_LOG_TRIVIAL(debug)
-          << "SeamPlacer: pick_seam_point : start";
-      //pick seam point
-      std::vector<PrintObjectSeamData::LayerSeams> &layers = m_seam_per_object[po].layers;
-      tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
-                        [&layers, configured_seam_preference, comparator](tbb::blocked_range<size_t> r) {
-                          for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
-                            std::vector<SeamCandidate> &layer_perimeter_points = layers[layer_idx].points;
-                            for (size_t current = 0; current < layer_perimeter_points.size();
-                                 current = layer_perimeter_points[current].perimeter.end_index)
-                              if (configured_seam_preference == spRandom)
-                                pick_random_seam_point(layer_perimeter_points, current);
-                              else
-                                pick_seam_point(layer_perimeter_points, current, comparator);
-                          }
-                        });
-      BOOST_LOG_TRIVIAL(debug)
-          << "SeamPlacer: pick_seam_point : end";
+    const bool compute_visibility = configured_seam_preference == spAligned || configured_seam_preference == spNearest;
+    if (compute_visibility) {
+      compute_global_occlusion(global_model_info, po, throw_if_canceled_func);
     }
     throw_if_canceled_func();
-    if (configured_seam_preference == spAligned || configured_seam_preference == spRear) {
-      BOOST_LOG_TRIVIAL(debug)
-          << "SeamPlacer: align_seam_points : start";
-      align_seam_points(po, comparator);
-      BOOST_LOG_TRIVIAL(debug)
-          << "SeamPlacer: align_seam_points : end";
-    }
+    BOOST_LOG_TRIVIAL(debug)
+        << "SeamPlacer: gather_seam_candidates and visibility: start";
+    gather_seam_candidates(po, global_model_info, compute_visibility);
+    BOOST_LOG_TRIVIAL(debug)
+        << "SeamPlacer: gather_seam_candidates and visibility: end";
+  } // destruction of global_model_info (large structure, no longer needed)
+
+  // Picking and aligning the seams only works on the per object seam data, the objects are processed concurrently.
+  // Each object task runs its per layer stages as nested parallel loops, thus a plate of many small objects
+  // as well as a single tall object keep all the worker threads busy.
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, print.objects().size(), 1),
+                    [this, &print, &throw_if_canceled_func](tbb::blocked_range<size_t> r) {
+                      for (size_t object_idx = r.begin(); object_idx < r.end(); ++object_idx)
+                        pick_and_align_seams(print.objects()[object_idx], throw_if_canceled_func);
+                    });
+}
+
+void SeamPlacer::pick_and_align_seams(const PrintObject *po, const std::function<void(void)> &throw_if_canceled_func) {
+  using namespace SeamPlacerImpl;
+
+  throw_if_canceled_func();
+  SeamPosition configured_seam_preference = po->config().seam_position.value;
+  SeamComparator comparator { configured_seam_preference };
+
+  BOOST_LOG_TRIVIAL(debug)
+      << "SeamPlacer: calculate_overhangs, layer embdedding and pick_seam_point : start";
+  calculate_overhangs_and_pick_seams(po, comparator);
+  BOOST_LOG_TRIVIAL(debug)
+      << "SeamPlacer: calculate_overhangs, layer embdedding and pick_seam_point : end";
+  throw_if_canceled_func();
+  if (configured_seam_preference == spAligned || configured_seam_preference == spRear) {
+    BOOST_LOG_TRIVIAL(debug)
+        << "SeamPlacer: align_seam_points : start";
+    align_seam_points(po, comparator);
+    BOOST_LOG_TRIVIAL(debug)
+        << "SeamPlacer: align_seam_points : end";
+  }
 
 #ifdef DEBUG_FILES
-    debug_export_points(m_seam_per_object[po].layers, po->bounding_box(), comparator);
+  debug_export_points(m_seam_per_object.at(po).layers, po->bounding_box(), comparator);
 #endif
-  }
 }
 
 void SeamPlacer::place_seam(const Layer *layer, ExtrusionLoop &loop,
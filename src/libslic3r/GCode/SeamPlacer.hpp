@@ -145,10 +145,10 @@ public:
 
   void place_seam(const Layer *layer, ExtrusionLoop &loop, const Point &last_pos, float& overhang) const;
 private:
-  void gather_seam_candidates(const PrintObject *po, const SeamPlacerImpl::GlobalModelInfo &global_model_info);
-  void calculate_candidates_visibility(const PrintObject *po,
-                                       const SeamPlacerImpl::GlobalModelInfo &global_model_info);
-  void calculate_overhangs_and_layer_embedding(const PrintObject *po);
+  void pick_and_align_seams(const PrintObject *po, const std::function<void(void)> &throw_if_canceled_func);
+  void gather_seam_candidates(const PrintObject *po, const SeamPlacerImpl::GlobalModelInfo &global_model_info,
+                              bool compute_visibility);
+  void calculate_overhangs_and_pick_seams(const PrintObject *po, const SeamPlacerImpl::SeamComparator &comparator);
   void align_seam_points(const PrintObject *po, const SeamPlacerImpl::SeamComparator &comparator);
   std::vector<std::pair<size_t, size_t>> find_seam_string(const PrintObject *po,
                                                           std::pair<size_t, size_t> start_seam,
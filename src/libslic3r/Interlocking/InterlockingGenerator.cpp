@@ -3,30 +3,22 @@
 
 #include "InterlockingGenerator.hpp"
 
-namespace std {
-template<> struct hash<Slic3r::GridPoint3>
-{
-    size_t operator()(const Slic3r::GridPoint3& pp) const noexcept
-    {
-        static int prime  = 31;
-        int        result = 89;
-        result            = static_cast<int>(result * prime + pp.x());
-        result            = static_cast<int>(result * prime + pp.y());
-        result            = static_cast<int>(result * prime + pp.z());
-        return static_cast<size_t>(result);
-    }
-};
-} // namespace std
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
 
 
 namespace Slic3r {
 
 void InterlockingGenerator::generate_interlocking_structure(PrintObject* print_object)
 {
-    const auto& config = print_object->config();
-    if (!config.interlocking_beam) {
-        return;
+    if (print_object->config().interlocking_beam) {
+        generate_interlocking_structure(print_object, true);
     }
+}
+
+void InterlockingGenerator::generate_interlocking_structure(PrintObject* print_object, bool reuse_shell_voxels)
+{
+    const auto& config = print_object->config();
 
     const float    rotation           = Geometry::deg2rad(config.interlocking_orientation.value);
     const coord_t  beam_layer_count   = config.interlocking_beam_layer_count;
@@ -42,6 +34,11 @@ void InterlockingGenerator::generate_interlocking_structure(PrintObject* print_o
     const coord_t cell_width = beam_width + beam_width;
     const Vec3crd cell_size(cell_width, cell_width, 2 * beam_layer_count);
 
+    // The shell voxels of a region are reused by all its pairs until an interlocking structure modifies its outlines.
+    // Most pairs of a multi-body object don't touch, these only need the voxels of both regions to find out.
+    std::vector<std::unique_ptr<VoxelSet>> shell_voxels(print_object->num_printing_regions());
+
+    // The pairs are processed one after another, each pair modifies the outlines the next pairs of its regions start from.
     for (size_t region_a_index = 0; region_a_index < print_object->num_printing_regions(); region_a_index++) {
         const PrintRegion& region_a      = print_object->printing_region(region_a_index);
         const auto         extruder_nr_a = region_a.extruder(FlowRole::frExternalPerimeter);
@@ -55,7 +52,11 @@ void InterlockingGenerator::generate_interlocking_structure(PrintObject* print_o
 
             InterlockingGenerator gen(*print_object, region_a_index, region_b_index, beam_width, boundary_avoidance, rotation, cell_size, beam_layer_count,
                                       interface_dilation, air_dilation, air_filtering);
-            gen.generateInterlockingStructure();
+            gen.generateInterlockingStructure(shell_voxels);
+            if (!reuse_shell_voxels) {
+                for (std::unique_ptr<VoxelSet>& voxels : shell_voxels)
+                    voxels.reset();
+            }
         }
     }
 }
@@ -82,7 +83,7 @@ std::pair<ExPolygons, ExPolygons> InterlockingGenerator::growBorderAreasPerpendi
     return {from_border_a, from_border_b};
 }
 
-void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>& has_all_meshes) const
+void InterlockingGenerator::handleThinAreas(const VoxelSet& has_all_meshes) const
 {
     const coord_t     number_of_beams_detect = boundary_avoidance;
     const coord_t     number_of_beams_expand = boundary_avoidance - 1;
@@ -105,49 +106,64 @@ void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>
             near_interlock_per_layer[static_cast<size_t>(layer_nr)].push_back(vu.toPolygon(cell));
         }
     }
-    for (auto& near_interlock : near_interlock_per_layer) {
-        near_interlock = offset(union_(closing(near_interlock, rounding_errors)), detect);
-        polygons_rotate(near_interlock, rotation);
-    }
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, near_interlock_per_layer.size()), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++layer_nr) {
+            Polygons& near_interlock = near_interlock_per_layer[layer_nr];
+            near_interlock = offset(union_(closing(near_interlock, rounding_errors)), detect);
+            polygons_rotate(near_interlock, rotation);
+        }
+    });
 
     // Only alter layers when they are present in both meshes, zip should take care if that.
-    for (size_t layer_nr = 0; layer_nr < print_object.layer_count(); layer_nr++){
-        auto       layer   = print_object.get_layer(layer_nr);
-        ExPolygons polys_a = to_expolygons(layer->get_region(region_a_index)->slices.surfaces);
-        ExPolygons polys_b = to_expolygons(layer->get_region(region_b_index)->slices.surfaces);
-
-        const auto [from_border_a, from_border_b] = growBorderAreasPerpendicular(polys_a, polys_b, detect);
-
-        // Get the areas of each mesh that are _not_ thin (large), by performing a morphological open.
-        const ExPolygons large_a = opening_ex(polys_a, detect);
-        const ExPolygons large_b = opening_ex(polys_b, detect);
-
-        // Derive the area that the thin areas need to expand into (so the added areas to the thin strips) from the information we already have.
-        const ExPolygons thin_expansion_a =
-            offset_ex(intersection_ex(intersection_ex(intersection_ex(large_b, offset_ex(diff_ex(polys_a, large_a), expand)),
-                                                      near_interlock_per_layer[layer_nr]),
-                                      from_border_a),
-                      rounding_errors);
-        const ExPolygons thin_expansion_b =
-            offset_ex(intersection_ex(intersection_ex(intersection_ex(large_a, offset_ex(diff_ex(polys_b, large_b), expand)),
-                                                      near_interlock_per_layer[layer_nr]),
-                                      from_border_b),
-                      rounding_errors);
-
-        // Expanded thin areas of the opposing polygon should 'eat into' the larger areas of the polygon,
-        // and conversely, add the expansions to their own thin areas.
-        layer->get_region(region_a_index)->slices.set(closing_ex(diff_ex(union_ex(polys_a, thin_expansion_a), thin_expansion_b), close_gaps), stInternal);
-        layer->get_region(region_b_index)->slices.set(closing_ex(diff_ex(union_ex(polys_b, thin_expansion_b), thin_expansion_a), close_gaps), stInternal);
-    }
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, print_object.layer_count()), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++layer_nr) {
+            auto       layer   = print_object.get_layer(layer_nr);
+            ExPolygons polys_a = to_expolygons(layer->get_region(region_a_index)->slices.surfaces);
+            ExPolygons polys_b = to_expolygons(layer->get_region(region_b_index)->slices.surfaces);
+
+            const auto [from_border_a, from_border_b] = growBorderAreasPerpendicular(polys_a, polys_b, detect);
+
+            // Get the areas of each mesh that are _not_ thin (large), by performing a morphological open.
+            const ExPolygons large_a = opening_ex(polys_a, detect);
+            const ExPolygons large_b = opening_ex(polys_b, detect);
+
+            // Derive the area that the thin areas need to expand into (so the added areas to the thin strips) from the information we already have.
+            const ExPolygons thin_expansion_a =
+                offset_ex(intersection_ex(intersection_ex(intersection_ex(large_b, offset_ex(diff_ex(polys_a, large_a), expand)),
+                                                          near_interlock_per_layer[layer_nr]),
+                                          from_border_a),
+                          rounding_errors);
+            const ExPolygons thin_expansion_b =
+                offset_ex(intersection_ex(intersection_ex(intersection_ex(large_a, offset_ex(diff_ex(polys_b, large_b), expand)),
+                                                          near_interlock_per_layer[layer_nr]),
+                                          from_border_b),
+                          rounding_errors);
+
+            // Expanded thin areas of the opposing polygon should 'eat into' the larger areas of the polygon,
+            // and conversely, add the expansions to their own thin areas.
+            layer->get_region(region_a_index)->slices.set(closing_ex(diff_ex(union_ex(polys_a, thin_expansion_a), thin_expansion_b), close_gaps), stInternal);
+            layer->get_region(region_b_index)->slices.set(closing_ex(diff_ex(union_ex(polys_b, thin_expansion_b), thin_expansion_a), close_gaps), stInternal);
+        }
+    });
 }
 
-void InterlockingGenerator::generateInterlockingStructure() const
+void InterlockingGenerator::generateInterlockingStructure(std::vector<std::unique_ptr<VoxelSet>>& shell_voxels) const
 {
-    std::vector<std::unordered_set<GridPoint3>> voxels_per_mesh = getShellVoxels(interface_dilation);
-
-    std::unordered_set<GridPoint3>& has_any_mesh   = voxels_per_mesh[0];
-    std::unordered_set<GridPoint3>& has_all_meshes = voxels_per_mesh[1];
-    has_any_mesh.merge(has_all_meshes); // perform union and intersection simultaneously. Cannibalizes voxels_per_mesh
+    auto voxelize = [this, &shell_voxels](size_t region) {
+        if (!shell_voxels[region])
+            shell_voxels[region] = std::make_unique<VoxelSet>(getShellVoxels(region, interface_dilation));
+    };
+    tbb::parallel_invoke([&voxelize, this]() { voxelize(region_a_index); }, [&voxelize, this]() { voxelize(region_b_index); });
+
+    // Intersection of the shell voxels of the two meshes.
+    const VoxelSet& voxels_a = *shell_voxels[region_a_index];
+    const VoxelSet& voxels_b = *shell_voxels[region_b_index];
+    const VoxelSet& smaller  = voxels_a.size() < voxels_b.size() ? voxels_a : voxels_b;
+    const VoxelSet& larger   = voxels_a.size() < voxels_b.size() ? voxels_b : voxels_a;
+    VoxelSet        has_all_meshes;
+    for (const GridPoint3& p : smaller)
+        if (larger.contains(p))
+            has_all_meshes.insert(p);
 
     if (has_all_meshes.empty()) {
         return;
@@ -156,7 +172,7 @@ void InterlockingGenerator::generateInterlockingStructure() const
     const std::vector<ExPolygons> layer_regions = computeUnionedVolumeRegions();
 
     if (air_filtering) {
-        std::unordered_set<GridPoint3> air_cells;
+        VoxelSet air_cells;
         addBoundaryCells(layer_regions, air_dilation, air_cells);
 
         for (const GridPoint3& p : air_cells) {
@@ -167,53 +183,66 @@ void InterlockingGenerator::generateInterlockingStructure() const
     }
 
     applyMicrostructureToOutlines(has_all_meshes, layer_regions);
+
+    // The outlines of both regions were modified.
+    shell_voxels[region_a_index].reset();
+    shell_voxels[region_b_index].reset();
 }
 
-std::vector<std::unordered_set<GridPoint3>> InterlockingGenerator::getShellVoxels(const DilationKernel& kernel) const
+VoxelSet InterlockingGenerator::getShellVoxels(const size_t region, const DilationKernel& kernel) const
 {
-    std::vector<std::unordered_set<GridPoint3>> voxels_per_mesh(2);
-
     // mark all cells which contain some boundary
-    for (size_t region_idx = 0; region_idx < 2; region_idx++)
-    {
-        const size_t region = (region_idx == 0) ? region_a_index : region_b_index;
-        std::unordered_set<GridPoint3>& mesh_voxels = voxels_per_mesh[region_idx];
-
-        std::vector<ExPolygons> rotated_polygons_per_layer(print_object.layer_count());
-        for (size_t layer_nr = 0; layer_nr < print_object.layer_count(); layer_nr++)
-        {
+    std::vector<ExPolygons> rotated_polygons_per_layer(print_object.layer_count());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, print_object.layer_count()), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++layer_nr) {
             auto layer = print_object.get_layer(layer_nr);
             rotated_polygons_per_layer[layer_nr] = to_expolygons(layer->get_region(region)->slices.surfaces);
             expolygons_rotate(rotated_polygons_per_layer[layer_nr], rotation);
         }
+    });
 
-        addBoundaryCells(rotated_polygons_per_layer, kernel, mesh_voxels);
-    }
-
-    return voxels_per_mesh;
+    VoxelSet mesh_voxels;
+    addBoundaryCells(rotated_polygons_per_layer, kernel, mesh_voxels);
+    return mesh_voxels;
 }
 
-void InterlockingGenerator::addBoundaryCells(const std::vector<ExPolygons>&  layers,
-                                             const DilationKernel&           kernel,
-                                             std::unordered_set<GridPoint3>& cells) const
+void InterlockingGenerator::addBoundaryCells(const std::vector<ExPolygons>& layers,
+                                             const DilationKernel&          kernel,
+                                             VoxelSet&                      cells) const
 {
-    auto voxel_emplacer = [&cells](GridPoint3 p) {
-        if (p.z() < 0) {
-            return true;
-        }
-        cells.emplace(p);
-        return true;
-    };
-
-    for (size_t layer_nr = 0; layer_nr < layers.size(); layer_nr++) {
-        const coord_t z = static_cast<coord_t>(layer_nr);
-        vu.walkDilatedPolygons(layers[layer_nr], z, kernel, voxel_emplacer);
-        ExPolygons skin = layers[layer_nr];
-        if (layer_nr > 0) {
-            skin = xor_ex(skin, layers[layer_nr - 1]);
+    // The dilated layers overlap, thus the cells of each layer are collected into a set of its own. The sets are merged in the order
+    // of the layers: The iteration order of VoxelSet is the insertion order, which is then the same as if the layers were walked sequentially.
+    std::vector<VoxelSet> cells_per_layer(layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++layer_nr) {
+            VoxelSet& layer_cells    = cells_per_layer[layer_nr];
+            auto      voxel_emplacer = [&layer_cells](GridPoint3 p) {
+                if (p.z() < 0) {
+                    return true;
+                }
+                layer_cells.emplace(p);
+                return true;
+            };
+
+            const coord_t z = static_cast<coord_t>(layer_nr);
+            vu.walkDilatedPolygons(layers[layer_nr], z, kernel, voxel_emplacer);
+            ExPolygons skin = layers[layer_nr];
+            if (layer_nr > 0) {
+                skin = xor_ex(skin, layers[layer_nr - 1]);
+            }
+            skin = opening_ex(skin, cell_size.x() / 2.f); // remove superfluous small areas, which would anyway be included because of walkPolygons
+            vu.walkDilatedAreas(skin, z, kernel, voxel_emplacer);
         }
-        skin = opening_ex(skin, cell_size.x() / 2.f); // remove superfluous small areas, which would anyway be included because of walkPolygons
-        vu.walkDilatedAreas(skin, z, kernel, voxel_emplacer);
+    });
+
+    for (VoxelSet& layer_cells : cells_per_layer) {
+        if (cells.empty())
+            cells = std::move(layer_cells);
+        else
+            for (const GridPoint3& p : layer_cells)
+                cells.insert(p);
+        // Release the memory of the merged layer early.
+        layer_cells = VoxelSet();
     }
 }
 
@@ -223,15 +252,17 @@ std::vector<ExPolygons> InterlockingGenerator::computeUnionedVolumeRegions() con
                                    1; // introduce ghost layer on top for correct skin computation of topmost layer.
     std::vector<ExPolygons> layer_regions(max_layer_count);
 
-    for (size_t layer_nr = 0; layer_nr < max_layer_count - 1; layer_nr++) {
-        auto& layer_region = layer_regions[static_cast<size_t>(layer_nr)];
-        for (size_t region_idx : {region_a_index, region_b_index}) {
-            auto layer = print_object.get_layer(layer_nr);
-            expolygons_append(layer_region, to_expolygons(layer->get_region(region_idx)->slices.surfaces));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, max_layer_count - 1), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++layer_nr) {
+            auto& layer_region = layer_regions[static_cast<size_t>(layer_nr)];
+            for (size_t region_idx : {region_a_index, region_b_index}) {
+                auto layer = print_object.get_layer(layer_nr);
+                expolygons_append(layer_region, to_expolygons(layer->get_region(region_idx)->slices.surfaces));
+            }
+            layer_region = closing_ex(layer_region, ignored_gap_); // Morphological close to merge meshes into single volume
+            expolygons_rotate(layer_region, rotation);
         }
-        layer_region = closing_ex(layer_region, ignored_gap_); // Morphological close to merge meshes into single volume
-        expolygons_rotate(layer_region, rotation);
-    }
+    });
     return layer_regions;
 }
 
@@ -265,8 +296,8 @@ std::vector<std::vector<ExPolygons>> InterlockingGenerator::generateMicrostructu
     return cell_area_per_mesh_per_layer;
 }
 
-void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_set<GridPoint3>& cells,
-                                                          const std::vector<ExPolygons>&        layer_regions) const
+void InterlockingGenerator::applyMicrostructureToOutlines(const VoxelSet&                cells,
+                                                          const std::vector<ExPolygons>& layer_regions) const
 {
     std::vector<std::vector<ExPolygons>> cell_area_per_mesh_per_layer = generateMicrostructure();
 
@@ -300,31 +331,35 @@ void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_s
         }
     }
 
-    for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++) {
-        for (size_t layer_nr = 0; layer_nr < structure_per_layer[mesh_idx].size(); layer_nr++) {
-            ExPolygons& layer_structure = structure_per_layer[mesh_idx][layer_nr];
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, 2 * num_interlocking_layers), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t idx = range.begin(); idx < range.end(); ++idx) {
+            ExPolygons& layer_structure = structure_per_layer[idx / num_interlocking_layers][idx % num_interlocking_layers];
             layer_structure = union_ex(layer_structure);
             expolygons_rotate(layer_structure, unapply_rotation);
         }
-    }
+    });
 
-    for (size_t region_idx = 0; region_idx < 2; region_idx++) {
-        const size_t region = (region_idx == 0) ? region_a_index : region_b_index;
-        for (size_t layer_nr = 0; layer_nr < max_layer_count; layer_nr++) {
+    // The new outlines of both regions are computed from the structure and the combined volume only, the layers are independent.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, max_layer_count), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++layer_nr) {
             ExPolygons layer_outlines = layer_regions[layer_nr];
             expolygons_rotate(layer_outlines, unapply_rotation);
 
-            const ExPolygons areas_here = intersection_ex(structure_per_layer[region_idx][layer_nr / static_cast<size_t>(beam_layer_count)], layer_outlines);
-            const ExPolygons& areas_other = structure_per_layer[!region_idx][layer_nr / static_cast<size_t>(beam_layer_count)];
+            for (size_t region_idx = 0; region_idx < 2; region_idx++) {
+                const size_t region = (region_idx == 0) ? region_a_index : region_b_index;
+
+                const ExPolygons areas_here = intersection_ex(structure_per_layer[region_idx][layer_nr / static_cast<size_t>(beam_layer_count)], layer_outlines);
+                const ExPolygons& areas_other = structure_per_layer[!region_idx][layer_nr / static_cast<size_t>(beam_layer_count)];
 
-            auto       layer  = print_object.get_layer(layer_nr);
-            auto&      slices = layer->get_region(region)->slices;
-            ExPolygons polys  = to_expolygons(slices.surfaces);
-            slices.set(union_ex(diff_ex(polys, areas_other), // reduce layer areas inward with beams from other mesh
-                                areas_here)                  // extend layer areas outward with newly added beams
-                       , stInternal);
+                auto       layer  = print_object.get_layer(layer_nr);
+                auto&      slices = layer->get_region(region)->slices;
+                ExPolygons polys  = to_expolygons(slices.surfaces);
+                slices.set(union_ex(diff_ex(polys, areas_other), // reduce layer areas inward with beams from other mesh
+                                    areas_here)                  // extend layer areas outward with newly added beams
+                           , stInternal);
+            }
         }
-    }
+    });
 }
 
 } // namespace Slic3r
@@ -7,8 +7,22 @@
 #include "../Print.hpp"
 #include "VoxelUtils.hpp"
 
+#include <ankerl/unordered_dense.h>
+
 namespace Slic3r {
 
+struct GridPoint3Hash
+{
+    using is_avalanching = void;
+    uint64_t operator()(const GridPoint3& p) const noexcept
+    {
+        return ankerl::unordered_dense::hash<uint64_t>{}(uint64_t(p.x()) * 0x9E3779B97F4A7C15ull ^ uint64_t(p.y()) * 0xC2B2AE3D27D4EB4Full ^ uint64_t(p.z()));
+    }
+};
+
+// Sparse set of voxels, the grid points are stored in a single contiguous array indexed by an open addressing hash table.
+using VoxelSet = ankerl::unordered_dense::set<GridPoint3, GridPoint3Hash>;
+
 /*!
  * Class for generating an interlocking structure between two adjacent models of a different extruder.
  *
@@ -43,15 +57,26 @@ class InterlockingGenerator
 {
 public:
     /*!
-     * Generate an interlocking structure between each two adjacent meshes.
+     * Generate an interlocking structure between each two adjacent meshes, if enabled by the interlocking_beam option.
      */
     static void generate_interlocking_structure(PrintObject* print_object);
 
+    /*!
+     * Generate an interlocking structure between each two adjacent meshes regardless of the interlocking_beam option.
+     *
+     * \param reuse_shell_voxels Whether the shell voxels of a region are reused by its next pairs until its outlines are modified.
+     * Only disabled by the tests, which compare against voxelizing the regions of each pair again.
+     */
+    static void generate_interlocking_structure(PrintObject* print_object, bool reuse_shell_voxels);
+
 private:
     /*!
      * Generate an interlocking structure between two meshes
+     *
+     * \param[in,out] shell_voxels The shell voxels of each region, computed if missing and reused by the next pairs of a region.
+     * Those of the two regions are reset if their outlines are modified.
      */
-    void generateInterlockingStructure() const;
+    void generateInterlockingStructure(std::vector<std::unique_ptr<VoxelSet>>& shell_voxels) const;
 
     /*!
      * Private class for storing some variables used in the computation of the interlocking structure between two meshes.
@@ -104,16 +129,17 @@ private:
      * Expand the meshes into each other where they need it, namely when a thin strip of material needs to be attached.
      * \param has_all_meshes Only do this special handling if there's actually microstructure nearby that needs to be adhered to.
      */
-    void handleThinAreas(const std::unordered_set<GridPoint3>& has_all_meshes) const;
+    void handleThinAreas(const VoxelSet& has_all_meshes) const;
 
     /*!
-     * Compute the voxels overlapping with the shell of both models.
+     * Compute the voxels overlapping with the shell of a model.
      * This includes the walls, but also top/bottom skin.
      *
+     * \param region The region of the model
      * \param kernel The dilation kernel to give the returned voxel shell more thickness
-     * \return The shell voxels for mesh a and those for mesh b
+     * \return The shell voxels of the region
      */
-    std::vector<std::unordered_set<GridPoint3>> getShellVoxels(const DilationKernel& kernel) const;
+    VoxelSet getShellVoxels(const size_t region, const DilationKernel& kernel) const;
 
     /*!
      * Compute the voxels overlapping with the shell of some layers.
@@ -123,7 +149,7 @@ private:
      * \param kernel The dilation kernel to give the returned voxel shell more thickness
      * \param[out] cells The output cells which elong to the shell
      */
-    void addBoundaryCells(const std::vector<ExPolygons>& layers, const DilationKernel& kernel, std::unordered_set<GridPoint3>& cells) const;
+    void addBoundaryCells(const std::vector<ExPolygons>& layers, const DilationKernel& kernel, VoxelSet& cells) const;
 
     /*!
      * Compute the regions occupied by both models.
@@ -145,7 +171,7 @@ private:
      * \param cells The cells where we want to apply the interlocking structure.
      * \param layer_regions The total volume of the two meshes combined (and small gaps closed)
      */
-    void applyMicrostructureToOutlines(const std::unordered_set<GridPoint3>& cells, const std::vector<ExPolygons>& layer_regions) const;
+    void applyMicrostructureToOutlines(const VoxelSet& cells, const std::vector<ExPolygons>& layer_regions) const;
 
     static const coord_t ignored_gap_ = 100u; //!< Distance between models to be considered next to each other so that an interlocking structure will be generated there
 
@@ -246,6 +246,29 @@ void Layer::make_perimeters()
     BOOST_LOG_TRIVIAL(trace) << "Generating perimeters for layer " << this->id() << " - Done";
 }
 
+void Layer::release_extrusions()
+{
+    for (LayerRegion *layerm : m_regions) {
+        layerm->perimeters.clear();
+        layerm->fills.clear();
+        layerm->thin_fills.clear();
+        layerm->raw_slices = ExPolygons();
+        layerm->fill_expolygons = ExPolygons();
+        layerm->fill_no_overlap_expolygons = ExPolygons();
+        layerm->unsupported_bridge_edges = Polylines();
+    }
+    this->sharp_tails = ExPolygons();
+    this->cantilevers = ExPolygons();
+    this->sharp_tails_height.clear();
+}
+
+void SupportLayer::release_extrusions()
+{
+    Layer::release_extrusions();
+    this->support_fills.clear();
+    this->overhang_areas = ExPolygons();
+}
+
 void Layer::export_region_slices_to_svg(const char *path) const
 {
     BoundingBox bbox;
@@ -196,6 +196,10 @@ public:
 
     // Is there any valid extrusion assigned to this LayerRegion?
     virtual bool            has_extrusions() const { for (auto layerm : m_regions) if (layerm->has_extrusions()) return true; return false; }
+    // Free the extrusions and the intermediate polygons of the regions once the G-code of this layer has been emitted,
+    // see Print::set_release_layers_after_export(). The slices, the fill surfaces and the lslices are kept,
+    // the G-code generator still reads them from the lower layer when planning the travels of the next layer.
+    virtual void            release_extrusions();
 
     //BBS
     void simplify_wall_extrusion_path() { for (auto layerm : m_regions) layerm->simplify_wall_extrusion_entity();}
@@ -283,6 +287,7 @@ public:
 
     // Is there any valid extrusion assigned to this LayerRegion?
     virtual bool                has_extrusions() const { return ! support_fills.empty(); }
+    void                        release_extrusions() override;
 
     // Zero based index of an interface layer, used for alternating direction of interface / contact layers.
     size_t                      interface_id() const { return m_interface_id; }
@@ -480,6 +480,15 @@ CGALMeshPtr clone(const CGALMesh &m)
     return CGALMeshPtr{new CGALMesh{m}};
 }
 
+size_t memory_size(const CGALMesh &m)
+{
+    // A point and an outgoing halfedge per vertex, the next, previous, target vertex and incident face per halfedge,
+    // a halfedge per face.
+    return m.m.number_of_vertices() * (sizeof(_EpicMesh::Point) + sizeof(uint32_t)) +
+           m.m.number_of_halfedges() * 4 * sizeof(uint32_t) +
+           m.m.number_of_faces() * sizeof(uint32_t);
+}
+
 } // namespace cgal
 
 
@@ -497,6 +506,12 @@ struct McutMesh
 void McutMeshDeleter::operator()(McutMesh *ptr) { delete ptr; }
 
 bool empty(const McutMesh &mesh) { return mesh.vertexCoordsArray.empty() || mesh.faceIndicesArray.empty(); }
+McutMeshPtr clone(const McutMesh &mesh) { return McutMeshPtr{new McutMesh{mesh}}; }
+size_t memory_size(const McutMesh &mesh)
+{
+    return mesh.faceSizesArray.capacity() * sizeof(uint32_t) + mesh.faceIndicesArray.capacity() * sizeof(uint32_t) +
+           mesh.vertexCoordsArray.capacity() * sizeof(double);
+}
 void triangle_mesh_to_mcut(const TriangleMesh &src_mesh, McutMesh &srcMesh, const Transform3d &src_nm = Transform3d::Identity())
 {
     // vertices precision convention and copy
@@ -29,6 +29,8 @@ struct CGALMeshDeleter { void operator()(CGALMesh *ptr); };
 using CGALMeshPtr = std::unique_ptr<CGALMesh, CGALMeshDeleter>;
 
 CGALMeshPtr clone(const CGALMesh &m);
+// Estimate of the memory held by the mesh in bytes.
+size_t      memory_size(const CGALMesh &m);
 
 void save_CGALMesh(const std::string& fname, const CGALMesh& cgal_mesh);
 
@@ -80,6 +82,9 @@ struct McutMeshDeleter
 };
 using McutMeshPtr = std::unique_ptr<McutMesh, McutMeshDeleter>;
 bool empty(const McutMesh &mesh);
+McutMeshPtr clone(const McutMesh &mesh);
+// Memory held by the mesh in bytes.
+size_t      memory_size(const McutMesh &mesh);
 
 McutMeshPtr  triangle_mesh_to_mcut(const indexed_triangle_set &M);
 TriangleMesh mcut_to_triangle_mesh(const McutMesh &mcutmesh);
@@ -0,0 +1,95 @@
+#include "MeshProxy.hpp"
+#include "QuadricEdgeCollapse.hpp"
+
+#include <boost/log/trivial.hpp>
+
+namespace Slic3r {
+
+indexed_triangle_set its_make_proxy(indexed_triangle_set its, const MeshProxy::Params &params, std::function<void()> throw_on_cancel)
+{
+    if (its.indices.size() <= params.max_triangles)
+        return its;
+    // The edge collapse does not update the face properties.
+    its.properties.clear();
+    // The quadric error of a vertex sums the squared distances to the planes of all the faces merged into it. A vertex of a closed mesh
+    // starts with about 6 planes, the count grows with the decimation ratio.
+    const float max_distance = float(params.max_relative_error * bounding_box(its).size().norm());
+    const float num_planes   = 6.f * float(its.indices.size()) / float(params.max_triangles);
+    float       max_error    = max_distance * max_distance * num_planes;
+    if (max_error > 0.f)
+        its_quadric_edge_collapse_parallel(its, uint32_t(params.max_triangles), &max_error, std::move(throw_on_cancel));
+    return its;
+}
+
+namespace {
+struct ProxyCanceled {};
+
+// Merge the transformed sources as ModelObject::raw_indexed_triangle_set() does, with the vertex indices of each part offsetted.
+indexed_triangle_set merge_sources(const std::vector<MeshProxy::Source> &sources)
+{
+    size_t num_vertices = 0;
+    size_t num_faces    = 0;
+    for (const MeshProxy::Source &src : sources) {
+        num_vertices += src.mesh->its.vertices.size();
+        num_faces    += src.mesh->its.indices.size();
+    }
+    indexed_triangle_set out;
+    out.vertices.reserve(num_vertices);
+    out.indices.reserve(num_faces);
+    for (const MeshProxy::Source &src : sources) {
+        size_t i = out.vertices.size();
+        size_t j = out.indices.size();
+        its_merge(out, src.mesh->its);
+        for (; i < out.vertices.size(); ++ i)
+            out.vertices[i] = (src.matrix * out.vertices[i].cast<double>()).cast<float>().eval();
+        if (src.matrix.matrix().block<3, 3>(0, 0).determinant() < 0.)
+            for (; j < out.indices.size(); ++ j)
+                std::swap(out.indices[j][0], out.indices[j][1]);
+    }
+    return out;
+}
+}
+
+MeshProxy::MeshProxy(std::vector<Source> sources, const Params &params)
+{
+    m_sources.reserve(sources.size());
+    for (const Source &src : sources) {
+        m_sources.push_back({ src.volume_id, src.mesh, src.matrix });
+        m_source_triangles += src.mesh->its.indices.size();
+    }
+    std::promise<indexed_triangle_set> promise;
+    m_its = promise.get_future().share();
+    // The sources are merged on the background thread as well, the caller only copies the shared pointers to the meshes.
+    m_thread = std::thread([this, sources = std::move(sources), params, promise = std::move(promise)]() mutable {
+        try {
+            indexed_triangle_set its = merge_sources(sources);
+            // Don't keep the source meshes alive while decimating.
+            sources.clear();
+            const size_t triangles = its.indices.size();
+            indexed_triangle_set out = its_make_proxy(std::move(its), params, [this]() { if (m_canceled.load(std::memory_order_relaxed)) throw ProxyCanceled(); });
+            if (out.indices.size() < triangles)
+                BOOST_LOG_TRIVIAL(debug) << "Mesh proxy decimated from " << triangles << " to " << out.indices.size() << " triangles";
+            promise.set_value(std::move(out));
+        } catch (const ProxyCanceled &) {
+            // The proxy is being destroyed, nobody waits for the result.
+            promise.set_value(indexed_triangle_set());
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    });
+}
+
+MeshProxy::~MeshProxy()
+{
+    // The decimation checks the flag every few edge collapses, thus the thread finishes soon.
+    m_canceled.store(true, std::memory_order_relaxed);
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+bool MeshProxy::ready() const
+{
+    return m_its.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+} // namespace Slic3r
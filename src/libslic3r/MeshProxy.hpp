@@ -0,0 +1,78 @@
+#ifndef slic3r_MeshProxy_hpp_
+#define slic3r_MeshProxy_hpp_
+
+#include "TriangleMesh.hpp"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace Slic3r {
+
+// Decimated proxy of a mesh for the queries, which do not need the full resolution, such as the auto orientation
+// and the rotation optimizer. These run their search on the proxy and validate the final pick on the full mesh.
+// The proxy is merged from the transformed model parts and decimated by the quadric edge collapse on a background thread,
+// which is joined when the proxy is destroyed. Meshes, which are already small, are kept as they are.
+class MeshProxy
+{
+public:
+    struct Params
+    {
+        // Meshes with at most this number of triangles are not decimated, the proxy is decimated down to this number of triangles.
+        size_t max_triangles      { 50000 };
+        // Maximum geometric error of the proxy relative to the bounding box diagonal of the mesh, as the root mean square
+        // distance of a proxy vertex to the planes of the source faces merged into it.
+        float  max_relative_error { 0.005f };
+    };
+
+    // Model part, from which the proxy is built.
+    struct Source
+    {
+        size_t                               volume_id;
+        std::shared_ptr<const TriangleMesh>  mesh;
+        Transform3d                          matrix;
+    };
+    // Identifies a source of the proxy without keeping its mesh alive. The weak pointer keeps the control block,
+    // thus a new mesh allocated at the address of a released one does not match.
+    struct SourceKey
+    {
+        size_t                               volume_id;
+        std::weak_ptr<const TriangleMesh>    mesh;
+        Transform3d                          matrix;
+    };
+
+    // Start merging the transformed sources and decimating them on a background thread.
+    MeshProxy(std::vector<Source> sources, const Params &params);
+    explicit MeshProxy(std::vector<Source> sources) : MeshProxy(std::move(sources), Params()) {}
+    // Stops the decimation and waits for the background thread.
+    ~MeshProxy();
+
+    MeshProxy(const MeshProxy &) = delete;
+    MeshProxy& operator=(const MeshProxy &) = delete;
+
+    // The model parts the proxy was built from, see ModelObject::proxy_mesh().
+    const std::vector<SourceKey>& sources() const { return m_sources; }
+    // Is the proxy decimated already?
+    bool                        ready() const;
+    // The proxy mesh. Blocks until the decimation finishes.
+    const indexed_triangle_set& its() const { return m_its.get(); }
+    // Was the mesh decimated, or is the proxy equal to the source mesh? Blocks until the decimation finishes.
+    bool                        decimated() const { return this->its().indices.size() < m_source_triangles; }
+
+private:
+    std::vector<SourceKey>                    m_sources;
+    size_t                                    m_source_triangles { 0 };
+    std::atomic<bool>                         m_canceled { false };
+    std::shared_future<indexed_triangle_set>  m_its;
+    std::thread                               m_thread;
+};
+
+// Decimate a mesh with the quadric edge collapse down to params.max_triangles, stopping early when the error bound is reached.
+// The face properties are not preserved.
+indexed_triangle_set its_make_proxy(indexed_triangle_set its, const MeshProxy::Params &params, std::function<void()> throw_on_cancel = nullptr);
+
+} // namespace Slic3r
+
+#endif // slic3r_MeshProxy_hpp_
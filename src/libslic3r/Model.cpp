@@ -31,6 +31,7 @@
 
 // BBS: for segment
 #include "MeshBoolean.hpp"
+#include "MeshProxy.hpp"
 #include "Format/3mf.hpp"
 
 // Transtltion
@@ -1479,6 +1480,42 @@ indexed_triangle_set ModelObject::raw_indexed_triangle_set() const
 }
 
 
+bool ModelObject::proxy_mesh_matches(const MeshProxy &proxy) const
+{
+    const std::vector<MeshProxy::SourceKey> &sources = proxy.sources();
+    size_t                                   idx     = 0;
+    for (const ModelVolume *v : this->volumes)
+        if (v->is_model_part()) {
+            if (idx == sources.size())
+                return false;
+            const MeshProxy::SourceKey &src = sources[idx ++];
+            if (src.volume_id != v->id().id || src.mesh.lock() != v->get_mesh_shared_ptr() || src.matrix.matrix() != v->get_matrix().matrix())
+                return false;
+        }
+    return idx == sources.size();
+}
+
+std::shared_ptr<const MeshProxy> ModelObject::proxy_mesh() const
+{
+    // May be called from a worker thread, while the UI thread replaces the proxy.
+    std::shared_ptr<const MeshProxy> proxy = std::atomic_load(&m_proxy_mesh);
+    return proxy && this->proxy_mesh_matches(*proxy) ? proxy : nullptr;
+}
+
+void ModelObject::update_proxy_mesh() const
+{
+    std::shared_ptr<const MeshProxy> proxy = std::atomic_load(&m_proxy_mesh);
+    if (proxy && this->proxy_mesh_matches(*proxy))
+        return;
+    // Only the pointers to the meshes are copied here, the meshes are merged on the background thread.
+    std::vector<MeshProxy::Source> sources;
+    for (const ModelVolume *v : this->volumes)
+        if (v->is_model_part())
+            sources.push_back({ v->id().id, v->get_mesh_shared_ptr(), v->get_matrix() });
+    std::atomic_store(&m_proxy_mesh, std::shared_ptr<const MeshProxy>(std::make_shared<MeshProxy>(std::move(sources))));
+}
+
+
 const BoundingBoxf3& ModelObject::raw_mesh_bounding_box() const
 {
     if (! m_raw_mesh_bounding_box_valid) {
@@ -3279,18 +3316,14 @@ void ModelInstance::get_arrange_polygon(void *ap, const Slic3r::DynamicPrintConf
 
 indexed_triangle_set FacetsAnnotation::get_facets(const ModelVolume& mv, EnforcerBlockerType type) const
 {
-    TriangleSelector selector(mv.mesh());
-    // Reset of TriangleSelector is done inside TriangleSelector's constructor, so we don't need it to perform it again in deserialize().
-    selector.deserialize(m_data, false);
-    return selector.get_facets(type);
+    const FacetsPerType &facets = *this->get_facets_per_type(mv, false);
+    return size_t(type) < facets.size() ? facets[size_t(type)] : indexed_triangle_set();
 }
 
 // BBS
 void FacetsAnnotation::get_facets(const ModelVolume& mv, std::vector<indexed_triangle_set>& facets_per_type) const
 {
-    TriangleSelector selector(mv.mesh());
-    selector.deserialize(m_data, false);
-    selector.get_facets(facets_per_type);
+    facets_per_type = *this->get_facets_per_type(mv, false);
 }
 
 void FacetsAnnotation::set_enforcer_block_type_limit(const ModelVolume& mv, EnforcerBlockerType max_type)
@@ -3302,10 +3335,33 @@ void FacetsAnnotation::set_enforcer_block_type_limit(const ModelVolume& mv, Enfo
 
 indexed_triangle_set FacetsAnnotation::get_facets_strict(const ModelVolume& mv, EnforcerBlockerType type) const
 {
-    TriangleSelector selector(mv.mesh());
-    // Reset of TriangleSelector is done inside TriangleSelector's constructor, so we don't need it to perform it again in deserialize().
-    selector.deserialize(m_data, false);
-    return selector.get_facets_strict(type);
+    const FacetsPerType &facets = *this->get_facets_per_type(mv, true);
+    return size_t(type) < facets.size() ? facets[size_t(type)] : indexed_triangle_set();
+}
+
+std::shared_ptr<const FacetsAnnotation::FacetsPerType> FacetsAnnotation::get_facets_per_type(const ModelVolume& mv, bool strict) const
+{
+    // Concurrent callers of the same annotation wait for the first one to extract the facets of the same variant.
+    Cache::Variant              &variant = m_cache->variants[strict];
+    std::scoped_lock<std::mutex> lock(variant.mutex);
+    if (variant.timestamp != this->timestamp() || variant.mesh.lock() != mv.get_mesh_shared_ptr()) {
+        variant.timestamp = this->timestamp();
+        variant.mesh      = mv.get_mesh_shared_ptr();
+        variant.facets.reset();
+    }
+    std::shared_ptr<const FacetsPerType> &facets = variant.facets;
+    if (! facets) {
+        TriangleSelector selector(mv.mesh());
+        // Reset of TriangleSelector is done inside TriangleSelector's constructor, so we don't need it to perform it again in deserialize().
+        selector.deserialize(m_data, false);
+        auto out = std::make_shared<FacetsPerType>();
+        if (strict)
+            selector.get_facets_strict(*out);
+        else
+            selector.get_facets(*out);
+        facets = std::move(out);
+    }
+    return facets;
 }
 
 bool FacetsAnnotation::has_facets(const ModelVolume& mv, EnforcerBlockerType type) const
@@ -3317,7 +3373,8 @@ bool FacetsAnnotation::set(const TriangleSelector& selector)
 {
     TriangleSelector::TriangleSplittingData sel_map = selector.serialize();
     if (sel_map != m_data) {
-        m_data = std::move(sel_map);
+        m_data  = std::move(sel_map);
+        m_cache = std::make_shared<Cache>();
         this->touch();
         return true;
     }
@@ -3328,6 +3385,7 @@ void FacetsAnnotation::reset()
 {
     m_data.triangles_to_split.clear();
     m_data.bitstream.clear();
+    m_cache = std::make_shared<Cache>();
     this->touch();
 }
 
@@ -33,6 +33,7 @@
 #include <vector>
 #include <algorithm>
 #include <functional>
+#include <mutex>
 #include <optional>
 
 namespace cereal {
@@ -48,6 +49,7 @@ namespace Slic3r {
 enum class ConversionType;
 
 class BuildVolume;
+class MeshProxy;
 class Model;
 class ModelInstance;
 class ModelMaterial;
@@ -458,6 +460,14 @@ public:
     TriangleMesh raw_mesh() const;
     // The same as above, but producing a lightweight indexed_triangle_set.
     indexed_triangle_set raw_indexed_triangle_set() const;
+    // Decimated proxy of raw_indexed_triangle_set() for the auto orientation and the rotation optimizer.
+    // The proxy is being built in the background since update_proxy_mesh() was called, MeshProxy::its() blocks until it is ready.
+    // Returns null if there is no proxy or if the volumes changed since it was built. Never starts building a proxy,
+    // thus it is safe to be called from a worker thread.
+    std::shared_ptr<const MeshProxy> proxy_mesh() const;
+    // Start building the proxy mesh on a background thread, if the volumes changed since the proxy was built.
+    // To be called from the UI thread only.
+    void update_proxy_mesh() const;
     // A transformed snug bounding box around the non-modifier object volumes, without the translation applied.
     // This bounding box is only used for the actual slicing.
     const BoundingBoxf3& raw_bounding_box() const;
@@ -639,6 +649,13 @@ private:
     mutable bool          m_raw_bounding_box_valid { false };
     mutable BoundingBoxf3 m_raw_mesh_bounding_box;
     mutable bool          m_raw_mesh_bounding_box_valid { false };
+    // Decimated mesh, shared by the copies of this object.
+    // Accessed with std::atomic_load() / std::atomic_store(), see proxy_mesh().
+    mutable std::shared_ptr<const MeshProxy> m_proxy_mesh;
+
+    // Was the proxy mesh built from the current model part volumes, their meshes and transformations?
+    // Compares the volume ids, the mesh pointers and the matrices, the mesh data is not touched.
+    bool proxy_mesh_matches(const MeshProxy &proxy) const;
 
     // Only use this method if now the source and dest ModelObjects are equal, for example they were synchronized by Print::apply().
     void copy_transformation_caches(const ModelObject &src) {
@@ -651,6 +668,7 @@ private:
         m_raw_bounding_box_valid          = src.m_raw_bounding_box_valid;
         m_raw_mesh_bounding_box           = src.m_raw_mesh_bounding_box;
         m_raw_mesh_bounding_box_valid     = src.m_raw_mesh_bounding_box_valid;
+        m_proxy_mesh                      = std::atomic_load(&src.m_proxy_mesh);
     }
 
     // Called by Print::apply() to set the model pointer after making a copy.
@@ -720,14 +738,21 @@ enum class En3mfType : int {
 
 class FacetsAnnotation final : public ObjectWithTimestamp {
 public:
+    // Facets of all the states, indexed by EnforcerBlockerType.
+    using FacetsPerType = std::vector<indexed_triangle_set>;
+
     // Assign the content if the timestamp differs, don't assign an ObjectID.
-    void assign(const FacetsAnnotation &rhs) { if (! this->timestamp_matches(rhs)) { m_data = rhs.m_data; this->copy_timestamp(rhs); } }
-    void assign(FacetsAnnotation &&rhs) { if (! this->timestamp_matches(rhs)) { m_data = std::move(rhs.m_data); this->copy_timestamp(rhs); } }
+    // The cache of the extracted facets is shared with rhs.
+    void assign(const FacetsAnnotation &rhs) { if (! this->timestamp_matches(rhs)) { m_data = rhs.m_data; m_cache = rhs.m_cache; this->copy_timestamp(rhs); } }
+    void assign(FacetsAnnotation &&rhs) { if (! this->timestamp_matches(rhs)) { m_data = std::move(rhs.m_data); m_cache = std::move(rhs.m_cache); this->copy_timestamp(rhs); } }
     const TriangleSelector::TriangleSplittingData &get_data() const noexcept { return m_data; }
     bool set(const TriangleSelector& selector);
     indexed_triangle_set get_facets(const ModelVolume& mv, EnforcerBlockerType type) const;
     // BBS
     void get_facets(const ModelVolume& mv, std::vector<indexed_triangle_set>& facets_per_type) const;
+    // Facets of all the states, T-joints triangulated if strict. Extracted from the split trees once and cached until the annotation
+    // or the mesh of the volume changes, so that slicing an unchanged painted object again does not rebuild them. Thread safe.
+    std::shared_ptr<const FacetsPerType> get_facets_per_type(const ModelVolume& mv, bool strict) const;
     void set_enforcer_block_type_limit(const ModelVolume& mv, EnforcerBlockerType max_type);
     indexed_triangle_set get_facets_strict(const ModelVolume& mv, EnforcerBlockerType type) const;
     bool has_facets(const ModelVolume& mv, EnforcerBlockerType type) const;
@@ -745,7 +770,8 @@ public:
     // Deserialize triangles one by one, with strictly increasing triangle_id.
     void set_triangle_from_string(int triangle_id, const std::string& str);
     // After deserializing the last triangle, shrink data to fit.
-    void shrink_to_fit() { m_data.triangles_to_split.shrink_to_fit(); m_data.bitstream.shrink_to_fit(); }
+    // The timestamp is not touched while deserializing, drop the facets cached for the previous data.
+    void shrink_to_fit() { m_data.triangles_to_split.shrink_to_fit(); m_data.bitstream.shrink_to_fit(); m_cache = std::make_shared<Cache>(); }
     bool equals(const FacetsAnnotation &other) const;
 
 private:
@@ -772,7 +798,24 @@ private:
         ar(cereal::base_class<ObjectWithTimestamp>(this), m_data);
     }
 
+    // Extracted facets, valid for the timestamp and the mesh they were extracted for.
+    // Shared by the copies of this annotation, replaced when the annotation is modified.
+    struct Cache
+    {
+        // The strict and the not strict facets are extracted independently, each under its own lock.
+        struct Variant
+        {
+            std::mutex                           mutex;
+            Timestamp                            timestamp { 0 };
+            std::weak_ptr<const TriangleMesh>    mesh;
+            std::shared_ptr<const FacetsPerType> facets;
+        };
+        // Not strict, strict.
+        Variant variants[2];
+    };
+
     TriangleSelector::TriangleSplittingData m_data;
+    std::shared_ptr<Cache>                  m_cache { std::make_shared<Cache>() };
 
     // To access set_new_unique_id() when copy / pasting a ModelVolume.
     friend class ModelVolume;
@@ -11,7 +11,9 @@
 #include <utility>
 #include <unordered_set>
 
+#include <boost/container/small_vector.hpp>
 #include <boost/log/trivial.hpp>
+#include <tbb/enumerable_thread_specific.h>
 #include <tbb/parallel_for.h>
 #include <mutex>
 #include <boost/thread/lock_guard.hpp>
@@ -73,8 +75,9 @@ struct MMU_Graph
 
     struct Node
     {
-        Vec2d             point;
-        std::list<size_t> arc_idxs;
+        Vec2d point;
+        // Voronoi vertices have three arcs, the points of the input polygons rarely more than four.
+        boost::container::small_vector<size_t, 4> arc_idxs;
 
         void remove_edge(const size_t to_idx, MMU_Graph &graph)
         {
@@ -104,6 +107,16 @@ struct MMU_Graph
 
     [[nodiscard]] size_t get_global_index(const size_t poly_idx, const size_t point_idx) const { return polygon_idx_offset[poly_idx] + point_idx; }
 
+    // Keeps the allocated memory to be reused for the next layer.
+    void clear()
+    {
+        this->nodes.clear();
+        this->arcs.clear();
+        this->all_border_points = 0;
+        this->polygon_idx_offset.clear();
+        this->polygon_sizes.clear();
+    }
+
     void append_edge(const size_t &from_idx, const size_t &to_idx, int color = -1, ARC_TYPE type = ARC_TYPE::NON_BORDER)
     {
         // Don't append duplicate edges between the same nodes.
@@ -159,9 +172,9 @@ struct MMU_Graph
     void add_contours(const std::vector<std::vector<ColoredLine>> &color_poly)
     {
         this->all_border_points = nodes.size();
-        this->polygon_sizes     = std::vector<size_t>(color_poly.size());
+        this->polygon_sizes.assign(color_poly.size(), 0);
         for (size_t polygon_idx = 0; polygon_idx < color_poly.size(); ++polygon_idx) this->polygon_sizes[polygon_idx] = color_poly[polygon_idx].size();
-        this->polygon_idx_offset    = std::vector<size_t>(color_poly.size());
+        this->polygon_idx_offset.assign(color_poly.size(), 0);
         this->polygon_idx_offset[0] = 0;
         for (size_t polygon_idx = 1; polygon_idx < color_poly.size(); ++polygon_idx) {
             this->polygon_idx_offset[polygon_idx] = this->polygon_idx_offset[polygon_idx - 1] + color_poly[polygon_idx - 1].size();
@@ -1347,57 +1360,99 @@ static inline std::vector<std::vector<ExPolygons>> mmu_segmentation_top_and_bott
 #endif // MM_SEGMENTATION_DEBUG_TOP_BOTTOM
 
     if (max_top_layers > 0 || max_bottom_layers > 0) {
+        // Patches painted by a single extruder on a single volume, projected concurrently.
+        struct PaintedPatch
+        {
+            const indexed_triangle_set *painted;
+            Transform3d                 trafo;
+            size_t                      extruder_idx;
+            std::vector<Polygons>       top;
+            std::vector<Polygons>       bottom;
+            bool                        sliced { false };
+        };
+        // Projections of an extruder merged in the order of the volumes: A finished patch is merged together with the finished patches
+        // following it, thus only the projections finished ahead of their turn are kept until merged.
+        struct ExtruderPatches
+        {
+            std::mutex          mutex;
+            std::vector<size_t> patch_idxs;
+            size_t              next_to_merge { 0 };
+        };
+        std::vector<std::shared_ptr<const FacetsAnnotation::FacetsPerType>> painted_per_volume;
+        std::vector<PaintedPatch>                                           patches;
+        std::vector<ExtruderPatches>                                        extruder_patches(num_extruders);
         for (const ModelVolume *mv : print_object.model_object()->volumes)
             if (mv->is_model_part()) {
                 const Transform3d volume_trafo = object_trafo * mv->get_matrix();
-                for (size_t extruder_idx = 0; extruder_idx < num_extruders; ++ extruder_idx) {
-                    const indexed_triangle_set painted = mv->mmu_segmentation_facets.get_facets_strict(*mv, EnforcerBlockerType(extruder_idx));
-#ifdef MM_SEGMENTATION_DEBUG_TOP_BOTTOM
-                    {
-                        static int iRun = 0;
-                        its_write_obj(painted, debug_out_path("mm-painted-patch-%d-%d.obj", iRun ++, extruder_idx).c_str());
+                const auto       &painted_per_type = painted_per_volume.emplace_back(mv->mmu_segmentation_facets.get_facets_per_type(*mv, true));
+                for (size_t extruder_idx = 0; extruder_idx < num_extruders && extruder_idx < painted_per_type->size(); ++ extruder_idx)
+                    if (const indexed_triangle_set &painted = (*painted_per_type)[extruder_idx]; ! painted.indices.empty()) {
+                        extruder_patches[extruder_idx].patch_idxs.emplace_back(patches.size());
+                        patches.push_back({ &painted, volume_trafo, extruder_idx, {}, {} });
                     }
+            }
+
+        auto merge = [](std::vector<Polygons> &&src, std::vector<Polygons> &dst) {
+            auto it_src = find_if(src.begin(), src.end(), [](const Polygons &p){ return ! p.empty(); });
+            if (it_src != src.end()) {
+                if (dst.empty()) {
+                    dst = std::move(src);
+                } else {
+                    assert(src.size() == dst.size());
+                    auto it_dst = dst.begin() + (it_src - src.begin());
+                    for (; it_src != src.end(); ++ it_src, ++ it_dst)
+                        if (! it_src->empty()) {
+                            if (it_dst->empty())
+                                *it_dst = std::move(*it_src);
+                            else
+                                append(*it_dst, std::move(*it_src));
+                        }
+                }
+            }
+            // Release the emptied layers.
+            std::vector<Polygons>().swap(src);
+        };
+
+        // slice_mesh_slabs() is parallel over the layers, the patches are usually small though and its setup is serial.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, patches.size(), 1), [&patches, &extruder_patches, &top_raw, &bottom_raw, &merge, &zs, max_top_layers, max_bottom_layers, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+            for (size_t patch_idx = range.begin(); patch_idx < range.end(); ++ patch_idx) {
+                PaintedPatch               &patch   = patches[patch_idx];
+                const indexed_triangle_set &painted = *patch.painted;
+                std::vector<Polygons>      &top     = patch.top;
+                std::vector<Polygons>      &bottom  = patch.bottom;
+#ifdef MM_SEGMENTATION_DEBUG_TOP_BOTTOM
+                {
+                    static int iRun = 0;
+                    its_write_obj(painted, debug_out_path("mm-painted-patch-%d-%d.obj", iRun ++, patch.extruder_idx).c_str());
+                }
 #endif // MM_SEGMENTATION_DEBUG_TOP_BOTTOM
-                    if (! painted.indices.empty()) {
-                        std::vector<Polygons> top, bottom;
-                        if (!zs.empty() && is_volume_sinking(painted, volume_trafo)) {
-                            std::vector<float> zs_sinking = {0.f};
-                            Slic3r::append(zs_sinking, zs);
-                            slice_mesh_slabs(painted, zs_sinking, volume_trafo, max_top_layers > 0 ? &top : nullptr, max_bottom_layers > 0 ? &bottom : nullptr, throw_on_cancel_callback);
-
-                            MeshSlicingParams slicing_params;
-                            slicing_params.trafo = volume_trafo;
-                            Polygons bottom_slice = slice_mesh(painted, zs[0], slicing_params);
-
-                            top.erase(top.begin());
-                            bottom.erase(bottom.begin());
-
-                            bottom[0] = union_(bottom[0], bottom_slice);
-                        } else
-                            slice_mesh_slabs(painted, zs, volume_trafo, max_top_layers > 0 ? &top : nullptr, max_bottom_layers > 0 ? &bottom : nullptr, throw_on_cancel_callback);
-                        auto merge = [](std::vector<Polygons> &&src, std::vector<Polygons> &dst) {
-                            auto it_src = find_if(src.begin(), src.end(), [](const Polygons &p){ return ! p.empty(); });
-                            if (it_src != src.end()) {
-                                if (dst.empty()) {
-                                    dst = std::move(src);
-                                } else {
-                                    assert(src.size() == dst.size());
-                                    auto it_dst = dst.begin() + (it_src - src.begin());
-                                    for (; it_src != src.end(); ++ it_src, ++ it_dst)
-                                        if (! it_src->empty()) {
-                                            if (it_dst->empty())
-                                                *it_dst = std::move(*it_src);
-                                            else
-                                                append(*it_dst, std::move(*it_src));
-                                        }
-                                }
-                            }
-                        };
-                        merge(std::move(top),    top_raw[extruder_idx]);
-                        merge(std::move(bottom), bottom_raw[extruder_idx]);
-                    }
+                if (!zs.empty() && is_volume_sinking(painted, patch.trafo)) {
+                    std::vector<float> zs_sinking = {0.f};
+                    Slic3r::append(zs_sinking, zs);
+                    slice_mesh_slabs(painted, zs_sinking, patch.trafo, max_top_layers > 0 ? &top : nullptr, max_bottom_layers > 0 ? &bottom : nullptr, throw_on_cancel_callback);
+
+                    MeshSlicingParams slicing_params;
+                    slicing_params.trafo = patch.trafo;
+                    Polygons bottom_slice = slice_mesh(painted, zs[0], slicing_params);
+
+                    top.erase(top.begin());
+                    bottom.erase(bottom.begin());
+
+                    bottom[0] = union_(bottom[0], bottom_slice);
+                } else
+                    slice_mesh_slabs(painted, zs, patch.trafo, max_top_layers > 0 ? &top : nullptr, max_bottom_layers > 0 ? &bottom : nullptr, throw_on_cancel_callback);
+
+                // Merge this patch and the finished patches following it.
+                ExtruderPatches            &extruder = extruder_patches[patch.extruder_idx];
+                std::lock_guard<std::mutex> lock(extruder.mutex);
+                patch.sliced = true;
+                for (; extruder.next_to_merge < extruder.patch_idxs.size() && patches[extruder.patch_idxs[extruder.next_to_merge]].sliced; ++ extruder.next_to_merge) {
+                    PaintedPatch &finished = patches[extruder.patch_idxs[extruder.next_to_merge]];
+                    merge(std::move(finished.top),    top_raw[patch.extruder_idx]);
+                    merge(std::move(finished.bottom), bottom_raw[patch.extruder_idx]);
                 }
             }
+        });
     }
 
     auto filter_out_small_polygons = [&num_extruders, &num_layers](std::vector<std::vector<Polygons>> &raw_surfaces, double min_area) -> void {
@@ -1660,7 +1715,8 @@ static inline Line clip_finite_voronoi_edge(const Voronoi::VD::edge_type &edge,
 
 static inline bool has_same_color(const ColoredLine &cl1, const ColoredLine &cl2) { return cl1.color == cl2.color; }
 
-static MMU_Graph build_graph(size_t layer_idx, const std::vector<std::vector<ColoredLine>> &color_poly)
+// The graph is cleared first, its memory is reused.
+static void build_graph(size_t layer_idx, const std::vector<std::vector<ColoredLine>> &color_poly, MMU_Graph &graph)
 {
     const Polygons color_poly_tmp = colored_points_to_polygon(color_poly);
     const Points   points         = to_points(color_poly_tmp);
@@ -1690,7 +1746,7 @@ static MMU_Graph build_graph(size_t layer_idx, const std::vector<std::vector<Col
     Voronoi::VD vd;
     vd.construct_voronoi(colored_lines.begin(), colored_lines.end());
     // boost::polygon::construct_voronoi(lines_colored.begin(), lines_colored.end(), &vd);
-    MMU_Graph graph;
+    graph.clear();
     graph.nodes.reserve(points.size() + vd.vertices().size());
     for (const Point &point : points) graph.nodes.push_back({Vec2d(double(point.x()), double(point.y()))});
 
@@ -1874,7 +1930,6 @@ static MMU_Graph build_graph(size_t layer_idx, const std::vector<std::vector<Col
     }
 
     graph.remove_nodes_with_one_arc();
-    return graph;
 }
 
 static std::vector<std::vector<std::pair<size_t, size_t>>> get_all_segments(const std::vector<std::vector<ColoredLine>> &color_poly)
@@ -1887,12 +1942,16 @@ static std::vector<std::vector<std::pair<size_t, size_t>>> get_all_segments(cons
     return all_segments;
 }
 
-static inline double compute_edge_length(const MMU_Graph &graph, const size_t start_idx, const size_t &start_arc_idx)
+// used_arcs is a scratch buffer of graph.arcs.size() items, all false on input and on output.
+// used_arc_idxs is a scratch buffer to reset used_arcs.
+static inline double compute_edge_length(const MMU_Graph &graph, const size_t start_idx, const size_t &start_arc_idx, std::vector<bool> &used_arcs, std::vector<size_t> &used_arc_idxs)
 {
     assert(start_arc_idx < graph.arcs.size());
-    std::vector<bool> used_arcs(graph.arcs.size(), false);
+    assert(used_arcs.size() == graph.arcs.size());
+    assert(used_arc_idxs.empty());
 
     used_arcs[start_arc_idx]                = true;
+    used_arc_idxs.emplace_back(start_arc_idx);
     const MMU_Graph::Arc *arc               = &graph.arcs[start_arc_idx];
     size_t                idx               = start_idx;
     double                line_total_length = (graph.nodes[arc->to_idx].point - graph.nodes[idx].point).norm();
@@ -1917,6 +1976,7 @@ static inline double compute_edge_length(const MMU_Graph &graph, const size_t st
 
                 line_total_length += (graph.nodes[arc->to_idx].point - graph.nodes[idx].point).norm();
                 used_arcs[arc_idx] = true;
+                used_arc_idxs.emplace_back(arc_idx);
                 found              = true;
                 break;
             }
@@ -1924,12 +1984,18 @@ static inline double compute_edge_length(const MMU_Graph &graph, const size_t st
         if (!found) break;
     }
 
+    for (size_t arc_idx : used_arc_idxs)
+        used_arcs[arc_idx] = false;
+    used_arc_idxs.clear();
     return line_total_length;
 }
 
 static void remove_multiple_edges_in_vertices(MMU_Graph &graph, const std::vector<std::vector<ColoredLine>> &color_poly)
 {
     std::vector<std::vector<std::pair<size_t, size_t>>> colored_segments = get_all_segments(color_poly);
+    // Scratch buffers of compute_edge_length().
+    std::vector<bool>   used_arcs(graph.arcs.size(), false);
+    std::vector<size_t> used_arc_idxs;
     for (const std::vector<std::pair<size_t, size_t>> &colored_segment_p : colored_segments) {
         size_t poly_idx = &colored_segment_p - &colored_segments.front();
         for (const std::pair<size_t, size_t> &colored_segment : colored_segment_p) {
@@ -1942,7 +2008,7 @@ static void remove_multiple_edges_in_vertices(MMU_Graph &graph, const std::vecto
                 for (const size_t &arc_idx : graph.nodes[first_idx].arc_idxs) {
                     MMU_Graph::Arc &n_arc = graph.arcs[arc_idx];
                     if (n_arc.type == MMU_Graph::ARC_TYPE::NON_BORDER) {
-                        double total_len = compute_edge_length(graph, first_idx, arc_idx);
+                        double total_len = compute_edge_length(graph, first_idx, arc_idx, used_arcs, used_arc_idxs);
                         arc_to_check.emplace_back(&n_arc, total_len);
                     }
                 }
@@ -2156,11 +2222,15 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
 
     BOOST_LOG_TRIVIAL(debug) << "MM segmentation - projection of painted triangles - begin";
     for (const ModelVolume *mv : print_object.model_object()->volumes) {
-        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_extruders + 1), [&mv, &print_object, &layers, &edge_grids, &painted_lines, &painted_lines_mutex, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        if (!mv->is_model_part())
+            continue;
+        // Extracted once for all the extruders.
+        const auto custom_facets_per_type = mv->mmu_segmentation_facets.get_facets_per_type(*mv, false);
+        tbb::parallel_for(tbb::blocked_range<size_t>(1, std::min(num_extruders + 1, custom_facets_per_type->size())), [&mv, &custom_facets_per_type, &print_object, &layers, &edge_grids, &painted_lines, &painted_lines_mutex, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
             for (size_t extruder_idx = range.begin(); extruder_idx < range.end(); ++extruder_idx) {
                 throw_on_cancel_callback();
-                const indexed_triangle_set custom_facets = mv->mmu_segmentation_facets.get_facets(*mv, EnforcerBlockerType(extruder_idx));
-                if (!mv->is_model_part() || custom_facets.indices.empty())
+                const indexed_triangle_set &custom_facets = (*custom_facets_per_type)[extruder_idx];
+                if (custom_facets.indices.empty())
                     continue;
 
                 const Transform3f tr = print_object.trafo().cast<float>() * mv->get_matrix().cast<float>();
@@ -2250,7 +2320,9 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
                              << std::count_if(painted_lines.begin(), painted_lines.end(), [](const std::vector<PaintedLine> &pl) { return !pl.empty(); });
 
     BOOST_LOG_TRIVIAL(debug) << "MM segmentation - layers segmentation in parallel - begin";
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_extruders, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+    // The graphs of the layers are built into a per thread instance, reusing the memory of the previous layer.
+    tbb::enumerable_thread_specific<MMU_Graph> graphs;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_extruders, &graphs, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
         for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
             throw_on_cancel_callback();
             if (!painted_lines[layer_idx].empty()) {
@@ -2276,7 +2348,8 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
                     // If the whole layer is painted using the same color, it is not needed to construct a Voronoi diagram for the segmentation of this layer.
                     segmented_regions[layer_idx][size_t(color_poly.front().front().color)] = input_expolygons[layer_idx];
                 } else {
-                    MMU_Graph graph = build_graph(layer_idx, color_poly);
+                    MMU_Graph &graph = graphs.local();
+                    build_graph(layer_idx, color_poly, graph);
                     remove_multiple_edges_in_vertices(graph, color_poly);
                     graph.remove_nodes_with_one_arc();
                     segmented_regions[layer_idx] = extract_colored_segments(graph, num_extruders);
@@ -1,5 +1,7 @@
 #include "Orient.hpp"
 #include "Geometry.hpp"
+#include <atomic>
+#include <limits>
 #include <numeric>
 #include <ClipperUtils.hpp>
 #include <boost/geometry/index/rtree.hpp>
@@ -43,7 +45,7 @@ namespace orientation {
         static std::string field_names() {
             return "                                      overhang, bottom, bothull, contour, A_laf, A_prj, unprintability";
         }
-        std::string field_values() {
+        std::string field_values() const {
             std::stringstream ss;
             ss << std::fixed << std::setprecision(1);
             ss << overhang << ",\t" << bottom << ",\t" << bottom_hull << ",\t" << contour << ",\t" << area_laf << ",\t" << area_projected << ",\t" << unprintability;
@@ -61,29 +63,40 @@ public:
     OrientMesh *orient_mesh = NULL;
     TriangleMesh* mesh;
     TriangleMesh mesh_convex_hull;
-    Eigen::MatrixXf normals, normals_quantize, normals_hull, normals_hull_quantize;
+    Eigen::MatrixXf normals_quantize, normals_hull_quantize;
     Eigen::VectorXf areas, areas_hull;
-    Eigen::VectorXf is_apperance; // whether a facet is outer apperance
-    Eigen::MatrixXf z_projected;
-    Eigen::VectorXf z_max, z_max_hull;  // max of projected z
-    Eigen::VectorXf z_median;  // median of projected z
-    Eigen::VectorXf z_mean;  // mean of projected z
     std::vector<Vec3f> face_normals;
     std::vector<Vec3f> face_normals_hull;
     OrientParams params;
 
+    // The candidate orientations are evaluated by plain loops over structures of arrays, which the compiler vectorizes.
+    // Vertices of the mesh and of its convex hull.
+    std::vector<float> vertices_x, vertices_y, vertices_z;
+    std::vector<float> vertices_hull_x, vertices_hull_y, vertices_hull_z;
+    // Face normals of the mesh.
+    std::vector<float> normals_x, normals_y, normals_z;
+    // Face areas of the mesh, the areas of the outer appearance faces are increased by the penalty of supporting them.
+    std::vector<float> areas_appearance;
+    // Features not depending on the orientation.
+    float area_total { 0.f };
+    float radius { 0.f };
+    float volume { 0.f };
 
     std::vector< Vec3f> orientations;  // Vec3f == stl_normal
+    // Reject the candidates, which are known to be worse than the best one before they are fully evaluated.
+    bool early_rejection { true };
     std::function<void(unsigned)> progressind = { };  // default empty indicator function
 
 public:
     AutoOrienter(OrientMesh* orient_mesh_,
                  const OrientParams           &params_,
                  std::function<void(unsigned)> progressind_,
-                 std::function<bool(void)>     stopcond_)
+                 std::function<bool(void)>     stopcond_,
+                 // Mesh to be evaluated instead of orient_mesh_->mesh, i.e. its proxy.
+                 TriangleMesh                 *mesh_ = nullptr)
     {
         orient_mesh = orient_mesh_;
-        mesh = &orient_mesh->mesh;
+        mesh = mesh_ ? mesh_ : &orient_mesh->mesh;
         params = params_;
         progressind = progressind_;
         params.ASCENT = cos(PI - orient_mesh->overhang_angle * PI / 180); // use per-object overhang angle
@@ -102,7 +115,8 @@ public:
 
     struct VecHash {
         size_t operator()(const Vec3f& n1) const {
-            return std::hash<coord_t>()(int(n1(0)*100+100)) + std::hash<coord_t>()(int(n1(1)*100+100)) * 101 + std::hash<coord_t>()(int(n1(2)*100+100)) * 10221;
+            // Same resolution as quantize_vec3f(), so that the quantized normals rarely collide.
+            return std::hash<coord_t>()(int(n1(0)*1000+1000)) + std::hash<coord_t>()(int(n1(1)*1000+1000)) * 2003 + std::hash<coord_t>()(int(n1(2)*1000+1000)) * 4012009;
         }
     };
 
@@ -110,7 +124,47 @@ public:
         return Vec3f(floor(n1(0) * 1000) / 1000, floor(n1(1) * 1000) / 1000, floor(n1(2) * 1000) / 1000);
     }
 
+    // Scratch buffers of a single candidate evaluation, reused by the candidates evaluated by the same task.
+    struct Workspace {
+        std::vector<float> vertex_z;
+        std::vector<float> vertex_z_hull;
+        std::vector<float> z_max;       // max of projected z per face
+        std::vector<float> z_mean;      // mean of projected z per face
+        std::vector<float> z_max_hull;
+    };
+
+    typedef std::pair<Vec3f, CostItems> PAIR;
+
     Vec3d process()
+    {
+        generate_candidates();
+        return pick_best(evaluate_candidates());
+    }
+
+    // Evaluate just the given candidates and the original orientation, for example the best candidates found on a proxy of the mesh.
+    Vec3d process(const std::vector<Vec3f> &candidates)
+    {
+        orientations = { { 0,0,-1 } }; // original orientation
+        for (const Vec3f &candidate : candidates)
+            orientations.emplace_back(-candidate);
+        remove_duplicates();
+        return pick_best(evaluate_candidates());
+    }
+
+    // Search the candidates and return up to count of the best ones, best first.
+    std::vector<Vec3f> best_candidates(size_t count)
+    {
+        generate_candidates();
+        // All the candidates need to be evaluated to rank them.
+        early_rejection = false;
+        std::vector<PAIR> results_vector = evaluate_candidates();
+        std::vector<Vec3f> out;
+        for (size_t i = 0; i < std::min(count, results_vector.size()); ++ i)
+            out.emplace_back(results_vector[i].first);
+        return out;
+    }
+
+    void generate_candidates()
     {
         orientations = { { 0,0,-1 } }; // original orientation
 
@@ -127,34 +181,57 @@ public:
 
         if (progressind)
             progressind(30);
+    }
+
+    // Evaluate the candidates, returns the ones not rejected sorted by their unprintability.
+    std::vector<PAIR> evaluate_candidates()
+    {
+        // The candidates are evaluated in parallel. A candidate is rejected as soon as the lower bound of its cost exceeds the cost
+        // of the best candidate evaluated so far. Candidates within EPSILON of the best one are always evaluated, as they are needed
+        // to avoid flipping below.
+        std::vector<CostItems> costs(orientations.size());
+        std::vector<char>      rejected(orientations.size(), false);
+        std::atomic<float>     best_cost(std::numeric_limits<float>::max());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, orientations.size(), 1), [this, &costs, &rejected, &best_cost](const tbb::blocked_range<size_t> &range) {
+            Workspace workspace;
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                const float reject_above = early_rejection ? best_cost.load(std::memory_order_relaxed) : std::numeric_limits<float>::max();
+                if (! get_features(-orientations[i], params.min_volume, reject_above == std::numeric_limits<float>::max() ? reject_above : reject_above + float(EPSILON), workspace, costs[i])) {
+                    rejected[i] = true;
+                    continue;
+                }
+                float cost = target_function(costs[i], params.min_volume);
+                for (float best = best_cost.load(std::memory_order_relaxed); cost < best && ! best_cost.compare_exchange_weak(best, cost, std::memory_order_relaxed);) ;
+            }
+        });
 
-        std::unordered_map<Vec3f, CostItems, VecHash> results;
         BOOST_LOG_TRIVIAL(info) << CostItems::field_names();
         std::cout << CostItems::field_names() << std::endl;
-        for (int i = 0; i < orientations.size();i++) {
+        std::vector<PAIR> results_vector;
+        results_vector.reserve(orientations.size());
+        for (size_t i = 0; i < orientations.size(); ++ i) {
             auto orientation = -orientations[i];
-
-            project_vertices(orientation);
-
-            auto cost_items = get_features(orientation, params.min_volume);
-
-            float unprintability = target_function(cost_items, params.min_volume);
-
-            results[orientation] = cost_items;
-
-            BOOST_LOG_TRIVIAL(info) << std::fixed << std::setprecision(4) << "orientation:" << orientation.transpose() << ", cost:" << std::fixed << std::setprecision(4) << cost_items.field_values();
-            std::cout << std::fixed << std::setprecision(4) << "orientation:" << orientation.transpose() << ", cost:" << std::fixed << std::setprecision(4) << cost_items.field_values() << std::endl;
+            if (rejected[i]) {
+                BOOST_LOG_TRIVIAL(info) << std::fixed << std::setprecision(4) << "orientation:" << orientation.transpose() << ", rejected";
+                continue;
+            }
+            results_vector.emplace_back(orientation, costs[i]);
+            BOOST_LOG_TRIVIAL(info) << std::fixed << std::setprecision(4) << "orientation:" << orientation.transpose() << ", cost:" << std::fixed << std::setprecision(4) << costs[i].field_values();
+            std::cout << std::fixed << std::setprecision(4) << "orientation:" << orientation.transpose() << ", cost:" << std::fixed << std::setprecision(4) << costs[i].field_values() << std::endl;
         }
         if (progressind)
             progressind(60);
 
-        typedef std::pair<Vec3f, CostItems> PAIR;
-        std::vector<PAIR> results_vector(results.begin(), results.end());
-        sort(results_vector.begin(), results_vector.end(), [](const PAIR& p1, const PAIR& p2) {return p1.second.unprintability < p2.second.unprintability; });
+        std::stable_sort(results_vector.begin(), results_vector.end(), [](const PAIR& p1, const PAIR& p2) {return p1.second.unprintability < p2.second.unprintability; });
 
         if (progressind)
             progressind(80);
 
+        return results_vector;
+    }
+
+    Vec3d pick_best(const std::vector<PAIR> &results_vector)
+    {
         //To avoid flipping, we need to verify if there are orientations with same unprintability.
         Vec3f n1 = {0, 0, 1};
         auto best_orientation = results_vector[0].first;
@@ -178,26 +255,44 @@ public:
         return best_orientation.cast<double>();
     }
 
+    static void split_vertices(const indexed_triangle_set &its, std::vector<float> &x, std::vector<float> &y, std::vector<float> &z)
+    {
+        x.resize(its.vertices.size());
+        y.resize(its.vertices.size());
+        z.resize(its.vertices.size());
+        for (size_t i = 0; i < its.vertices.size(); i++) {
+            x[i] = its.vertices[i].x();
+            y[i] = its.vertices[i].y();
+            z[i] = its.vertices[i].z();
+        }
+    }
+
     void preprocess()
     {
         int count_apperance = 0;
         {
             int face_count = mesh->facets_count();
-            auto its = mesh->its;
+            indexed_triangle_set &its = mesh->its;
             face_normals = its_face_normals(its);
             areas = Eigen::VectorXf::Zero(face_count);
-            is_apperance = Eigen::VectorXf::Zero(face_count);
-            normals = Eigen::MatrixXf::Zero(face_count, 3);
             normals_quantize = Eigen::MatrixXf::Zero(face_count, 3);
+            normals_x.resize(face_count);
+            normals_y.resize(face_count);
+            normals_z.resize(face_count);
+            areas_appearance.resize(face_count);
             for (size_t i = 0; i < face_count; i++)
             {
                 float area = its.facet_area(i);
-                normals.row(i) = face_normals[i];
                 normals_quantize.row(i) = quantize_vec3f(face_normals[i]);
+                normals_x[i] = face_normals[i].x();
+                normals_y[i] = face_normals[i].y();
+                normals_z[i] = face_normals[i].z();
                 areas(i) = area;
-                is_apperance(i) = (its.get_property(i).type == EnumFaceTypes::eExteriorAppearance);
-                count_apperance += (is_apperance(i)==1);
+                bool is_apperance = its.get_property(i).type == EnumFaceTypes::eExteriorAppearance;
+                areas_appearance[i] = is_apperance ? area * (params.APPERANCE_FACE_SUPP + 1) : area;
+                count_apperance += is_apperance;
             }
+            split_vertices(its, vertices_x, vertices_y, vertices_z);
         }
 
         if (orient_mesh)
@@ -209,21 +304,25 @@ public:
             //mesh_convex_hull.write_binary("convex_hull_debug.stl");
 
             int face_count = mesh_convex_hull.facets_count();
-            auto its = mesh_convex_hull.its;
+            const indexed_triangle_set &its = mesh_convex_hull.its;
             face_count_hull = mesh_convex_hull.facets_count();
             face_normals_hull = its_face_normals(its);
             areas_hull = Eigen::VectorXf::Zero(face_count);
-            normals_hull = Eigen::MatrixXf::Zero(face_count_hull, 3);
             normals_hull_quantize = Eigen::MatrixXf::Zero(face_count_hull, 3);
             for (size_t i = 0; i < face_count; i++)
             {
                 float area = its.facet_area(i);
                 //We cannot use quantized vector here, the accumulated error will result in bad orientations.
-                normals_hull.row(i) = face_normals_hull[i];
                 normals_hull_quantize.row(i) = quantize_vec3f(face_normals_hull[i]);
                 areas_hull(i) = area;
             }
+            split_vertices(its, vertices_hull_x, vertices_hull_y, vertices_hull_z);
         }
+
+        BoundingBoxf3 bbox = mesh->bounding_box();
+        area_total = bbox.area();
+        radius = bbox.radius();
+        volume = mesh->stats().volume > 0 ? mesh->stats().volume : its_volume(mesh->its);
     }
 
     void area_cumulation(const Eigen::MatrixXf& normals_, const Eigen::VectorXf& areas_, int num_directions = 10)
@@ -253,32 +352,33 @@ public:
     //This function is to make sure to return the accurate normal rather than quantized normal
     void area_cumulation_accurate( std::vector<Vec3f>& normals_, const Eigen::MatrixXf& quantize_normals_, const Eigen::VectorXf& areas_, int num_directions = 10)
     {
-        std::unordered_map<stl_normal, std::pair<std::vector<float>, Vec3f>, VecHash> alignments_;
-        Vec3f n1 = { 0, 0, 0 };
-        std::vector<float> current_areas = {0, 0};
-        // init to 0
-        for (size_t i = 0; i < areas_.size(); i++) {
-            alignments_.insert(std::pair(quantize_normals_.row(i), std::pair(current_areas, n1)));
-        }
+        struct Alignment {
+            float max_area   { 0.f };   // area of the largest face, which normal is returned
+            float total_area { 0.f };
+            Vec3f normal     { 0.f, 0.f, 0.f };
+        };
+        std::unordered_map<stl_normal, Alignment, VecHash> alignments_;
+        alignments_.reserve(areas_.size());
         // cumulate areas
         for (size_t i = 0; i < areas_.size(); i++)
         {
-            alignments_[quantize_normals_.row(i)].first[1] += areas_(i);
-            if (areas_(i) > alignments_[quantize_normals_.row(i)].first[0]){
-                alignments_[quantize_normals_.row(i)].second = normals_[i];
-                alignments_[quantize_normals_.row(i)].first[0] = areas_(i);
+            Alignment &alignment = alignments_[quantize_normals_.row(i)];
+            alignment.total_area += areas_(i);
+            if (areas_(i) > alignment.max_area) {
+                alignment.normal   = normals_[i];
+                alignment.max_area = areas_(i);
             }
         }
 
-        typedef std::pair<stl_normal, std::pair<std::vector<float>, Vec3f>> PAIR;
+        typedef std::pair<stl_normal, Alignment> PAIR;
         std::vector<PAIR> align_counts(alignments_.begin(), alignments_.end());
-        sort(align_counts.begin(), align_counts.end(), [](const PAIR& p1, const PAIR& p2) {return p1.second.first[1] > p2.second.first[1]; });
-
         num_directions = std::min((size_t)num_directions, align_counts.size());
+        std::partial_sort(align_counts.begin(), align_counts.begin() + num_directions, align_counts.end(), [](const PAIR& p1, const PAIR& p2) {return p1.second.total_area > p2.second.total_area; });
+
         for (size_t i = 0; i < num_directions; i++)
         {
-            orientations.push_back(align_counts[i].second.second);
-            BOOST_LOG_TRIVIAL(debug) << align_counts[i].second.second.transpose() << ", area: " << align_counts[i].second.first[1];
+            orientations.push_back(align_counts[i].second.normal);
+            BOOST_LOG_TRIVIAL(debug) << align_counts[i].second.normal.transpose() << ", area: " << align_counts[i].second.total_area;
         }
     }
     void add_supplements()
@@ -316,38 +416,6 @@ public:
         }
     }
 
-    void project_vertices(Vec3f orientation)
-    {
-        int face_count = mesh->facets_count();
-        auto its = mesh->its;
-        z_projected.resize(face_count, 3);
-        z_max.resize(face_count, 1);
-        z_median.resize(face_count, 1);
-        z_mean.resize(face_count, 1);
-        for (size_t i = 0; i < face_count; i++)
-        {
-            float z0 = its.get_vertex(i,0).dot(orientation);
-            float z1 = its.get_vertex(i,1).dot(orientation);
-            float z2 = its.get_vertex(i,2).dot(orientation);
-            z_projected(i, 0) = z0;
-            z_projected(i, 1) = z1;
-            z_projected(i, 2) = z2;
-            z_max(i) = MAX3(z0,z1,z2);
-            z_median(i) = MEDIAN3(z0,z1,z2);
-            z_mean(i) = (z0 + z1 + z2) / 3;
-        }
-
-        z_max_hull.resize(mesh_convex_hull.facets_count(), 1);
-        its = mesh_convex_hull.its;
-        for (size_t i = 0; i < z_max_hull.rows(); i++)
-        {
-            float z0 = its.get_vertex(i,0).dot(orientation);
-            float z1 = its.get_vertex(i,1).dot(orientation);
-            float z2 = its.get_vertex(i,2).dot(orientation);
-            z_max_hull(i) = MAX3(z0, z1, z2);
-        }
-    }
-
     static Eigen::VectorXi argsort(const Eigen::VectorXf& vec, std::string order="ascend")
     {
         Eigen::VectorXi ind = Eigen::VectorXi::LinSpaced(vec.size(), 0, vec.size() - 1);//[0 1 2 3 ... N-1]
@@ -371,84 +439,149 @@ public:
         //}
     }
 
+    // Project the vertices to the orientation.
+    static void project_vertices(const std::vector<float> &x, const std::vector<float> &y, const std::vector<float> &z, const Vec3f &orientation, std::vector<float> &out)
+    {
+        const size_t n  = x.size();
+        const float  ox = orientation.x();
+        const float  oy = orientation.y();
+        const float  oz = orientation.z();
+        out.resize(n);
+        const float *px = x.data(), *py = y.data(), *pz = z.data();
+        float       *pout = out.data();
+        for (size_t i = 0; i < n; ++ i)
+            pout[i] = px[i] * ox + py[i] * oy + pz[i] * oz;
+    }
+
+    // Max (and optionally mean) of the projected z of the faces, returns the min of the projected z.
+    static float project_faces(const indexed_triangle_set &its, const std::vector<float> &vertex_z, std::vector<float> &z_max, std::vector<float> *z_mean)
+    {
+        const size_t face_count = its.indices.size();
+        z_max.resize(face_count);
+        if (z_mean)
+            z_mean->resize(face_count);
+        float z_min = std::numeric_limits<float>::max();
+        for (size_t i = 0; i < face_count; ++ i) {
+            const stl_triangle_vertex_indices &face = its.indices[i];
+            float z0 = vertex_z[face(0)];
+            float z1 = vertex_z[face(1)];
+            float z2 = vertex_z[face(2)];
+            z_max[i] = MAX3(z0, z1, z2);
+            z_min = std::min(z_min, std::min(std::min(z0, z1), z2));
+            if (z_mean)
+                (*z_mean)[i] = (z0 + z1 + z2) / 3;
+        }
+        return z_min;
+    }
+
+    // Sum of fn(i) over [begin, end). The sum is accumulated in independent lanes, so that the loop is vectorized without reassociating
+    // the float additions. fn shall be branch free, conditions are applied by multiplying with float(condition).
+    template<typename Fn>
+    static float sum_lanes(size_t begin, size_t end, Fn &&fn)
+    {
+        static constexpr const size_t lanes = 8;
+        float  partial[lanes] = {};
+        size_t i = begin;
+        for (; i + lanes <= end; i += lanes)
+            for (size_t k = 0; k < lanes; ++ k)
+                partial[k] += fn(i + k);
+        float sum = 0;
+        for (; i < end; ++ i)
+            sum += fn(i);
+        for (float p : partial)
+            sum += p;
+        return sum;
+    }
+
+    // Sum of the areas of the faces with z_max below the threshold.
+    static float sum_areas_below(const std::vector<float> &z_max, const float *areas, float threshold)
+    {
+        const float *pz = z_max.data();
+        return sum_lanes(0, z_max.size(), [pz, areas, threshold](size_t i) { return float(pz[i] < threshold) * areas[i]; });
+    }
+
     // previously calc_overhang
-    CostItems get_features(Vec3f orientation, bool min_volume = true)
+    // Returns false if the candidate was rejected, because its cost is above reject_above. The costs are then incomplete.
+    bool get_features(const Vec3f &orientation, bool min_volume, float reject_above, Workspace &workspace, CostItems &costs) const
     {
-        CostItems costs;
-        costs.area_total = mesh->bounding_box().area();
-        costs.radius = mesh->bounding_box().radius();
-        // volume
-        costs.volume = mesh->stats().volume > 0 ? mesh->stats().volume : its_volume(mesh->its);
+        costs.area_total = area_total;
+        costs.radius = radius;
+        costs.volume = volume;
+
+        project_vertices(vertices_x, vertices_y, vertices_z, orientation, workspace.vertex_z);
+        float total_min_z = project_faces(mesh->its, workspace.vertex_z, workspace.z_max, min_volume ? &workspace.z_mean : nullptr);
+        project_vertices(vertices_hull_x, vertices_hull_y, vertices_hull_z, orientation, workspace.vertex_z_hull);
+        project_faces(mesh_convex_hull.its, workspace.vertex_z_hull, workspace.z_max_hull, nullptr);
 
-        float total_min_z = z_projected.minCoeff();
         // filter bottom area
-        auto bottom_condition = z_max.array() < total_min_z + this->params.FIRST_LAY_H - EPSILON;
-        auto bottom_condition_hull = z_max_hull.array() < total_min_z + this->params.FIRST_LAY_H - EPSILON;
-        auto bottom_condition_2nd = z_max.array() < total_min_z + this->params.FIRST_LAY_H/2.f - EPSILON;
+        const float bottom_z     = total_min_z + this->params.FIRST_LAY_H - float(EPSILON);
+        const float bottom_z_2nd = total_min_z + this->params.FIRST_LAY_H / 2.f - float(EPSILON);
         //The first layer is sliced on half of the first layer height. 
         //The bottom area is measured by accumulating first layer area with the facets area below first layer height.
         //By combining these two factors, we can avoid the wrong orientation of large planar faces while not influence the
         //orientations of complex objects with small bottom areas.
-        costs.bottom = bottom_condition.select(areas, 0).sum()*0.5 + bottom_condition_2nd.select(areas, 0).sum();
-
-        // filter overhang
-        Eigen::VectorXf normal_projection(normals.rows(), 1);// = this->normals.dot(orientation);
-        for (size_t i = 0; i < normals.rows(); i++)
-        {
-            normal_projection(i) = normals.row(i).dot(orientation);
-        }
-        auto areas_appearance = areas.cwiseProduct((is_apperance * params.APPERANCE_FACE_SUPP + Eigen::VectorXf::Ones(is_apperance.rows(), is_apperance.cols())));
-        auto overhang_areas = ((normal_projection.array() < params.ASCENT) * (!bottom_condition_2nd)).select(areas_appearance, 0);
-        Eigen::MatrixXf inner = normal_projection.array() - params.ASCENT;
-        inner = inner.cwiseMin(0).cwiseAbs();
-        if (min_volume)
-        {
-            Eigen::MatrixXf heights = z_mean.array() - total_min_z;
-            costs.overhang = (heights.array()* overhang_areas.array()*inner.array()).sum();
-        }
-        else {
-            costs.overhang = overhang_areas.array().cwiseAbs().sum();
-        }
+        costs.bottom = sum_areas_below(workspace.z_max, areas.data(), bottom_z) * 0.5 + sum_areas_below(workspace.z_max, areas.data(), bottom_z_2nd);
 
         {
             // contour perimeter
-#if 1
             // the simple way for contour is even better for faces of small bridges
             costs.contour = 4 * sqrt(costs.bottom);
-#else
-            float contour = 0;
-            int face_count = mesh->facets_count();
-            auto its = mesh->its;
-            int contour_amout = 0;
-            for (size_t i = 0; i < face_count; i++)
-            {
-                if (bottom_condition(i)) {
-                    Eigen::VectorXi index = argsort(z_projected.row(i));
-                    stl_vertex line = its.get_vertex(i, index(0)) - its.get_vertex(i, index(1));
-                    contour += line.norm();
-                    contour_amout++;
-                }
-            }
-            costs.contour += contour + params.CONTOUR_AMOUNT * contour_amout;
-#endif
         }
 
         // bottom of convex hull
-        costs.bottom_hull = (bottom_condition_hull).select(areas_hull, 0).sum();
-
-        // low angle faces
-        auto normal_projection_abs = normal_projection.cwiseAbs();
-        Eigen::MatrixXf laf_areas = ((normal_projection_abs.array() < params.LAF_MAX) * (normal_projection_abs.array() > params.LAF_MIN) * (z_max.array() > total_min_z + params.FIRST_LAY_H)).select(areas, 0);
-        costs.area_laf = laf_areas.sum();
+        costs.bottom_hull = sum_areas_below(workspace.z_max_hull, areas_hull.data(), bottom_z);
+
+        // The cost grows with the overhang and with the area of low angle faces, which are accumulated below, unless the overhang
+        // appears in the denominator of the cost function. Then the cost of the partial sums is a lower bound of the cost.
+        const bool can_reject = reject_above < std::numeric_limits<float>::max() && (! min_volume || params.TAR_E == 0.f);
+
+        // filter overhang, low angle faces
+        static constexpr const size_t chunk_size = 16384;
+        const size_t face_count = workspace.z_max.size();
+        const float  laf_z      = total_min_z + params.FIRST_LAY_H;
+        double       overhang   = 0.;
+        double       area_laf   = 0.;
+        for (size_t chunk_begin = 0; chunk_begin < face_count; chunk_begin += chunk_size) {
+            const size_t chunk_end = std::min(face_count, chunk_begin + chunk_size);
+            const float ox = orientation.x(), oy = orientation.y(), oz = orientation.z();
+            const float *nx = normals_x.data(), *ny = normals_y.data(), *nz = normals_z.data();
+            const float *z_max = workspace.z_max.data(), *z_mean = workspace.z_mean.data(), *areas_app = areas_appearance.data(), *areas_all = areas.data();
+            const float ascent = params.ASCENT, laf_max = params.LAF_MAX, laf_min = params.LAF_MIN;
+            float overhang_chunk = min_volume ?
+                sum_lanes(chunk_begin, chunk_end, [=](size_t i) {
+                    float normal_projection = nx[i] * ox + ny[i] * oy + nz[i] * oz;
+                    float is_overhang       = float((normal_projection < ascent) & (z_max[i] >= bottom_z_2nd));
+                    return is_overhang * areas_app[i] * (z_mean[i] - total_min_z) * std::max(ascent - normal_projection, 0.f);
+                }) :
+                sum_lanes(chunk_begin, chunk_end, [=](size_t i) {
+                    float normal_projection = nx[i] * ox + ny[i] * oy + nz[i] * oz;
+                    return float((normal_projection < ascent) & (z_max[i] >= bottom_z_2nd)) * areas_app[i];
+                });
+            float area_laf_chunk = sum_lanes(chunk_begin, chunk_end, [=](size_t i) {
+                float normal_projection_abs = std::abs(nx[i] * ox + ny[i] * oy + nz[i] * oz);
+                return float((normal_projection_abs < laf_max) & (normal_projection_abs > laf_min) & (z_max[i] > laf_z)) * areas_all[i];
+            });
+            overhang += overhang_chunk;
+            area_laf += area_laf_chunk;
+            if (can_reject && chunk_end < face_count) {
+                CostItems partial = costs;
+                partial.overhang = float(overhang);
+                partial.area_laf = float(area_laf);
+                if (target_function(partial, min_volume) > reject_above)
+                    return false;
+            }
+        }
+        costs.overhang = float(overhang);
+        costs.area_laf = float(area_laf);
 
         // height to bottom_hull_area ratio
         //float total_max_z = z_projected.maxCoeff();
         //costs.height_to_bottom_hull_ratio = SQ(total_max_z) / (costs.bottom_hull + 1e-7);
 
-        return costs;
+        return true;
     }
 
-    float target_function(CostItems& costs, bool min_volume)
+    float target_function(CostItems& costs, bool min_volume) const
     {
         float cost=0;
         float bottom = costs.bottom;//std::min(costs.bottom, params.BOTTOM_MAX);
@@ -470,6 +603,19 @@ public:
     }
 };
 
+// Number of the best candidates found on the proxy mesh to be evaluated on the full mesh.
+static constexpr const size_t PROXY_CANDIDATES = 8;
+
+// If the mesh has a decimated proxy, the candidates are searched and ranked on the proxy. Only the best of them
+// are evaluated again on the full mesh, which picks the final orientation.
+static Vec3d find_best_orientation(OrientMesh &mesh_, const OrientParams &params, std::function<bool()> stopfn)
+{
+    if (mesh_.proxy.empty())
+        return AutoOrienter(&mesh_, params, {}, stopfn).process();
+    std::vector<Vec3f> candidates = AutoOrienter(&mesh_, params, {}, stopfn, &mesh_.proxy).best_candidates(PROXY_CANDIDATES);
+    return AutoOrienter(&mesh_, params, {}, stopfn).process(candidates);
+}
+
 void _orient(OrientMeshs& meshs_,
         const OrientParams           &params,
         std::function<void(unsigned, std::string)> progressfn,
@@ -481,8 +627,7 @@ void _orient(OrientMeshs& meshs_,
             auto& mesh_ = meshs_[i];
             progressfn(i, mesh_.name);
             //auto progressfn_i = [&](unsigned cnt) {progressfn(cnt, "Orienting " + mesh_.name); };
-            AutoOrienter orienter(&mesh_, params, /*progressfn_i*/{}, stopfn);
-            mesh_.orientation = orienter.process();
+            mesh_.orientation = find_best_orientation(mesh_, params, stopfn);
             Geometry::rotation_from_two_vectors(mesh_.orientation, { 0,0,1 }, mesh_.axis, mesh_.angle, &mesh_.rotation_matrix);
             BOOST_LOG_TRIVIAL(info) << std::fixed << std::setprecision(3) << "v,phi: " << mesh_.axis.transpose() << ", " << mesh_.angle;
             //flush_logs();
@@ -493,8 +638,7 @@ void _orient(OrientMeshs& meshs_,
             for (size_t i = range.begin(); i != range.end(); ++i) {
                 auto& mesh_ = meshs_[i];
                 progressfn(i, mesh_.name);
-                AutoOrienter orienter(&mesh_, params, {}, stopfn);
-                mesh_.orientation = orienter.process();
+                mesh_.orientation = find_best_orientation(mesh_, params, stopfn);
                 Geometry::rotation_from_two_vectors(mesh_.orientation, { 0,0,1 }, mesh_.axis, mesh_.angle, &mesh_.rotation_matrix);
                 mesh_.euler_angles = Geometry::extract_euler_angles(mesh_.rotation_matrix);
                 BOOST_LOG_TRIVIAL(debug) << "rotation_from_two_vectors: " << mesh_.orientation << "; " << mesh_.axis << "; " << mesh_.angle << "; euler: " << mesh_.euler_angles.transpose();
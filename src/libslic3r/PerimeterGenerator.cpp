@@ -22,6 +22,8 @@
 #include "libslic3r/AABBTreeLines.hpp"
 #include "Print.hpp"
 #include "Algorithm/LineSplit.hpp"
+
+#include <tbb/parallel_for.h>
 static const int overhang_sampling_number = 6;
 static const double narrow_loop_length_threshold = 10;
 static const double min_degree_gap = 0.1;
@@ -2867,9 +2869,18 @@ void PerimeterGenerator::process_arachne()
     process_no_bridge(all_surfaces, perimeter_spacing, ext_perimeter_width);
     // BBS: don't simplify too much which influence arc fitting when export gcode if arc_fitting is enabled
     double surface_simplify_resolution = (print_config->enable_arc_fitting && !this->has_fuzzy_skin) ? 0.2 * m_scaled_resolution : m_scaled_resolution;
+    struct SurfaceWalls
+    {
+        std::vector<Arachne::VariableWidthLines> perimeters;
+        ExPolygons                               infill_contour;
+        ExPolygons                               top_expolygons;
+        int                                      loop_number;
+        bool                                     is_bottom_layer;
+        bool                                     is_topmost_layer;
+    };
     // we need to process each island separately because we might have different
     // extra perimeters for each one
-    for (const Surface& surface : all_surfaces) {
+    auto generate_walls = [&](const Surface &surface) -> SurfaceWalls {
         coord_t bead_width_0 = ext_perimeter_spacing;
         // detect how many perimeters must be generated for this island
         int loop_number = this->config->wall_loops + surface.extra_perimeters - 1; // 0-indexed loops
@@ -2993,6 +3004,25 @@ void PerimeterGenerator::process_arachne()
         }
 #endif
 
+        return { std::move(perimeters), std::move(infill_contour), std::move(top_expolygons), loop_number, is_bottom_layer, is_topmost_layer };
+    };
+
+    // The Arachne walls of the islands are independent, generate them in parallel. The walls are then ordered
+    // and appended to the layer sequentially in the order of the surfaces, thus the output does not depend on the scheduling.
+    std::vector<SurfaceWalls> surface_walls(all_surfaces.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, all_surfaces.size()), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t surface_idx = range.begin(); surface_idx < range.end(); ++ surface_idx)
+            surface_walls[surface_idx] = generate_walls(all_surfaces[surface_idx]);
+    });
+
+    for (SurfaceWalls &walls : surface_walls) {
+        std::vector<Arachne::VariableWidthLines> &perimeters       = walls.perimeters;
+        ExPolygons                               &infill_contour   = walls.infill_contour;
+        const ExPolygons                         &top_expolygons   = walls.top_expolygons;
+        const int                                 loop_number      = walls.loop_number;
+        const bool                                is_bottom_layer  = walls.is_bottom_layer;
+        const bool                                is_topmost_layer = walls.is_topmost_layer;
+
         // All closed ExtrusionLine should have the same the first and the last point.
         // But in rare cases, Arachne produce ExtrusionLine marked as closed but without
         // equal the first and the last point.
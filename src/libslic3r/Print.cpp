@@ -82,6 +82,7 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
         "additional_cooling_fan_speed",
         "reduce_crossing_wall",
         "max_travel_detour_distance",
+        "optimize_travel_order",
         "printable_area",
         //BBS: add bed_exclude_area
         "bed_exclude_area",
@@ -2212,10 +2213,22 @@ std::string Print::export_gcode(const std::string& path_template, GCodeProcessor
     //BBS: compute plate offset for gcode-generator
     const Vec3d origin = this->get_plate_origin();
     gcode.set_gcode_offset(origin(0), origin(1));
+    // Log the memory around the export to measure the effect of releasing the layers: The peak of the slicing itself is reached
+    // before the export, when all the layers hold their extrusions.
+    if (m_release_layers_after_export)
+        BOOST_LOG_TRIVIAL(info) << "Before the G-code export, releasing the layers:" << log_memory_info(true);
     gcode.do_export(this, path.c_str(), result, thumbnail_cb);
 
+    if (m_release_layers_after_export) {
+        // The extrusions of the layers were freed by the G-code generator.
+        for (PrintObject *object : m_objects)
+            object->invalidate_step(posSlice);
+        BOOST_LOG_TRIVIAL(info) << "Released the layers after the G-code export:" << log_memory_info(true);
+    }
+
     //BBS
-    result->conflict_result = m_conflict_result;
+    if (result != nullptr)
+        result->conflict_result = m_conflict_result;
     return path.c_str();
 }
 
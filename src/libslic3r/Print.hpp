@@ -558,6 +558,10 @@ private:
     static bool infill_only_where_needed;
 };
 
+// Union (or intersection) of the polygons of the layers [begin, end) for each of the ranges, combined the way
+// PrintObject::discover_vertical_shells() combines the top / bottom shells. Exported for unit tests.
+std::vector<Polygons> combine_layer_ranges(const std::vector<Polygons> &layers, const std::vector<std::pair<size_t, size_t>> &ranges, bool intersect);
+
 struct FakeWipeTower
 {
     // generate fake extrusion
@@ -842,6 +846,14 @@ public:
     // Exports G-code into a file name based on the path_template, returns the file path of the generated G-code file.
     // If preview_data is not null, the preview_data is filled in for the G-code visualization (not used by the command line Slic3r).
     std::string         export_gcode(const std::string& path_template, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb = nullptr);
+    // Low memory mode of the command line: free the extrusions of each layer as soon as its G-code is emitted, so that the G-code export
+    // does not hold the extrusions of all the layers at once. The slicing is invalidated by export_gcode(), the layers are sliced again
+    // by the next process(). Not to be used together with export_cached_data().
+    // Limitation: The layers hold their extrusions until the export starts, thus the peak of process() itself is not lowered.
+    // What is lowered is the memory held while the G-code export and the G-code processor allocate their own data,
+    // and while the following plates are sliced.
+    void                set_release_layers_after_export(bool release) { m_release_layers_after_export = release; }
+    bool                release_layers_after_export() const { return m_release_layers_after_export; }
     //return 0 means successful
     int                 export_cached_data(const std::string& dir_path, bool with_space=false);
     int                 load_cached_data(const std::string& directory);
@@ -1036,6 +1048,7 @@ private:
     // Estimated print time, filament consumed.
     PrintStatistics                         m_print_statistics;
     bool                                    m_support_used {false};
+    bool                                    m_release_layers_after_export {false};
 
     //BBS: plate's origin
     Vec3d   m_origin;
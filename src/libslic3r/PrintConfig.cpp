@@ -656,6 +656,14 @@ void PrintConfigDef::init_fff_params()
     def->mode = comAdvanced;
     def->set_default_value(new ConfigOptionFloatOrPercent(0., false));
 
+    def = this->add("optimize_travel_order", coBool);
+    def->label = L("Optimize travel order");
+    def->category = L("Quality");
+    def->tooltip = L("Plan the order, in which the objects and their separate parts are printed on each layer, to shorten the travel moves. "
+                     "The parts of an object are still printed together. Only applies if the print order is the default one");
+    def->mode = comAdvanced;
+    def->set_default_value(new ConfigOptionBool(false));
+
     // BBS
     def = this->add("cool_plate_temp", coInts);
     def->label = L("Other layers");
@@ -7046,6 +7054,14 @@ CLIActionsConfigDef::CLIActionsConfigDef()
     def->cli_params = "option";
     def->set_default_value(new ConfigOptionBool(false));
 
+    def = this->add("low_memory", coBool);
+    def->label = "Low memory";
+    def->tooltip = "Free the extrusions of each layer as soon as its G-code is exported, to reduce the memory usage during the G-code export "
+                   "and while slicing the following plates. The peak memory usage of slicing a single plate is not lowered. "
+                   "Ignored together with export_slicedata.";
+    def->cli_params = "option";
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("mtcpp", coInt);
     def->label = "mtcpp";
     def->tooltip = "max triangle count per plate for slicing.";
@@ -7407,6 +7423,29 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->tooltip = "Allow 3mf with newer version to be sliced";
     def->cli_params = "option";
     def->set_default_value(new  ConfigOptionBool(false));
+
+    def = this->add("batch", coString);
+    def->label = "Batch mode";
+    def->tooltip = "Keep running and slice the jobs read from the file, a named pipe or the standard input (-), one JSON object per line "
+                   "with the optional keys id, models, settings, filaments, outputdir, slice and args. "
+                   "The result of each job is written as a JSON object per line to batch_results, or to the standard output.";
+    def->cli_params = "jobs.jsonl";
+    def->set_default_value(new ConfigOptionString(""));
+
+    def = this->add("batch_results", coString);
+    def->label = "Batch mode results";
+    def->tooltip = "File to write the results of the batch jobs to. If empty, the results are written to the standard output "
+                   "and all the other output of the jobs is redirected to the standard error. "
+                   "peak_memory is the peak resident memory of the job, reported on Linux only. process_peak_memory is the peak "
+                   "of the whole batch process so far, it never decreases from job to job.";
+    def->cli_params = "results.jsonl";
+    def->set_default_value(new ConfigOptionString(""));
+
+    def = this->add("batch_threads", coInt);
+    def->label = "Batch mode threads";
+    def->tooltip = "Number of cores used by a single job of the batch mode, 0 for all of them.";
+    def->min = 0;
+    def->set_default_value(new ConfigOptionInt(0));
 }
 
 const CLIActionsConfigDef    cli_actions_config_def;
@@ -31,6 +31,7 @@
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
 
 #include <Shiny/Shiny.h>
 
@@ -781,9 +782,13 @@ std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> PrintObject::prepare
     for (size_t i = 1; i < overhangs.size(); ++ i)
         append(overhangs.front(), std::move(overhangs[i]));
 
-    return std::make_pair(
-        adaptive_line_spacing ? build_octree(mesh, overhangs.front(), adaptive_line_spacing, false) : OctreePtr(),
-        support_line_spacing  ? build_octree(mesh, overhangs.front(), support_line_spacing, true) : OctreePtr());
+    // Both octrees are built concurrently, each of them is built in parallel as well.
+    OctreePtr adaptive_fill_octree;
+    OctreePtr support_fill_octree;
+    tbb::parallel_invoke(
+        [&]() { if (adaptive_line_spacing) adaptive_fill_octree = build_octree(mesh, overhangs.front(), adaptive_line_spacing, false); },
+        [&]() { if (support_line_spacing)  support_fill_octree  = build_octree(mesh, overhangs.front(), support_line_spacing, true); });
+    return std::make_pair(std::move(adaptive_fill_octree), std::move(support_fill_octree));
 }
 
 FillLightning::GeneratorPtr PrintObject::prepare_lightning_infill_data()
@@ -1317,8 +1322,8 @@ void PrintObject::detect_surfaces_type()
                     Surfaces top;
                     if (upper_layer) {
                         ExPolygons upper_slices = interface_shells ?
-                            diff_ex(layerm_slices_surfaces, upper_layer->m_regions[region_id]->slices.surfaces, ApplySafetyOffset::Yes) :
-                            diff_ex(layerm_slices_surfaces, upper_layer->lslices, ApplySafetyOffset::Yes);
+                            diff_ex_partitioned(layerm_slices_surfaces, upper_layer->m_regions[region_id]->slices.surfaces, ApplySafetyOffset::Yes) :
+                            diff_ex_partitioned(layerm_slices_surfaces, upper_layer->lslices, ApplySafetyOffset::Yes);
                         surfaces_append(top, opening_ex(upper_slices, offset), stTop);
                     } else {
                         // if no upper layer, all surfaces of this one are solid
@@ -1344,7 +1349,7 @@ void PrintObject::detect_surfaces_type()
                         surfaces_append(
                             bottom,
                             opening_ex(
-                                diff_ex(layerm_slices_surfaces, lower_layer->lslices, ApplySafetyOffset::Yes),
+                                diff_ex_partitioned(layerm_slices_surfaces, lower_layer->lslices, ApplySafetyOffset::Yes),
                                 offset),
                             surface_type_bottom_other);
                         // if user requested internal shells, we need to identify surfaces
@@ -1543,6 +1548,72 @@ void PrintObject::process_external_surfaces()
     }
 }
 
+namespace {
+
+// Combines per-layer polygons over ranges of consecutive layers with an idempotent operation (union or intersection).
+// Level k of the table stores the combination over layers [i, i + 2^k), thus any range of layers is combined
+// from two overlapping entries of the longest level not exceeding the range. Building the table costs about
+// one boolean operation per layer and level, while combining the layers of the range one by one for each layer
+// costs one boolean operation per layer of the range, which is expensive for thick top / bottom shells.
+class LayerRangeCombiner
+{
+public:
+    using Combine = std::function<Polygons(const Polygons&, const Polygons&)>;
+
+    // layer(idx) returns the polygons of layer idx, ranges up to max_range layers long are to be queried.
+    LayerRangeCombiner(std::function<const Polygons&(size_t)> layer, size_t num_layers, size_t max_range, Combine combine, std::function<void()> throw_if_canceled) :
+        m_layer(std::move(layer)), m_combine(std::move(combine))
+    {
+        for (size_t level = 1; (size_t(1) << level) <= std::min(max_range, num_layers); ++ level) {
+            const size_t          half = size_t(1) << (level - 1);
+            std::vector<Polygons> &dst = m_levels.emplace_back(num_layers + 1 - 2 * half);
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, dst.size()), [this, level, half, &dst, &throw_if_canceled](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
+                    throw_if_canceled();
+                    dst[i] = m_combine(this->entry(level - 1, i), this->entry(level - 1, i + half));
+                }
+            });
+        }
+    }
+
+    // Combination of layers [begin, end).
+    Polygons operator()(size_t begin, size_t end) const
+    {
+        assert(begin < end);
+        size_t level = 0;
+        while ((size_t(2) << level) <= end - begin)
+            ++ level;
+        assert(level <= m_levels.size());
+        const size_t len = size_t(1) << level;
+        return len == end - begin ? this->entry(level, begin) : m_combine(this->entry(level, begin), this->entry(level, end - len));
+    }
+
+private:
+    const Polygons& entry(size_t level, size_t idx) const { return level == 0 ? m_layer(idx) : m_levels[level - 1][idx]; }
+
+    std::function<const Polygons&(size_t)> m_layer;
+    Combine                                m_combine;
+    std::vector<std::vector<Polygons>>     m_levels;
+};
+
+} // namespace
+
+std::vector<Polygons> combine_layer_ranges(const std::vector<Polygons> &layers, const std::vector<std::pair<size_t, size_t>> &ranges, bool intersect)
+{
+    size_t max_range = 0;
+    for (const std::pair<size_t, size_t> &range : ranges)
+        max_range = std::max(max_range, range.second - range.first);
+    auto union_polygons     = [](const Polygons &polygons1, const Polygons &polygons2) { return union_(polygons1, polygons2); };
+    auto intersect_polygons = [](const Polygons &polygons1, const Polygons &polygons2) { return intersection(polygons1, polygons2); };
+    LayerRangeCombiner combiner([&layers](size_t i) -> const Polygons& { return layers[i]; }, layers.size(), max_range,
+        intersect ? LayerRangeCombiner::Combine(intersect_polygons) : LayerRangeCombiner::Combine(union_polygons), []() {});
+    std::vector<Polygons> out;
+    out.reserve(ranges.size());
+    for (const std::pair<size_t, size_t> &range : ranges)
+        out.emplace_back(combiner(range.first, range.second));
+    return out;
+}
+
 void PrintObject::discover_vertical_shells()
 {
     PROFILE_FUNC();
@@ -1686,11 +1757,54 @@ void PrintObject::discover_vertical_shells()
             BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << region_id << " in parallel - end : cache top / bottom";
         }
 
+        // Ranges of layers [first, second) above / below each layer, which are projected to it.
+        const PrintRegionConfig &config = region.config();
+        std::vector<std::pair<size_t, size_t>> top_ranges(num_layers), bottom_ranges(num_layers);
+        size_t max_top_range = 0, max_bottom_range = 0;
+        for (size_t idx_layer = 0; idx_layer < num_layers; ++ idx_layer) {
+            if (int n_top_layers = config.top_shell_layers.value; n_top_layers > 0) {
+                coordf_t print_z = m_layers[idx_layer]->print_z;
+                int i = int(idx_layer) + 1;
+                int itop = int(idx_layer) + n_top_layers;
+                for (; i < int(num_layers) && (i < itop || m_layers[i]->print_z - print_z < config.top_shell_thickness - EPSILON); ++ i) ;
+                top_ranges[idx_layer] = { idx_layer + 1, size_t(i) };
+                max_top_range = std::max(max_top_range, size_t(i) - idx_layer - 1);
+            }
+            if (int n_bottom_layers = config.bottom_shell_layers.value; n_bottom_layers > 0) {
+                coordf_t bottom_z = m_layers[idx_layer]->bottom_z();
+                int i = int(idx_layer) - 1;
+                int ibottom = int(idx_layer) - n_bottom_layers;
+                for (; i >= 0 && (i > ibottom || bottom_z - m_layers[i]->bottom_z() < config.bottom_shell_thickness - EPSILON); -- i) ;
+                bottom_ranges[idx_layer] = { size_t(i + 1), idx_layer };
+                max_bottom_range = std::max(max_bottom_range, idx_layer - size_t(i + 1));
+            }
+        }
+
+        // Unions of the top / bottom surfaces and intersections of the holes over the ranges of layers are queried from tables
+        // built once per region instead of combining the cached layers one by one for each layer.
+        BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << region_id << " in parallel - start : combine top / bottom";
+        auto throw_if_canceled = [this]() { m_print->throw_if_canceled(); };
+        auto union_shells      = [](const Polygons &shell1, const Polygons &shell2) {
+            // Running the union_ using the Clipper library piece by piece is cheaper than running the union_ all at once.
+            return shell1.empty() ? shell2 : shell2.empty() ? shell1 : union_(shell1, shell2);
+        };
+        auto intersect_holes   = [](const Polygons &holes1, const Polygons &holes2) {
+            return holes1.empty() || holes2.empty() ? Polygons() : intersection(holes1, holes2);
+        };
+        LayerRangeCombiner top_shells([&cache_top_botom_regions](size_t i) -> const Polygons& { return cache_top_botom_regions[i].top_surfaces; },
+            num_layers, max_top_range, union_shells, throw_if_canceled);
+        LayerRangeCombiner bottom_shells([&cache_top_botom_regions](size_t i) -> const Polygons& { return cache_top_botom_regions[i].bottom_surfaces; },
+            num_layers, max_bottom_range, union_shells, throw_if_canceled);
+        LayerRangeCombiner holes_combined([&cache_top_botom_regions](size_t i) -> const Polygons& { return cache_top_botom_regions[i].holes; },
+            num_layers, std::max(max_top_range, max_bottom_range), intersect_holes, throw_if_canceled);
+        m_print->throw_if_canceled();
+        BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << region_id << " in parallel - end : combine top / bottom";
+
         BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << region_id << " in parallel - start : ensure vertical wall thickness";
         grain_size = 1;
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, num_layers, grain_size),
-            [this, region_id, &cache_top_botom_regions]
+            [this, region_id, &cache_top_botom_regions, &top_ranges, &bottom_ranges, &top_shells, &bottom_shells, &holes_combined]
             (const tbb::blocked_range<size_t>& range) {
                 // printf("discover_vertical_shells from %d to %d\n", range.begin(), range.end());
                 for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
@@ -1747,13 +1861,11 @@ void PrintObject::discover_vertical_shells()
                         else
                             holes = intersection(holes, holes2);
                     };
-                    auto combine_shells = [&shell](const Polygons &shells2) {
+                    auto combine_shells = [&shell](Polygons &&shells2) {
                         if (shell.empty())
                             shell = std::move(shells2);
                         else if (! shells2.empty()) {
-                            polygons_append(shell, shells2);
-                            // Running the union_ using the Clipper library piece by piece is cheaper 
-                            // than running the union_ all at once.
+                            polygons_append(shell, std::move(shells2));
                             shell = union_(shell);
                         }
                     };
@@ -1761,25 +1873,21 @@ void PrintObject::discover_vertical_shells()
 			        if (int n_top_layers = region_config.top_shell_layers.value; n_top_layers > 0) {
                         // Gather top regions projected to this layer.
                         coordf_t print_z = layer->print_z;
-                        int i = int(idx_layer) + 1;
+                        auto [ibegin, iend] = top_ranges[idx_layer];
+                        // The first layer above the projected ones.
+                        int i = int(iend);
                         int itop = int(idx_layer) + n_top_layers;
-                        bool at_least_one_top_projected = false;
-	                    for (; i < int(cache_top_botom_regions.size()) &&
-	                         (i < itop || m_layers[i]->print_z - print_z < region_config.top_shell_thickness - EPSILON);
-	                        ++ i) {
-                            at_least_one_top_projected = true;
-	                        const DiscoverVerticalShellsCacheEntry &cache = cache_top_botom_regions[i];
-                            combine_holes(cache.holes);
-                            combine_shells(cache.top_surfaces);
-	                    }
-                        if (!at_least_one_top_projected && i < int(cache_top_botom_regions.size())) {
+                        if (ibegin < iend) {
+                            combine_holes(holes_combined(ibegin, iend));
+                            combine_shells(top_shells(ibegin, iend));
+                        } else if (i < int(cache_top_botom_regions.size())) {
                             // Lets consider this a special case - with only 1 top solid and minimal shell thickness settings, the
                             // boundaries of solid layers are not anchored over/under perimeters, so lets fix it by adding at least one
                             // perimeter width of area
                             Polygons anchor_area = intersection(expand(cache_top_botom_regions[idx_layer].top_surfaces,
                                                                        layerm->flow(frExternalPerimeter).scaled_spacing()),
                                                                 to_polygons(m_layers[i]->lslices));
-                            combine_shells(anchor_area);
+                            combine_shells(std::move(anchor_area));
                         }
 
                         if (one_more_layer_below_top_bottom_surfaces)
@@ -1790,23 +1898,18 @@ void PrintObject::discover_vertical_shells()
 	                if (int n_bottom_layers = region_config.bottom_shell_layers.value; n_bottom_layers > 0) {
                         // Gather bottom regions projected to this layer.
                         coordf_t bottom_z = layer->bottom_z();
-                        int i = int(idx_layer) - 1;
+                        auto [ibegin, iend] = bottom_ranges[idx_layer];
+                        // The first layer below the projected ones.
+                        int i = int(ibegin) - 1;
                         int ibottom = int(idx_layer) - n_bottom_layers;
-                        bool at_least_one_bottom_projected = false;
-	                    for (; i >= 0 &&
-	                         (i > ibottom || bottom_z - m_layers[i]->bottom_z() < region_config.bottom_shell_thickness - EPSILON);
-	                        -- i) {
-                                at_least_one_bottom_projected = true;
-	                        const DiscoverVerticalShellsCacheEntry &cache = cache_top_botom_regions[i];
-							combine_holes(cache.holes);
-                            combine_shells(cache.bottom_surfaces);
-	                    }
-
-                        if (!at_least_one_bottom_projected && i >= 0) {
+                        if (ibegin < iend) {
+                            combine_holes(holes_combined(ibegin, iend));
+                            combine_shells(bottom_shells(ibegin, iend));
+                        } else if (i >= 0) {
                             Polygons anchor_area = intersection(expand(cache_top_botom_regions[idx_layer].bottom_surfaces,
                                                                        layerm->flow(frExternalPerimeter).scaled_spacing()),
                                                                 to_polygons(m_layers[i]->lslices));
-                            combine_shells(anchor_area);
+                            combine_shells(std::move(anchor_area));
                         }
 
                         if (one_more_layer_below_top_bottom_surfaces)
@@ -1937,7 +2040,7 @@ void PrintObject::discover_vertical_shells()
                     if (regularized_shell.empty())
                         continue;
 
-                    ExPolygons new_internal_solid = intersection_ex(polygonsInternal, regularized_shell);
+                    ExPolygons new_internal_solid = intersection_ex_partitioned(polygonsInternal, regularized_shell);
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
                     {
                         Slic3r::SVG svg(debug_out_path("discover_vertical_shells-regularized-%d.svg", debug_idx), get_extents(shell_before));
@@ -1952,8 +2055,8 @@ void PrintObject::discover_vertical_shells()
 #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
 
                     // Trim the internal & internalvoid by the shell.
-                    Slic3r::ExPolygons new_internal = diff_ex(layerm->fill_surfaces.filter_by_type(stInternal), regularized_shell);
-                    Slic3r::ExPolygons new_internal_void = diff_ex(layerm->fill_surfaces.filter_by_type(stInternalVoid), regularized_shell);
+                    Slic3r::ExPolygons new_internal = diff_ex_partitioned(layerm->fill_surfaces.filter_by_type(stInternal), regularized_shell);
+                    Slic3r::ExPolygons new_internal_void = diff_ex_partitioned(layerm->fill_surfaces.filter_by_type(stInternalVoid), regularized_shell);
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
                     {
@@ -2185,7 +2288,7 @@ void PrintObject::bridge_over_infill()
                     }
 
                     solid_infill  = union_safety_offset_ex(solid_infill);
-                    sparse_infill = diff_ex(sparse_infill, solid_infill);
+                    sparse_infill = diff_ex_partitioned(sparse_infill, solid_infill);
 
                     region->fill_surfaces.remove_types({stInternalSolid, stInternal});
                     for (const ExPolygon &ep : solid_infill) {
@@ -2813,7 +2916,7 @@ void PrintObject::bridge_over_infill()
                 ExPolygons additional_ensuring = intersection_ex(additional_ensuring_areas, near_perimeters);
 
                 SurfacesPtr internal_infills = region->fill_surfaces.filter_by_type(stInternal);
-                ExPolygons new_internal_infills = diff_ex(internal_infills, cut_from_infill);
+                ExPolygons new_internal_infills = diff_ex_partitioned(internal_infills, cut_from_infill);
                 new_internal_infills            = diff_ex(new_internal_infills, additional_ensuring);
                 for (const ExPolygon &ep : new_internal_infills) {
                     new_surfaces.emplace_back(stInternal, ep);
@@ -3963,9 +4066,13 @@ void PrintObject::project_and_append_custom_facets(
 {
     for (const ModelVolume* mv : this->model_object()->volumes)
         if (mv->is_model_part()) {
-            const indexed_triangle_set custom_facets = seam
-                    ? mv->seam_facets.get_facets_strict(*mv, type)
-                    : mv->supported_facets.get_facets_strict(*mv, type);
+            // Shared with the previous slicing of this object, if the painting did not change.
+            const auto custom_facets_per_type = seam
+                    ? mv->seam_facets.get_facets_per_type(*mv, true)
+                    : mv->supported_facets.get_facets_per_type(*mv, true);
+            if (size_t(type) >= custom_facets_per_type->size())
+                continue;
+            const indexed_triangle_set &custom_facets = (*custom_facets_per_type)[size_t(type)];
             if (! custom_facets.indices.empty()) {
                 if (seam)
                     project_triangles_to_slabs(this->layers(), custom_facets,
@@ -2,7 +2,11 @@
 #include <tuple>
 #include <optional>
 #include "MutablePriorityQueue.hpp"
+#include <mutex>
+#include <numeric>
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/task_arena.h>
 
 using namespace Slic3r;
 
@@ -145,6 +149,8 @@ namespace QuadricEdgeCollapse {
     // constants --> may be move to config
     const uint32_t check_cancel_period = 16; // how many edge to reduce before call throw_on_cancel
     const size_t max_triangle_count_for_one_vertex = 50;
+    // its_quadric_edge_collapse_parallel() splits the mesh into patches of at least this size
+    const size_t min_triangles_per_patch = 100000;
     // change speed of progress bargraph
     const int status_init_size = 10; // in percents
     // parts of init size
@@ -157,6 +163,163 @@ namespace QuadricEdgeCollapse {
 
 using namespace QuadricEdgeCollapse;
 
+namespace QuadricEdgeCollapse {
+    auto make_mutable_priority_queue(std::vector<size_t> &ti_2_mpqi)
+    {
+        // convert from triangle index to mutable priority queue index
+        auto setter = [&ti_2_mpqi](const Error &e, size_t index) { ti_2_mpqi[e.triangle_index] = index; };
+        auto less = [](const Error &e1, const Error &e2) -> bool { return e1.value < e2.value; };
+        return make_miniheap_mutable_priority_queue<Error, 32, false>(std::move(setter), std::move(less));
+    }
+
+    // Collapse the edges of the triangles in mpq, smallest error first, until actual_triangle_count drops to triangle_count
+    // or the error reaches maximal_error. Edges touching a locked vertex are not collapsed.
+    // The triangles around the collapsed edges must be in mpq.
+    template<typename MPQ>
+    void collapse_edges(MPQ &mpq, indexed_triangle_set &its, TriangleInfos &t_infos, VertexInfos &v_infos, EdgeInfos &e_infos,
+                        std::vector<size_t> &ti_2_mpqi, const std::vector<uint8_t> *locked, uint32_t triangle_count, float maximal_error,
+                        uint32_t &actual_triangle_count, float &last_collapsed_error, ThrowOnCancel &throw_on_cancel,
+                        uint32_t status_mod, const std::function<void()> &increase_status)
+    {
+        CopyEdgeInfos ceis;
+        ceis.reserve(max_triangle_count_for_one_vertex);
+        EdgeInfos e_infos_swap;
+        e_infos_swap.reserve(max_triangle_count_for_one_vertex);
+        std::vector<uint32_t> changed_triangle_indices;
+        changed_triangle_indices.reserve(2 * max_triangle_count_for_one_vertex);
+
+        uint32_t iteration_number = 0;
+        while (actual_triangle_count > triangle_count && !mpq.empty()) {
+            ++iteration_number;
+            if (iteration_number % status_mod == 0) increase_status();
+            if (iteration_number % check_cancel_period == 0) throw_on_cancel();
+
+            // triangle index 0
+            Error e = mpq.top(); // copy
+            if (e.value >= maximal_error) break; // Too big error
+            mpq.pop();
+            uint32_t ti0 = e.triangle_index;
+            TriangleInfo &t_info0 = t_infos[ti0];
+            if (t_info0.is_deleted()) continue;
+            assert(t_info0.min_index < 3);
+
+            const Triangle &t0 = its.indices[ti0];
+            uint32_t vi0 = t0[t_info0.min_index];
+            uint32_t vi1 = t0[(t_info0.min_index+1) %3];
+            // Need by move of neighbor edge infos in function: change_neighbors
+            if (vi0 > vi1) std::swap(vi0, vi1);
+            VertexInfo &v_info0 = v_infos[vi0];
+            VertexInfo &v_info1 = v_infos[vi1];
+            assert(!v_info0.is_deleted() && !v_info1.is_deleted());
+            // The triangles around a locked vertex may be modified by other threads.
+            bool is_locked = locked != nullptr && ((*locked)[vi0] || (*locked)[vi1]);
+
+            // new vertex position
+            SymMat q(v_info0.q);
+            q += v_info1.q;
+            Vec3f new_vertex0 = calculate_vertex(vi0, vi1, q, its.vertices);
+            // set of triangle indices that change quadric
+            uint32_t ti1 = -1; // triangle 1 index
+            std::optional<uint32_t> ti1_opt;
+            if (! is_locked)
+                ti1_opt = (v_info0.count < v_info1.count)?
+                    find_triangle_index1(vi1, v_info0, ti0, e_infos, its.indices) :
+                    find_triangle_index1(vi0, v_info1, ti0, e_infos, its.indices) ;
+            if (ti1_opt.has_value()) { 
+                ti1 = *ti1_opt;
+                reorder_edges(e_infos, v_info0, ti0, ti1);
+                reorder_edges(e_infos, v_info1, ti0, ti1);
+            }
+            if (is_locked ||
+                !ti1_opt.has_value() || // edge has only one triangle
+                degenerate(vi0, ti0, ti1, v_info1, e_infos, its.indices) ||
+                degenerate(vi1, ti0, ti1, v_info0, e_infos, its.indices) ||
+                create_no_volume(vi0, vi1, ti0, ti1, v_info0, v_info1, e_infos, its.indices) ||
+                is_flipped(new_vertex0, ti0, ti1, v_info0, t_infos, e_infos, its) ||
+                is_flipped(new_vertex0, ti0, ti1, v_info1, t_infos, e_infos, its)) {
+                // try other triangle's edge
+                Vec3d errors = calculate_3errors(t0, its.vertices, v_infos);
+                Vec3i32 ord = (errors[0] < errors[1]) ? 
+                    ((errors[0] < errors[2])? 
+                        ((errors[1] < errors[2]) ? Vec3i32(0, 1, 2) : Vec3i32(0, 2, 1)) :
+                        Vec3i32(2, 0, 1)):
+                    ((errors[1] < errors[2])?
+                        ((errors[0] < errors[2]) ? Vec3i32(1, 0, 2) : Vec3i32(1, 2, 0)) :
+                        Vec3i32(2, 1, 0));
+                if (t_info0.min_index == ord[0]) { 
+                    t_info0.min_index = ord[1];
+                    e.value = errors[t_info0.min_index];
+                } else if (t_info0.min_index == ord[1]) {
+                    t_info0.min_index = ord[2];
+                    e.value = errors[t_info0.min_index];
+                } else {
+                    // error is changed when surround edge is reduced
+                    t_info0.min_index = 3; // bad index -> invalidate
+                    e.value           = std::numeric_limits<float>::max();
+                }
+                // IMPROVE: check mpq top if it is ti1 with same edge
+                mpq.push(e);
+                continue;
+            }
+            
+            last_collapsed_error = e.value;
+            changed_triangle_indices.clear();
+            changed_triangle_indices.reserve(v_info0.count + v_info1.count - 4);
+            
+            // for each vertex0 triangles
+            uint32_t v_info0_end = v_info0.start + v_info0.count - 2;
+            for (uint32_t di = v_info0.start; di < v_info0_end; ++di) {
+                assert(di < e_infos.size());
+                uint32_t    ti     = e_infos[di].t_index;
+                changed_triangle_indices.emplace_back(ti);
+            }
+
+            // for each vertex1 triangles
+            uint32_t v_info1_end = v_info1.start + v_info1.count - 2;
+            for (uint32_t di = v_info1.start; di < v_info1_end; ++di) {
+                assert(di < e_infos.size());
+                EdgeInfo &e_info = e_infos[di];
+                uint32_t    ti     = e_info.t_index;
+                Triangle &t = its.indices[ti];
+                t[e_info.edge] = vi0; // change index
+                changed_triangle_indices.emplace_back(ti);
+            }
+            v_info0.q = q;
+
+            // fix neighbors      
+            // vertex index of triangle 0 which is not vi0 nor vi1
+            uint32_t vi_top0 = t0[(t_info0.min_index + 2) % 3];
+            const Triangle &t1 = its.indices[ti1];
+            change_neighbors(e_infos, v_infos, ti0, ti1, vi0, vi1,
+                vi_top0, t1, ceis, e_infos_swap);
+            
+            // Change vertex
+            its.vertices[vi0] = new_vertex0;
+
+            // fix errors - must be after set neighbors - v_infos
+            mpq.remove(ti_2_mpqi[ti1]);
+            for (uint32_t ti : changed_triangle_indices) {
+                size_t priority_queue_index = ti_2_mpqi[ti];
+                TriangleInfo& t_info = t_infos[ti];
+                t_info.n = create_normal(its.indices[ti], its.vertices).cast<float>(); // recalc normals
+                mpq[priority_queue_index] = calculate_error(ti, its.indices[ti], its.vertices, v_infos, t_info.min_index);
+                mpq.update(priority_queue_index);
+            }
+
+            // set triangle(0 + 1) indices as deleted
+            TriangleInfo &t_info1 = t_infos[ti1];
+            t_info0.set_deleted();
+            t_info1.set_deleted();
+            // triangle counter decrementation
+            actual_triangle_count-=2;
+#ifdef EXPENSIVE_DEBUG_CHECKS
+            if (locked == nullptr)
+                assert(check_neighbors(its, t_infos, v_infos, e_infos));
+#endif // EXPENSIVE_DEBUG_CHECKS
+        }
+    }
+} // namespace QuadricEdgeCollapse
+
 void Slic3r::its_quadric_edge_collapse(
     indexed_triangle_set &    its,
     uint32_t                  triangle_count,
@@ -189,20 +352,11 @@ void Slic3r::its_quadric_edge_collapse(
 
     // convert from triangle index to mutable priority queue index
     std::vector<size_t> ti_2_mpqi(its.indices.size(), {0});
-    auto setter = [&ti_2_mpqi](const Error &e, size_t index) { ti_2_mpqi[e.triangle_index] = index; };
-    auto less = [](const Error &e1, const Error &e2) -> bool { return e1.value < e2.value; };
-    auto mpq = make_miniheap_mutable_priority_queue<Error, 32, false>(std::move(setter), std::move(less)); 
+    auto mpq = make_mutable_priority_queue(ti_2_mpqi);
     //MutablePriorityQueue<Error, decltype(setter), decltype(less)> mpq(std::move(setter), std::move(less));
     mpq.reserve(its.indices.size());
     for (Error &error :errors) mpq.push(error);
 
-    CopyEdgeInfos ceis;
-    ceis.reserve(max_triangle_count_for_one_vertex);
-    EdgeInfos e_infos_swap;
-    e_infos_swap.reserve(max_triangle_count_for_one_vertex);
-    std::vector<uint32_t> changed_triangle_indices;
-    changed_triangle_indices.reserve(2 * max_triangle_count_for_one_vertex);
-
     uint32_t actual_triangle_count = its.indices.size();
     uint32_t count_triangle_to_reduce = actual_triangle_count - triangle_count;
     auto increase_status = [&]() { 
@@ -216,134 +370,160 @@ void Slic3r::its_quadric_edge_collapse(
     uint32_t status_mod = std::max(uint32_t(16), 
         count_triangle_to_reduce / (100 - status_init_size));
 
-    uint32_t iteration_number = 0;
     float last_collapsed_error = 0.f;
-    while (actual_triangle_count > triangle_count && !mpq.empty()) {
-        ++iteration_number;
-        if (iteration_number % status_mod == 0) increase_status();
-        if (iteration_number % check_cancel_period == 0) throw_on_cancel();
-
-        // triangle index 0
-        Error e = mpq.top(); // copy
-        if (e.value >= maximal_error) break; // Too big error
-        mpq.pop();
-        uint32_t ti0 = e.triangle_index;
-        TriangleInfo &t_info0 = t_infos[ti0];
-        if (t_info0.is_deleted()) continue;
-        assert(t_info0.min_index < 3);
-
-        const Triangle &t0 = its.indices[ti0];
-        uint32_t vi0 = t0[t_info0.min_index];
-        uint32_t vi1 = t0[(t_info0.min_index+1) %3];
-        // Need by move of neighbor edge infos in function: change_neighbors
-        if (vi0 > vi1) std::swap(vi0, vi1);
-        VertexInfo &v_info0 = v_infos[vi0];
-        VertexInfo &v_info1 = v_infos[vi1];
-        assert(!v_info0.is_deleted() && !v_info1.is_deleted());
-        
-        // new vertex position
-        SymMat q(v_info0.q);
-        q += v_info1.q;
-        Vec3f new_vertex0 = calculate_vertex(vi0, vi1, q, its.vertices);
-        // set of triangle indices that change quadric
-        uint32_t ti1 = -1; // triangle 1 index
-        auto ti1_opt = (v_info0.count < v_info1.count)?
-            find_triangle_index1(vi1, v_info0, ti0, e_infos, its.indices) :
-            find_triangle_index1(vi0, v_info1, ti0, e_infos, its.indices) ;
-        if (ti1_opt.has_value()) { 
-            ti1 = *ti1_opt;
-            reorder_edges(e_infos, v_info0, ti0, ti1);
-            reorder_edges(e_infos, v_info1, ti0, ti1);
-        }
-        if (!ti1_opt.has_value() || // edge has only one triangle
-            degenerate(vi0, ti0, ti1, v_info1, e_infos, its.indices) ||
-            degenerate(vi1, ti0, ti1, v_info0, e_infos, its.indices) ||
-            create_no_volume(vi0, vi1, ti0, ti1, v_info0, v_info1, e_infos, its.indices) ||
-            is_flipped(new_vertex0, ti0, ti1, v_info0, t_infos, e_infos, its) ||
-            is_flipped(new_vertex0, ti0, ti1, v_info1, t_infos, e_infos, its)) {
-            // try other triangle's edge
-            Vec3d errors = calculate_3errors(t0, its.vertices, v_infos);
-            Vec3i32 ord = (errors[0] < errors[1]) ? 
-                ((errors[0] < errors[2])? 
-                    ((errors[1] < errors[2]) ? Vec3i32(0, 1, 2) : Vec3i32(0, 2, 1)) :
-                    Vec3i32(2, 0, 1)):
-                ((errors[1] < errors[2])?
-                    ((errors[0] < errors[2]) ? Vec3i32(1, 0, 2) : Vec3i32(1, 2, 0)) :
-                    Vec3i32(2, 1, 0));
-            if (t_info0.min_index == ord[0]) { 
-                t_info0.min_index = ord[1];
-                e.value = errors[t_info0.min_index];
-            } else if (t_info0.min_index == ord[1]) {
-                t_info0.min_index = ord[2];
-                e.value = errors[t_info0.min_index];
-            } else {
-                // error is changed when surround edge is reduced
-                t_info0.min_index = 3; // bad index -> invalidate
-                e.value           = maximal_error;
-            }
-            // IMPROVE: check mpq top if it is ti1 with same edge
-            mpq.push(e);
-            continue;
-        }
-        
-        last_collapsed_error = e.value;
-        changed_triangle_indices.clear();
-        changed_triangle_indices.reserve(v_info0.count + v_info1.count - 4);
-        
-        // for each vertex0 triangles
-        uint32_t v_info0_end = v_info0.start + v_info0.count - 2;
-        for (uint32_t di = v_info0.start; di < v_info0_end; ++di) {
-            assert(di < e_infos.size());
-            uint32_t    ti     = e_infos[di].t_index;
-            changed_triangle_indices.emplace_back(ti);
-        }
+    collapse_edges(mpq, its, t_infos, v_infos, e_infos, ti_2_mpqi, nullptr, triangle_count, maximal_error,
+                   actual_triangle_count, last_collapsed_error, throw_on_cancel, status_mod, increase_status);
 
-        // for each vertex1 triangles
-        uint32_t v_info1_end = v_info1.start + v_info1.count - 2;
-        for (uint32_t di = v_info1.start; di < v_info1_end; ++di) {
-            assert(di < e_infos.size());
-            EdgeInfo &e_info = e_infos[di];
-            uint32_t    ti     = e_info.t_index;
-            Triangle &t = its.indices[ti];
-            t[e_info.edge] = vi0; // change index
-            changed_triangle_indices.emplace_back(ti);
-        }
-        v_info0.q = q;
-
-        // fix neighbors      
-        // vertex index of triangle 0 which is not vi0 nor vi1
-        uint32_t vi_top0 = t0[(t_info0.min_index + 2) % 3];
-        const Triangle &t1 = its.indices[ti1];
-        change_neighbors(e_infos, v_infos, ti0, ti1, vi0, vi1,
-            vi_top0, t1, ceis, e_infos_swap);
-        
-        // Change vertex
-        its.vertices[vi0] = new_vertex0;
-
-        // fix errors - must be after set neighbors - v_infos
-        mpq.remove(ti_2_mpqi[ti1]);
-        for (uint32_t ti : changed_triangle_indices) {
-            size_t priority_queue_index = ti_2_mpqi[ti];
-            TriangleInfo& t_info = t_infos[ti];
-            t_info.n = create_normal(its.indices[ti], its.vertices).cast<float>(); // recalc normals
-            mpq[priority_queue_index] = calculate_error(ti, its.indices[ti], its.vertices, v_infos, t_info.min_index);
-            mpq.update(priority_queue_index);
+    // compact triangle
+    compact(v_infos, t_infos, e_infos, its);
+    if (max_error != nullptr) *max_error = last_collapsed_error;
+}
+
+void Slic3r::its_quadric_edge_collapse_parallel(
+    indexed_triangle_set &    its,
+    uint32_t                  triangle_count,
+    float *                   max_error,
+    std::function<void(void)> throw_on_cancel,
+    std::function<void(int)>  status_fn,
+    size_t                    num_patches)
+{
+    // check input
+    if (triangle_count >= its.indices.size()) return;
+    if (num_patches == 0)
+        num_patches = std::min(size_t(2 * tbb::this_task_arena::max_concurrency()), its.indices.size() / min_triangles_per_patch);
+    if (num_patches < 2 || its.vertices.size() < num_patches) {
+        its_quadric_edge_collapse(its, triangle_count, max_error, throw_on_cancel, status_fn);
+        return;
+    }
+    float maximal_error = (max_error == nullptr)? std::numeric_limits<float>::max() : *max_error;
+    if (maximal_error <= 0.f) return;
+    if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
+    if (status_fn == nullptr) status_fn = [](int) {};
+
+    // Split the vertices into slabs of the same vertex count along the longest axis of the bounding box.
+    // The vertices are renumbered, so that the vertices of a patch and their edge infos are stored consecutively,
+    // then change_neighbors() moving the edge infos of the following vertices stays inside of the patch.
+    {
+        const Vec3f size = bounding_box(its).size().cast<float>();
+        const int   axis = size.x() > size.y() ? (size.x() > size.z() ? 0 : 2) : (size.y() > size.z() ? 1 : 2);
+        std::vector<uint32_t> order(its.vertices.size());
+        std::iota(order.begin(), order.end(), 0);
+        tbb::parallel_sort(order.begin(), order.end(), [&its, axis](uint32_t l, uint32_t r) {
+            return its.vertices[l][axis] < its.vertices[r][axis] || (its.vertices[l][axis] == its.vertices[r][axis] && l < r);
+        });
+        std::vector<uint32_t> new_index(order.size());
+        Vertices vertices(order.size());
+        for (uint32_t i = 0; i < order.size(); ++ i) {
+            new_index[order[i]] = i;
+            vertices[i] = its.vertices[order[i]];
         }
+        its.vertices = std::move(vertices);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&its, &new_index](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                for (int j = 0; j < 3; ++ j)
+                    its.indices[i][j] = new_index[its.indices[i][j]];
+        });
+    }
+    throw_on_cancel();
 
-        // set triangle(0 + 1) indices as deleted
-        TriangleInfo &t_info1 = t_infos[ti1];
-        t_info0.set_deleted();
-        t_info1.set_deleted();
-        // triangle counter decrementation
-        actual_triangle_count-=2;
-#ifdef EXPENSIVE_DEBUG_CHECKS
-        assert(check_neighbors(its, t_infos, v_infos, e_infos));
-#endif // EXPENSIVE_DEBUG_CHECKS
+    StatusFn init_status_fn = [&](int percent) {
+        float n_percent = percent * status_init_size / 100.f;
+        status_fn(static_cast<int>(std::round(n_percent)));
+    };
+
+    TriangleInfos t_infos; // only normals with information about deleted triangle
+    VertexInfos   v_infos;
+    EdgeInfos     e_infos;
+    Errors        errors;
+    std::tie(t_infos, v_infos, e_infos, errors) = init(its, throw_on_cancel, init_status_fn);
+    throw_on_cancel();
+    status_fn(status_init_size);
+
+    // Triangles with all vertices inside a patch are simplified by the patch, the vertices of the triangles
+    // spanning more patches are locked until the final pass.
+    const size_t num_vertices = its.vertices.size();
+    auto patch_of_vertex = [num_vertices, num_patches](uint32_t vi) { return size_t(vi) * num_patches / num_vertices; };
+    std::vector<uint8_t>               locked(num_vertices, 0);
+    std::vector<std::vector<uint32_t>> patch_triangles(num_patches);
+    for (uint32_t ti = 0; ti < its.indices.size(); ++ ti) {
+        const Triangle &t = its.indices[ti];
+        size_t patch = patch_of_vertex(t[0]);
+        if (patch == patch_of_vertex(t[1]) && patch == patch_of_vertex(t[2]))
+            patch_triangles[patch].emplace_back(ti);
+        else
+            locked[t[0]] = locked[t[1]] = locked[t[2]] = 1;
+    }
+    // The triangles touching a locked vertex are left to the final pass, a patch reduces just the others,
+    // otherwise a small patch would be simplified way over the error of the rest of the mesh.
+    std::vector<uint32_t> patch_target(num_patches);
+    const double          ratio = double(triangle_count) / double(its.indices.size());
+    for (size_t patch = 0; patch < num_patches; ++ patch) {
+        const std::vector<uint32_t> &triangles = patch_triangles[patch];
+        uint32_t num_locked = std::count_if(triangles.begin(), triangles.end(), [&its, &locked](uint32_t ti) {
+            const Triangle &t = its.indices[ti];
+            return locked[t[0]] || locked[t[1]] || locked[t[2]];
+        });
+        patch_target[patch] = num_locked + uint32_t((triangles.size() - num_locked) * ratio);
     }
 
+    // Each patch is reduced by the same ratio as the whole mesh, the final pass reduces the triangles around the borders.
+    std::vector<size_t>   ti_2_mpqi(its.indices.size(), {0});
+    std::vector<uint32_t> patch_reduced(num_patches, 0);
+    std::vector<float>    patch_last_error(num_patches, 0.f);
+    std::mutex            status_mutex;
+    size_t                patches_done = 0;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_patches, 1), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t patch = range.begin(); patch < range.end(); ++ patch) {
+            const std::vector<uint32_t> &triangles = patch_triangles[patch];
+            auto mpq = make_mutable_priority_queue(ti_2_mpqi);
+            mpq.reserve(triangles.size());
+            for (uint32_t ti : triangles) mpq.push(errors[ti]);
+            uint32_t actual_triangle_count = triangles.size();
+            collapse_edges(mpq, its, t_infos, v_infos, e_infos, ti_2_mpqi, &locked, patch_target[patch], maximal_error,
+                           actual_triangle_count, patch_last_error[patch], throw_on_cancel, std::numeric_limits<uint32_t>::max(), {});
+            patch_reduced[patch] = triangles.size() - actual_triangle_count;
+            // status_fn is not expected to be thread safe.
+            std::lock_guard<std::mutex> lock(status_mutex);
+            status_fn(status_init_size + int((100 - status_init_size) * 7 / 10 * ++ patches_done / num_patches));
+        }
+    });
+    throw_on_cancel();
+    // Release the memory of the patches.
+    patch_triangles = {};
+    locked = {};
+
+    // Final pass over the whole mesh. The errors of the triangles may have changed with their neighbors.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t ti = range.begin(); ti < range.end(); ++ ti)
+            if (! t_infos[ti].is_deleted())
+                errors[ti] = calculate_error(ti, its.indices[ti], its.vertices, v_infos, t_infos[ti].min_index);
+    });
+    uint32_t actual_triangle_count = its.indices.size();
+    for (uint32_t reduced : patch_reduced)
+        actual_triangle_count -= reduced;
+    auto mpq = make_mutable_priority_queue(ti_2_mpqi);
+    mpq.reserve(actual_triangle_count);
+    for (size_t ti = 0; ti < its.indices.size(); ++ ti)
+        if (! t_infos[ti].is_deleted())
+            mpq.push(errors[ti]);
+    errors = {};
+
+    const int status_final = status_init_size + (100 - status_init_size) * 7 / 10;
+    uint32_t  count_triangle_to_reduce = std::max(actual_triangle_count, triangle_count + 1) - triangle_count;
+    auto increase_status = [&]() {
+        double reduced = (actual_triangle_count - triangle_count) / (double) count_triangle_to_reduce;
+        status_fn(static_cast<int>(std::round(status_final + (100 - status_final) * (1. - reduced))));
+    };
+    uint32_t status_mod = std::max(uint32_t(16), count_triangle_to_reduce / (100 - status_final));
+
+    float last_collapsed_error = 0.f;
+    collapse_edges(mpq, its, t_infos, v_infos, e_infos, ti_2_mpqi, nullptr, triangle_count, maximal_error,
+                   actual_triangle_count, last_collapsed_error, throw_on_cancel, status_mod, increase_status);
+
     // compact triangle
     compact(v_infos, t_infos, e_infos, its);
-    if (max_error != nullptr) *max_error = last_collapsed_error;
+    if (max_error != nullptr)
+        *max_error = std::max(last_collapsed_error, *std::max_element(patch_last_error.begin(), patch_last_error.end()));
 }
 
 Vec3d QuadricEdgeCollapse::create_normal(const Triangle &triangle,
@@ -25,4 +25,21 @@ void its_quadric_edge_collapse(
     std::function<void(void)> throw_on_cancel = nullptr,
     std::function<void(int)>  statusfn        = nullptr);
 
+/// <summary>
+/// Parallel variant of its_quadric_edge_collapse for large meshes.
+/// The mesh is split spatially into patches, which are simplified concurrently
+/// while the vertices on the borders between the patches are kept. A final pass
+/// over the whole mesh simplifies the borders and reaches the wanted triangle count.
+/// The order of the vertices of the simplified mesh differs from the serial variant.
+/// </summary>
+/// <param name="num_patches">Number of patches, 0 to derive it from the mesh size
+/// and the number of threads. Small meshes are simplified by its_quadric_edge_collapse.</param>
+void its_quadric_edge_collapse_parallel(
+    indexed_triangle_set &    its,
+    uint32_t                  triangle_count  = 0,
+    float *                   max_error       = nullptr,
+    std::function<void(void)> throw_on_cancel = nullptr,
+    std::function<void(int)>  statusfn        = nullptr,
+    size_t                    num_patches     = 0);
+
 } // namespace Slic3r
@@ -147,7 +147,7 @@ public:
             m_pxdim_scaled.h_mm /= pd.h_mm;
         }
         m_renderer.color(foreground);
-        clear(background);
+        fill(background);
         
         m_rasterizer.gamma(gammafn);
     }
@@ -167,7 +167,7 @@ public:
         return encoder(m_buf.data(), m_resolution.width_px, m_resolution.height_px, 1);    
     }
     
-    void clear(const TColor color) { m_raw_renderer.clear(color); }
+    void fill(const TColor color) { m_raw_renderer.clear(color); }
 };
 
 /*
@@ -207,7 +207,7 @@ public:
         return px;
     }
     
-    void clear() { Base::clear(Colors<TColor>::Black); }
+    void clear() override { Base::fill(Colors<TColor>::Black); }
 };
 
 class RasterGrayscaleAAGammaPower: public RasterGrayscaleAA {
@@ -11,25 +11,84 @@
 
 namespace Slic3r { namespace sla {
 
+namespace {
+
+// Deflate state and output buffer of the PNG encoder. The compressor alone takes about 300kB, each thread keeps
+// its own for all the rasters it encodes.
+struct PNGEncoderState
+{
+    std::unique_ptr<tdefl_compressor, decltype(&tdefl_compressor_free)> compressor { tdefl_compressor_alloc(), &tdefl_compressor_free };
+    std::vector<uint8_t>                                                idat;
+};
+
+mz_bool png_output_putter(const void *data, int len, void *user)
+{
+    auto &buf = *static_cast<std::vector<uint8_t> *>(user);
+    auto  ptr = static_cast<const uint8_t *>(data);
+    buf.insert(buf.end(), ptr, ptr + len);
+    return MZ_TRUE;
+}
+
+void png_append_u32(std::vector<uint8_t> &buf, uint32_t val)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        buf.push_back(uint8_t(val >> shift));
+}
+
+void png_append_chunk(std::vector<uint8_t> &buf, const char *type, const uint8_t *data, size_t len)
+{
+    png_append_u32(buf, uint32_t(len));
+    const size_t type_pos = buf.size();
+    buf.insert(buf.end(), type, type + 4);
+    buf.insert(buf.end(), data, data + len);
+    png_append_u32(buf, uint32_t(mz_crc32(MZ_CRC32_INIT, buf.data() + type_pos, len + 4)));
+}
+
+} // namespace
+
+// Same output as tdefl_write_image_to_png_file_in_memory(), which allocates a new compressor and an output buffer
+// of the size of the whole image for each call.
 EncodedRaster PNGRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
                                            size_t      num_components)
 {
-    std::vector<uint8_t> buf;
-    size_t s = 0;
-    
-    void *rawdata = tdefl_write_image_to_png_file_in_memory(
-        ptr, int(w), int(h), int(num_components), &s);
-    
+    // Number of probes of the default compression level 6, see tdefl_write_image_to_png_file_in_memory_ex().
+    static constexpr mz_uint num_probes = 128;
+    static constexpr uint8_t color_types[] = { 0x00, 0x00, 0x04, 0x02, 0x06 };
+
+    thread_local PNGEncoderState state;
+
     // On error, data() will return an empty vector. No other info can be
     // retrieved from miniz anyway...
-    if (rawdata == nullptr) return EncodedRaster({}, "png");
-    
-    auto pptr = static_cast<std::uint8_t*>(rawdata);
-    
-    buf.reserve(s);
-    std::copy(pptr, pptr + s, std::back_inserter(buf));
-    
-    MZ_FREE(rawdata);
+    if (! state.compressor || num_components == 0 || num_components >= std::size(color_types))
+        return EncodedRaster({}, "png");
+
+    state.idat.clear();
+    tdefl_init(state.compressor.get(), png_output_putter, &state.idat, num_probes | TDEFL_WRITE_ZLIB_HEADER);
+    const size_t bpl    = w * num_components;
+    const auto  *pixels = static_cast<const uint8_t *>(ptr);
+    for (size_t y = 0; y < h; ++ y) {
+        // Filter type "none" for each row.
+        const uint8_t filter = 0;
+        tdefl_compress_buffer(state.compressor.get(), &filter, 1, TDEFL_NO_FLUSH);
+        tdefl_compress_buffer(state.compressor.get(), pixels + y * bpl, bpl, TDEFL_NO_FLUSH);
+    }
+    if (tdefl_compress_buffer(state.compressor.get(), nullptr, 0, TDEFL_FINISH) != TDEFL_STATUS_DONE)
+        return EncodedRaster({}, "png");
+
+    static constexpr uint8_t signature[] = { 0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a };
+    std::vector<uint8_t> buf;
+    buf.reserve(std::size(signature) + 25 + 12 + state.idat.size() + 12);
+    buf.insert(buf.end(), std::begin(signature), std::end(signature));
+
+    std::vector<uint8_t> ihdr;
+    png_append_u32(ihdr, uint32_t(w));
+    png_append_u32(ihdr, uint32_t(h));
+    // Bit depth, color type, compression, filter and interlace methods.
+    ihdr.insert(ihdr.end(), { 8, color_types[num_components], 0, 0, 0 });
+    png_append_chunk(buf, "IHDR", ihdr.data(), ihdr.size());
+    png_append_chunk(buf, "IDAT", state.idat.data(), state.idat.size());
+    png_append_chunk(buf, "IEND", nullptr, 0);
+
     return EncodedRaster(std::move(buf), "png");
 }
 
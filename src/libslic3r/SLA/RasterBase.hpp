@@ -92,6 +92,9 @@ public:
 //    virtual Resolution resolution() const = 0;
 //    virtual PixelDim   pixel_dimensions() const = 0;
     virtual Trafo      trafo() const = 0;
+
+    /// Clear the raster to the background, so that it can be reused for the next layer.
+    virtual void clear() = 0;
     
     virtual EncodedRaster encode(RasterEncoder encoder) const = 0;
 };
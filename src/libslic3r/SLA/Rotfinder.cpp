@@ -10,9 +10,11 @@
 
 #include "libslic3r/SLAPrint.hpp"
 #include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/MeshProxy.hpp"
 
 #include <libslic3r/Geometry.hpp>
 
+#include <mutex>
 #include <thread>
 
 namespace Slic3r { namespace sla {
@@ -280,6 +282,48 @@ std::array<double, N> find_min_score(Fn &&fn, It from, It to, StopCond &&stopfn)
     return ret;
 }
 
+// The best rotations found on the proxy mesh, to be scored once more on the full mesh.
+class BestRotations {
+public:
+    explicit BestRotations(size_t count) : m_count(count) {}
+
+    // Lower score is better. May be called in parallel.
+    void add(const XYRotation &rot, double score)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::upper_bound(m_best.begin(), m_best.end(), score,
+                                   [](double s, const RotScore &r) { return s < r.score; });
+        if (size_t(it - m_best.begin()) < m_count) {
+            m_best.insert(it, {rot, score});
+            if (m_best.size() > m_count)
+                m_best.pop_back();
+        }
+    }
+
+    // The collected rotation of the lowest score_fn(rotation).
+    template<class Fn> XYRotation pick(Fn &&score_fn, const XYRotation &fallback) const
+    {
+        XYRotation rot   = fallback;
+        double     score = std::numeric_limits<double>::max();
+        for (const RotScore &r : m_best)
+            if (double s = score_fn(r.rot); s < score) {
+                rot   = r.rot;
+                score = s;
+            }
+        return rot;
+    }
+
+private:
+    struct RotScore { XYRotation rot; double score; };
+
+    size_t                m_count;
+    std::vector<RotScore> m_best;
+    std::mutex            m_mutex;
+};
+
+// Number of the best rotations found on the proxy mesh to be scored on the full mesh.
+constexpr size_t PROXY_CANDIDATES = 8;
+
 } // namespace
 
 
@@ -290,36 +334,56 @@ struct RotfinderBoilerplate {
 
     int status = 0;
     TriangleMesh mesh;
+    // Decimated mesh, empty if the mesh is small enough.
+    TriangleMesh proxy;
     unsigned max_tries;
     const RotOptimizeParams &params;
 
     // Assemble the mesh with the correct transformation to be used in rotation
     // optimization.
-    static TriangleMesh get_mesh_to_rotate(const ModelObject &mo)
+    static Transform3d get_trafo_to_rotate(const ModelObject &mo)
     {
-        TriangleMesh mesh = mo.raw_mesh();
-
         ModelInstance *mi = mo.instances[0];
         auto rotation = Vec3d::Zero();
         auto offset = Vec3d::Zero();
-        Transform3d trafo_instance =
-            Geometry::assemble_transform(offset, rotation,
-                                         mi->get_scaling_factor(),
-                                         mi->get_mirror());
+        return Geometry::assemble_transform(offset, rotation,
+                                            mi->get_scaling_factor(),
+                                            mi->get_mirror());
+    }
 
-        mesh.transform(trafo_instance);
+    static TriangleMesh get_mesh_to_rotate(const ModelObject &mo)
+    {
+        TriangleMesh mesh = mo.raw_mesh();
+        mesh.transform(get_trafo_to_rotate(mo));
+
+        return mesh;
+    }
+
+    // The same as above, but decimated. Empty if the proxy of the ModelObject is not ready, don't wait for it.
+    static TriangleMesh get_proxy_to_rotate(const ModelObject &mo)
+    {
+        std::shared_ptr<const MeshProxy> proxy = mo.proxy_mesh();
+        if (! proxy || ! proxy->ready() || ! proxy->decimated())
+            return {};
+
+        TriangleMesh mesh(proxy->its());
+        mesh.transform(get_trafo_to_rotate(mo));
 
         return mesh;
     }
 
     RotfinderBoilerplate(const ModelObject &mo, const RotOptimizeParams &p)
         : mesh{get_mesh_to_rotate(mo)}
+        , proxy{get_proxy_to_rotate(mo)}
         , params{p}
         , max_tries(p.accuracy() * MAX_TRIES)
     {
 
     }
 
+    // The rotations are searched on the proxy, if there is one.
+    const TriangleMesh &search_mesh() const { return proxy.empty() ? mesh : proxy; }
+
     void statusfn() { params.statuscb()(++status * 100.0 / max_tries); }
     bool stopcond() { return ! params.statuscb()(-1); }
 };
@@ -342,14 +406,21 @@ Vec2d find_best_misalignment_rotation(const ModelObject &      mo,
     // We can specify the bounds for a dimension in the following way:
     auto bounds = opt::bounds({ {-PI, PI}, {-PI, PI} });
 
+    BestRotations best{PROXY_CANDIDATES};
     auto result = solver.to_max().optimize(
-        [&bp] (const XYRotation &rot)
+        [&bp, &best] (const XYRotation &rot)
         {
             bp.statusfn();
-            return get_misalginment_score(bp.mesh, to_transform3f(rot));
+            double score = get_misalginment_score(bp.search_mesh(), to_transform3f(rot));
+            best.add(rot, -score);
+            return score;
         }, opt::initvals({0., 0.}), bounds);
 
-    return {result.optimum[0], result.optimum[1]};
+    XYRotation rot = result.optimum;
+    if (! bp.proxy.empty())
+        rot = best.pick([&bp](const XYRotation &rot) { return -get_misalginment_score(bp.mesh, to_transform3f(rot)); }, rot);
+
+    return {rot[0], rot[1]};
 }
 
 Vec2d find_least_supports_rotation(const ModelObject &      mo,
@@ -368,22 +439,28 @@ Vec2d find_least_supports_rotation(const ModelObject &      mo,
     // Different search methods have to be used depending on the model elevation
     if (is_on_floor(pocfg)) {
 
-        std::vector<XYRotation> inputs = get_chull_rotations(bp.mesh, bp.max_tries);
+        std::vector<XYRotation> inputs = get_chull_rotations(bp.search_mesh(), bp.max_tries);
         bp.max_tries = inputs.size();
 
         // If the model can be placed on the bed directly, we only need to
         // check the 3D convex hull face rotations.
 
-        auto objfn = [&bp](const XYRotation &rot) {
+        BestRotations best{PROXY_CANDIDATES};
+        auto objfn = [&bp, &best](const XYRotation &rot) {
             bp.statusfn();
             Transform3f tr = to_transform3f(rot);
-            return get_supportedness_onfloor_score(bp.mesh, tr);
+            double score = get_supportedness_onfloor_score(bp.search_mesh(), tr);
+            best.add(rot, score);
+            return score;
         };
 
         rot = find_min_score<2>(objfn, inputs.begin(), inputs.end(), [&bp] {
             return bp.stopcond();
         });
 
+        if (! bp.proxy.empty())
+            rot = best.pick([&bp](const XYRotation &rot) { return get_supportedness_onfloor_score(bp.mesh, to_transform3f(rot)); }, rot);
+
     } else {
         // Preparing the optimizer.
         size_t gridsize = std::sqrt(bp.max_tries); // 2D grid has gridsize^2 calls
@@ -398,15 +475,20 @@ Vec2d find_least_supports_rotation(const ModelObject &      mo,
         // We can specify the bounds for a dimension in the following way:
         auto bounds = opt::bounds({ {-PI, PI}, {-PI, PI} });
 
+        BestRotations best{PROXY_CANDIDATES};
         auto result = solver.to_min().optimize(
-            [&bp] (const XYRotation &rot)
+            [&bp, &best] (const XYRotation &rot)
             {
                 bp.statusfn();
-                return get_supportedness_score(bp.mesh, to_transform3f(rot));
+                double score = get_supportedness_score(bp.search_mesh(), to_transform3f(rot));
+                best.add(rot, score);
+                return score;
             }, opt::initvals({0., 0.}), bounds);
 
         // Save the result
         rot = result.optimum;
+        if (! bp.proxy.empty())
+            rot = best.pick([&bp](const XYRotation &rot) { return get_supportedness_score(bp.mesh, to_transform3f(rot)); }, rot);
     }
 
     return {rot[0], rot[1]};
@@ -434,7 +516,7 @@ Vec2d find_min_z_height_rotation(const ModelObject &mo,
 {
     RotfinderBoilerplate<1000> bp{mo, params};
 
-    TriangleMesh chull = bp.mesh.convex_hull_3d();
+    TriangleMesh chull = bp.search_mesh().convex_hull_3d();
     auto inputs = reserve_vector<XYRotation>(chull.its.indices.size());
     auto rotcmp = [](const XYRotation &r1, const XYRotation &r2) {
         double xdiff = r1[X] - r2[X], ydiff = r1[Y] - r2[Y];
@@ -460,16 +542,23 @@ Vec2d find_min_z_height_rotation(const ModelObject &mo,
     inputs.shrink_to_fit();
     bp.max_tries = inputs.size();
 
-    auto objfn = [&bp, &chull](const XYRotation &rot) {
+    BestRotations best{PROXY_CANDIDATES};
+    auto objfn = [&bp, &chull, &best](const XYRotation &rot) {
         bp.statusfn();
         Transform3f tr = to_transform3f(rot);
-        return bounding_box_with_tr(chull.its, tr).size().z();
+        double height = bounding_box_with_tr(chull.its, tr).size().z();
+        best.add(rot, height);
+        return height;
     };
 
     XYRotation rot = find_min_score<2>(objfn, inputs.begin(), inputs.end(), [&bp] {
         return bp.stopcond();
     });
 
+    // The height of the full mesh is the height of its convex hull.
+    if (! bp.proxy.empty())
+        rot = best.pick([&bp](const XYRotation &rot) { return bounding_box_with_tr(bp.mesh.its, to_transform3f(rot)).size().z(); }, rot);
+
     return {rot[0], rot[1]};
 }
 
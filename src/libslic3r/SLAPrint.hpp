@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <mutex>
+#include <tbb/enumerable_thread_specific.h>
 #include "PrintBase.hpp"
 #include "SLA/RasterBase.hpp"
 #include "SLA/SupportTree.hpp"
@@ -409,13 +410,19 @@ public:
         const EP & ep       = {})
     {
         m_layers.resize(layer_num);
+        // A raster holds a full resolution frame, each thread reuses its own for all the layers it draws.
+        tbb::enumerable_thread_specific<std::unique_ptr<sla::RasterBase>> rasters;
         execution::for_each(
             ep, size_t(0), m_layers.size(),
-            [this, &drawfn, &cancelfn](size_t idx) {
+            [this, &drawfn, &cancelfn, &rasters](size_t idx) {
                 if (cancelfn()) return;
 
-                sla::EncodedRaster &enc = m_layers[idx];
-                auto                rst = create_raster();
+                sla::EncodedRaster               &enc = m_layers[idx];
+                std::unique_ptr<sla::RasterBase> &rst = rasters.local();
+                if (rst)
+                    rst->clear();
+                else
+                    rst = create_raster();
                 drawfn(*rst, idx);
                 enc = rst->encode(get_encoder());
             },
@@ -12,6 +12,9 @@
 
 #include <cmath>
 #include <cassert>
+#include <numeric>
+
+#include <tbb/parallel_for.h>
 
 namespace Slic3r {
 
@@ -1959,6 +1962,208 @@ Polylines chain_polylines(Polylines &&polylines, const Point *start_near)
 	return out;
 }
 
+// Split the segments into partitions of at most max_partition_size segments by recursively splitting their centers
+// at the median of the longer side of their bounding box. The half closer to the center of the previously emitted partition
+// is visited first, so that consecutive partitions are mostly neighbors.
+static void partition_segments_for_chaining(const std::vector<Vec2d> &centers, std::vector<size_t>::iterator begin, std::vector<size_t>::iterator end,
+	size_t max_partition_size, Vec2d &entry, std::vector<std::vector<size_t>> &out)
+{
+	const size_t num_segments = end - begin;
+	if (num_segments <= max_partition_size) {
+		out.emplace_back(begin, end);
+		Vec2d center = Vec2d::Zero();
+		for (auto it = begin; it != end; ++ it)
+			center += centers[*it];
+		entry = center / double(num_segments);
+		return;
+	}
+	Vec2d bbox_min = centers[*begin];
+	Vec2d bbox_max = bbox_min;
+	for (auto it = begin; it != end; ++ it) {
+		bbox_min = bbox_min.cwiseMin(centers[*it]);
+		bbox_max = bbox_max.cwiseMax(centers[*it]);
+	}
+	const int axis = bbox_max.x() - bbox_min.x() > bbox_max.y() - bbox_min.y() ? 0 : 1;
+	auto      mid  = begin + num_segments / 2;
+	std::nth_element(begin, mid, end, [&centers, axis](size_t l, size_t r) { return centers[l][axis] < centers[r][axis]; });
+	if (entry[axis] <= centers[*mid][axis]) {
+		partition_segments_for_chaining(centers, begin, mid, max_partition_size, entry, out);
+		partition_segments_for_chaining(centers, mid, end, max_partition_size, entry, out);
+	} else {
+		partition_segments_for_chaining(centers, mid, end, max_partition_size, entry, out);
+		partition_segments_for_chaining(centers, begin, mid, max_partition_size, entry, out);
+	}
+}
+
+// Improve a chain by 2-opt moves: A sub-chain is reversed (both the order and the direction of its segments) if it shortens
+// the two connections to the rest of the chain. Only sub-chains of up to 64 segments, which all could be reversed, are tried,
+// thus a sweep is linear in the number of segments. Sweeps are repeated until no move improves the chain or max_moves moves were tried.
+// The budget is counted in moves rather than in time to make the result independent of the machine and of its load.
+template<typename SegmentEndPointFunc, typename CouldReverseFunc>
+static void improve_chain_by_two_opt(std::vector<std::pair<size_t, bool>> &chain, SegmentEndPointFunc end_point_func, CouldReverseFunc could_reverse_func,
+	bool fixed_start, size_t max_moves)
+{
+	static constexpr const size_t window = 64;
+	size_t num_moves = 0;
+	auto start_of = [&end_point_func](const std::pair<size_t, bool> &segment) -> Vec2d { return end_point_func(segment.first, ! segment.second).template cast<double>(); };
+	auto end_of   = [&end_point_func](const std::pair<size_t, bool> &segment) -> Vec2d { return end_point_func(segment.first, segment.second).template cast<double>(); };
+	const size_t num_segments = chain.size();
+	for (bool improved = true; improved;) {
+		improved = false;
+		for (size_t i = fixed_start ? 1 : 0; i < num_segments; ++ i) {
+			for (size_t j = i; j < std::min(num_segments, i + window) && could_reverse_func(chain[j].first); ++ j) {
+				if (++ num_moves > max_moves)
+					return;
+				// Connections (i - 1 -> i) and (j -> j + 1) are replaced by (i - 1 -> j reversed) and (i reversed -> j + 1).
+				double cost_old = 0.;
+				double cost_new = 0.;
+				if (i > 0) {
+					Vec2d prev = end_of(chain[i - 1]);
+					cost_old += (start_of(chain[i]) - prev).norm();
+					cost_new += (end_of(chain[j]) - prev).norm();
+				}
+				if (j + 1 < num_segments) {
+					Vec2d next = start_of(chain[j + 1]);
+					cost_old += (next - end_of(chain[j])).norm();
+					cost_new += (next - start_of(chain[i])).norm();
+				}
+				if (cost_new < cost_old - EPSILON) {
+					std::reverse(chain.begin() + i, chain.begin() + j + 1);
+					for (size_t k = i; k <= j; ++ k)
+						chain[k].second = ! chain[k].second;
+					improved = true;
+				}
+			}
+		}
+	}
+}
+
+// Chain a large number of segments in parallel: Spatially partition the segments, chain the partitions concurrently by chain_func,
+// then stitch the partial chains in the order of the partitions, reversing a partial chain if it shortens the connection and if all
+// its segments could be reversed. Optionally the stitched chain is improved by 2-opt moves.
+template<typename SegmentEndPointFunc, typename CouldReverseFunc, typename ChainFunc>
+static std::vector<std::pair<size_t, bool>> chain_segments_parallel(SegmentEndPointFunc end_point_func, CouldReverseFunc could_reverse_func, size_t num_segments,
+	const Point *start_near, const ChainParallelParams &params, ChainFunc chain_func)
+{
+	std::vector<std::pair<size_t, bool>> out;
+	if (num_segments < std::max<size_t>(params.min_items, 2) || num_segments <= params.max_partition_items) {
+		out = chain_func(end_point_func, could_reverse_func, num_segments, start_near);
+	} else {
+		std::vector<Vec2d> centers(num_segments);
+		for (size_t i = 0; i < num_segments; ++ i)
+			centers[i] = 0.5 * (end_point_func(i, true).template cast<double>() + end_point_func(i, false).template cast<double>());
+		std::vector<size_t> indices(num_segments);
+		std::iota(indices.begin(), indices.end(), 0);
+		Vec2d entry = start_near ? start_near->cast<double>() : centers.front();
+		std::vector<std::vector<size_t>> partitions;
+		partition_segments_for_chaining(centers, indices.begin(), indices.end(), std::max<size_t>(params.max_partition_items, 2), entry, partitions);
+
+		std::vector<std::vector<std::pair<size_t, bool>>> chains(partitions.size());
+		tbb::parallel_for(tbb::blocked_range<size_t>(0, partitions.size()), [&partitions, &chains, &end_point_func, &could_reverse_func, &chain_func, start_near](const tbb::blocked_range<size_t> &range) {
+			for (size_t partition_idx = range.begin(); partition_idx < range.end(); ++ partition_idx) {
+				const std::vector<size_t> &partition = partitions[partition_idx];
+				auto partition_end_point   = [&partition, &end_point_func](size_t idx, bool first_point) -> const Point& { return end_point_func(partition[idx], first_point); };
+				auto partition_could_reverse = [&partition, &could_reverse_func](size_t idx) { return could_reverse_func(partition[idx]); };
+				// Only the first partition starts near start_near, the other partial chains are oriented when stitching.
+				std::vector<std::pair<size_t, bool>> &chain = chains[partition_idx];
+				chain = chain_func(partition_end_point, partition_could_reverse, partition.size(), partition_idx == 0 ? start_near : nullptr);
+				for (std::pair<size_t, bool> &segment : chain)
+					segment.first = partition[segment.first];
+			}
+		});
+
+		out.reserve(num_segments);
+		for (std::vector<std::pair<size_t, bool>> &chain : chains) {
+			if (! out.empty() && ! chain.empty()) {
+				const Vec2d last   = end_point_func(out.back().first, out.back().second).template cast<double>();
+				const Vec2d first  = end_point_func(chain.front().first, ! chain.front().second).template cast<double>();
+				const Vec2d second = end_point_func(chain.back().first, chain.back().second).template cast<double>();
+				if ((second - last).squaredNorm() < (first - last).squaredNorm() &&
+					std::all_of(chain.begin(), chain.end(), [&could_reverse_func](const std::pair<size_t, bool> &segment) { return could_reverse_func(segment.first); })) {
+					std::reverse(chain.begin(), chain.end());
+					for (std::pair<size_t, bool> &segment : chain)
+						segment.second = ! segment.second;
+				}
+			}
+			append(out, std::move(chain));
+		}
+	}
+	if (params.refine_max_moves > 0 && out.size() > 1)
+		improve_chain_by_two_opt(out, end_point_func, could_reverse_func, start_near != nullptr, params.refine_max_moves);
+	assert(out.size() == num_segments);
+	return out;
+}
+
+std::vector<size_t> chain_points_parallel(const Points &points, Point *start_near, const ChainParallelParams &params)
+{
+	auto segment_end_point = [&points](size_t idx, bool /* first_point */) -> const Point& { return points[idx]; };
+	auto could_reverse     = [](size_t /* idx */) { return true; };
+	std::vector<std::pair<size_t, bool>> ordered = chain_segments_parallel(segment_end_point, could_reverse, points.size(), start_near, params,
+		[](auto end_point_func, auto /* could_reverse_func */, size_t num_segments, const Point *start_near) {
+			return chain_segments_greedy<Point, decltype(end_point_func)>(end_point_func, num_segments, start_near);
+		});
+	std::vector<size_t> out;
+	out.reserve(ordered.size());
+	for (auto &segment_and_reversal : ordered)
+		out.emplace_back(segment_and_reversal.first);
+	return out;
+}
+
+std::vector<std::pair<size_t, bool>> chain_extrusion_entities_parallel(std::vector<ExtrusionEntity*> &entities, const Point *start_near, const ChainParallelParams &params)
+{
+	auto segment_end_point = [&entities](size_t idx, bool first_point) -> const Point& { return first_point ? entities[idx]->first_point() : entities[idx]->last_point(); };
+	auto could_reverse = [&entities](size_t idx) { const ExtrusionEntity *ee = entities[idx]; return ee->is_loop() || ee->can_reverse(); };
+	std::vector<std::pair<size_t, bool>> out = chain_segments_parallel(segment_end_point, could_reverse, entities.size(), start_near, params,
+		[](auto end_point_func, auto could_reverse_func, size_t num_segments, const Point *start_near) {
+			return chain_segments_greedy_constrained_reversals<Point, decltype(end_point_func), decltype(could_reverse_func)>(end_point_func, could_reverse_func, num_segments, start_near);
+		});
+	for (std::pair<size_t, bool> &segment : out) {
+		ExtrusionEntity *ee = entities[segment.first];
+		if (ee->is_loop())
+			// Ignore reversals for loops, as the start point equals the end point.
+			segment.second = false;
+		assert(ee->can_reverse() || ! segment.second);
+	}
+	return out;
+}
+
+void chain_and_reorder_extrusion_entities_parallel(std::vector<ExtrusionEntity*> &entities, const Point *start_near, const ChainParallelParams &params)
+{
+	reorder_extrusion_entities(entities, chain_extrusion_entities_parallel(entities, start_near, params));
+}
+
+// Unlike chain_polylines(), the O(n^2) improvement by two exchanges is not run, it is replaced by the optional 2-opt refinement with a move budget.
+Polylines chain_polylines_parallel(Polylines &&polylines, const Point *start_near, const ChainParallelParams &params)
+{
+	if (polylines.size() < params.min_items && params.refine_max_moves == 0)
+		return chain_polylines(std::move(polylines), start_near);
+
+	auto segment_end_point = [&polylines](size_t idx, bool first_point) -> const Point& { return first_point ? polylines[idx].first_point() : polylines[idx].last_point(); };
+	auto could_reverse     = [](size_t /* idx */) { return true; };
+	std::vector<std::pair<size_t, bool>> ordered = chain_segments_parallel(segment_end_point, could_reverse, polylines.size(), start_near, params,
+		[](auto end_point_func, auto /* could_reverse_func */, size_t num_segments, const Point *start_near) {
+			return chain_segments_greedy2<Point, decltype(end_point_func)>(end_point_func, num_segments, start_near);
+		});
+	Polylines out;
+	out.reserve(polylines.size());
+	for (auto &segment_and_reversal : ordered) {
+		out.emplace_back(std::move(polylines[segment_and_reversal.first]));
+		if (segment_and_reversal.second)
+			out.back().reverse();
+	}
+	return out;
+}
+
+std::vector<std::pair<size_t, bool>> chain_segments_two_opt(const std::vector<std::pair<Point, Point>> &segments, const Point *start_near, size_t refine_max_moves)
+{
+	auto segment_end_point = [&segments](size_t idx, bool first_point) -> const Point& { return first_point ? segments[idx].first : segments[idx].second; };
+	auto could_reverse     = [](size_t /* idx */) { return true; };
+	std::vector<std::pair<size_t, bool>> out = chain_segments_greedy<Point, decltype(segment_end_point)>(segment_end_point, segments.size(), start_near);
+	if (refine_max_moves > 0 && out.size() > 2)
+		improve_chain_by_two_opt(out, segment_end_point, could_reverse, start_near != nullptr, refine_max_moves);
+	return out;
+}
+
 template<class T> static inline T chain_path_items(const Points &points, const T &items)
 {
 	auto segment_end_point = [&points](size_t idx, bool /* first_point */) -> const Point& { return points[idx]; };
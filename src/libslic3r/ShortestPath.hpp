@@ -39,6 +39,29 @@ template<typename T> inline void reorder_by_shortest_traverse(std::vector<T> &po
     for (size_t i:order) polylines_out.emplace_back(std::move(Temp[i]));
 }
 
+// Parameters of the parallel chaining of large inputs.
+struct ChainParallelParams
+{
+    // Inputs with fewer items are chained by the sequential algorithms.
+    size_t min_items             { 4096 };
+    // Maximum number of items chained by a single task.
+    size_t max_partition_items   { 1024 };
+    // Maximum number of moves tried by the 2-opt refinement of the final chain, zero disables the refinement.
+    size_t refine_max_moves      { 0 };
+};
+
+// Parallel variants of the chaining for large inputs (support, ironing): The items are spatially partitioned,
+// the partitions are chained concurrently by the greedy algorithms above and the partial chains are stitched
+// in the order of the partitions.
+std::vector<size_t>                  chain_points_parallel(const Points &points, Point *start_near = nullptr, const ChainParallelParams &params = {});
+std::vector<std::pair<size_t, bool>> chain_extrusion_entities_parallel(std::vector<ExtrusionEntity*> &entities, const Point *start_near = nullptr, const ChainParallelParams &params = {});
+void                                 chain_and_reorder_extrusion_entities_parallel(std::vector<ExtrusionEntity*> &entities, const Point *start_near = nullptr, const ChainParallelParams &params = {});
+Polylines                            chain_polylines_parallel(Polylines &&src, const Point *start_near = nullptr, const ChainParallelParams &params = {});
+
+// Chain segments given by their first and last points, all of which could be reversed, by the greedy algorithm,
+// then improve the chain by trying at most refine_max_moves 2-opt moves. Returns pairs of segment index and its reversal.
+std::vector<std::pair<size_t, bool>> chain_segments_two_opt(const std::vector<std::pair<Point, Point>> &segments, const Point *start_near, size_t refine_max_moves);
+
 std::vector<ClipperLib::PolyNode*>	 chain_clipper_polynodes(const Points &points, const std::vector<ClipperLib::PolyNode*> &items);
 
 // Chain instances of print objects by an approximate shortest path.
@@ -1642,7 +1642,7 @@ void TreeSupport::generate_toolpaths()
                         Polylines opt_polylines;
 #if 1
                         //this wont create connection patterns along contours
-                        append(opt_polylines, chain_polylines(std::move(polylines)));
+                        append(opt_polylines, chain_polylines_parallel(std::move(polylines)));
 #else
                         //this will create connection patterns along contours
                         FillParams params;
@@ -1669,7 +1669,7 @@ void TreeSupport::generate_toolpaths()
 
                 // sort extrusions to reduce travel, also make sure walls go before infills
                 if(ts_layer->support_fills.no_sort==false)
-                    chain_and_reorder_extrusion_entities(ts_layer->support_fills.entities);
+                    chain_and_reorder_extrusion_entities_parallel(ts_layer->support_fills.entities);
             }
         }
     );
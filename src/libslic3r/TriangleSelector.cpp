@@ -1428,27 +1428,41 @@ indexed_triangle_set TriangleSelector::get_facets(EnforcerBlockerType state) con
 // BBS
 void TriangleSelector::get_facets(std::vector<indexed_triangle_set>& facets_per_type) const
 {
-    facets_per_type.clear();
-
-    for (int type = (int)EnforcerBlockerType::NONE; type <= (int)EnforcerBlockerType::ExtruderMax; type++) {
-        facets_per_type.emplace_back();
-        indexed_triangle_set& its = facets_per_type.back();
-        std::vector<int> vertex_map(m_vertices.size(), -1);
-
-        for (const Triangle& tr : m_triangles) {
-            if (tr.valid() && !tr.is_split() && tr.get_state() == (EnforcerBlockerType)type) {
-                stl_triangle_vertex_indices indices;
-                for (int i = 0; i < 3; ++i) {
-                    int j = tr.verts_idxs[i];
-                    if (vertex_map[j] == -1) {
-                        vertex_map[j] = int(its.vertices.size());
-                        its.vertices.emplace_back(m_vertices[j].v);
-                    }
-                    indices[i] = vertex_map[j];
+    // Single pass over the triangles, the indices point to m_vertices until compacted.
+    facets_per_type.assign(size_t(EnforcerBlockerType::ExtruderMax) + 1, indexed_triangle_set());
+    for (const Triangle& tr : m_triangles)
+        if (tr.valid() && !tr.is_split())
+            facets_per_type[size_t(tr.get_state())].indices.emplace_back(tr.verts_idxs[0], tr.verts_idxs[1], tr.verts_idxs[2]);
+    this->compact_facets_vertices(facets_per_type);
+}
+
+void TriangleSelector::get_facets_strict(std::vector<indexed_triangle_set>& facets_per_type) const
+{
+    facets_per_type.assign(size_t(EnforcerBlockerType::ExtruderMax) + 1, indexed_triangle_set());
+    for (int itriangle = 0; itriangle < m_orig_size_indices; ++ itriangle)
+        this->get_facets_strict_recursive(m_triangles[itriangle], m_neighbors[itriangle], facets_per_type);
+    this->compact_facets_vertices(facets_per_type);
+}
+
+void TriangleSelector::compact_facets_vertices(std::vector<indexed_triangle_set>& facets_per_type) const
+{
+    // Shared by all the states, only the entries touched by a state are reset.
+    std::vector<int> vertex_map(m_vertices.size(), -1);
+    std::vector<int> used;
+    for (indexed_triangle_set& its : facets_per_type) {
+        for (stl_triangle_vertex_indices& indices : its.indices)
+            for (int i = 0; i < 3; ++ i) {
+                int j = indices[i];
+                if (vertex_map[j] == -1) {
+                    vertex_map[j] = int(its.vertices.size());
+                    its.vertices.emplace_back(m_vertices[j].v);
+                    used.emplace_back(j);
                 }
-                its.indices.emplace_back(indices);
+                indices[i] = vertex_map[j];
             }
-        }
+        for (int j : used)
+            vertex_map[j] = -1;
+        used.clear();
     }
 }
 
@@ -1494,6 +1508,21 @@ void TriangleSelector::get_facets_strict_recursive(
         this->get_facets_split_by_tjoints({tr.verts_idxs[0], tr.verts_idxs[1], tr.verts_idxs[2]}, neighbors, out_triangles);
 }
 
+void TriangleSelector::get_facets_strict_recursive(
+    const Triangle                              &tr,
+    const Vec3i32                               &neighbors,
+    std::vector<indexed_triangle_set>           &out_per_type) const
+{
+    if (tr.is_split()) {
+        for (int i = 0; i <= tr.number_of_split_sides(); ++ i)
+            this->get_facets_strict_recursive(
+                m_triangles[tr.children[i]],
+                this->child_neighbors(tr, neighbors, i),
+                out_per_type);
+    } else
+        this->get_facets_split_by_tjoints({tr.verts_idxs[0], tr.verts_idxs[1], tr.verts_idxs[2]}, neighbors, out_per_type[size_t(tr.get_state())].indices);
+}
+
 void TriangleSelector::get_facets_split_by_tjoints(const Vec3i32 &vertices, const Vec3i32 &neighbors, std::vector<stl_triangle_vertex_indices> &out_triangles) const
 {
 // Export this triangle, but first collect the T-joint vertices along its edges.
@@ -331,7 +331,11 @@ public:
     std::vector<Vec2i32> get_seed_fill_contour() const;
 
     // BBS
+    // Get facets of all the states in a single pass, indexed by EnforcerBlockerType. Don't triangulate T-joints.
     void get_facets(std::vector<indexed_triangle_set>& facets_per_type) const;
+    // Get facets of all the states in a single pass, indexed by EnforcerBlockerType. Triangulate T-joints.
+    // Contrary to get_facets_strict(state), only the vertices referenced by a state are stored.
+    void get_facets_strict(std::vector<indexed_triangle_set>& facets_per_type) const;
 
     // Set facet of the mesh to a given state. Only works for original triangles.
     void set_facet(int facet_idx, EnforcerBlockerType state);
@@ -497,8 +501,15 @@ private:
         const Vec3i32                                 &neighbors,
         EnforcerBlockerType                          state,
         std::vector<stl_triangle_vertex_indices>    &out_triangles) const;
+    void get_facets_strict_recursive(
+        const Triangle                              &tr,
+        const Vec3i32                               &neighbors,
+        std::vector<indexed_triangle_set>           &out_per_type) const;
     void get_facets_split_by_tjoints(const Vec3i32 &vertices, const Vec3i32 &neighbors, std::vector<stl_triangle_vertex_indices> &out_triangles) const;
 
+    // Replace indices into m_vertices with indices into the vertices of each indexed_triangle_set, copying just the referenced vertices.
+    void compact_facets_vertices(std::vector<indexed_triangle_set> &facets_per_type) const;
+
     void get_seed_fill_contour_recursive(int facet_idx, const Vec3i32 &neighbors, const Vec3i32 &neighbors_propagated, std::vector<Vec2i32> &edges_out) const;
 
     int m_free_triangles_head { -1 };
@@ -85,6 +85,11 @@ extern std::string format_memsize_MB(size_t n);
 // The string is non-empty if the loglevel >= info (3) or ignore_loglevel==true.
 // Latter is used to get the memory info from SysInfoDialog.
 extern std::string log_memory_info(bool ignore_loglevel = false);
+// Returns the peak resident memory of the process in bytes, zero if not available.
+extern size_t peak_memory_usage();
+// Resets the peak resident memory of the process to the current resident memory, so that peak_memory_usage()
+// reports the peak of the work done after the reset. Only supported on Linux, returns false if the peak was not reset.
+extern bool reset_peak_memory_usage();
 extern void disable_multi_threading();
 // Returns the size of physical memory (RAM) in bytes.
 extern size_t total_physical_memory();
@@ -6,6 +6,8 @@
 #include <ctime>
 #include <cstdarg>
 #include <stdio.h>
+#include <fstream>
+#include <sstream>
 
 #include "format.hpp"
 #include "Platform.hpp"
@@ -1384,15 +1386,8 @@ std::string log_memory_info(bool ignore_loglevel)
     #endif
         // Now get peak memory usage.
         out += "; Peak memory usage: ";
-        rusage memory_info;
-        if (getrusage(RUSAGE_SELF, &memory_info) == 0)
-        {
-            size_t peak_mem_usage = (size_t)memory_info.ru_maxrss;
-            #ifdef __linux__
-                peak_mem_usage *= 1024;// getrusage returns the value in kB on linux
-            #endif
+        if (size_t peak_mem_usage = peak_memory_usage(); peak_mem_usage > 0)
             out += format_memsize_MB(peak_mem_usage);
-        }
         else
             out += "N/A";
 #endif
@@ -1400,6 +1395,49 @@ std::string log_memory_info(bool ignore_loglevel)
     return out;
 }
 
+// Returns the peak resident memory of the process in bytes, zero if not available.
+size_t peak_memory_usage()
+{
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return (size_t)pmc.PeakWorkingSetSize;
+#elif defined(__linux__) or defined(__APPLE__)
+    #ifdef __linux__
+    // VmHWM is the same high water mark as ru_maxrss, but unlike ru_maxrss it is reset by reset_peak_memory_usage().
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);)
+        if (boost::starts_with(line, "VmHWM:")) {
+            size_t peak_mem_usage = 0;
+            if (std::istringstream(line.substr(6)) >> peak_mem_usage)
+                return peak_mem_usage * 1024; // in kB
+            break;
+        }
+    #endif
+    rusage memory_info;
+    if (getrusage(RUSAGE_SELF, &memory_info) == 0) {
+        size_t peak_mem_usage = (size_t)memory_info.ru_maxrss;
+    #ifdef __linux__
+        peak_mem_usage *= 1024;// getrusage returns the value in kB on linux
+    #endif
+        return peak_mem_usage;
+    }
+#endif
+    return 0;
+}
+
+// Resets the peak resident memory reported by peak_memory_usage() to the current resident memory.
+bool reset_peak_memory_usage()
+{
+#ifdef __linux__
+    // Writing 5 to clear_refs resets VmHWM, see proc(5).
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    return clear_refs && (clear_refs << "5" << std::flush);
+#else
+    return false;
+#endif
+}
+
 // Returns the size of physical memory (RAM) in bytes.
 // http://nadeausoftware.com/articles/2012/09/c_c_tip_how_get_physical_memory_size_system
 size_t total_physical_memory()
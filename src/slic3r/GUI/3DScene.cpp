@@ -538,11 +538,10 @@ void GLVolume::simple_render(GLShaderProgram* shader, ModelObjectPtrs& model_obj
         color_volume = true;
         if (model_volume->mmu_segmentation_facets.timestamp() != mmuseg_ts) {
             mmuseg_models.clear();
-            std::vector<indexed_triangle_set> its_per_color;
-            model_volume->mmu_segmentation_facets.get_facets(*model_volume, its_per_color);
-            mmuseg_models.resize(its_per_color.size());
-            for (int idx = 0; idx < its_per_color.size(); idx++) {
-                mmuseg_models[idx].init_from(its_per_color[idx]);
+            const auto its_per_color = model_volume->mmu_segmentation_facets.get_facets_per_type(*model_volume, false);
+            mmuseg_models.resize(its_per_color->size());
+            for (int idx = 0; idx < its_per_color->size(); idx++) {
+                mmuseg_models[idx].init_from((*its_per_color)[idx]);
             }
 
             mmuseg_ts = model_volume->mmu_segmentation_facets.timestamp();
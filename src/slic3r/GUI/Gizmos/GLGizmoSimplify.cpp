@@ -510,7 +510,7 @@ void GLGizmoSimplify::process()
 
         // Start the actual calculation.
         try {
-            its_quadric_edge_collapse(*its, triangle_count, &max_error, throw_on_cancel, statusfn);
+            its_quadric_edge_collapse_parallel(*its, triangle_count, &max_error, throw_on_cancel, statusfn);
         } catch (SimplifyCanceledException &) {
             std::lock_guard lk(m_state_mutex);
             m_state.status = State::idle;
@@ -1,6 +1,7 @@
 #include "OrientJob.hpp"
 
 #include "libslic3r/Model.hpp"
+#include "libslic3r/MeshProxy.hpp"
 #include "slic3r/GUI/Plater.hpp"
 #include "slic3r/GUI/GUI.hpp"
 #include "slic3r/GUI/GUI_App.hpp"
@@ -229,6 +230,15 @@ orientation::OrientMesh OrientJob::get_orient_mesh(ModelInstance* instance)
     auto obj = instance->get_object();
     om.name = obj->name;
     om.mesh = obj->mesh(); // don't know the difference to obj->raw_mesh(). Both seem OK
+    // Search on the decimated proxy if it is ready, don't wait for it.
+    if (std::shared_ptr<const MeshProxy> proxy = obj->proxy_mesh(); proxy && proxy->ready() && proxy->decimated()) {
+        TriangleMesh raw_proxy(proxy->its());
+        for (const ModelInstance *i : obj->instances) {
+            TriangleMesh m = raw_proxy;
+            i->transform_mesh(&m);
+            om.proxy.merge(m);
+        }
+    }
     if (obj->config.has("support_threshold_angle"))
         om.overhang_angle = obj->config.opt_int("support_threshold_angle");
     else {
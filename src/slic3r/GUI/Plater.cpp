@@ -4643,6 +4643,10 @@ std::vector<size_t> Plater::priv::load_model_objects(const ModelObjectPtrs& mode
     for (const size_t idx : obj_idxs)
         wxGetApp().obj_list()->update_info_items(idx);
 
+    // Decimate the large meshes in the background for the auto orientation and the rotation optimizer.
+    for (const size_t idx : obj_idxs)
+        model.objects[idx]->update_proxy_mesh();
+
     object_list_changed();
 
     this->schedule_background_process();
@@ -4998,6 +5002,8 @@ void Plater::priv::reset(bool apply_presets_change)
     // Stop and reset the Print content.
     this->background_process.reset();
     model.clear_objects();
+    // The meshes of the boolean operations on the closed project won't be needed anymore.
+    csg::clear_mesh_caches();
     assemble_view->get_canvas3d()->reset_explosion_ratio();
     update();
 
@@ -13267,6 +13273,7 @@ void Plater::changed_mesh(int obj_idx)
 {
     ModelObject* mo = model().objects[obj_idx];
     sla::reproject_points_and_holes(mo);
+    mo->update_proxy_mesh();
     update();
     p->object_list_changed();
     p->schedule_background_process();
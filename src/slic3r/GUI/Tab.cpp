@@ -2082,6 +2082,7 @@ void TabPrint::build()
         optgroup->append_single_option_line("only_one_wall_first_layer");
         optgroup->append_single_option_line("reduce_crossing_wall");
         optgroup->append_single_option_line("max_travel_detour_distance");
+        optgroup->append_single_option_line("optimize_travel_order");
 
         optgroup->append_single_option_line("small_area_infill_flow_compensation", "small-area-infill-flow-compensation");
         Option option = optgroup->get_option("small_area_infill_flow_compensation_model");
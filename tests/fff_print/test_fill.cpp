@@ -5,10 +5,16 @@
 
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Fill/Fill.hpp"
+#include "libslic3r/Fill/FillAdaptive.hpp"
+#include "libslic3r/Fill/FillGyroid.hpp"
+#include "libslic3r/Fill/FillLightning.hpp"
+#include "libslic3r/Fill/Lightning/Generator.hpp"
+#include "libslic3r/Fill/FillPatternCache.hpp"
 #include "libslic3r/Flow.hpp"
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/SVG.hpp"
+#include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/libslic3r.h"
 
 #include "test_data.hpp"
@@ -429,6 +435,315 @@ for my $pattern (qw(rectilinear honeycomb hilbertcurve concentric)) {
 }
 */
 
+TEST_CASE("Fill: Periodic patterns from the shared tile cache", "[Fill]") {
+    const ExPolygon square(Polygon::new_scale({ {0, 0}, {30, 0}, {30, 30}, {0, 30} }));
+    // Surface of the same size shifted far away, clipping the same tile.
+    ExPolygon square_shifted = square;
+    square_shifted.translate(scaled<coord_t>(117.3), scaled<coord_t>(-41.9));
+
+    for (const char *pattern : { "gyroid", "honeycomb", "3dhoneycomb", "crosshatch" }) {
+        SECTION(pattern) {
+            auto fill = [pattern](const ExPolygon &expolygon, double z) {
+                std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type(pattern));
+                filler->bounding_box = get_extents(expolygon.contour);
+                filler->angle        = float(M_PI / 4.);
+                filler->spacing      = 0.45;
+                filler->z            = z;
+                filler->layer_id     = size_t(z / 0.2);
+                FillParams fill_params;
+                fill_params.density = 0.2f;
+                Surface surface(stInternal, expolygon);
+                return filler->fill_surface(&surface, fill_params);
+            };
+            FillPatternCache::clear();
+            for (double z : { 0.2, 1.4, 7.6 }) {
+                Polylines generated = fill(square, z);
+                Polylines cached    = fill(square, z);
+                REQUIRE(! generated.empty());
+                REQUIRE(generated == cached);
+                // The infill covers the shifted square as densely as the original one.
+                Polylines shifted = fill(square_shifted, z);
+                REQUIRE(! shifted.empty());
+                REQUIRE(total_length(shifted) == Approx(total_length(generated)).epsilon(0.1));
+            }
+        }
+    }
+}
+
+// Honeycomb as generated before the shared tiles: The whole pattern rotated by the infill direction and clipped by the surface.
+static Polylines honeycomb_uncached(const ExPolygon &expolygon, float direction, double spacing, float density)
+{
+    const coord_t min_spacing    = coord_t(scale_(spacing));
+    const coord_t distance       = coord_t(min_spacing / density);
+    const coord_t hex_side       = coord_t(distance / (sqrt(3)/2));
+    const coord_t hex_width      = distance * 2;
+    const coord_t pattern_height = hex_side * 2 + hex_side;
+    const coord_t y_short        = coord_t(distance * sqrt(3)/3);
+    const coord_t x_offset       = min_spacing / 2;
+    const coord_t y_offset       = coord_t(x_offset * sqrt(3)/3);
+    const Point   hex_center(hex_width/2, hex_side);
+
+    Polygon bb_polygon = expolygon.contour.bounding_box().polygon();
+    bb_polygon.rotate(direction, hex_center);
+    BoundingBox bounding_box = bb_polygon.bounding_box();
+    bounding_box.merge(align_to_grid(bounding_box.min, Point(hex_width, pattern_height)));
+
+    Polylines polylines;
+    for (coord_t x = bounding_box.min(0); x <= bounding_box.max(0);) {
+        Polyline p;
+        coord_t ax[2] = { x + x_offset, x + distance - x_offset };
+        for (size_t i = 0; i < 2; ++ i) {
+            std::reverse(p.points.begin(), p.points.end());
+            for (coord_t y = bounding_box.min(1); y <= bounding_box.max(1); y += y_short + hex_side + y_short + hex_side) {
+                p.points.push_back(Point(ax[1], y + y_offset));
+                p.points.push_back(Point(ax[0], y + y_short - y_offset));
+                p.points.push_back(Point(ax[0], y + y_short + hex_side + y_offset));
+                p.points.push_back(Point(ax[1], y + y_short + hex_side + y_short - y_offset));
+                p.points.push_back(Point(ax[1], y + y_short + hex_side + y_short + hex_side + y_offset));
+            }
+            ax[0] = ax[0] + distance;
+            ax[1] = ax[1] + distance;
+            std::swap(ax[0], ax[1]);
+            x += distance;
+        }
+        p.rotate(-direction, hex_center);
+        polylines.push_back(p);
+    }
+    return intersection_pl(polylines, expolygon);
+}
+
+// Gyroid as generated before the shared tiles: The waves at the exact z starting at the aligned bounding box of the surface.
+static Polylines gyroid_uncached(ExPolygon expolygon, float angle, double spacing, float density, double z)
+{
+    const float infill_angle = float(angle + (FillGyroid::CorrectionAngle * 2*M_PI) / 360.);
+    expolygon.rotate(-infill_angle);
+    BoundingBox  bb               = expolygon.contour.bounding_box();
+    const double density_adjusted = std::max(0., density * FillGyroid::DensityAdjust);
+    const coord_t distance        = coord_t(scale_(spacing) / density_adjusted);
+    bb.merge(align_to_grid(bb.min, Point(2*M_PI*distance, 2*M_PI*distance)));
+    Polylines polylines = make_gyroid_waves(scale_(z), density_adjusted, spacing, ceil(bb.size()(0) / distance) + 1., ceil(bb.size()(1) / distance) + 1.);
+    for (Polyline &pl : polylines)
+        pl.translate(bb.min);
+    polylines = intersection_pl(polylines, expolygon);
+    const double minlength = scale_(0.8 * spacing);
+    polylines.erase(std::remove_if(polylines.begin(), polylines.end(), [minlength](const Polyline &pl) { return pl.length() < minlength; }), polylines.end());
+    for (Polyline &pl : polylines)
+        pl.rotate(infill_angle);
+    return polylines;
+}
+
+// Do all the vertices of polylines lie on the lines of reference?
+static bool polylines_on_reference(const Polylines &polylines, const Polylines &reference, double max_distance)
+{
+    Lines lines = to_lines(reference);
+    for (const Polyline &pl : polylines)
+        for (const Point &pt : pl.points)
+            if (std::none_of(lines.begin(), lines.end(), [&pt, max_distance](const Line &l) { return l.distance_to(pt) < max_distance; }))
+                return false;
+    return true;
+}
+
+TEST_CASE("Fill: Periodic patterns from the shared tile cache match the uncached patterns", "[Fill]") {
+    const ExPolygon square(Polygon::new_scale({ {3, 2}, {23, 4}, {21, 22}, {1, 19} }));
+    const double    spacing = 0.45;
+    const float     density = 0.2f;
+    // The lines of the cached pattern are clipped in the pattern coordinate system and rotated back, thus their end points
+    // are rounded differently.
+    const double    max_distance = scale_(0.005);
+
+    auto fill = [&](const char *pattern, float angle, double z, size_t layer_id) {
+        std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type(pattern));
+        filler->bounding_box = get_extents(square.contour);
+        filler->angle        = angle;
+        filler->spacing      = spacing;
+        filler->z            = z;
+        filler->layer_id     = layer_id;
+        FillParams fill_params;
+        fill_params.density           = density;
+        fill_params.anchor_length     = 0.f;
+        fill_params.anchor_length_max = 0.f;
+        REQUIRE(fill_params.dont_connect());
+        // fill_surface() shrinks the surface by half the spacing minus the overlap, keep the surface as it is.
+        filler->overlap = 0.5 * spacing;
+        Surface surface(stInternal, square);
+        return filler->fill_surface(&surface, fill_params);
+    };
+
+    SECTION("honeycomb") {
+        // The honeycomb rotates the surface into the pattern and the clipped lines back, compare all three layer angles.
+        for (size_t layer_id : { 0, 1, 2 }) {
+            const float angle = float(M_PI / 7.);
+            // Same direction as Fill::_infill_direction().
+            const float direction = angle + float(M_PI/3.) * (layer_id % 3) + float(M_PI/2.);
+            FillPatternCache::clear();
+            Polylines generated = fill("honeycomb", angle, 0.2 * layer_id, layer_id);
+            Polylines cached    = fill("honeycomb", angle, 0.2 * layer_id, layer_id);
+            Polylines reference = honeycomb_uncached(square, direction, spacing, density);
+            REQUIRE(! reference.empty());
+            REQUIRE(generated == cached);
+            REQUIRE(total_length(generated) == Approx(total_length(reference)).epsilon(0.001));
+            REQUIRE(polylines_on_reference(generated, reference, max_distance));
+            REQUIRE(polylines_on_reference(reference, generated, max_distance));
+        }
+    }
+
+    SECTION("gyroid") {
+        // The cached gyroid uses z modulo the pattern period rounded to scaled coordinates, compare it against the exact z
+        // including heights above several periods.
+        for (double z : { 0.2, 1.37, 7.6, 55.55, 187.43 }) {
+            const float angle = float(M_PI / 7.);
+            FillPatternCache::clear();
+            Polylines generated = fill("gyroid", angle, z, size_t(z / 0.2));
+            Polylines cached    = fill("gyroid", angle, z, size_t(z / 0.2));
+            Polylines reference = gyroid_uncached(square, angle, spacing, density, z);
+            REQUIRE(! reference.empty());
+            REQUIRE(generated == cached);
+            REQUIRE(total_length(generated) == Approx(total_length(reference)).epsilon(0.001));
+            REQUIRE(polylines_on_reference(generated, reference, max_distance));
+            REQUIRE(polylines_on_reference(reference, generated, max_distance));
+        }
+    }
+}
+
+TEST_CASE("Fill: Periodic patterns clipped against many islands at once", "[Fill]") {
+    // Grid of small islands, as sliced from a lattice.
+    ExPolygons islands;
+    for (int i = 0; i < 4; ++ i)
+        for (int j = 0; j < 4; ++ j) {
+            islands.emplace_back(Polygon::new_scale({ {0, 0}, {6, 0}, {6, 6}, {0, 6} }));
+            islands.back().translate(scaled<coord_t>(8. * i), scaled<coord_t>(8. * j));
+        }
+
+    for (const char *pattern : { "gyroid", "honeycomb", "3dhoneycomb", "crosshatch" }) {
+        SECTION(pattern) {
+            std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type(pattern));
+            REQUIRE(filler->supports_batched_clipping());
+            filler->bounding_box = get_extents(islands);
+            filler->angle        = float(M_PI / 4.);
+            filler->spacing      = 0.45;
+            filler->z            = 1.4;
+            filler->layer_id     = 7;
+            FillParams fill_params;
+            fill_params.density = 0.2f;
+            Surface surface(stInternal, islands.front());
+
+            auto fill_islands = [&]() {
+                std::vector<Polylines> out;
+                for (const ExPolygon &island : islands) {
+                    surface.expolygon = island;
+                    out.emplace_back(filler->fill_surface(&surface, fill_params));
+                }
+                return out;
+            };
+            std::vector<Polylines> one_by_one = fill_islands();
+            filler->prepare_batched_clipping(surface, islands, fill_params);
+            REQUIRE(filler->num_batched_clipping() == islands.size());
+            std::vector<Polylines> batched = fill_islands();
+            filler->clear_batched_clipping();
+
+            for (size_t i = 0; i < islands.size(); ++ i) {
+                REQUIRE(! batched[i].empty());
+                // The same pattern, only the lines may be split at different points of the tile.
+                REQUIRE(total_length(batched[i]) == Approx(total_length(one_by_one[i])).epsilon(0.02));
+                for (const Polyline &pl : batched[i])
+                    REQUIRE(get_extents(offset_ex(islands[i], scale_(0.01))).contains(get_extents(pl)));
+            }
+        }
+    }
+}
+
+TEST_CASE("Fill: Adaptive cubic infill from an octree built in parallel", "[Fill]") {
+    const indexed_triangle_set mesh = its_make_sphere(20., PI / 64.);
+    FillAdaptive::OctreePtr octree            = FillAdaptive::build_octree(mesh, {}, 2., false);
+    FillAdaptive::OctreePtr octree_sequential = FillAdaptive::build_octree(mesh, {}, 2., false, false);
+
+    // The octree has the same cubes as the one built by inserting the triangles one by one.
+    const std::vector<size_t> cubes_per_depth = FillAdaptive::octree_cubes_per_depth(*octree);
+    REQUIRE(cubes_per_depth == FillAdaptive::octree_cubes_per_depth(*octree_sequential));
+    // The surface of the sphere reaches down to the smallest cubes, which all have a parent.
+    REQUIRE(cubes_per_depth.size() > 3);
+    REQUIRE(cubes_per_depth.front() == 1);
+    for (size_t depth = 1; depth < cubes_per_depth.size(); ++ depth) {
+        REQUIRE(cubes_per_depth[depth] > cubes_per_depth[depth - 1]);
+        REQUIRE(cubes_per_depth[depth] <= 8 * cubes_per_depth[depth - 1]);
+    }
+
+    const ExPolygon square(Polygon::new_scale({ {-20, -20}, {20, -20}, {20, 20}, {-20, 20} }));
+    auto fill = [&square](FillAdaptive::Octree *octree, double z) {
+        std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type(ipAdaptiveCubic));
+        filler->adapt_fill_octree = octree;
+        filler->bounding_box      = get_extents(square.contour);
+        filler->spacing           = 0.45;
+        filler->z                 = z;
+        FillParams fill_params;
+        fill_params.density = 0.2f;
+        Surface surface(stInternal, square);
+        return filler->fill_surface(&surface, fill_params);
+    };
+    for (double z : { -12.2, 0.2, 7.6 }) {
+        Polylines polylines = fill(octree.get(), z);
+        REQUIRE(! polylines.empty());
+        // The same infill as from the sequentially built octree.
+        REQUIRE(polylines == fill(octree_sequential.get(), z));
+    }
+}
+
+TEST_CASE("Fill: Lightning trees propagated down a tall object", "[Fill]") {
+    Slic3r::Print print;
+    Slic3r::Model model;
+    Slic3r::Test::init_print({ Slic3r::Test::mesh(Slic3r::Test::TestMesh::cube_20x20x20, Vec3d::Zero(), Vec3d(1., 1., 4.)) }, print, model, {
+        { "sparse_infill_pattern", "lightning" },
+        { "sparse_infill_density", "10%" },
+        { "layer_height",          0.4 }
+    });
+    print.process();
+    const PrintObject &object = *print.objects().front();
+
+    FillLightning::GeneratorPtr generator = FillLightning::build_generator(object, []() {});
+    // Supporting radius of the lightning infill, see the Generator constructor.
+    const double supporting_radius = double(generator->infilll_extrusion_width()) * 100. / 10.;
+    size_t last_layer_with_trees = 0;
+    for (size_t layer_id = 0; layer_id < object.layers().size(); ++ layer_id) {
+        const FillLightning::Layer &trees = generator->getTreesForLayer(layer_id);
+        const BoundingBox           bbox  = get_extents(object.get_layer(int(layer_id))->lslices).inflated(scale_(1.));
+        // The trees stored in the node pool of the layer are proper trees inside the layer:
+        // each node is reachable from exactly one root and the parent / child links agree.
+        std::vector<bool>                  visited(trees.nodes.size(), false);
+        std::vector<FillLightning::NodeIdx> stack;
+        for (FillLightning::NodeIdx root : trees.tree_roots) {
+            REQUIRE(root < trees.nodes.size());
+            REQUIRE(trees.nodes[root].isRoot());
+            stack.assign(1, root);
+            while (! stack.empty()) {
+                FillLightning::NodeIdx idx = stack.back();
+                stack.pop_back();
+                REQUIRE(! visited[idx]);
+                visited[idx] = true;
+                REQUIRE(bbox.contains(trees.nodes.getLocation(idx)));
+                for (FillLightning::NodeIdx child : trees.nodes[idx].children) {
+                    REQUIRE(child < trees.nodes.size());
+                    REQUIRE(trees.nodes[child].parent == idx);
+                    stack.emplace_back(child);
+                }
+            }
+        }
+        // Without the junction overlap, the lines do not depend on the random choice of the branch to continue at a junction.
+        Polylines lines = trees.convertToLines({ bbox.polygon() }, 0);
+        if (! lines.empty())
+            last_layer_with_trees = layer_id;
+        // The trees support the internal overhang of the layer: only slivers of it are further from the lines
+        // than the supporting radius, as the overhang is sampled at discrete points when growing the trees.
+        const Polygons &overhang = generator->Overhangs()[layer_id];
+        if (const double overhang_area = area(overhang); overhang_area > sqr(supporting_radius)) {
+            REQUIRE(! lines.empty());
+            const Polygons unsupported = diff(overhang, offset(lines, float(1.5 * supporting_radius)));
+            REQUIRE(area(unsupported) < 0.05 * overhang_area);
+        }
+    }
+    // The trees grow from below the top surface of the cube.
+    REQUIRE(last_layer_with_trees > object.layers().size() * 3 / 4);
+}
+
 bool test_if_solid_surface_filled(const ExPolygon& expolygon, double flow_spacing, double angle, double density)
 {
     std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type("rectilinear"));
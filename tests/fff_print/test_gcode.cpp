@@ -1,8 +1,15 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
 #include <memory>
+#include <set>
 
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCode/AvoidCrossingPerimeters.hpp"
+#include "libslic3r/Layer.hpp"
+#include "libslic3r/Print.hpp"
+
+#include "test_data.hpp"
 
 using namespace Slic3r;
 
@@ -20,3 +27,84 @@ SCENARIO("Origin manipulation", "[GCode]") {
     	}
     }
 }
+
+// Object layers and support layers of all objects in the order of the G-code generator.
+static std::vector<std::vector<const Layer*>> layers_by_print_z(const Print &print)
+{
+	std::vector<const Layer*> layers;
+	for (const PrintObject *object : print.objects()) {
+		layers.insert(layers.end(), object->layers().begin(), object->layers().end());
+		layers.insert(layers.end(), object->support_layers().begin(), object->support_layers().end());
+	}
+	std::stable_sort(layers.begin(), layers.end(), [](const Layer *l1, const Layer *l2) { return l1->print_z < l2->print_z; });
+	std::vector<std::vector<const Layer*>> out;
+	for (const Layer *layer : layers) {
+		if (out.empty() || std::abs(out.back().front()->print_z - layer->print_z) > EPSILON)
+			out.emplace_back();
+		out.back().emplace_back(layer);
+	}
+	return out;
+}
+
+static void require_same_layer_data(const AvoidCrossingPerimeters::LayerData &data, const AvoidCrossingPerimeters::LayerData &fresh)
+{
+	REQUIRE(data.layer->object() == fresh.layer->object());
+	REQUIRE(data.is_support_layer == fresh.is_support_layer);
+	REQUIRE(data.external_perimeter_width == fresh.external_perimeter_width);
+	REQUIRE(data.perimeter_spacing == fresh.perimeter_spacing);
+	REQUIRE(data.lslices_offset == fresh.lslices_offset);
+	REQUIRE(data.lslices_offset_bboxes.size() == fresh.lslices_offset_bboxes.size());
+	for (size_t i = 0; i < data.lslices_offset_bboxes.size(); ++ i) {
+		REQUIRE(data.lslices_offset_bboxes[i].min == fresh.lslices_offset_bboxes[i].min);
+		REQUIRE(data.lslices_offset_bboxes[i].max == fresh.lslices_offset_bboxes[i].max);
+	}
+}
+
+SCENARIO("Avoid crossing perimeters reuses the travel data of the layers", "[GCode]") {
+	GIVEN("A cube and an overhanging object printed on a raft, with support") {
+		Slic3r::Print print;
+		Slic3r::Test::init_and_process_print({ Slic3r::Test::TestMesh::cube_20x20x20, Slic3r::Test::TestMesh::overhang }, print, {
+			{ "support_material", 1 },
+			{ "raft_layers",      2 }
+			});
+		REQUIRE(print.objects().size() == 2);
+		REQUIRE(print.objects().back()->support_layers().size() > 2);
+		const std::vector<std::vector<const Layer*>> layers = layers_by_print_z(print);
+
+		const PrintObject *cube = print.objects().front();
+		auto check = [&layers, cube](bool precompute) {
+			AvoidCrossingPerimeters avoid_crossing_perimeters;
+			// Data of the cube's layers.
+			std::set<const AvoidCrossingPerimeters::LayerData*> distinct;
+			for (const std::vector<const Layer*> &layers_at_z : layers) {
+				if (precompute) {
+					std::vector<AvoidCrossingPerimeters::LayerDataPtr> layer_data;
+					for (const Layer *layer : layers_at_z)
+						layer_data.emplace_back(AvoidCrossingPerimeters::precompute_layer_data(*layer));
+					avoid_crossing_perimeters.set_precomputed_layer_data(std::move(layer_data));
+				}
+				for (const Layer *layer : layers_at_z) {
+					avoid_crossing_perimeters.init_layer(*layer);
+					AvoidCrossingPerimeters fresh;
+					fresh.init_layer(*layer);
+					require_same_layer_data(*avoid_crossing_perimeters.layer_data(), *fresh.layer_data());
+					if (layer->object() == cube && dynamic_cast<const SupportLayer*>(layer) == nullptr)
+						distinct.insert(avoid_crossing_perimeters.layer_data().get());
+				}
+			}
+			// The layers in the middle of the cube are identical. Their data survives the layers of the other object and the raft printed in between.
+			REQUIRE(distinct.size() < cube->layers().size() / 2);
+		};
+
+		WHEN("The layers are initialized one after the other") {
+			THEN("The reused data matches the data built from scratch") {
+				check(false);
+			}
+		}
+		WHEN("The layer data is precomputed ahead of the initialization") {
+			THEN("The reused data matches the data built from scratch") {
+				check(true);
+			}
+		}
+	}
+}
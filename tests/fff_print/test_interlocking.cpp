@@ -0,0 +1,124 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+
+#include <tbb/task_arena.h>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/Interlocking/InterlockingGenerator.hpp"
+#include "libslic3r/Layer.hpp"
+#include "libslic3r/Print.hpp"
+
+#include "test_data.hpp"
+
+using namespace Slic3r;
+
+TEST_CASE("Interlocking: Voxel set of grid points", "[Interlocking]") {
+    VoxelSet voxels;
+    for (coord_t z = -2; z <= 2; ++ z)
+        for (coord_t y = -3; y <= 3; ++ y)
+            for (coord_t x = -4; x <= 4; ++ x) {
+                voxels.insert(GridPoint3(x, y, z));
+                voxels.insert(GridPoint3(x, y, z));
+            }
+    REQUIRE(voxels.size() == 9 * 7 * 5);
+    REQUIRE(voxels.contains(GridPoint3(-4, 3, -2)));
+    REQUIRE(! voxels.contains(GridPoint3(5, 0, 0)));
+    // The set iterates in the order of insertion, the shell voxels of the layers rely on it.
+    REQUIRE(*voxels.begin() == GridPoint3(-4, -3, -2));
+
+    // Neighbor cells and cells with swapped coordinates hash differently.
+    const GridPoint3Hash hash;
+    REQUIRE(hash(GridPoint3(1, 0, 0)) != hash(GridPoint3(0, 1, 0)));
+    REQUIRE(hash(GridPoint3(1, 0, 0)) != hash(GridPoint3(0, 0, 1)));
+    REQUIRE(hash(GridPoint3(1, 2, 3)) != hash(GridPoint3(1, 2, 4)));
+    REQUIRE(hash(GridPoint3(-1, 0, 0)) != hash(GridPoint3(1, 0, 0)));
+}
+
+// Three 10mm boxes in a row printed by three filaments. The first box touches the second one, the second one touches the third one.
+static void init_three_boxes(Print &print, Model &model)
+{
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "filament_diameter", "1.75,1.75,1.75" },
+        { "filament_colour",   "#FF0000;#00FF00;#0000FF" },
+        { "layer_height",      0.2 },
+        // The structure is applied to the processed slices by the test.
+        { "interlocking_beam", 0 }
+    });
+    ModelObject *object = model.add_object();
+    for (int i = 0; i < 3; ++ i) {
+        TriangleMesh box(its_make_cube(10., 10., 10.));
+        box.translate(float(10 * i), 0.f, 0.f);
+        object->add_volume(std::move(box))->config.set("extruder", i + 1);
+    }
+    object->add_instance();
+    object->instances.front()->set_offset(Vec3d(50., 50., 0.));
+    object->ensure_on_bed();
+    print.apply(model, config);
+    print.set_status_silent();
+    print.process();
+}
+
+// Slices of each region of each layer.
+static std::vector<std::vector<ExPolygons>> region_slices(const PrintObject &object)
+{
+    std::vector<std::vector<ExPolygons>> out;
+    for (const Layer *layer : object.layers()) {
+        std::vector<ExPolygons> &regions = out.emplace_back();
+        for (const LayerRegion *region : layer->regions())
+            regions.emplace_back(to_expolygons(region->slices.surfaces));
+    }
+    return out;
+}
+
+SCENARIO("Interlocking: Structure between boxes of three filaments", "[Interlocking]") {
+    GIVEN("Three boxes in a row, each printed by another filament") {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        init_three_boxes(print, model);
+        PrintObject &object = *print.get_object(0);
+        REQUIRE(object.num_printing_regions() == 3);
+        const std::vector<std::vector<ExPolygons>> slices = region_slices(object);
+
+        WHEN("The structure is generated in parallel, the shell voxels of the third box are reused by the pair of the second and third box") {
+            InterlockingGenerator::generate_interlocking_structure(&object, true);
+            const std::vector<std::vector<ExPolygons>> interlocked = region_slices(object);
+
+            THEN("The structure matches a sequential run voxelizing the regions of each pair again") {
+                Slic3r::Print print_sequential;
+                Slic3r::Model model_sequential;
+                init_three_boxes(print_sequential, model_sequential);
+                PrintObject &object_sequential = *print_sequential.get_object(0);
+                tbb::task_arena arena(1);
+                arena.execute([&object_sequential]() { InterlockingGenerator::generate_interlocking_structure(&object_sequential, false); });
+                REQUIRE(region_slices(object_sequential) == interlocked);
+            }
+            THEN("Both the touching pairs are interlocked after the first pair invalidated the voxels of the second box") {
+                const size_t layer_idx = object.layers().size() / 2;
+                for (size_t region_idx = 0; region_idx < 3; ++ region_idx)
+                    REQUIRE(interlocked[layer_idx][region_idx] != slices[layer_idx][region_idx]);
+                // The second box reaches into the first and the third one.
+                std::vector<size_t> regions_by_x { 0, 1, 2 };
+                std::sort(regions_by_x.begin(), regions_by_x.end(), [&slices, layer_idx](size_t r1, size_t r2) {
+                    return get_extents(slices[layer_idx][r1]).min.x() < get_extents(slices[layer_idx][r2]).min.x();
+                });
+                const size_t      middle           = regions_by_x[1];
+                const BoundingBox bbox             = get_extents(slices[layer_idx][middle]);
+                const BoundingBox bbox_interlocked = get_extents(interlocked[layer_idx][middle]);
+                REQUIRE(bbox_interlocked.min.x() < bbox.min.x());
+                REQUIRE(bbox_interlocked.max.x() > bbox.max.x());
+            }
+            THEN("The boxes keep their volume") {
+                for (size_t layer_idx = 0; layer_idx < slices.size(); ++ layer_idx) {
+                    double area_before = 0., area_after = 0.;
+                    for (size_t region_idx = 0; region_idx < 3; ++ region_idx) {
+                        area_before += area(slices[layer_idx][region_idx]);
+                        area_after  += area(interlocked[layer_idx][region_idx]);
+                    }
+                    REQUIRE(area_after == Approx(area_before).epsilon(0.01));
+                }
+            }
+        }
+    }
+}
@@ -3,6 +3,8 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/MultiMaterialSegmentation.hpp"
+#include "libslic3r/TriangleSelector.hpp"
 
 #include "test_data.hpp"
 
@@ -126,3 +128,97 @@ SCENARIO("Print: Brim generation", "[Print]") {
         }
     }
 }
+
+SCENARIO("Print: Releasing the layers after the G-code export", "[Print]") {
+    // The header contains the time of the export.
+    auto strip_timestamp = [](std::string gcode) {
+        if (size_t pos = gcode.find("; generated by "); pos != std::string::npos)
+            gcode.erase(pos, gcode.find('\n', pos) - pos);
+        return gcode;
+    };
+    for (const char *print_sequence : { "by layer", "by object" }) {
+        GIVEN(std::string("20mm cube, print sequence ") + print_sequence) {
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, { { "print_sequence", print_sequence } });
+            Slic3r::Print print_released;
+            Slic3r::Model model_released;
+            Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print_released, model_released, { { "print_sequence", print_sequence } });
+            WHEN("The layers are released after the G-code export") {
+                const std::string gcode = strip_timestamp(Slic3r::Test::gcode(print));
+                print_released.set_release_layers_after_export(true);
+                const std::string gcode_released = strip_timestamp(Slic3r::Test::gcode(print_released));
+                THEN("The G-code is the same as without releasing the layers") {
+                    REQUIRE(! gcode.empty());
+                    REQUIRE(gcode_released == gcode);
+                }
+                THEN("No layer keeps its extrusions, the slices are kept") {
+                    const PrintObject &object = *print_released.objects().front();
+                    REQUIRE(std::none_of(object.layers().begin(), object.layers().end(), [](const Layer *layer) { return layer->has_extrusions(); }));
+                    REQUIRE(std::all_of(object.layers().begin(), object.layers().end(), [](const Layer *layer) { return ! layer->lslices.empty(); }));
+                }
+                THEN("The slicing is invalidated, exporting again gives the same G-code") {
+                    REQUIRE(! print_released.is_step_done(posSlice));
+                    print_released.set_release_layers_after_export(false);
+                    REQUIRE(strip_timestamp(Slic3r::Test::gcode(print_released)) == gcode);
+                    const PrintObject &object = *print_released.objects().front();
+                    REQUIRE(std::all_of(object.layers().begin(), object.layers().end(), [](const Layer *layer) { return layer->has_extrusions(); }));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Print: Multi-material segmentation of a painted cube", "[Print]") {
+    GIVEN("20mm cube with the top painted by the second filament and the left side by the third filament") {
+        Slic3r::DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "filament_colour",            "#FF0000;#00FF00;#0000FF" },
+            { "top_shell_layers",           3 },
+            { "bottom_shell_layers",        3 },
+            { "layer_height",               0.2 },
+            { "initial_layer_print_height", 0.2 }
+        });
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+        ModelVolume *volume = model.objects.front()->volumes.front();
+        TriangleSelector selector(volume->mesh());
+        const indexed_triangle_set &its = volume->mesh().its;
+        for (int facet_idx = 0; facet_idx < int(its.indices.size()); ++ facet_idx) {
+            const Vec3f normal = its_face_normal(its, facet_idx);
+            if (normal.z() > 0.5f)
+                selector.set_facet(facet_idx, EnforcerBlockerType::Extruder2);
+            else if (normal.x() < -0.5f)
+                selector.set_facet(facet_idx, EnforcerBlockerType::Extruder3);
+        }
+        volume->mmu_segmentation_facets.set(selector);
+        print.apply(model, config);
+        print.process();
+        const PrintObject &object = *print.objects().front();
+        REQUIRE(object.layers().size() == 100);
+
+        WHEN("The painting is projected to the layers") {
+            const std::vector<std::vector<ExPolygons>> segmentation = multi_material_segmentation_by_painting(object, []() {});
+            REQUIRE(segmentation.size() == object.layers().size());
+            const BoundingBox bbox = get_extents(object.layers().front()->lslices);
+            THEN("The top shell layers are covered by the second filament") {
+                for (size_t layer_idx = object.layers().size() - 3; layer_idx < object.layers().size(); ++ layer_idx)
+                    REQUIRE(area(segmentation[layer_idx][2]) > 0.5 * area(object.layers()[layer_idx]->lslices));
+            }
+            THEN("The layers below the top shell are painted at the left side by the third filament only") {
+                for (size_t layer_idx : { size_t(10), size_t(50), size_t(90) }) {
+                    REQUIRE(segmentation[layer_idx][2].empty());
+                    REQUIRE(! segmentation[layer_idx][3].empty());
+                    REQUIRE(get_extents(segmentation[layer_idx][3]).max.x() < bbox.min.x() + scaled<coord_t>(5.));
+                }
+            }
+            THEN("Segmenting again gives the same regions") {
+                const std::vector<std::vector<ExPolygons>> segmentation2 = multi_material_segmentation_by_painting(object, []() {});
+                for (size_t layer_idx = 0; layer_idx < segmentation.size(); ++ layer_idx)
+                    for (size_t extruder_idx = 0; extruder_idx < segmentation[layer_idx].size(); ++ extruder_idx)
+                        REQUIRE(area(segmentation2[layer_idx][extruder_idx]) == Approx(area(segmentation[layer_idx][extruder_idx])));
+            }
+        }
+    }
+}
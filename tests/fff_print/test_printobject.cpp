@@ -1,6 +1,9 @@
 #include <catch2/catch.hpp>
 
+#include <random>
+
 #include "libslic3r/libslic3r.h"
+#include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
 
@@ -87,3 +90,39 @@ SCENARIO("PrintObject: object layer heights", "[PrintObject]") {
 #endif
     }
 }
+
+TEST_CASE("PrintObject: Layer ranges combined from a table match the layers combined one by one", "[PrintObject]") {
+    std::mt19937 rng(4321);
+    // Two overlapping rectangles per layer, shifted randomly from layer to layer.
+    std::uniform_int_distribution<coord_t> shift(- scaled<coord_t>(10.), scaled<coord_t>(10.));
+    std::uniform_int_distribution<coord_t> size(scaled<coord_t>(40.), scaled<coord_t>(60.));
+    const size_t          num_layers = 40;
+    std::vector<Polygons> layers(num_layers);
+    for (Polygons &layer : layers)
+        for (size_t i = 0; i < 2; ++ i) {
+            const Point min(shift(rng), shift(rng));
+            const Point max = min + Point(size(rng), size(rng));
+            layer.emplace_back(Polygon({ min, Point(max.x(), min.y()), max, Point(min.x(), max.y()) }));
+        }
+    // Single layers, ranges of the length of a power of two, random ranges and the whole object.
+    std::vector<std::pair<size_t, size_t>> ranges { { 0, 1 }, { num_layers - 1, num_layers }, { 3, 11 }, { 0, num_layers } };
+    std::uniform_int_distribution<size_t> begin(0, num_layers - 1);
+    std::uniform_int_distribution<size_t> length(1, 12);
+    for (size_t i = 0; i < 100; ++ i) {
+        const size_t b = begin(rng);
+        ranges.emplace_back(b, std::min(num_layers, b + length(rng)));
+    }
+
+    for (bool intersect : { false, true }) {
+        const std::vector<Polygons> combined = combine_layer_ranges(layers, ranges, intersect);
+        REQUIRE(combined.size() == ranges.size());
+        for (size_t i = 0; i < ranges.size(); ++ i) {
+            Polygons expected = layers[ranges[i].first];
+            for (size_t layer_idx = ranges[i].first + 1; layer_idx < ranges[i].second; ++ layer_idx)
+                expected = intersect ? intersection(expected, layers[layer_idx]) : union_(expected, layers[layer_idx]);
+            REQUIRE(area(combined[i]) == Approx(area(expected)));
+            REQUIRE(area(diff(combined[i], expected)) == Approx(0.).margin(1.));
+            REQUIRE(area(diff(expected, combined[i])) == Approx(0.).margin(1.));
+        }
+    }
+}
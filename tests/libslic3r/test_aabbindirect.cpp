@@ -4,6 +4,8 @@
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
 
+#include <random>
+
 using namespace Slic3r;
 
 TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndirect]")
@@ -58,3 +60,56 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.y() == Approx(0.5));
     REQUIRE(closest_point.z() == Approx(1.));
 }
+
+TEST_CASE("Ray packet traversal gives the same hits as the single ray traversal", "[AABBIndirect]")
+{
+    indexed_triangle_set its = its_make_sphere(1., 0.1);
+    its_merge(its, its_make_cube(0.5, 0.5, 0.5));
+
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+    REQUIRE(! tree.empty());
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> dist(-1., 1.);
+    for (const Vec3d &origin : { Vec3d(0.05, 0.1, 0.3), Vec3d(0.7, -0.1, 0.2), Vec3d(-3., 0.33, 0.25) }) {
+        std::array<Vec3d, 17> dirs;
+        for (Vec3d &dir : dirs)
+            dir = Vec3d(dist(rng), dist(rng), dist(rng)).normalized();
+        // Axis aligned direction, which is the special case of the slab test.
+        dirs.back() = Vec3d(1., 0., 0.);
+
+        std::array<igl::Hit, 17> hits;
+        size_t num_hits = AABBTreeIndirect::intersect_ray_packet_first_hit(its.vertices, its.indices, tree, origin, dirs, hits);
+        size_t num_hits_expected = 0;
+        for (size_t i = 0; i < dirs.size(); ++ i) {
+            igl::Hit hit;
+            bool intersected = AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, tree, origin, dirs[i], hit);
+            REQUIRE(intersected == (hits[i].id >= 0));
+            if (intersected) {
+                ++ num_hits_expected;
+                REQUIRE(hits[i].id == hit.id);
+                REQUIRE(hits[i].t == Approx(hit.t));
+            }
+        }
+        REQUIRE(num_hits == num_hits_expected);
+    }
+}
+
+TEST_CASE("Slab test of a ray parallel to the slab", "[AABBIndirect]")
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    double tnear, tfar;
+    // Slab touching the ray origin, the product 0 * inf must not make the interval NaN.
+    AABBTreeIndirect::detail::ray_slab_invdir(0., 1., inf, tnear, tfar);
+    REQUIRE(tnear == - inf);
+    REQUIRE(tfar == inf);
+    AABBTreeIndirect::detail::ray_slab_invdir(-1., 0., - inf, tnear, tfar);
+    REQUIRE(tnear == - inf);
+    REQUIRE(tfar == inf);
+    // Slab not containing the ray origin is never intersected.
+    AABBTreeIndirect::detail::ray_slab_invdir(0.5, 1., inf, tnear, tfar);
+    REQUIRE(tnear > tfar);
+    AABBTreeIndirect::detail::ray_slab_invdir(0.5, 1., 2., tnear, tfar);
+    REQUIRE(tnear == Approx(1.));
+    REQUIRE(tfar == Approx(2.));
+}
@@ -0,0 +1,134 @@
+#include <catch2/catch.hpp>
+
+#include <libslic3r/Arachne/WallToolPaths.hpp>
+#include <libslic3r/Arachne/utils/PooledList.hpp>
+#include <libslic3r/ClipperUtils.hpp>
+
+#include <list>
+#include <random>
+
+using namespace Slic3r;
+
+static Arachne::WallToolPathsParams make_test_params()
+{
+    Arachne::WallToolPathsParams params;
+    params.min_bead_width                   = 0.34f;
+    params.min_feature_size                 = 0.1f;
+    params.min_length_factor                = 0.5f;
+    params.wall_transition_length           = 0.4f;
+    params.wall_transition_angle            = 10.f;
+    params.wall_transition_filter_deviation = 0.1f;
+    params.wall_distribution_count          = 1;
+    params.is_top_or_bottom_layer           = false;
+    return params;
+}
+
+using ToolPathKey = std::tuple<size_t, bool, bool, std::vector<std::pair<Point, coord_t>>>;
+
+// Order independent representation of the generated toolpaths.
+static std::vector<ToolPathKey> toolpath_keys(const std::vector<Arachne::VariableWidthLines> &toolpaths)
+{
+    std::vector<ToolPathKey> out;
+    for (const Arachne::VariableWidthLines &lines : toolpaths)
+        for (const Arachne::ExtrusionLine &line : lines) {
+            std::vector<std::pair<Point, coord_t>> junctions;
+            for (const Arachne::ExtrusionJunction &j : line.junctions)
+                junctions.emplace_back(j.p, j.w);
+            out.emplace_back(line.inset_idx, line.is_odd, line.is_closed, std::move(junctions));
+        }
+    std::sort(out.begin(), out.end(), [](const ToolPathKey &l, const ToolPathKey &r) {
+        if (std::get<0>(l) != std::get<0>(r))
+            return std::get<0>(l) < std::get<0>(r);
+        if (std::get<1>(l) != std::get<1>(r))
+            return std::get<1>(l) < std::get<1>(r);
+        if (std::get<2>(l) != std::get<2>(r))
+            return std::get<2>(l) < std::get<2>(r);
+        return std::lexicographical_compare(std::get<3>(l).begin(), std::get<3>(l).end(), std::get<3>(r).begin(), std::get<3>(r).end(),
+            [](const std::pair<Point, coord_t> &a, const std::pair<Point, coord_t> &b) {
+                return a.first.x() < b.first.x() || (a.first.x() == b.first.x() && (a.first.y() < b.first.y() || (a.first.y() == b.first.y() && a.second < b.second)));
+            });
+    });
+    return out;
+}
+
+static std::vector<Arachne::VariableWidthLines> generate_toolpaths(const Polygons &outline, bool split_islands = true)
+{
+    const coord_t bead_width = scaled<coord_t>(0.45);
+    Arachne::WallToolPathsParams params = make_test_params();
+    params.split_islands = split_islands;
+    Arachne::WallToolPaths wall_tool_paths(outline, bead_width, bead_width, 3, 0, 0.2, params);
+    return wall_tool_paths.getToolPaths();
+}
+
+SCENARIO("Arachne walls of independent islands", "[Arachne]") {
+    GIVEN("A perforated plate made of square rings of varying widths") {
+        ExPolygons islands;
+        for (int i = 0; i < 5; ++ i)
+            for (int j = 0; j < 4; ++ j) {
+                ExPolygon ring(Polygon::new_scale({ { 0., 0. }, { 6., 0. }, { 6., 6. }, { 0., 6. } }));
+                const double wall = 0.6 + 0.35 * (i + j);
+                ring.holes.emplace_back(Polygon::new_scale({ { wall, wall }, { wall, 6. - wall }, { 6. - wall, 6. - wall }, { 6. - wall, wall } }));
+                ring.translate(scaled<coord_t>(8. * i), scaled<coord_t>(8. * j));
+                islands.emplace_back(std::move(ring));
+            }
+        const Polygons outline = to_polygons(islands);
+
+        WHEN("Walls are generated for the whole layer") {
+            std::vector<Arachne::VariableWidthLines> toolpaths = generate_toolpaths(outline);
+            THEN("The result matches walls generated by a single skeletonization of the whole outline") {
+                std::vector<Arachne::VariableWidthLines> expected = generate_toolpaths(outline, false);
+                REQUIRE(! toolpaths.empty());
+                REQUIRE(toolpath_keys(toolpaths) == toolpath_keys(expected));
+            }
+            THEN("The result is deterministic") {
+                std::vector<Arachne::VariableWidthLines> toolpaths2 = generate_toolpaths(outline);
+                REQUIRE(toolpaths.size() == toolpaths2.size());
+                for (size_t i = 0; i < toolpaths.size(); ++ i) {
+                    REQUIRE(toolpaths[i].size() == toolpaths2[i].size());
+                    for (size_t j = 0; j < toolpaths[i].size(); ++ j) {
+                        const Arachne::ExtrusionLine &l1 = toolpaths[i][j];
+                        const Arachne::ExtrusionLine &l2 = toolpaths2[i][j];
+                        REQUIRE(l1.junctions.size() == l2.junctions.size());
+                        for (size_t k = 0; k < l1.junctions.size(); ++ k) {
+                            REQUIRE(l1.junctions[k].p == l2.junctions[k].p);
+                            REQUIRE(l1.junctions[k].w == l2.junctions[k].w);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("PooledList behaves like std::list", "[Arachne]") {
+    Arachne::PooledList<std::pair<int, std::shared_ptr<int>>> pooled;
+    std::list<std::pair<int, std::shared_ptr<int>>>           reference;
+    std::mt19937 rng(0);
+    for (int i = 0; i < 5000; ++ i) {
+        const int op = std::uniform_int_distribution<int>(0, 3)(rng);
+        if (op == 0) {
+            pooled.emplace_front(i, std::make_shared<int>(i));
+            reference.emplace_front(i, std::make_shared<int>(i));
+        } else if (op == 1) {
+            pooled.emplace_back(i, std::make_shared<int>(i));
+            reference.emplace_back(i, std::make_shared<int>(i));
+        } else if (! reference.empty()) {
+            // Erase the n-th element, through an iterator recovered from the element address.
+            const size_t n = std::uniform_int_distribution<size_t>(0, reference.size() - 1)(rng);
+            auto it_pooled = pooled.begin();
+            auto it_reference = reference.begin();
+            std::advance(it_pooled, n);
+            std::advance(it_reference, n);
+            REQUIRE(pooled.iterator_to(*it_pooled) == it_pooled);
+            pooled.erase(pooled.iterator_to(*it_pooled));
+            reference.erase(it_reference);
+        }
+        REQUIRE(pooled.size() == reference.size());
+    }
+    std::vector<int> values_pooled, values_reference;
+    for (const auto &v : pooled)
+        values_pooled.emplace_back(*v.second);
+    for (const auto &v : reference)
+        values_reference.emplace_back(*v.second);
+    REQUIRE(values_pooled == values_reference);
+}
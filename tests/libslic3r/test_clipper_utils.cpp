@@ -5,6 +5,7 @@
 #include <boost/filesystem.hpp>
 
 #include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/Clipper2Utils.hpp"
 #include "libslic3r/ExPolygon.hpp"
 #include "libslic3r/SVG.hpp"
 
@@ -299,3 +300,132 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+TEST_CASE("Clipper and Clipper2 operations produce equivalent results", "[ClipperUtils]") {
+    auto square = [](coord_t x, coord_t y, coord_t size) {
+        return Polygon{ { x, y }, { x + size, y }, { x + size, y + size }, { x, y + size } };
+    };
+    auto square_with_hole = [&square](coord_t x, coord_t y, coord_t size) {
+        ExPolygon expoly(square(x, y, size), square(x + size / 4, y + size / 4, size / 2));
+        expoly.holes.front().reverse();
+        return expoly;
+    };
+    Polygon circle;
+    for (size_t i = 0; i < 64; ++ i) {
+        double a = 2. * PI * double(i) / 64.;
+        circle.points.emplace_back(coord_t(scaled(70.) + scaled(12.) * cos(a)), coord_t(scaled(12.) * sin(a)));
+    }
+    // The offsets expect the input ExPolygons not to overlap.
+    ExPolygons subject { square_with_hole(0, 0, scaled(20.)), square_with_hole(scaled(30.), 0, scaled(10.)), ExPolygon(circle) };
+    Polygons   clip    { square(scaled(10.), scaled(10.), scaled(20.)), square(scaled(32.), scaled(2.), scaled(3.)), square(scaled(65.), scaled(-5.), scaled(30.)) };
+
+    auto run = [](auto &&fn, auto &&fn2) { return std::make_pair(fn(), fn2()); };
+    auto holes = [](const ExPolygons &expolys) {
+        return std::accumulate(expolys.begin(), expolys.end(), size_t(0), [](size_t acc, const ExPolygon &e) { return acc + e.holes.size(); });
+    };
+    // Both libraries round differently, compare topology exactly and the area within the rounding error of the vertices.
+    auto require_equivalent = [&holes](const ExPolygons &clipper, const ExPolygons &clipper2) {
+        REQUIRE(clipper2.size() == clipper.size());
+        REQUIRE(holes(clipper2) == holes(clipper));
+        for (const ExPolygon &expoly : clipper2) {
+            REQUIRE(expoly.contour.is_counter_clockwise());
+            for (const Polygon &hole : expoly.holes)
+                REQUIRE(hole.is_clockwise());
+        }
+        REQUIRE(area(clipper2) == Approx(area(clipper)).epsilon(0.001));
+    };
+
+    SECTION("union_ex") {
+        ExPolygons overlapping = subject;
+        overlapping.emplace_back(clip.front());
+        auto [clipper, clipper2] = run([&overlapping]() { return union_ex(overlapping); }, [&overlapping]() { return union_ex_2(overlapping); });
+        require_equivalent(clipper, clipper2);
+    }
+    SECTION("union_") {
+        Polygons polygons = to_polygons(subject);
+        append(polygons, clip);
+        auto [clipper, clipper2] = run([&]() { return union_(polygons); }, [&]() { return union_2(polygons); });
+        REQUIRE(clipper2.size() == clipper.size());
+        REQUIRE(area(clipper2) == Approx(area(clipper)).epsilon(0.001));
+    }
+    SECTION("diff_ex") {
+        auto [clipper, clipper2] = run([&]() { return diff_ex(subject, clip); }, [&]() { return diff_ex_2(subject, clip); });
+        require_equivalent(clipper, clipper2);
+    }
+    SECTION("diff_ex with safety offset") {
+        auto [clipper, clipper2] = run([&]() { return diff_ex(subject, clip, ApplySafetyOffset::Yes); }, [&]() { return diff_ex_2(subject, clip, ApplySafetyOffset::Yes); });
+        require_equivalent(clipper, clipper2);
+    }
+    SECTION("intersection_ex") {
+        auto [clipper, clipper2] = run([&]() { return intersection_ex(subject, clip); }, [&]() { return intersection_ex_2(subject, clip); });
+        require_equivalent(clipper, clipper2);
+    }
+    SECTION("offset_ex") {
+        for (float delta : { scaled<float>(1.), scaled<float>(-1.), scaled<float>(-3.), scaled<float>(4.) }) {
+            auto [clipper, clipper2] = run([&]() { return offset_ex(subject, delta); }, [&]() { return offset_ex_2(subject, delta); });
+            require_equivalent(clipper, clipper2);
+            std::tie(clipper, clipper2) = run([&]() { return offset_ex(to_polygons(subject), delta); }, [&]() { return offset_ex_2(to_polygons(subject), delta); });
+            require_equivalent(clipper, clipper2);
+        }
+    }
+    SECTION("offset_ex with round joins") {
+        auto [clipper, clipper2] = run([&]() { return offset_ex(subject, scaled<float>(2.), jtRound, scaled<double>(0.005)); },
+                                       [&]() { return offset_ex_2(subject, scaled<float>(2.), jtRound, scaled<double>(0.005)); });
+        require_equivalent(clipper, clipper2);
+    }
+    SECTION("offset") {
+        auto [clipper, clipper2] = run([&]() { return offset(subject, scaled<float>(-1.)); }, [&]() { return offset_2(subject, scaled<float>(-1.)); });
+        REQUIRE(clipper2.size() == clipper.size());
+        REQUIRE(area(clipper2) == Approx(area(clipper)).epsilon(0.001));
+    }
+    SECTION("opening_ex") {
+        // The narrow frame of the small square vanishes, the other islands survive.
+        auto [clipper, clipper2] = run([&]() { return opening_ex(subject, scaled<float>(1.5)); }, [&]() { return opening_ex_2(subject, scaled<float>(1.5)); });
+        require_equivalent(clipper, clipper2);
+        REQUIRE(clipper2.size() == 2);
+    }
+}
+
+TEST_CASE("Partitioned boolean operations match the plain ones", "[ClipperUtils]") {
+    auto square = [](coord_t x, coord_t y, coord_t size) {
+        return Polygon{ { x, y }, { x + size, y }, { x + size, y + size }, { x, y + size } };
+    };
+    // A plate of 10x10 separated islands with holes, the clip crosses some of them and the gaps between them.
+    ExPolygons subject;
+    for (int i = 0; i < 10; ++ i)
+        for (int j = 0; j < 10; ++ j) {
+            ExPolygon expoly(square(i * scaled(15.), j * scaled(15.), scaled(10.)), square(i * scaled(15.) + scaled(4.), j * scaled(15.) + scaled(4.), scaled(2.)));
+            expoly.holes.front().reverse();
+            subject.emplace_back(std::move(expoly));
+        }
+    ExPolygons clip { ExPolygon(square(scaled(5.), scaled(5.), scaled(30.))), ExPolygon(square(scaled(100.), scaled(-5.), scaled(12.))), ExPolygon(square(scaled(200.), scaled(200.), scaled(10.))) };
+
+    auto holes = [](const ExPolygons &expolys) {
+        return std::accumulate(expolys.begin(), expolys.end(), size_t(0), [](size_t acc, const ExPolygon &e) { return acc + e.holes.size(); });
+    };
+    auto require_same = [&holes](const ExPolygons &plain, const ExPolygons &partitioned) {
+        REQUIRE(partitioned.size() == plain.size());
+        REQUIRE(holes(partitioned) == holes(plain));
+        REQUIRE(area(partitioned) == Approx(area(plain)));
+    };
+
+    SECTION("diff_ex") {
+        require_same(diff_ex(subject, clip), diff_ex_partitioned(subject, clip));
+    }
+    SECTION("diff_ex with safety offset") {
+        require_same(diff_ex(subject, clip, ApplySafetyOffset::Yes), diff_ex_partitioned(subject, clip, ApplySafetyOffset::Yes));
+    }
+    SECTION("diff_ex passes the untouched islands through") {
+        ExPolygons result = diff_ex_partitioned(subject, to_polygons(clip));
+        REQUIRE(std::count(result.begin(), result.end(), subject.back()) == 1);
+    }
+    SECTION("intersection_ex") {
+        require_same(intersection_ex(subject, clip), intersection_ex_partitioned(subject, clip));
+        require_same(intersection_ex(to_polygons(subject), clip), intersection_ex_partitioned(to_polygons(subject), clip));
+    }
+    SECTION("single group") {
+        ExPolygons merged = union_ex(subject, to_polygons(offset_ex(subject, scaled<float>(3.))));
+        REQUIRE(merged.size() == 1);
+        require_same(diff_ex(merged, clip), diff_ex_partitioned(merged, clip));
+    }
+}
@@ -0,0 +1,154 @@
+#include <catch2/catch.hpp>
+
+#include <libslic3r/EdgeGrid.hpp>
+#include <libslic3r/Geometry.hpp>
+#include <libslic3r/Polygon.hpp>
+
+#include <random>
+
+using namespace Slic3r;
+
+// Contours around the origin and far away from it. Above 2^52 the coordinates are rounded when converted to doubles.
+static const Points origins { Point(0, 0), Point(coord_t(1) << 40, - (coord_t(1) << 40)), Point((coord_t(1) << 53) + 1, - (coord_t(1) << 53) - 3) };
+
+// Star shaped contour with a long spike and with collinear points inserted into some of its edges,
+// followed by a thin triangle next to the star.
+static Polygons star_and_sliver(std::mt19937 &rng, const Point &origin)
+{
+    std::uniform_real_distribution<double> radius(3., 10.);
+    const size_t num_points = 60;
+    Polygon      star;
+    for (size_t i = 0; i < num_points; ++ i) {
+        const double angle = 2. * PI * double(i) / double(num_points);
+        const double r     = i == 7 ? 19. : radius(rng);
+        star.points.emplace_back(origin + Point(scaled<coord_t>(r * cos(angle)), scaled<coord_t>(r * sin(angle))));
+    }
+    for (size_t i = num_points - 1; i > 0; -- i)
+        if (i % 5 == 0) {
+            // The midpoint of an edge with an even vector is exactly collinear.
+            const Point a = star.points[i - 1];
+            const Point v = coord_t(2) * ((star.points[i] - a) / coord_t(2));
+            star.points[i] = a + v;
+            star.points.insert(star.points.begin() + i, a + v / coord_t(2));
+        }
+    Polygon sliver({ Point(scaled<coord_t>(-12.), scaled<coord_t>(-12.)), Point(scaled<coord_t>(8.), scaled<coord_t>(-12.)), Point(scaled<coord_t>(8.), scaled<coord_t>(-12.) + 1) });
+    sliver.translate(origin);
+    return { star, sliver };
+}
+
+// Exact distance of a point to the closest segment of the contours.
+static double distance_exact(const Polygons &polygons, const Point &pt)
+{
+    double d_min = std::numeric_limits<double>::max();
+    for (const Polygon &polygon : polygons)
+        for (size_t i = 0; i < polygon.points.size(); ++ i) {
+            const Point   &a  = polygon.points[i];
+            const Point   &b  = polygon.points[(i + 1) % polygon.points.size()];
+            const Point    v  = b - a;
+            const Point    w  = pt - a;
+            const Point    wb = pt - b;
+            const int64_t  t  = int64_t(v.x()) * int64_t(w.x()) + int64_t(v.y()) * int64_t(w.y());
+            const int64_t  l2 = int64_t(v.x()) * int64_t(v.x()) + int64_t(v.y()) * int64_t(v.y());
+            double d;
+            if (t <= 0)
+                d = sqrt(double(int64_t(w.x()) * int64_t(w.x()) + int64_t(w.y()) * int64_t(w.y())));
+            else if (t >= l2)
+                d = sqrt(double(int64_t(wb.x()) * int64_t(wb.x()) + int64_t(wb.y()) * int64_t(wb.y())));
+            else
+                d = std::abs(double(int64_t(v.x()) * int64_t(w.y()) - int64_t(v.y()) * int64_t(w.x()))) / sqrt(double(l2));
+            d_min = std::min(d_min, d);
+        }
+    return d_min;
+}
+
+TEST_CASE("EdgeGrid distances match the exact distances", "[EdgeGrid]") {
+    std::mt19937  rng(1234);
+    const coord_t search_radius = scaled<coord_t>(2.);
+    for (const Point &origin : origins) {
+        const Polygons polygons = star_and_sliver(rng, origin);
+        EdgeGrid::Grid grid;
+        grid.create(polygons, scaled<coord_t>(1.));
+
+        // Random points, the vertices, points on the edges, on the extensions of the edges and right next to the edges.
+        const BoundingBox bbox = grid.bbox();
+        std::uniform_int_distribution<coord_t> random_x(bbox.min.x(), bbox.max.x());
+        std::uniform_int_distribution<coord_t> random_y(bbox.min.y(), bbox.max.y());
+        Points points;
+        for (size_t i = 0; i < 1000; ++ i)
+            points.emplace_back(random_x(rng), random_y(rng));
+        for (const Polygon &polygon : polygons)
+            for (size_t i = 0; i < polygon.points.size(); ++ i) {
+                const Point &a = polygon.points[i];
+                const Point  v = polygon.points[(i + 1) % polygon.points.size()] - a;
+                const Point  n = Point(- v.y(), v.x()) / std::max<coord_t>(1, coord_t(v.cast<double>().norm()));
+                points.emplace_back(a);
+                points.emplace_back(a + v / coord_t(2));
+                points.emplace_back(a - v);
+                points.emplace_back(a + coord_t(2) * v);
+                points.emplace_back(a + v / coord_t(2) + n);
+                points.emplace_back(a + v / coord_t(2) - n);
+            }
+
+        for (const Point &pt : points) {
+            const double d = distance_exact(polygons, pt);
+            if (std::abs(d - double(search_radius)) < 2.)
+                // Too close to the search radius to decide whether a segment is found.
+                continue;
+            const EdgeGrid::Grid::ClosestPointResult closest = grid.closest_point_signed_distance(pt, search_radius);
+            coordf_t   distance = 0.;
+            const bool found    = grid.signed_distance_edges(pt, search_radius, distance);
+            if (d < double(search_radius)) {
+                REQUIRE(closest.valid());
+                REQUIRE(std::abs(closest.distance) == Approx(d).margin(1e-6));
+                REQUIRE(found);
+                REQUIRE(std::abs(distance) == Approx(d).margin(1e-6));
+            } else {
+                REQUIRE(! closest.valid());
+                REQUIRE(! found);
+            }
+        }
+    }
+}
+
+TEST_CASE("EdgeGrid cell intersections match the exact segment intersections", "[EdgeGrid]") {
+    std::mt19937 rng(5678);
+    for (const Point &origin : origins) {
+        const Polygons polygons = star_and_sliver(rng, origin);
+        EdgeGrid::Grid grid;
+        grid.create(polygons, scaled<coord_t>(1.));
+
+        // Random segments, segments collinear with the edges overlapping them or touching their end points,
+        // segments perpendicular to the edges touching their end points.
+        const BoundingBox bbox = grid.bbox();
+        std::uniform_int_distribution<coord_t> random_x(bbox.min.x(), bbox.max.x());
+        std::uniform_int_distribution<coord_t> random_y(bbox.min.y(), bbox.max.y());
+        Lines segments;
+        for (size_t i = 0; i < 300; ++ i)
+            segments.emplace_back(Point(random_x(rng), random_y(rng)), Point(random_x(rng), random_y(rng)));
+        for (const Polygon &polygon : polygons)
+            for (size_t i = 0; i < polygon.points.size(); ++ i) {
+                const Point &a = polygon.points[i];
+                const Point &b = polygon.points[(i + 1) % polygon.points.size()];
+                const Point  v = b - a;
+                segments.emplace_back(a - v, b + v);
+                segments.emplace_back(b, b + v);
+                segments.emplace_back(b, b + Point(- v.y(), v.x()));
+            }
+
+        for (const Line &segment : segments) {
+            size_t num_mismatches = 0;
+            for (coord_t row = 0; row < coord_t(grid.rows()); ++ row)
+                for (coord_t col = 0; col < coord_t(grid.cols()); ++ col) {
+                    bool intersects = false;
+                    const auto cell_data_range = grid.cell_data_range(row, col);
+                    for (auto it = cell_data_range.first; it != cell_data_range.second && ! intersects; ++ it) {
+                        const Line &l = grid.cell_line(it);
+                        intersects = Geometry::segments_intersect(l.a, l.b, segment.a, segment.b);
+                    }
+                    if (grid.cell_intersects_line(row, col, segment.a, segment.b) != intersects)
+                        ++ num_mismatches;
+                }
+            REQUIRE(num_mismatches == 0);
+        }
+    }
+}
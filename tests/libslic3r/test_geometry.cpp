@@ -17,6 +17,7 @@
 
 #include "../libnest2d/printer_parts.hpp"
 
+#include <random>
 #include <unordered_set>
 
 using namespace Slic3r;
@@ -357,6 +358,105 @@ SCENARIO("Path chaining", "[Geometry]") {
 	}
 }
 
+TEST_CASE("Parallel path chaining", "[Geometry]") {
+	// Short vertical lines on a jittered grid, shuffled.
+	std::mt19937 rng(0);
+	std::uniform_int_distribution<coord_t> jitter(0, 500);
+	Polylines polylines;
+	for (int i = 0; i < 60; ++ i)
+		for (int j = 0; j < 40; ++ j) {
+			Point pt(i * 1000 + jitter(rng), j * 3000 + jitter(rng));
+			polylines.push_back({ pt, pt + Point(jitter(rng) - 250, 2000) });
+		}
+	std::shuffle(polylines.begin(), polylines.end(), rng);
+	auto connection_length = [](const Polylines &chained) {
+		double length = 0.;
+		for (size_t i = 1; i < chained.size(); ++ i)
+			length += (chained[i].first_point() - chained[i - 1].last_point()).cast<double>().norm();
+		return length;
+	};
+	auto same_lines = [&polylines](Polylines chained) {
+		auto key = [](const Polyline &pl) { return std::make_pair(std::min(pl.first_point(), pl.last_point()), std::max(pl.first_point(), pl.last_point())); };
+		std::vector<std::pair<Point, Point>> a, b;
+		for (const Polyline &pl : polylines) a.emplace_back(key(pl));
+		for (const Polyline &pl : chained) b.emplace_back(key(pl));
+		std::sort(a.begin(), a.end());
+		std::sort(b.begin(), b.end());
+		return a == b;
+	};
+	ChainParallelParams params;
+	params.min_items           = 0;
+	params.max_partition_items = 200;
+
+	const double sequential = connection_length(chain_polylines(polylines));
+	Polylines    parallel   = chain_polylines_parallel(Polylines(polylines), nullptr, params);
+	// All the lines are chained, with a quality close to the sequential chaining.
+	REQUIRE(same_lines(parallel));
+	REQUIRE(connection_length(parallel) < 1.25 * sequential);
+
+	params.refine_max_moves = 1000000;
+	Polylines refined = chain_polylines_parallel(Polylines(polylines), nullptr, params);
+	// The 2-opt refinement does not make the chain longer.
+	REQUIRE(same_lines(refined));
+	REQUIRE(connection_length(refined) <= connection_length(parallel) + EPSILON);
+
+	Point start = polylines[1234].last_point();
+	Polylines from_start = chain_polylines_parallel(Polylines(polylines), &start, params);
+	REQUIRE(from_start.front().first_point() == start);
+
+	Points points;
+	for (const Polyline &pl : polylines)
+		points.emplace_back(pl.first_point());
+	std::vector<size_t> order = chain_points_parallel(points, nullptr, params);
+	// Chained points are a permutation of the input.
+	std::sort(order.begin(), order.end());
+	REQUIRE(order.size() == points.size());
+	REQUIRE(std::adjacent_find(order.begin(), order.end()) == order.end());
+}
+
+TEST_CASE("Chaining segments with 2-opt refinement", "[Geometry]") {
+	// Segments of random direction around points of a jittered grid, as the islands of objects on a bed.
+	std::mt19937 rng(1);
+	std::uniform_int_distribution<coord_t> jitter(-5000, 5000);
+	std::vector<std::pair<Point, Point>> segments;
+	for (int i = 0; i < 12; ++ i)
+		for (int j = 0; j < 12; ++ j) {
+			Point center(i * 30000 + jitter(rng), j * 30000 + jitter(rng));
+			segments.emplace_back(center, center + Point(jitter(rng), jitter(rng)));
+		}
+	std::shuffle(segments.begin(), segments.end(), rng);
+	auto connection_length = [&segments](const std::vector<std::pair<size_t, bool>> &chain) {
+		double length = 0.;
+		for (size_t i = 1; i < chain.size(); ++ i) {
+			const Point &last  = chain[i - 1].second ? segments[chain[i - 1].first].first : segments[chain[i - 1].first].second;
+			const Point &first = chain[i].second ? segments[chain[i].first].second : segments[chain[i].first].first;
+			length += (first - last).cast<double>().norm();
+		}
+		return length;
+	};
+	std::vector<std::pair<size_t, bool>> greedy  = chain_segments_two_opt(segments, nullptr, 0);
+	std::vector<std::pair<size_t, bool>> refined = chain_segments_two_opt(segments, nullptr, 1000000);
+	// The 2-opt refinement does not make the chain longer.
+	REQUIRE(connection_length(refined) <= connection_length(greedy) + EPSILON);
+	std::vector<size_t> order;
+	for (const std::pair<size_t, bool> &segment : refined)
+		order.emplace_back(segment.first);
+	std::sort(order.begin(), order.end());
+	REQUIRE(order.size() == segments.size());
+	REQUIRE(std::adjacent_find(order.begin(), order.end()) == order.end());
+
+	// A refinement cut short by the move budget is reproducible.
+	std::vector<std::pair<size_t, bool>> limited = chain_segments_two_opt(segments, nullptr, 500);
+	REQUIRE(limited == chain_segments_two_opt(segments, nullptr, 500));
+	REQUIRE(connection_length(limited) <= connection_length(greedy) + EPSILON);
+
+	// The chain starts with the segment end closest to start_near, which stays first.
+	Point start = segments[57].second;
+	std::vector<std::pair<size_t, bool>> from_start = chain_segments_two_opt(segments, &start, 1000000);
+	REQUIRE(from_start.front().first == 57);
+	REQUIRE(from_start.front().second);
+}
+
 SCENARIO("Line distances", "[Geometry]"){
     GIVEN("A line"){
         Line line(Point(0, 0), Point(20, 0));
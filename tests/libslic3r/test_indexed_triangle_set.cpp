@@ -3,6 +3,7 @@
 #include <catch2/catch.hpp>
 
 #include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleSelector.hpp"
 
 using namespace Slic3r;
 
@@ -291,6 +292,30 @@ bool exist_triangle_with_twice_vertices(const std::vector<stl_triangle_vertex_in
     return false;
 }
 
+TEST_CASE("Simplify mesh by parallel Quadric edge collapse to 5%", "[its]")
+{
+    TriangleMesh mesh = load_model("frog_legs.obj");
+    double original_volume = its_volume(mesh.its);
+    uint32_t wanted_count = mesh.its.indices.size() * 0.05;
+    REQUIRE_FALSE(mesh.empty());
+    indexed_triangle_set its = mesh.its; // copy
+    float max_error = std::numeric_limits<float>::max();
+    // Force splitting of the small mesh into patches.
+    its_quadric_edge_collapse_parallel(its, wanted_count, &max_error, nullptr, nullptr, 4);
+    CHECK(its.indices.size() <= wanted_count);
+    CHECK(its.indices.size() + 2 >= wanted_count);
+    CHECK(!exist_triangle_with_twice_vertices(its.indices));
+    double volume = its_volume(its);
+    CHECK(fabs(original_volume - volume) < 33.);
+
+    CompareConfig cfg;
+    cfg.max_average_distance = 0.045f;
+    cfg.max_distance         = 0.32f;
+
+    CHECK(is_similar(mesh.its, its, cfg));
+    CHECK(is_similar(its, mesh.its, cfg));
+}
+
 TEST_CASE("Simplify trouble case", "[its]")
 {
     TriangleMesh tm = load_model("simplification.obj");
@@ -309,3 +334,39 @@ TEST_CASE("Simplified cube should not be empty.", "[its]")
     its_quadric_edge_collapse(its, wanted_count, &max_error);
     CHECK(!its.indices.empty());
 }
+
+TEST_CASE("Painted facets of all states extracted in a single pass", "[its][TriangleSelector]")
+{
+    TriangleMesh     mesh(its_make_sphere(10., PI / 30.));
+    TriangleSelector selector(mesh);
+    for (int i = 0; i < int(mesh.its.indices.size()); ++ i)
+        selector.set_facet(i, EnforcerBlockerType((i / 7) % 4));
+    // Split the triangles around a vertex to produce T-joints.
+    selector.select_patch(0, TriangleSelector::SinglePointCursor::cursor_factory(mesh.its.vertices.front(), Vec3f(0.f, 0.f, 100.f), 2.f,
+                          TriangleSelector::SPHERE, Transform3d::Identity(), TriangleSelector::ClippingPlane()),
+                          EnforcerBlockerType::Extruder5, Transform3d::Identity(), true);
+
+    std::vector<indexed_triangle_set> facets, facets_strict;
+    selector.get_facets(facets);
+    selector.get_facets_strict(facets_strict);
+    REQUIRE(facets.size() == size_t(EnforcerBlockerType::ExtruderMax) + 1);
+    REQUIRE(facets_strict.size() == facets.size());
+
+    auto area = [](const indexed_triangle_set &its) {
+        double out = 0.;
+        for (const stl_triangle_vertex_indices &f : its.indices)
+            out += 0.5 * (its.vertices[f(1)] - its.vertices[f(0)]).cross(its.vertices[f(2)] - its.vertices[f(0)]).cast<double>().norm();
+        return out;
+    };
+    for (size_t state = 0; state < facets.size(); ++ state) {
+        indexed_triangle_set its = selector.get_facets(EnforcerBlockerType(state));
+        CHECK(facets[state].indices == its.indices);
+        CHECK(facets[state].vertices == its.vertices);
+        // The single state variant keeps all the vertices of the selector, the indices differ.
+        indexed_triangle_set its_strict = selector.get_facets_strict(EnforcerBlockerType(state));
+        CHECK(facets_strict[state].indices.size() == its_strict.indices.size());
+        CHECK(area(facets_strict[state]) == Approx(area(its_strict)));
+        CHECK(facets_strict[state].vertices.size() <= its_strict.vertices.size());
+    }
+    CHECK(facets_strict[size_t(EnforcerBlockerType::Extruder5)].indices.size() > facets[size_t(EnforcerBlockerType::Extruder5)].indices.size());
+}
@@ -0,0 +1,89 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/MeshProxy.hpp"
+
+using namespace Slic3r;
+
+TEST_CASE("Mesh proxy of a fine sphere", "[MeshProxy]") {
+    const double radius = 10.;
+    Model        model;
+    ModelObject *object = model.add_object();
+    ModelVolume *volume = object->add_volume(TriangleMesh(its_make_sphere(radius, PI / 180.)));
+    object->add_instance();
+    REQUIRE(volume->mesh().its.indices.size() > MeshProxy::Params().max_triangles);
+
+    GIVEN("No proxy was built") {
+        THEN("There is no proxy") {
+            REQUIRE(object->proxy_mesh() == nullptr);
+        }
+    }
+
+    WHEN("The proxy is built") {
+        object->update_proxy_mesh();
+        std::shared_ptr<const MeshProxy> proxy = object->proxy_mesh();
+        REQUIRE(proxy != nullptr);
+        const indexed_triangle_set &its = proxy->its();
+        THEN("The proxy is decimated") {
+            REQUIRE(proxy->ready());
+            REQUIRE(proxy->decimated());
+            REQUIRE(its.indices.size() <= MeshProxy::Params().max_triangles);
+        }
+        THEN("The proxy stays within the error bound") {
+            const double max_distance = MeshProxy::Params().max_relative_error * 2. * sqrt(3.) * radius;
+            double       sum_squared  = 0.;
+            for (const stl_vertex &v : its.vertices)
+                sum_squared += sqr(v.cast<double>().norm() - radius);
+            REQUIRE(sqrt(sum_squared / double(its.vertices.size())) < max_distance);
+        }
+        THEN("Building the proxy again keeps it") {
+            object->update_proxy_mesh();
+            REQUIRE(object->proxy_mesh() == proxy);
+        }
+    }
+
+    WHEN("The volume is transformed after the proxy was built") {
+        object->update_proxy_mesh();
+        volume->set_offset(Vec3d(1., 2., 3.));
+        THEN("The proxy is invalidated") {
+            REQUIRE(object->proxy_mesh() == nullptr);
+        }
+        THEN("The rebuilt proxy is transformed") {
+            object->update_proxy_mesh();
+            std::shared_ptr<const MeshProxy> proxy = object->proxy_mesh();
+            REQUIRE(proxy != nullptr);
+            REQUIRE(bounding_box(proxy->its()).center().cast<double>().isApprox(Vec3d(1., 2., 3.), 0.1));
+        }
+    }
+
+    WHEN("The mesh is replaced after the proxy was built") {
+        object->update_proxy_mesh();
+        volume->set_mesh(its_make_cube(10., 10., 10.));
+        THEN("The proxy is invalidated") {
+            REQUIRE(object->proxy_mesh() == nullptr);
+        }
+        THEN("The small mesh is not decimated") {
+            object->update_proxy_mesh();
+            std::shared_ptr<const MeshProxy> proxy = object->proxy_mesh();
+            REQUIRE(proxy != nullptr);
+            REQUIRE(! proxy->decimated());
+            REQUIRE(proxy->its().indices.size() == 12);
+        }
+    }
+
+    WHEN("A model part is added after the proxy was built") {
+        object->update_proxy_mesh();
+        object->add_volume(TriangleMesh(its_make_cube(1., 1., 1.)));
+        THEN("The proxy is invalidated") {
+            REQUIRE(object->proxy_mesh() == nullptr);
+        }
+    }
+
+    WHEN("The model is destroyed while the proxy is being decimated") {
+        object->update_proxy_mesh();
+        model.clear_objects();
+        THEN("The background thread is stopped and joined") {
+            REQUIRE(model.objects.empty());
+        }
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/MeshBoolean.hpp>
+#include <libslic3r/CSGMesh/PerformCSGMeshBooleans.hpp>
 
 using namespace Slic3r;
 
@@ -23,3 +24,63 @@ TEST_CASE("CGAL and TriangleMesh conversions", "[MeshBoolean]") {
     
     REQUIRE(! MeshBoolean::cgal::does_self_intersect(M));
 }
+
+TEST_CASE("CSG parts evaluated in batches match the sequential booleans", "[MeshBoolean]") {
+    indexed_triangle_set cube = its_make_cube(10., 10., 10.);
+    indexed_triangle_set hole = its_make_cylinder(2., 20.);
+    auto translation = [](double x, double y) { return Transform3f(Eigen::Translation3f(float(x), float(y), -5.f)); };
+
+    std::vector<csg::CSGPart> parts;
+    parts.emplace_back(&cube, csg::CSGType::Union);
+    parts.emplace_back(&hole, csg::CSGType::Difference, translation(3., 3.));
+    parts.emplace_back(&hole, csg::CSGType::Difference, translation(7., 3.));
+    parts.emplace_back(&hole, csg::CSGType::Difference, translation(5., 7.));
+
+    indexed_triangle_set expected = cube;
+    for (size_t i = 1; i < parts.size(); ++ i) {
+        indexed_triangle_set tool = hole;
+        its_transform(tool, parts[i].trafo, true);
+        MeshBoolean::cgal::minus(expected, tool);
+    }
+
+    csg::mesh_cache<MeshBoolean::cgal::CGALMeshPtr>().clear();
+    auto result = csg::perform_csgmesh_booleans(range(parts));
+    REQUIRE(result);
+    TriangleMesh M = MeshBoolean::cgal::cgal_to_triangle_mesh(*result);
+    REQUIRE(M.volume() == Approx(its_volume(expected)));
+
+    // Evaluated again from the memoized result.
+    auto cached = csg::perform_csgmesh_booleans(range(parts));
+    REQUIRE(cached);
+    REQUIRE(MeshBoolean::cgal::cgal_to_triangle_mesh(*cached).volume() == Approx(M.volume()));
+}
+
+TEST_CASE("CSG parts evaluated with mcut match the sequential booleans", "[MeshBoolean]") {
+    indexed_triangle_set cube = its_make_cube(20., 20., 10.);
+    indexed_triangle_set hole = its_make_cylinder(2., 20.);
+    auto translation = [](double x, double y) { return Transform3f(Eigen::Translation3f(float(x), float(y), -5.f)); };
+
+    // Disjoint negative parts, mcut must not combine them into a single operand.
+    std::vector<csg::CSGPart> parts;
+    parts.emplace_back(&cube, csg::CSGType::Union);
+    for (const Vec2d &pos : { Vec2d(5., 5.), Vec2d(15., 5.), Vec2d(5., 15.), Vec2d(15., 15.), Vec2d(10., 10.) })
+        parts.emplace_back(&hole, csg::CSGType::Difference, translation(pos.x(), pos.y()));
+
+    MeshBoolean::mcut::McutMeshPtr expected = MeshBoolean::mcut::triangle_mesh_to_mcut(cube);
+    for (size_t i = 1; i < parts.size(); ++ i) {
+        indexed_triangle_set tool = hole;
+        its_transform(tool, parts[i].trafo, true);
+        MeshBoolean::mcut::do_boolean(*expected, *MeshBoolean::mcut::triangle_mesh_to_mcut(tool), "A_NOT_B");
+    }
+    TriangleMesh expected_mesh = MeshBoolean::mcut::mcut_to_triangle_mesh(*expected);
+
+    csg::mesh_cache<MeshBoolean::mcut::McutMeshPtr>().clear();
+    auto result = csg::perform_csgmesh_booleans_mcut(range(parts));
+    REQUIRE(result);
+    TriangleMesh M = MeshBoolean::mcut::mcut_to_triangle_mesh(*result);
+    REQUIRE(M.its.indices.size() == expected_mesh.its.indices.size());
+    REQUIRE(M.volume() == Approx(expected_mesh.volume()));
+    // Each hole is subtracted once.
+    indexed_triangle_set hole_in_cube = its_make_cylinder(2., 10.);
+    REQUIRE(M.volume() == Approx(its_volume(cube) - 5. * its_volume(hole_in_cube)));
+}
@@ -3,6 +3,7 @@
 #include <random>
 #include <numeric>
 #include <cstdint>
+#include <cstring>
 
 #include "sla_test_utils.hpp"
 
@@ -10,6 +11,8 @@
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
 #include <libslic3r/SLA/Concurrency.hpp>
 
+#include <miniz.h>
+
 namespace {
 
 const char *const BELOW_PAD_TEST_OBJECTS[] = {
@@ -223,6 +226,37 @@ TEST_CASE("RasterizedPolygonAreaShouldMatch", "[SLARasterOutput]") {
 }
 
 
+TEST_CASE("ReusedRasterEncodesAsMinizPNG", "[SLARasterOutput]") {
+    sla::Resolution res{640, 360};
+    sla::PixelDim   pixdim{120. / res.width_px, 68. / res.height_px};
+
+    sla::RasterGrayscaleAAGammaPower raster(res, pixdim, {}, 1.);
+    auto bb = BoundingBox({0, 0}, {scaled(120.), scaled(68.)});
+
+    for (double size : {10., 40.}) {
+        // The raster is reused for the next layer as by SLAArchive::draw_layers().
+        raster.clear();
+        REQUIRE(raster_pxsum(raster) == 0);
+
+        ExPolygon poly = square_with_hole(size);
+        poly.translate(bb.center().x(), bb.center().y());
+        raster.draw(poly);
+
+        std::vector<uint8_t> pixels(res.pixels());
+        for (size_t row = 0; row < res.height_px; ++row)
+            for (size_t col = 0; col < res.width_px; ++col)
+                pixels[row * res.width_px + col] = raster.read_pixel(col, row);
+
+        sla::EncodedRaster png = raster.encode(sla::PNGRasterEncoder());
+        size_t len = 0;
+        void *expected = tdefl_write_image_to_png_file_in_memory(pixels.data(), int(res.width_px), int(res.height_px), 1, &len);
+        REQUIRE(expected != nullptr);
+        REQUIRE(png.size() == len);
+        REQUIRE(std::memcmp(png.data(), expected, len) == 0);
+        mz_free(expected);
+    }
+}
+
 TEST_CASE("halfcone test", "[halfcone]") {
     sla::DiffBridge br{Vec3d{1., 1., 1.}, Vec3d{10., 10., 10.}, 0.25, 0.5};
 